@@ -62,6 +62,10 @@ typedef struct {
     Search for hashnr/key/keylen in the list starting from 'head' and
     position the cursor. The list is ORDER BY hashnr, key
 
+    If callback is set, all normal nodes of the list are passed to it
+    instead, together with 'key' as an argument, until it returns
+    non-zero.
+
   RETURN
     0 - not found
     1 - found
@@ -69,9 +73,12 @@ typedef struct {
   NOTE
     cursor is positioned in either case
     pins[0..2] are used, they are NOT removed on return
+    callback is called with the node pinned; it may be called more than
+    once for the same node if the list is modified concurrently
 */
 static int lfind(LF_SLIST * volatile *head, CHARSET_INFO *cs, uint32 hashnr,
-                 const uchar *key, uint keylen, CURSOR *cursor, LF_PINS *pins)
+                 const uchar *key, uint keylen, CURSOR *cursor, LF_PINS *pins,
+                 my_hash_walk_action callback)
 {
   uint32       cur_hashnr;
   const uchar  *cur_key;
@@ -104,7 +111,12 @@ retry:
     }
     if (!DELETED(link))
     {
-      if (cur_hashnr >= hashnr)
+      if (callback)
+      {
+        if ((cur_hashnr & 1) && callback(cursor->curr + 1, (void*) key))
+          return 1;
+      }
+      else if (cur_hashnr >= hashnr)
       {
         int r= 1;
         if (cur_hashnr > hashnr ||
@@ -157,7 +169,7 @@ static LF_SLIST *linsert(LF_SLIST * volatile *head, CHARSET_INFO *cs,
   for (;;)
   {
     if (lfind(head, cs, node->hashnr, node->key, node->keylen,
-              &cursor, pins) &&
+              &cursor, pins, 0) &&
         (flags & LF_HASH_UNIQUE))
     {
       res= 0; /* duplicate found */
@@ -208,7 +220,7 @@ static int ldelete(LF_SLIST * volatile *head, CHARSET_INFO *cs, uint32 hashnr,
 
   for (;;)
   {
-    if (!lfind(head, cs, hashnr, key, keylen, &cursor, pins))
+    if (!lfind(head, cs, hashnr, key, keylen, &cursor, pins, 0))
     {
       res= 1; /* not found */
       break;
@@ -232,7 +244,7 @@ static int ldelete(LF_SLIST * volatile *head, CHARSET_INFO *cs, uint32 hashnr,
             (to ensure the number of "set DELETED flag" actions
             is equal to the number of "remove from the list" actions)
           */
-          lfind(head, cs, hashnr, key, keylen, &cursor, pins);
+          lfind(head, cs, hashnr, key, keylen, &cursor, pins, 0);
         }
         res= 0;
         break;
@@ -263,7 +275,7 @@ static LF_SLIST *lsearch(LF_SLIST * volatile *head, CHARSET_INFO *cs,
                          LF_PINS *pins)
 {
   CURSOR cursor;
-  int res= lfind(head, cs, hashnr, key, keylen, &cursor, pins);
+  int res= lfind(head, cs, hashnr, key, keylen, &cursor, pins, 0);
   if (res)
     _lf_pin(pins, 2, cursor.curr);
   else
@@ -448,11 +460,14 @@ int lf_hash_delete(LF_HASH *hash, LF_PINS *pins, const void *key, uint keylen)
   NOTE
     see lsearch() for pin usage notes
 */
-void *lf_hash_search(LF_HASH *hash, LF_PINS *pins, const void *key, uint keylen)
+void *lf_hash_search_using_hash_value(LF_HASH *hash, LF_PINS *pins,
+                                      my_hash_value_type hashnr,
+                                      const void *key, uint keylen)
 {
   LF_SLIST * volatile *el, *found;
-  uint bucket, hashnr= calc_hash(hash, (uchar *)key, keylen);
+  uint bucket;
 
+  hashnr&= INT_MAX32;
   bucket= hashnr % hash->size;
   lf_rwlock_by_pins(pins);
   el= _lf_dynarray_lvalue(&hash->array, bucket);
@@ -466,6 +481,56 @@ void *lf_hash_search(LF_HASH *hash, LF_PINS *pins, const void *key, uint keylen)
   return found ? found+1 : 0;
 }
 
+void *lf_hash_search(LF_HASH *hash, LF_PINS *pins, const void *key, uint keylen)
+{
+  return lf_hash_search_using_hash_value(hash, pins,
+                                         calc_hash(hash, (uchar*) key, keylen),
+                                         key, keylen);
+}
+
+/*
+  DESCRIPTION
+    calls 'action' for every element of the hash, passing 'argument' to it,
+    until 'action' returns non-zero
+
+  RETURN
+    0 - all elements were visited
+    1 - 'action' returned non-zero
+
+  NOTE
+    it uses pins[0..2], on return all pins are removed.
+    The element passed to 'action' is pinned, but it is not protected
+    against concurrent deletion: it may be visited after it was deleted,
+    and it may be visited more than once. Elements inserted during the
+    walk may or may not be visited.
+*/
+int lf_hash_iterate(LF_HASH *hash, LF_PINS *pins,
+                    my_hash_walk_action action, void *argument)
+{
+  CURSOR cursor;
+  int res;
+  LF_SLIST * volatile *el;
+
+  lf_rwlock_by_pins(pins);
+  el= _lf_dynarray_lvalue(&hash->array, 0);
+  if (unlikely(!el))
+  {
+    lf_rwunlock_by_pins(pins);
+    return 0; /* if there's no bucket 0, the hash is empty */
+  }
+  if (*el == NULL && unlikely(initialize_bucket(hash, el, 0, pins)))
+  {
+    lf_rwunlock_by_pins(pins);
+    return 0;
+  }
+  res= lfind(el, 0, 0, (uchar*) argument, 0, &cursor, pins, action);
+  _lf_unpin(pins, 2);
+  _lf_unpin(pins, 1);
+  _lf_unpin(pins, 0);
+  lf_rwunlock_by_pins(pins);
+  return res;
+}
+
 static const uchar *dummy_key= (uchar*)"";
 
 /*
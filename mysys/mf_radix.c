@@ -58,3 +58,105 @@ void radixsort_for_str_ptr(uchar **base, uint number_of_elements, size_t size_of
   next:;
   }
 }
+
+
+/*
+  MSD radixsort for pointers to fixed length strings.
+
+  The pointers are distributed by the first byte of the strings, then
+  each bucket by the next byte and so on. Bytes which are equal in all
+  strings of a bucket (like padding of sort keys) are skipped without
+  moving the pointers. Small buckets, and buckets still unsorted after
+  RADIX_MSD_MAX_LEVELS distributions, are sorted with my_qsort2() on the
+  remaining suffix of the strings. Unlike radixsort_for_str_ptr() this
+  works well for long strings too.
+  Needs an extra buffer of number_of_elements pointers.
+*/
+
+#define RADIX_MSD_MIN_ITEMS  64
+#define RADIX_MSD_MAX_LEVELS 8
+
+typedef struct st_radix_msd_suffix
+{
+  size_t offset, length;
+} RADIX_MSD_SUFFIX;
+
+
+static int radix_msd_cmp_suffix(const void *arg, const void *a,
+                                const void *b)
+{
+  const RADIX_MSD_SUFFIX *suffix= (const RADIX_MSD_SUFFIX*) arg;
+  return memcmp(*(uchar**) a + suffix->offset,
+                *(uchar**) b + suffix->offset, suffix->length);
+}
+
+
+static void radixsort_msd(uchar **base, uint number_of_elements,
+                          size_t size_of_element, size_t pass,
+                          uchar **buffer, uint levels)
+{
+  uchar **end= base + number_of_elements, **ptr;
+  uint32 count[256];
+  uint i;
+
+  if (number_of_elements >= RADIX_MSD_MIN_ITEMS)
+  {
+    /* Skip the bytes which are the same in all strings */
+    size_t common= size_of_element;
+    for (ptr= base + 1 ; ptr < end && common > pass ; ptr++)
+    {
+      if (!memcmp(base[0] + pass, ptr[0] + pass, common - pass))
+        continue;
+      for (i= (uint) pass ; base[0][i] == ptr[0][i] ; i++) ;
+      common= i;
+    }
+    pass= common;
+  }
+
+  if (number_of_elements >= RADIX_MSD_MIN_ITEMS && pass < size_of_element &&
+      levels)
+  {
+    bzero((uchar*) count, sizeof(count));
+    for (ptr= base ; ptr < end ; ptr++)
+      count[ptr[0][pass]]++;
+
+    for (i= 1 ; i < 256 ; i++)
+      count[i]+= count[i-1];
+    for (ptr= end ; ptr-- != base ;)
+      buffer[--count[ptr[0][pass]]]= *ptr;
+    memcpy(base, buffer, number_of_elements * sizeof(uchar*));
+
+    /* count[i] is now the start of the bucket for byte value i */
+    for (i= 0 ; i < 256 ; i++)
+    {
+      uint32 bucket_end= i < 255 ? count[i+1] : number_of_elements;
+      if (bucket_end - count[i] > 1)
+        radixsort_msd(base + count[i], bucket_end - count[i],
+                      size_of_element, pass + 1, buffer, levels - 1);
+    }
+    return;
+  }
+
+  if (number_of_elements > 1 && pass < size_of_element)
+  {
+    RADIX_MSD_SUFFIX suffix;
+    suffix.offset= pass;
+    suffix.length= size_of_element - pass;
+    my_qsort2(base, number_of_elements, sizeof(uchar*),
+              radix_msd_cmp_suffix, &suffix);
+  }
+}
+
+
+my_bool radixsort_msd_is_applicable(uint n_items, size_t size_of_element)
+{
+  return size_of_element > 0 && n_items >= RADIX_MSD_MIN_ITEMS * 16;
+}
+
+
+void radixsort_msd_for_str_ptr(uchar **base, uint number_of_elements,
+                               size_t size_of_element, uchar **buffer)
+{
+  radixsort_msd(base, number_of_elements, size_of_element, 0, buffer,
+                RADIX_MSD_MAX_LEVELS);
+}
@@ -48,7 +48,9 @@ public:
   {
     return &this->queries;
   }
-} *qc;
+};
+
+static Partitioned_query_cache *qc;
 
 bool schema_table_store_record(THD *thd, TABLE *table);
 
@@ -70,22 +72,17 @@ static ST_FIELD_INFO qc_info_fields[]=
   {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
 };
 
-static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
-                                              COND *cond)
+static int qc_info_fill_partition(THD *thd, TABLE *table,
+                                  Accessible_Query_Cache *part)
 {
   int status= 1;
   CHARSET_INFO *scs= system_charset_info;
-  TABLE *table= tables->table;
-  HASH *queries = qc->get_queries();
-
-  /* one must have PROCESS privilege to see others' queries */
-  if (check_global_access(thd, PROCESS_ACL, true))
-    return 0;
+  HASH *queries = part->get_queries();
 
-  if (qc->try_lock(thd))
+  if (part->try_lock(thd))
     return 0; // QC is or is being disabled
 
-  /* loop through all queries in the query cache */
+  /* loop through all queries in the query cache partition */
   for (uint i= 0; i < queries->records; i++)
   {
     const uchar *query_cache_block_raw;
@@ -164,27 +161,105 @@ static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
   status = 0;
 
 cleanup:
-  qc->unlock();
+  part->unlock();
   return status;
 }
 
-static int qc_info_plugin_init(void *p)
+static int qc_info_fill_table(THD *thd, TABLE_LIST *tables,
+                                              COND *cond)
 {
-  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+  /* one must have PROCESS privilege to see others' queries */
+  if (check_global_access(thd, PROCESS_ACL, true))
+    return 0;
 
-  schema->fields_info= qc_info_fields;
-  schema->fill_table= qc_info_fill_table;
+  for (uint i= 0; i < qc->partition_count(); i++)
+  {
+    if (qc_info_fill_partition(thd, tables->table,
+                               (Accessible_Query_Cache *) qc->partition(i)))
+      return 1;
+  }
+  return 0;
+}
 
+static int qc_init()
+{
 #ifdef _WIN32
-  qc = (Accessible_Query_Cache *)
-    GetProcAddress(GetModuleHandle(NULL), "?query_cache@@3VQuery_cache@@A");
+  qc = (Partitioned_query_cache *)
+    GetProcAddress(GetModuleHandle(NULL),
+                   "?query_cache@@3VPartitioned_query_cache@@A");
 #else
-  qc = (Accessible_Query_Cache *)&query_cache;
+  qc = &query_cache;
 #endif
 
   return qc == 0;
 }
 
+static int qc_info_plugin_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= qc_info_fields;
+  schema->fill_table= qc_info_fill_table;
+
+  return qc_init();
+}
+
+/* ST_FIELD_INFO is defined in table.h */
+static ST_FIELD_INFO qc_partitions_fields[]=
+{
+  {"PARTITION_ID", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"QUERY_CACHE_SIZE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"FREE_MEMORY", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"QUERIES_IN_CACHE", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"HITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"INSERTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"NOT_CACHED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"LOWMEM_PRUNES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"LOCK_WAITS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"LOCK_TIMEOUTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
+};
+
+/*
+  The counters are read without locking the partitions, like the Qcache_%
+  status variables.
+*/
+static int qc_partitions_fill_table(THD *thd, TABLE_LIST *tables,
+                                    COND *cond)
+{
+  TABLE *table= tables->table;
+
+  for (uint p= 0; p < qc->partition_count(); p++)
+  {
+    Query_cache *part= qc->partition(p);
+
+    table->field[0]->store(p, 0);
+    table->field[1]->store(part->query_cache_size, 1);
+    table->field[2]->store(part->free_memory, 1);
+    table->field[3]->store(part->queries_in_cache, 1);
+    table->field[4]->store(part->hits, 1);
+    table->field[5]->store(part->inserts, 1);
+    table->field[6]->store(part->refused, 1);
+    table->field[7]->store(part->lowmem_prunes, 1);
+    table->field[8]->store(part->lock_waits, 1);
+    table->field[9]->store(part->lock_timeouts, 1);
+
+    if (schema_table_store_record(thd, table))
+      return 1;
+  }
+  return 0;
+}
+
+static int qc_partitions_plugin_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= qc_partitions_fields;
+  schema->fill_table= qc_partitions_fill_table;
+
+  return qc_init();
+}
+
 
 static struct st_mysql_information_schema qc_info_plugin=
 { MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
@@ -208,6 +283,21 @@ maria_declare_plugin(query_cache_info)
   NULL,                       /* system variables     */
   "1.0",                      /* version as a string  */
   MariaDB_PLUGIN_MATURITY_GAMMA
+},
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &qc_info_plugin,
+  "QUERY_CACHE_PARTITION_STATS",
+  "Percona",
+  "Statistics of the query cache partitions.",
+  PLUGIN_LICENSE_BSD,
+  qc_partitions_plugin_init,  /* Plugin Init          */
+  0,                          /* Plugin Deinit        */
+  0x0100,                     /* version, hex         */
+  NULL,                       /* status variables     */
+  NULL,                       /* system variables     */
+  "1.0",                      /* version as a string  */
+  MariaDB_PLUGIN_MATURITY_EXPERIMENTAL
 }
 maria_declare_plugin_end;
 
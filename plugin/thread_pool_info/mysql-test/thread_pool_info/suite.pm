@@ -0,0 +1,13 @@
+package My::Suite::Thread_pool_info;
+
+@ISA = qw(My::Suite);
+
+return "No Thread_pool_info plugin" unless $ENV{THREAD_POOL_INFO_SO} or
+  $::mysqld_variables{'thread-pool-groups'} eq "ON";
+
+return "No thread pool" unless defined $::mysqld_variables{'thread-pool-size'};
+
+sub is_default { 1 }
+
+bless { };
+
@@ -0,0 +1,173 @@
+/* Copyright (C) 2026 Percona
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+
+/*
+  INFORMATION_SCHEMA tables with statistics of the thread groups of the
+  thread pool. They are empty unless thread_handling=pool-of-threads.
+*/
+
+#define MYSQL_SERVER 1
+#include <sql_class.h>
+#include <sql_show.h>
+#include <sql_parse.h>          // check_global_access
+#include <sql_acl.h>            // PROCESS_ACL
+#include <threadpool.h>
+#include <mysql/plugin.h>
+
+static ST_FIELD_INFO groups_fields[]=
+{
+  {"GROUP_ID", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"CONNECTIONS", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"THREADS", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"ACTIVE_THREADS", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"QUEUE_LENGTH", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"HIGH_PRIO_QUEUE_LENGTH", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"HIGH_PRIO_EVENTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"LOW_PRIO_EVENTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"STEALS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {"STOLEN", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
+};
+
+static int groups_fill_table(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  TP_GROUP_STATS stats;
+
+  if (check_global_access(thd, PROCESS_ACL, true))
+    return 0;
+
+  for (uint i= 0; !tp_get_group_stats(i, &stats); i++)
+  {
+    table->field[0]->store(i, 1);
+    table->field[1]->store(stats.connections, 1);
+    table->field[2]->store(stats.threads, 1);
+    table->field[3]->store(stats.active_threads, 1);
+    table->field[4]->store(stats.queue_length, 1);
+    table->field[5]->store(stats.high_prio_queue_length, 1);
+    table->field[6]->store(stats.high_prio_events, 1);
+    table->field[7]->store(stats.low_prio_events, 1);
+    table->field[8]->store(stats.steals, 1);
+    table->field[9]->store(stats.stolen, 1);
+
+    if (schema_table_store_record(thd, table))
+      return 1;
+  }
+  return 0;
+}
+
+static int groups_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= groups_fields;
+  schema->fill_table= groups_fill_table;
+  return 0;
+}
+
+
+#define TIME_STRING_LENGTH 14
+
+static ST_FIELD_INFO queue_latency_fields[]=
+{
+  {"GROUP_ID", MY_INT32_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONG, 0, 0, 0, 0},
+  {"TIME", TIME_STRING_LENGTH, MYSQL_TYPE_STRING, 0, 0, 0, 0},
+  {"COUNT", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0, 0, 0, 0},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, 0}
+};
+
+/*
+  One row per group and bucket. TIME is the upper bound of the bucket
+  in seconds, like in QUERY_RESPONSE_TIME.
+*/
+static int queue_latency_fill_table(THD *thd, TABLE_LIST *tables, COND *cond)
+{
+  TABLE *table= tables->table;
+  TP_GROUP_STATS stats;
+
+  if (check_global_access(thd, PROCESS_ACL, true))
+    return 0;
+
+  for (uint i= 0; !tp_get_group_stats(i, &stats); i++)
+  {
+    ulonglong bound= TP_QUEUE_LATENCY_MIN;
+    for (uint b= 0; b < TP_QUEUE_LATENCY_BUCKETS; b++, bound*= 10)
+    {
+      char time[TIME_STRING_LENGTH + 1];
+      size_t length;
+
+      if (b == TP_QUEUE_LATENCY_BUCKETS - 1)
+        length= my_snprintf(time, sizeof(time), "TOO LONG");
+      else
+        length= my_snprintf(time, sizeof(time), "%7u.%06u",
+                            (uint) (bound / 1000000),
+                            (uint) (bound % 1000000));
+
+      table->field[0]->store(i, 1);
+      table->field[1]->store(time, length, system_charset_info);
+      table->field[2]->store(stats.queue_latency[b], 1);
+
+      if (schema_table_store_record(thd, table))
+        return 1;
+    }
+  }
+  return 0;
+}
+
+static int queue_latency_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE *)p;
+
+  schema->fields_info= queue_latency_fields;
+  schema->fill_table= queue_latency_fill_table;
+  return 0;
+}
+
+
+static struct st_mysql_information_schema thread_pool_info_plugin=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
+maria_declare_plugin(thread_pool_info)
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &thread_pool_info_plugin,
+  "THREAD_POOL_GROUPS",
+  "Percona",
+  "Statistics of the thread pool groups.",
+  PLUGIN_LICENSE_GPL,
+  groups_init,                /* Plugin Init          */
+  0,                          /* Plugin Deinit        */
+  0x0100,                     /* version, hex         */
+  NULL,                       /* status variables     */
+  NULL,                       /* system variables     */
+  "1.0",                      /* version as a string  */
+  MariaDB_PLUGIN_MATURITY_EXPERIMENTAL
+},
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &thread_pool_info_plugin,
+  "THREAD_POOL_QUEUE_LATENCY",
+  "Percona",
+  "Histogram of the time events wait in the thread pool queues.",
+  PLUGIN_LICENSE_GPL,
+  queue_latency_init,         /* Plugin Init          */
+  0,                          /* Plugin Deinit        */
+  0x0100,                     /* version, hex         */
+  NULL,                       /* status variables     */
+  NULL,                       /* system variables     */
+  "1.0",                      /* version as a string  */
+  MariaDB_PLUGIN_MATURITY_EXPERIMENTAL
+}
+maria_declare_plugin_end;
@@ -679,6 +679,12 @@ alter table servers      modify Username     char(80)                   not null
 alter table procs_priv   modify Grantor      char(141) COLLATE utf8_bin not null default '';
 alter table tables_priv  modify Grantor      char(141) COLLATE utf8_bin not null default '';
 
+# The number of rows the column statistics are collected from
+ALTER TABLE column_stats ADD COLUMN IF NOT EXISTS sample_size bigint unsigned DEFAULT NULL AFTER histogram;
+
+# Histograms of the type MCV_HB and histograms larger than 255 bytes
+ALTER TABLE column_stats MODIFY hist_size smallint unsigned, MODIFY hist_type enum('SINGLE_PREC_HB','DOUBLE_PREC_HB','MCV_HB'), MODIFY histogram blob;
+
 # Activate the new, possible modified privilege tables
 # This should not be needed, but gives us some extra testing that the above
 # changes was correct
@@ -0,0 +1,145 @@
+#!@PERL@
+# Copyright (c) 2014, MariaDB
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Library General Public
+# License as published by the Free Software Foundation; version 2
+# of the License.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public
+# License along with this library; if not, write to the Free
+# Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+# MA 02110-1301, USA
+#
+# Test of the evaluation of WHERE conditions in table scans: the same
+# queries are run with the conditions evaluated for each record
+# (optimizer_switch='batch_cond=off') and over blocks of records
+# (optimizer_switch='batch_cond=on').
+#
+##################### Standard benchmark inits ##############################
+
+use Cwd;
+use DBI;
+use Getopt::Long;
+use Benchmark;
+
+$opt_loop_count=1000000;
+$opt_small_loop_count=20;
+
+$pwd = cwd(); $pwd = "." if ($pwd eq '');
+require "$pwd/bench-init.pl" || die "Can't read Configuration file: $!\n";
+
+if ($opt_small_test)
+{
+  $opt_loop_count/=10;
+  $opt_small_loop_count/=10;
+}
+
+print "Testing the evaluation of WHERE conditions in table scans\n";
+print "The test table has $opt_loop_count rows.\n\n";
+
+####
+####  Connect and start timeing
+####
+
+$dbh = $server->connect();
+$start_time=new Benchmark;
+
+####
+#### Create needed tables
+####
+
+goto select_test if ($opt_skip_create);
+
+print "Creating table\n";
+$dbh->do("drop table bench1" . $server->{'drop_attr'});
+
+do_many($dbh,$server->create("bench1",
+			     ["id integer NOT NULL",
+			      "grp smallint NOT NULL",
+			      "val integer",
+			      "price decimal(10,2) NOT NULL",
+			      "day date NOT NULL",
+			      "name char(20) NOT NULL"],
+			     []));
+
+####
+#### Insert $opt_loop_count records, doubling the table with
+#### INSERT ... SELECT after the first rows
+####
+
+print "Inserting $opt_loop_count rows\n";
+
+$loop_time=new Benchmark;
+for ($id=0 ; $id < 1024 && $id < $opt_loop_count ; $id++)
+{
+  $val= $id % 13 ? $id % 1000 : "NULL";
+  do_query($dbh,"insert into bench1 values ($id," . ($id % 100) .
+	   ",$val," . ($id % 5000) / 4 . ",'2014-01-01' + interval " .
+	   ($id % 365) . " day,'name$id')");
+}
+for ($rows=$id ; $rows < $opt_loop_count ; $rows*=2)
+{
+  $limit= min($rows, $opt_loop_count - $rows);
+  do_query($dbh,"insert into bench1 select id+$rows,(grp*7+3) % 100," .
+	   "val,price,day,name from bench1 limit $limit");
+}
+
+$end_time=new Benchmark;
+print "Time to insert ($opt_loop_count): " .
+    timestr(timediff($end_time, $loop_time),"all") . "\n\n";
+
+####
+#### Run the scans with both ways to evaluate the conditions
+####
+
+select_test:
+
+@queries=
+  ("count_int_range",
+   "select count(*) from bench1 where grp >= 10 and grp < 40",
+   "count_int_and",
+   "select count(*) from bench1 where id > 100 and grp <> 5 and val < 500",
+   "count_int_or",
+   "select count(*) from bench1 where grp = 1 or grp = 7 or val is null",
+   "count_int_arith",
+   "select count(*) from bench1 where val * 2 + grp > 1000",
+   "count_decimal_date",
+   "select count(*) from bench1 where price between 100 and 500.5 and " .
+   "day > '2014-03-01'",
+   "sum_selective",
+   "select sum(val),max(price) from bench1 where grp = 42 and " .
+   "day < '2014-02-01'");
+
+foreach $mode ("off", "on")
+{
+  do_query($dbh,"set optimizer_switch='batch_cond=$mode'");
+  for ($q=0 ; $q < $#queries ; $q+=2)
+  {
+    time_fetch_all_rows(undef, "$queries[$q]_batch_cond_$mode",
+			$queries[$q+1], $dbh, $opt_small_loop_count);
+  }
+}
+
+####
+#### End of benchmark
+####
+
+if (!$opt_skip_delete)
+{
+  do_query($dbh,"drop table bench1" . $server->{'drop_attr'});
+}
+
+if ($opt_fast && defined($server->{vacuum}))
+{
+  $server->vacuum(0,\$dbh);
+}
+
+$dbh->disconnect;				# close connection
+
+end_benchmark($start_time);
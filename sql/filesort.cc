@@ -58,7 +58,10 @@ static ha_rows find_all_keys(Sort_param *param,SQL_SELECT *select,
                              ha_rows *found_rows);
 static bool write_keys(Sort_param *param, Filesort_info *fs_info,
                       uint count, IO_CACHE *buffer_file, IO_CACHE *tempfile);
+static bool write_run(Sort_param *param, uchar **sort_keys, uint count,
+                      IO_CACHE *buffer_file, IO_CACHE *tempfile);
 static void make_sortkey(Sort_param *param, uchar *to, uchar *ref_pos);
+static uint make_packed_sortkey(Sort_param *param, uchar *to, uchar *ref_pos);
 static void register_used_fields(Sort_param *param);
 static bool save_index(Sort_param *param, uint count,
                        Filesort_info *table_sort);
@@ -70,6 +73,8 @@ static SORT_ADDON_FIELD *get_addon_fields(ulong max_length_for_sort_data,
                                           uint sortlength, uint *plength);
 static void unpack_addon_fields(struct st_sort_addon_field *addon_field,
                                 uchar *buff, uchar *buff_end);
+static void unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                                       uchar *buff, uchar *buff_end);
 static bool check_if_pq_applicable(Sort_param *param, Filesort_info *info,
                                    TABLE *table,
                                    ha_rows records, ulong memory_available);
@@ -107,6 +112,187 @@ void Sort_param::init_for_filesort(uint sortlen, TABLE *table,
 }
 
 
+/** Whether padding is stripped from the key part in packed sort keys */
+
+static bool is_packable_sort_field(SORT_FIELD *sort_field)
+{
+  Field *field;
+  if (sort_field->length <= 2 || sort_field->suffix_length)
+    return false;
+  if ((field= sort_field->field))
+    return (field->result_type() == STRING_RESULT &&
+            !(field->flags & (ENUM_FLAG | SET_FLAG)) &&
+            field->sort_charset() != &my_charset_bin);
+  return sort_field->result_type == STRING_RESULT;
+}
+
+
+/**
+  Make the key part of an empty string, which is what make_sortkey()
+  pads shorter strings with.
+*/
+
+static void make_sort_pad(SORT_FIELD *sort_field, bool maybe_null, uchar *to)
+{
+  Field *field= sort_field->field;
+  CHARSET_INFO *cs= (field ? field->sort_charset() :
+                     sort_field->item->collation.collation);
+  uchar *pad= to;
+  if (maybe_null)
+    *to++= 1;
+  if (field || sort_field->need_strxnfrm)
+    cs->coll->strnxfrm(cs, to, sort_field->length, sort_field->length,
+                       (const uchar*) "", 0,
+                       MY_STRXFRM_PAD_WITH_SPACE | MY_STRXFRM_PAD_TO_MAXLEN);
+  else
+    cs->cset->fill(cs, (char*) to, sort_field->length,
+                   (cs->state & MY_CS_BINSORT) ? (char) 0 : ' ');
+  if (sort_field->reverse)
+  {
+    for (uchar *end= to + sort_field->length; to != end; to++)
+      *to= (uchar) ~*to;
+    if (maybe_null)
+      pad[0]= 0;
+  }
+}
+
+
+/**
+  Switch to packed records, see SORT_KEY_PART: string key parts are
+  stored without the padding and addon fields with their actual length.
+  Uses local_sortorder.
+
+  @retval false  Records are packed.
+  @retval true   Nothing to pack or out of memory, records stay fixed size.
+*/
+
+bool Sort_param::init_packed_records()
+{
+  SORT_FIELD *sort_field;
+  SORT_KEY_PART *part;
+  uint parts= 0, packed_parts= 0, pad_length= 0;
+  DBUG_ENTER("Sort_param::init_packed_records");
+
+  for (sort_field= local_sortorder; sort_field != end; sort_field++)
+  {
+    parts++;
+    if (is_packable_sort_field(sort_field))
+    {
+      packed_parts++;
+      pad_length+= sort_field->length + 1;
+    }
+  }
+  if (!packed_parts && !addon_field)
+    DBUG_RETURN(true);
+  /* Lengths of the record, key parts and addon fields */
+  ulong packed_length= rec_length + 2 + packed_parts * 2 + (addon_field ? 2 : 0);
+  if (packed_length > UINT_MAX16 ||
+      !(key_parts= (SORT_KEY_PART*) my_malloc((parts + 1) *
+                                              sizeof(SORT_KEY_PART) +
+                                              pad_length,
+                                              MYF(MY_WME |
+                                                  MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(true);
+
+  uchar *pad= (uchar*) (key_parts + parts + 1);
+  part= key_parts;
+  part->length= 0;
+  part->pad= NULL;
+  for (sort_field= local_sortorder; sort_field != end; sort_field++)
+  {
+    bool maybe_null= (sort_field->field ? sort_field->field->maybe_null() :
+                      sort_field->item->maybe_null);
+    uint length= sort_field->length + maybe_null;
+    if (is_packable_sort_field(sort_field))
+    {
+      if (part->length)
+        part++;
+      part->length= length;
+      part->pad= pad;
+      part->maybe_null= maybe_null;
+      make_sort_pad(sort_field, maybe_null, pad);
+      pad+= length;
+      part++;
+      part->length= 0;
+      part->pad= NULL;
+    }
+    else
+      part->length+= length;                    // Join adjacent fixed parts
+  }
+  key_parts_end= part->length ? part + 1 : part;
+
+  rec_length= (uint) packed_length;
+  if (addon_field)
+  {
+    addon_length+= 2;
+    res_length= addon_length;
+  }
+  DBUG_PRINT("info", ("packed rec_length: %u  key parts: %u",
+                      rec_length, (uint) (key_parts_end - key_parts)));
+  DBUG_RETURN(false);
+}
+
+
+/**
+  Compare packed records: gives the same result as comparing the fixed
+  size records with memcmp().
+*/
+
+int cmp_packed_sort_keys(const Sort_param *param, uchar **a, uchar **b)
+{
+  uchar *pos_a= *a + 2, *pos_b= *b + 2;
+  int res;
+
+  for (SORT_KEY_PART *part= param->key_parts;
+       part != param->key_parts_end;
+       part++)
+  {
+    if (!part->pad)
+    {
+      if ((res= memcmp(pos_a, pos_b, part->length)))
+        return res;
+      pos_a+= part->length;
+      pos_b+= part->length;
+      continue;
+    }
+    uint length_a= uint2korr(pos_a), length_b= uint2korr(pos_b);
+    pos_a+= 2;
+    pos_b+= 2;
+    if ((res= memcmp(pos_a, pos_b, MY_MIN(length_a, length_b))))
+      return res;
+    /* The stripped bytes of the shorter key are those of the pad */
+    if (length_a < length_b)
+      res= memcmp(part->pad + length_a, pos_b + length_a, length_b - length_a);
+    else if (length_a > length_b)
+      res= memcmp(pos_a + length_b, part->pad + length_b, length_a - length_b);
+    if (res)
+      return res;
+    pos_a+= length_a;
+    pos_b+= length_b;
+  }
+  /* Without addon fields the record reference is sorted on as well */
+  return param->addon_field ? 0 : memcmp(pos_a, pos_b, param->ref_length);
+}
+
+
+/**
+  Get the result of a packed record: the addon fields, starting with
+  their length, or the record reference.
+*/
+
+static uchar *get_packed_result(const Sort_param *param, uchar *record,
+                                uint *length)
+{
+  uchar *pos= record + 2;
+  for (SORT_KEY_PART *part= param->key_parts;
+       part != param->key_parts_end;
+       part++)
+    pos+= part->pad ? 2 + uint2korr(pos) : part->length;
+  *length= param->addon_field ? uint2korr(pos) : param->ref_length;
+  return pos;
+}
+
+
 /**
   Sort a table.
   Creates a set of pointers that can be used to read the rows
@@ -198,14 +384,9 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
                           max_rows, sort_positions);
 
   table_sort.addon_buf= 0;
-  table_sort.addon_length= param.addon_length;
   table_sort.addon_field= param.addon_field;
-  table_sort.unpack= unpack_addon_fields;
-  if (param.addon_field &&
-      !(table_sort.addon_buf=
-        (uchar *) my_malloc(param.addon_length, MYF(MY_WME |
-                                                    MY_THREAD_SPECIFIC))))
-    goto err;
+  param.sort_form= table;
+  param.end=(param.local_sortorder=sortorder)+s_length;
 
   if (select && select->quick)
     thd->inc_status_sort_range();
@@ -250,6 +431,16 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   {
     DBUG_PRINT("info", ("filesort PQ is not applicable"));
 
+    /*
+      Pack the records if they may not all fit into the buffer, that is
+      when packing may save writing or merging runs.
+    */
+    if ((num_rows == HA_POS_ERROR ||
+         num_rows * (param.rec_length + sizeof(char*)) > memory_available ||
+         DBUG_EVALUATE_IF("filesort_packed_records", true, false)) &&
+        !param.init_packed_records())
+      DBUG_PRINT("info", ("filesort packs the records"));
+
     size_t min_sort_memory= MY_MAX(MIN_SORT_MEMORY, param.sort_length*MERGEBUFF2);
     set_if_bigger(min_sort_memory, sizeof(BUFFPEK*)*MERGEBUFF2);
     while (memory_available >= min_sort_memory)
@@ -285,12 +476,21 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
     }
   }
 
+  table_sort.addon_length= param.addon_length;
+  table_sort.using_packed_addons= (param.using_packed_records() &&
+                                   param.addon_field);
+  table_sort.unpack= (table_sort.using_packed_addons ?
+                      unpack_packed_addon_fields : unpack_addon_fields);
+  if (param.addon_field &&
+      !(table_sort.addon_buf=
+        (uchar *) my_malloc(param.addon_length, MYF(MY_WME |
+                                                    MY_THREAD_SPECIFIC))))
+    goto err;
+
   if (open_cached_file(&buffpek_pointers,mysql_tmpdir,TEMP_PREFIX,
 		       DISK_BUFFER_SIZE, MYF(MY_WME)))
     goto err;
 
-  param.sort_form= table;
-  param.end=(param.local_sortorder=sortorder)+s_length;
   num_rows= find_all_keys(&param, select,
                           &table_sort,
                           &buffpek_pointers,
@@ -366,6 +566,7 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
 
   err:
   my_free(param.tmp_buffer);
+  my_free(param.key_parts);
   if (!subselect || !subselect->is_uncacheable())
   {
     table_sort.free_sort_buffer();
@@ -615,6 +816,282 @@ static void dbug_print_record(TABLE *table, bool print_rowid)
 #endif 
 
 
+/**
+  Background threads which sort the key buffers filled by find_all_keys()
+  and write them to the temporary file as runs, so that rows are read
+  while a full buffer is being sorted.
+
+  find_all_keys() hands over a full buffer with submit() and continues
+  with the empty buffer it gets back. There is one buffer more than there
+  are threads, each with its own scratch space for radix sort. All memory
+  is allocated and freed by the connection thread; the threads only sort
+  and write under LOCK_write.
+*/
+
+class Filesort_run_writers
+{
+public:
+  Filesort_run_writers(Sort_param *param, IO_CACHE *buffpek_pointers,
+                       IO_CACHE *tempfile)
+    :m_param(param), m_buffpek_pointers(buffpek_pointers),
+     m_tempfile(tempfile), m_current(NULL), m_n_runs(0), m_n_threads(0),
+     m_n_running(0), m_queue_head(0), m_n_queued(0), m_n_free(0),
+     m_stop(false), m_error(false), m_errno(0)
+  {}
+  ~Filesort_run_writers();
+
+  bool start(uint n_threads, Filesort_buffer *buffer);
+  bool is_started() const { return m_n_threads != 0; }
+  Filesort_buffer *submit(uint count);
+  bool finish();
+  void run();
+
+private:
+  /** A key buffer and what is to be done with it. */
+  struct Run
+  {
+    Filesort_buffer *buffer;
+    uchar **scratch;
+    uint count;
+  };
+
+  void stop(bool abort);
+
+  Sort_param *m_param;
+  IO_CACHE *m_buffpek_pointers;
+  IO_CACHE *m_tempfile;
+  /** Buffers besides the one in Filesort_info */
+  Filesort_buffer m_buffers[MAX_SORT_THREADS];
+  Run m_runs[MAX_SORT_THREADS + 1];
+  /** The run find_all_keys() is filling */
+  Run *m_current;
+  uint m_n_runs;
+  uint m_n_threads;
+  /* The members below are protected by m_LOCK_runs */
+  uint m_n_running;
+  Run *m_queue[MAX_SORT_THREADS + 1];
+  uint m_queue_head, m_n_queued;
+  Run *m_free[MAX_SORT_THREADS + 1];
+  uint m_n_free;
+  bool m_stop;
+  bool m_error;
+  int m_errno;
+  mysql_mutex_t m_LOCK_runs;
+  mysql_mutex_t m_LOCK_write;
+  mysql_cond_t m_COND_run_queued;
+  mysql_cond_t m_COND_run_done;
+};
+
+
+pthread_handler_t filesort_run_writer(void *arg)
+{
+  my_thread_init();
+  ((Filesort_run_writers *) arg)->run();
+  my_thread_end();
+  return NULL;
+}
+
+
+/**
+  Allocate the buffers and start the threads.
+
+  Fewer threads are started if memory or threads are short.
+
+  @param n_threads  Number of threads wanted.
+  @param buffer     The buffer find_all_keys() has filled so far.
+
+  @retval false  At least one thread runs.
+  @retval true   No thread could be started, sort in this thread.
+*/
+
+bool Filesort_run_writers::start(uint n_threads, Filesort_buffer *buffer)
+{
+  const uint keys= m_param->max_keys_per_buffer;
+  DBUG_ENTER("Filesort_run_writers::start");
+
+  /* The threads must not create the file */
+  if (!my_b_inited(m_tempfile) &&
+      open_cached_file(m_tempfile, mysql_tmpdir, TEMP_PREFIX,
+                       DISK_BUFFER_SIZE, MYF(MY_WME)))
+    DBUG_RETURN(true);
+  if (m_tempfile->file < 0 && real_open_cached_file(m_tempfile))
+    DBUG_RETURN(true);
+
+  set_if_smaller(n_threads, MAX_SORT_THREADS);
+  for (m_n_runs= 0; m_n_runs <= n_threads; m_n_runs++)
+  {
+    Run *run= &m_runs[m_n_runs];
+    run->buffer= m_n_runs ? &m_buffers[m_n_runs - 1] : buffer;
+    run->count= 0;
+    if (!(run->scratch= (uchar**) my_malloc(keys * sizeof(uchar*),
+                                            MYF(MY_THREAD_SPECIFIC))))
+      break;
+    if (m_n_runs &&
+        !run->buffer->alloc_sort_buffer(keys, m_param->rec_length))
+    {
+      my_free(run->scratch);
+      break;
+    }
+  }
+  if (m_n_runs < 2)
+  {
+    if (m_n_runs)
+      my_free(m_runs[0].scratch);
+    m_n_runs= 0;
+    DBUG_RETURN(true);
+  }
+
+  mysql_mutex_init(key_LOCK_filesort_runs, &m_LOCK_runs, MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_LOCK_filesort_write, &m_LOCK_write,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_filesort_run_queued, &m_COND_run_queued, NULL);
+  mysql_cond_init(key_COND_filesort_run_done, &m_COND_run_done, NULL);
+
+  m_current= &m_runs[0];
+  for (uint i= 1; i < m_n_runs; i++)
+    m_free[m_n_free++]= &m_runs[i];
+
+  mysql_mutex_lock(&m_LOCK_runs);
+  for (m_n_threads= 0; m_n_threads < m_n_runs - 1; m_n_threads++)
+  {
+    pthread_t th;
+    if (mysql_thread_create(key_thread_filesort_run_writer, &th,
+                            &connection_attrib, filesort_run_writer, this))
+      break;
+    m_n_running++;
+  }
+  mysql_mutex_unlock(&m_LOCK_runs);
+  DBUG_PRINT("info", ("started %u of %u threads", m_n_threads, n_threads));
+  DBUG_RETURN(m_n_threads == 0);
+}
+
+
+/**
+  Queue the current buffer to be sorted and written as a run.
+
+  @param count  Number of keys in the current buffer.
+
+  @return An empty buffer to go on with, or NULL if writing a run failed.
+*/
+
+Filesort_buffer *Filesort_run_writers::submit(uint count)
+{
+  Filesort_buffer *buffer= NULL;
+  DBUG_ASSERT(is_started());
+  mysql_mutex_lock(&m_LOCK_runs);
+  m_current->count= count;
+  m_queue[(m_queue_head + m_n_queued++) % m_n_runs]= m_current;
+  mysql_cond_signal(&m_COND_run_queued);
+  while (!m_n_free && !m_error)
+    mysql_cond_wait(&m_COND_run_done, &m_LOCK_runs);
+  if (!m_error)
+  {
+    m_current= m_free[--m_n_free];
+    buffer= m_current->buffer;
+  }
+  mysql_mutex_unlock(&m_LOCK_runs);
+  return buffer;
+}
+
+
+/**
+  Wait until all queued runs are written and the threads have exited.
+
+  @retval false  OK
+  @retval true   Writing a run failed, the error has been reported.
+*/
+
+bool Filesort_run_writers::finish()
+{
+  stop(false);
+  if (m_error)
+  {
+    my_error(ER_ERROR_ON_WRITE, MYF(0), my_filename(m_tempfile->file),
+             m_errno);
+    return true;
+  }
+  return false;
+}
+
+
+void Filesort_run_writers::stop(bool abort)
+{
+  if (!m_n_threads)
+    return;
+  mysql_mutex_lock(&m_LOCK_runs);
+  m_stop= true;
+  if (abort)
+    m_error= true;                              // Skip the queued runs
+  mysql_cond_broadcast(&m_COND_run_queued);
+  while (m_n_running)
+    mysql_cond_wait(&m_COND_run_done, &m_LOCK_runs);
+  mysql_mutex_unlock(&m_LOCK_runs);
+  m_n_threads= 0;
+}
+
+
+Filesort_run_writers::~Filesort_run_writers()
+{
+  stop(true);
+  if (!m_n_runs)
+    return;
+  for (uint i= 0; i < m_n_runs; i++)
+  {
+    my_free(m_runs[i].scratch);
+    if (i)
+      m_runs[i].buffer->free_sort_buffer();
+  }
+  mysql_mutex_destroy(&m_LOCK_runs);
+  mysql_mutex_destroy(&m_LOCK_write);
+  mysql_cond_destroy(&m_COND_run_queued);
+  mysql_cond_destroy(&m_COND_run_done);
+}
+
+
+/** Body of a writer thread: sort and write queued runs until stopped. */
+
+void Filesort_run_writers::run()
+{
+  mysql_mutex_lock(&m_LOCK_runs);
+  for (;;)
+  {
+    while (!m_n_queued && !m_stop)
+      mysql_cond_wait(&m_COND_run_queued, &m_LOCK_runs);
+    if (!m_n_queued)
+      break;
+    Run *run= m_queue[m_queue_head];
+    m_queue_head= (m_queue_head + 1) % m_n_runs;
+    m_n_queued--;
+    bool skip= m_error;
+    mysql_mutex_unlock(&m_LOCK_runs);
+
+    bool error= false;
+    int saved_errno= 0;
+    if (!skip)
+    {
+      run->buffer->sort_buffer(m_param, run->count, run->scratch);
+      mysql_mutex_lock(&m_LOCK_write);
+      if ((error= write_run(m_param, run->buffer->get_key_pointers(),
+                            run->count, m_buffpek_pointers, m_tempfile)))
+        saved_errno= my_errno;
+      mysql_mutex_unlock(&m_LOCK_write);
+    }
+
+    mysql_mutex_lock(&m_LOCK_runs);
+    if (error && !m_error)
+    {
+      m_error= true;
+      m_errno= saved_errno;
+    }
+    m_free[m_n_free++]= run;
+    mysql_cond_signal(&m_COND_run_done);
+  }
+  m_n_running--;
+  mysql_cond_signal(&m_COND_run_done);
+  mysql_mutex_unlock(&m_LOCK_runs);
+}
+
+
 /**
   Search after sort_keys, and write them into tempfile
   (if we run out of space in the sort_keys buffer).
@@ -655,6 +1132,9 @@ static void dbug_print_record(TABLE *table, bool print_rowid)
        don't sort, leave sort_keys array to be sorted by caller.
   @endverbatim
 
+    With sort_threads > 0, the sort-dump-dump steps are done by
+    Filesort_run_writers while the next buffer is being filled.
+
   @retval
     Number of records written on success.
   @retval
@@ -676,6 +1156,10 @@ static ha_rows find_all_keys(Sort_param *param, SQL_SELECT *select,
   THD *thd= current_thd;
   handler *file;
   MY_BITMAP *save_read_set, *save_write_set, *save_vcol_set;
+  Filesort_buffer *sort_buffer= fs_info->get_filesort_buffer();
+  Filesort_run_writers writers(param, buffpek_pointers, tempfile);
+  bool use_writers= !pq && thd->variables.sort_threads > 0;
+  const bool packed= param->using_packed_records();
   
   DBUG_ENTER("find_all_keys");
   DBUG_PRINT("info",("using: %s",
@@ -696,6 +1180,8 @@ static ha_rows find_all_keys(Sort_param *param, SQL_SELECT *select,
   if (flag)
     ref_pos= &file->ref[0];
   next_pos=ref_pos;
+  if (packed)
+    sort_buffer->start_packed_records();
 
   DBUG_EXECUTE_IF("show_explain_in_find_all_keys", 
                   dbug_serve_apcs(thd, 1);
@@ -827,14 +1313,39 @@ static ha_rows find_all_keys(Sort_param *param, SQL_SELECT *select,
       }
       else
       {
-        if (idx == param->max_keys_per_buffer)
+        uchar *to= NULL;
+        if (packed ? !(to= sort_buffer->get_packed_record_buffer()) :
+            idx == param->max_keys_per_buffer)
         {
-          if (write_keys(param, fs_info, idx, buffpek_pointers, tempfile))
+          if (use_writers && !writers.is_started())
+            use_writers= !writers.start(thd->variables.sort_threads,
+                                        sort_buffer);
+          if (use_writers)
+          {
+            if (!(sort_buffer= writers.submit(idx)))
+            {
+              writers.finish();
+              DBUG_RETURN(HA_POS_ERROR);
+            }
+          }
+          else if (write_keys(param, fs_info, idx, buffpek_pointers, tempfile))
              DBUG_RETURN(HA_POS_ERROR);
 	  idx= 0;
 	  indexpos++;
+          if (packed)
+          {
+            sort_buffer->start_packed_records();
+            to= sort_buffer->get_packed_record_buffer();
+          }
+        }
+        if (packed)
+        {
+          sort_buffer->add_packed_record(make_packed_sortkey(param, to,
+                                                             ref_pos));
+          idx++;
         }
-        make_sortkey(param, fs_info->get_record_buffer(idx++), ref_pos);
+        else
+          make_sortkey(param, sort_buffer->get_record_buffer(idx++), ref_pos);
       }
     }
 
@@ -868,12 +1379,16 @@ static ha_rows find_all_keys(Sort_param *param, SQL_SELECT *select,
     file->print_error(error,MYF(ME_ERROR | ME_WAITTANG)); // purecov: inspected
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
   }
-  if (indexpos && idx &&
-      write_keys(param, fs_info, idx, buffpek_pointers, tempfile))
+  if (writers.is_started())
+  {
+    bool failed= idx && !writers.submit(idx);
+    if (writers.finish() || failed)
+      DBUG_RETURN(HA_POS_ERROR);
+  }
+  else if (indexpos && idx &&
+           write_keys(param, fs_info, idx, buffpek_pointers, tempfile))
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
-  const ha_rows retval=
-    my_b_inited(tempfile) ?
-    (ha_rows) (my_b_tell(tempfile)/param->rec_length) : idx;
+  const ha_rows retval= my_b_inited(tempfile) ? param->written_rows : idx;
   DBUG_PRINT("info", ("find_all_keys return %u", (uint) retval));
   DBUG_RETURN(retval);
 } /* find_all_keys */
@@ -905,20 +1420,39 @@ static bool
 write_keys(Sort_param *param,  Filesort_info *fs_info, uint count,
            IO_CACHE *buffpek_pointers, IO_CACHE *tempfile)
 {
-  size_t rec_length;
-  uchar **end;
-  BUFFPEK buffpek;
   DBUG_ENTER("write_keys");
 
-  rec_length= param->rec_length;
-  uchar **sort_keys= fs_info->get_sort_keys();
-
   fs_info->sort_buffer(param, count);
 
   if (!my_b_inited(tempfile) &&
       open_cached_file(tempfile, mysql_tmpdir, TEMP_PREFIX, DISK_BUFFER_SIZE,
                        MYF(MY_WME)))
-    goto err;                                   /* purecov: inspected */
+    DBUG_RETURN(1);                             /* purecov: inspected */
+  DBUG_RETURN(write_run(param, fs_info->get_filesort_buffer()->
+                        get_key_pointers(), count,
+                        buffpek_pointers, tempfile));
+} /* write_keys */
+
+
+/**
+  Write a sorted sequence of keys to tempfile and the BUFFPEK describing
+  it to buffpek_pointers. Both files must be open.
+
+  @retval
+    0 OK
+  @retval
+    1 Error
+*/
+
+static bool
+write_run(Sort_param *param, uchar **sort_keys, uint count,
+          IO_CACHE *buffpek_pointers, IO_CACHE *tempfile)
+{
+  size_t rec_length= param->rec_length;
+  uchar **end;
+  BUFFPEK buffpek;
+  DBUG_ENTER("write_run");
+
   /* check we won't have more buffpeks than we can possibly keep in memory */
   if (my_b_tell(buffpek_pointers) + sizeof(BUFFPEK) > (ulonglong)UINT_MAX)
     goto err;
@@ -927,15 +1461,20 @@ write_keys(Sort_param *param,  Filesort_info *fs_info, uint count,
     count=(uint) param->max_rows;               /* purecov: inspected */
   buffpek.count=(ha_rows) count;
   for (end=sort_keys+count ; sort_keys != end ; sort_keys++)
+  {
+    if (param->using_packed_records())
+      rec_length= uint2korr(*sort_keys);
     if (my_b_write(tempfile, (uchar*) *sort_keys, (uint) rec_length))
       goto err;
+  }
   if (my_b_write(buffpek_pointers, (uchar*) &buffpek, sizeof(buffpek)))
     goto err;
+  param->written_rows+= count;
   DBUG_RETURN(0);
 
 err:
   DBUG_RETURN(1);
-} /* write_keys */
+} /* write_run */
 
 
 /**
@@ -961,10 +1500,10 @@ static inline void store_length(uchar *to, uint length, uint pack_length)
 }
 
 
-/** Make a sort-key from record. */
+/** Make the key parts of a sort-key from record, return their end. */
 
-static void make_sortkey(register Sort_param *param,
-                         register uchar *to, uchar *ref_pos)
+static uchar *make_sortkey_parts(register Sort_param *param,
+                                 register uchar *to)
 {
   reg3 Field *field;
   reg1 SORT_FIELD *sort_field;
@@ -1156,7 +1695,18 @@ static void make_sortkey(register Sort_param *param,
     else
       to+= sort_field->length;
   }
+  return to;
+}
 
+
+/** Make a sort-key from record. */
+
+static void make_sortkey(register Sort_param *param,
+                         register uchar *to, uchar *ref_pos)
+{
+  Field *field;
+
+  to= make_sortkey_parts(param, to);
   if (param->addon_field)
   {
     /* 
@@ -1203,6 +1753,72 @@ static void make_sortkey(register Sort_param *param,
 }
 
 
+/**
+  Make a packed sort-key from record, see SORT_KEY_PART.
+
+  The key parts are made as for fixed size records far enough into the
+  buffer to be packed in place.
+
+  @return Length of the record
+*/
+
+static uint make_packed_sortkey(Sort_param *param, uchar *to, uchar *ref_pos)
+{
+  uchar *start= to;
+  uchar *key= to + (param->rec_length - param->sort_length -
+                    (param->addon_field ? param->addon_length : 0));
+  uchar *key_end __attribute__((unused))= make_sortkey_parts(param, key);
+  Field *field;
+
+  to+= 2;
+  for (SORT_KEY_PART *part= param->key_parts;
+       part != param->key_parts_end;
+       part++)
+  {
+    uint length= part->length;
+    if (part->pad)
+    {
+      if (part->maybe_null && key[0] != part->pad[0])
+        length= 1;                              // NULL, the marker decides
+      else
+        while (length && key[length - 1] == part->pad[length - 1])
+          length--;
+      int2store(to, length);
+      to+= 2;
+    }
+    memmove(to, key, length);
+    to+= length;
+    key+= part->length;
+  }
+  DBUG_ASSERT(key == key_end);
+
+  if (param->addon_field)
+  {
+    /* Null bits and values of the fields, as in unpack_packed_addon_fields() */
+    SORT_ADDON_FIELD *addonf= param->addon_field;
+    uchar *addon_start= to;
+    uchar *nulls= to + 2;
+    memset(nulls, 0, addonf->offset);
+    to= nulls + addonf->offset;
+    for ( ; (field= addonf->field) ; addonf++)
+    {
+      if (addonf->null_bit && field->is_null())
+        nulls[addonf->null_offset]|= addonf->null_bit;
+      else
+        to= field->pack(to, field->ptr);
+    }
+    int2store(addon_start, (uint) (to - addon_start));
+  }
+  else
+  {
+    memcpy(to, ref_pos, (size_t) param->ref_length);
+    to+= param->ref_length;
+  }
+  int2store(start, (uint) (to - start));
+  return (uint) (to - start);
+}
+
+
 /*
   Register fields used by sorting in the sorted table's read set
 */
@@ -1259,13 +1875,37 @@ static bool save_index(Sort_param *param, uint count, Filesort_info *table_sort)
   DBUG_ENTER("save_index");
 
   table_sort->sort_buffer(param, count);
+  if ((ha_rows) count > param->max_rows)
+    count= (uint) param->max_rows;
   res_length= param->res_length;
   offset= param->rec_length-res_length;
+  uchar **sort_keys= table_sort->get_filesort_buffer()->get_key_pointers();
+  if (param->using_packed_records())
+  {
+    /* Store the results as they are, the addon fields with their length */
+    size_t length= 0;
+    for (uint i= 0; i < count; i++)
+    {
+      (void) get_packed_result(param, sort_keys[i], &res_length);
+      length+= res_length;
+    }
+    if (!(to= table_sort->record_pointers=
+          (uchar*) my_malloc(MY_MAX(length, 1),
+                             MYF(MY_WME | MY_THREAD_SPECIFIC))))
+      DBUG_RETURN(1);
+    for (uchar **end= sort_keys+count ; sort_keys != end ; sort_keys++)
+    {
+      uchar *result= get_packed_result(param, *sort_keys, &res_length);
+      memcpy(to, result, res_length);
+      to+= res_length;
+    }
+    table_sort->record_pointers_end= to;
+    DBUG_RETURN(0);
+  }
   if (!(to= table_sort->record_pointers= 
         (uchar*) my_malloc(res_length*count,
                            MYF(MY_WME | MY_THREAD_SPECIFIC))))
     DBUG_RETURN(1);                 /* purecov: inspected */
-  uchar **sort_keys= table_sort->get_sort_keys();
   for (uchar **end= sort_keys+count ; sort_keys != end ; sort_keys++)
   {
     memcpy(to, *sort_keys+offset, res_length);
@@ -1415,7 +2055,12 @@ bool check_if_pq_applicable(Sort_param *param,
 }
 
 
-/** Merge buffers to make < MERGEBUFF2 buffers. */
+/**
+  Merge buffers to make fewer buffers than can be merged at once.
+
+  With a large sort buffer all runs are usually merged in the single final
+  pass, see get_merge_fanin().
+*/
 
 int merge_many_buff(Sort_param *param, uchar *sort_buffer,
                     BUFFPEK *buffpek, uint *maxbuffer, IO_CACHE *t_file)
@@ -1423,9 +2068,12 @@ int merge_many_buff(Sort_param *param, uchar *sort_buffer,
   register uint i;
   IO_CACHE t_file2,*from_file,*to_file,*temp;
   BUFFPEK *lastbuff;
+  const uint mergebuff2= get_merge_fanin(param->max_keys_per_buffer,
+                                         param->rec_length);
+  const uint mergebuff= mergebuff2 / 2;
   DBUG_ENTER("merge_many_buff");
 
-  if (*maxbuffer < MERGEBUFF2)
+  if (*maxbuffer < mergebuff2)
     DBUG_RETURN(0);				/* purecov: inspected */
   if (flush_io_cache(t_file) ||
       open_cached_file(&t_file2,mysql_tmpdir,TEMP_PREFIX,DISK_BUFFER_SIZE,
@@ -1433,17 +2081,17 @@ int merge_many_buff(Sort_param *param, uchar *sort_buffer,
     DBUG_RETURN(1);				/* purecov: inspected */
 
   from_file= t_file ; to_file= &t_file2;
-  while (*maxbuffer >= MERGEBUFF2)
+  while (*maxbuffer >= mergebuff2)
   {
     if (reinit_io_cache(from_file,READ_CACHE,0L,0,0))
       goto cleanup;
     if (reinit_io_cache(to_file,WRITE_CACHE,0L,0,0))
       goto cleanup;
     lastbuff=buffpek;
-    for (i=0 ; i <= *maxbuffer-MERGEBUFF*3/2 ; i+=MERGEBUFF)
+    for (i=0 ; i <= *maxbuffer-mergebuff*3/2 ; i+=mergebuff)
     {
       if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
-			buffpek+i,buffpek+i+MERGEBUFF-1,0))
+			buffpek+i,buffpek+i+mergebuff-1,0))
       goto cleanup;
     }
     if (merge_buffers(param,from_file,to_file,sort_buffer,lastbuff++,
@@ -1464,7 +2112,7 @@ cleanup:
     setup_io_cache(t_file);
   }
 
-  DBUG_RETURN(*maxbuffer >= MERGEBUFF2);	/* Return 1 if interrupted */
+  DBUG_RETURN(*maxbuffer >= mergebuff2);	/* Return 1 if interrupted */
 } /* merge_many_buff */
 
 
@@ -1496,6 +2144,67 @@ uint read_to_buffer(IO_CACHE *fromfile, BUFFPEK *buffpek,
 } /* read_to_buffer */
 
 
+/**
+  Read packed records to buffer: as many whole records as fit into
+  max_keys records of the maximum length.
+
+  @retval
+    (uint)-1 if something goes wrong
+*/
+
+static uint read_packed_to_buffer(IO_CACHE *fromfile, BUFFPEK *buffpek,
+                                  uint rec_length)
+{
+  uchar *pos, *end;
+  size_t length;
+  uint count= 0;
+
+  if (!buffpek->count)
+    return 0;
+  /* The last records of the run may be shorter than the space */
+  length= mysql_file_pread(fromfile->file, (uchar*) buffpek->base,
+                           (size_t) buffpek->max_keys * rec_length,
+                           buffpek->file_pos, MYF(0));
+  if (length == MY_FILE_ERROR)
+    return (uint) -1;                           /* purecov: inspected */
+  for (pos= buffpek->base, end= pos + length;
+       count < buffpek->count && pos + 2 <= end && pos + uint2korr(pos) <= end;
+       pos+= uint2korr(pos))
+    count++;
+  if (!count)
+    return (uint) -1;                           /* purecov: inspected */
+  buffpek->key= buffpek->base;
+  buffpek->file_pos+= (my_off_t) (pos - buffpek->base);
+  buffpek->count-= count;
+  buffpek->mem_count= count;
+  return (uint) (pos - buffpek->base);
+}
+
+
+static inline uint read_run_to_buffer(Sort_param *param, IO_CACHE *fromfile,
+                                      BUFFPEK *buffpek)
+{
+  return (param->using_packed_records() ?
+          read_packed_to_buffer(fromfile, buffpek, param->rec_length) :
+          read_to_buffer(fromfile, buffpek, param->rec_length));
+}
+
+
+/**
+  Get what merge_buffers() writes of a packed record: the result for the
+  final merge, else the whole record.
+*/
+
+static inline uchar *get_packed_output(const Sort_param *param, uchar *record,
+                                       int flag, uint *length)
+{
+  if (flag)
+    return get_packed_result(param, record, length);
+  *length= uint2korr(record);
+  return record;
+}
+
+
 /**
   Put all room used by freed buffer to use in adjacent buffer.
 
@@ -1569,8 +2278,10 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
   uchar *src;
   uchar *unique_buff= param->unique_buff;
   const bool killable= !param->not_killable;
+  const bool packed= param->using_packed_records();
   THD* const thd=current_thd;
   DBUG_ENTER("merge_buffers");
+  DBUG_ASSERT(!packed || !unique_buff);
 
   thd->inc_status_sort_merge_passes();
   thd->query_plan_fsort_passes++;
@@ -1598,6 +2309,11 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
     cmp= param->compare;
     first_cmp_arg= (void *) &param->cmp_context;
   }
+  else if (packed)
+  {
+    cmp= (qsort2_cmp) cmp_packed_sort_keys;
+    first_cmp_arg= (void*) param;
+  }
   else
   {
     cmp= get_ptr_compare(sort_length);
@@ -1610,12 +2326,22 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
   {
     buffpek->base= strpos;
     buffpek->max_keys= maxcount;
-    strpos+=
-      (uint) (error= (int) read_to_buffer(from_file, buffpek, rec_length));
+    error= (int) read_run_to_buffer(param, from_file, buffpek);
 
     if (error == -1)
       goto err;					/* purecov: inspected */
-    buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+    if (packed)
+    {
+      /* The space is counted in records of the maximum length */
+      if (!buffpek->count)
+        buffpek->max_keys= ((uint) error + rec_length - 1) / rec_length;
+      strpos+= buffpek->max_keys * rec_length;
+    }
+    else
+    {
+      strpos+= (uint) error;
+      buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+    }
     queue_insert(&queue, (uchar*) buffpek);
   }
 
@@ -1634,8 +2360,7 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
     buffpek->key+= rec_length;
     if (! --buffpek->mem_count)
     {
-      if (!(error= (int) read_to_buffer(from_file, buffpek,
-                                        rec_length)))
+      if (!(error= (int) read_run_to_buffer(param, from_file, buffpek)))
       {
         queue_remove(&queue,0);
         reuse_freed_buff(&queue, buffpek, rec_length);
@@ -1689,7 +2414,9 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
       */          
       if (!check_dupl_count || dupl_count >= min_dupl_count)
       {
-        if (my_b_write(to_file, src+wr_offset, wr_len))
+        uchar *out= (packed ? get_packed_output(param, src, flag, &wr_len) :
+                     src + wr_offset);
+        if (my_b_write(to_file, out, wr_len))
         {
           error=1; goto err;                        /* purecov: inspected */
         }
@@ -1708,11 +2435,10 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
       }
 
     skip_duplicate:
-      buffpek->key+= rec_length;
+      buffpek->key+= packed ? uint2korr(buffpek->key) : rec_length;
       if (! --buffpek->mem_count)
       {
-        if (!(error= (int) read_to_buffer(from_file, buffpek,
-                                          rec_length)))
+        if (!(error= (int) read_run_to_buffer(param, from_file, buffpek)))
         {
           (void) queue_remove_top(&queue);
           reuse_freed_buff(&queue, buffpek, rec_length);
@@ -1773,7 +2499,19 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
       buffpek->count= 0;                        /* Don't read more */
     }
     max_rows-= buffpek->mem_count;
-    if (flag == 0)
+    if (packed)
+    {
+      src= buffpek->key;
+      for (uint i= 0; i < buffpek->mem_count; i++, src+= uint2korr(src))
+      {
+        uchar *out= get_packed_output(param, src, flag, &wr_len);
+        if (my_b_write(to_file, out, wr_len))
+        {
+          error= 1; goto err;                       /* purecov: inspected */
+        }
+      }
+    }
+    else if (flag == 0)
     {
       if (my_b_write(to_file, (uchar*) buffpek->key,
                      (rec_length*buffpek->mem_count)))
@@ -1802,7 +2540,7 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
       }
     }
   }
-  while ((error=(int) read_to_buffer(from_file, buffpek, rec_length))
+  while ((error=(int) read_run_to_buffer(param, from_file, buffpek))
          != -1 && error != 0);
 
 end:
@@ -2075,6 +2813,34 @@ unpack_addon_fields(struct st_sort_addon_field *addon_field, uchar *buff,
   }
 }
 
+
+/**
+  Unpack packed addon fields: their length, null bits and then the values
+  of the fields which are not null, one after the other.
+*/
+
+static void
+unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                           uchar *buff, uchar *buff_end)
+{
+  Field *field;
+  SORT_ADDON_FIELD *addonf= addon_field;
+  uchar *nulls= buff + 2;
+  const uchar *pos= nulls + addonf->offset;
+
+  buff_end= buff + uint2korr(buff);
+  for ( ; (field= addonf->field) ; addonf++)
+  {
+    if (addonf->null_bit && (addonf->null_bit & nulls[addonf->null_offset]))
+    {
+      field->set_null();
+      continue;
+    }
+    field->set_notnull();
+    pos= field->unpack(field->ptr, pos, buff_end, 0);
+  }
+}
+
 /*
 ** functions to change a double or float to a sortable string
 ** The following should work for IEEE
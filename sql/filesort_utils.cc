@@ -33,6 +33,22 @@ double get_merge_cost(ha_rows num_elements, ha_rows num_buffers, uint elem_size)
 }
 }
 
+/**
+  Get the maximum number of runs merged by one merge_buffers() call.
+
+  @param keys_per_buffer  Number of keys which fit into the merge buffer.
+  @param elem_size        Size of each key.
+
+  @return Number of runs merge_many_buff() leaves for the final merge.
+          Intermediate passes merge half as many runs at once.
+*/
+uint get_merge_fanin(ha_rows keys_per_buffer, uint elem_size)
+{
+  ha_rows min_keys_per_run= MY_MAX(MERGE_MIN_READ_SIZE / elem_size, 1);
+  ha_rows fanin= keys_per_buffer / min_keys_per_run;
+  return (uint) MY_MAX(MY_MIN(fanin, MERGEBUFF_MAX), MERGEBUFF2);
+}
+
 /**
   This is a simplified, and faster version of @see get_merge_many_buffs_cost().
   We calculate the cost of merging buffers, by simulating the actions
@@ -46,6 +62,8 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
 {
   ha_rows num_buffers= num_rows / num_keys_per_buffer;
   ha_rows last_n_elems= num_rows % num_keys_per_buffer;
+  const uint mergebuff2= get_merge_fanin(num_keys_per_buffer, elem_size);
+  const uint mergebuff= mergebuff2 / 2;
   double total_cost;
 
   // Calculate CPU cost of sorting buffers.
@@ -55,18 +73,18 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
     / TIME_FOR_COMPARE_ROWID;
   
   // Simulate behavior of merge_many_buff().
-  while (num_buffers >= MERGEBUFF2)
+  while (num_buffers >= mergebuff2)
   {
     // Calculate # of calls to merge_buffers().
-    const ha_rows loop_limit= num_buffers - MERGEBUFF*3/2;
-    const ha_rows num_merge_calls= 1 + loop_limit/MERGEBUFF;
+    const ha_rows loop_limit= num_buffers - mergebuff*3/2;
+    const ha_rows num_merge_calls= 1 + loop_limit/mergebuff;
     const ha_rows num_remaining_buffs=
-      num_buffers - num_merge_calls * MERGEBUFF;
+      num_buffers - num_merge_calls * mergebuff;
 
     // Cost of merge sort 'num_merge_calls'.
     total_cost+=
       num_merge_calls *
-      get_merge_cost(num_keys_per_buffer * MERGEBUFF, MERGEBUFF, elem_size);
+      get_merge_cost(num_keys_per_buffer * mergebuff, mergebuff, elem_size);
 
     // # of records in remaining buffers.
     last_n_elems+= num_remaining_buffs * num_keys_per_buffer;
@@ -76,7 +94,7 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
       get_merge_cost(last_n_elems, 1 + num_remaining_buffs, elem_size);
 
     num_buffers= num_merge_calls;
-    num_keys_per_buffer*= MERGEBUFF;
+    num_keys_per_buffer*= mergebuff;
   }
 
   // Simulate final merge_buff call.
@@ -104,12 +122,14 @@ uchar **Filesort_buffer::alloc_sort_buffer(uint num_records, uint record_length)
     m_record_length= record_length;
     uchar **start_of_data= m_idx_array.array() + m_idx_array.size();
     m_start_of_data= reinterpret_cast<uchar*>(start_of_data);
+    m_size_in_bytes= sort_buff_sz;
   }
   else
   {
     DBUG_ASSERT(num_records == m_idx_array.size());
     DBUG_ASSERT(record_length == m_record_length);
   }
+  m_packed_keys= NULL;
   DBUG_RETURN(m_idx_array.array());
 }
 
@@ -120,21 +140,37 @@ void Filesort_buffer::free_sort_buffer()
   m_idx_array= Idx_array();
   m_record_length= 0;
   m_start_of_data= NULL;
+  m_size_in_bytes= 0;
+  m_next_record= NULL;
+  m_packed_keys= NULL;
 }
 
 
-void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
+void Filesort_buffer::sort_buffer(const Sort_param *param, uint count,
+                                  uchar **scratch)
 {
   if (count <= 1)
     return;
+  if (m_packed_keys)
+  {
+    my_qsort2(m_packed_keys, count, sizeof(uchar*),
+              (qsort2_cmp) cmp_packed_sort_keys,
+              const_cast<Sort_param*>(param));
+    return;
+  }
   uchar **keys= get_sort_keys();
-  uchar **buffer= NULL;
-  if (radixsort_is_appliccable(count, param->sort_length) &&
-      (buffer= (uchar**) my_malloc(count*sizeof(char*),
-                                   MYF(MY_THREAD_SPECIFIC))))
+  uchar **buffer= scratch;
+  bool lsd= radixsort_is_appliccable(count, param->sort_length);
+  if ((lsd || radixsort_msd_is_applicable(count, param->sort_length)) &&
+      (buffer || (buffer= (uchar**) my_malloc(count*sizeof(char*),
+                                              MYF(MY_THREAD_SPECIFIC)))))
   {
-    radixsort_for_str_ptr(keys, count, param->sort_length, buffer);
-    my_free(buffer);
+    if (lsd)
+      radixsort_for_str_ptr(keys, count, param->sort_length, buffer);
+    else
+      radixsort_msd_for_str_ptr(keys, count, param->sort_length, buffer);
+    if (buffer != scratch)
+      my_free(buffer);
     return;
   }
   
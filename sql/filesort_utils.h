@@ -53,6 +53,10 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
   We wrap the buffer in order to be able to do lazy initialization of the
   pointers: the buffer is often much larger than what we actually need.
 
+  Packed records, which differ in length, are instead stored one after
+  the other from the start of the buffer, and the pointers to them from
+  the end of the buffer downwards, see start_packed_records().
+
   The buffer must be kept available for multiple executions of the
   same sort operation, so we have explicit allocate and free functions,
   rather than doing alloc/free in CTOR/DTOR.
@@ -61,11 +65,17 @@ class Filesort_buffer
 {
 public:
   Filesort_buffer() :
-    m_idx_array(), m_record_length(0), m_start_of_data(NULL)
+    m_idx_array(), m_record_length(0), m_start_of_data(NULL),
+    m_size_in_bytes(0), m_next_record(NULL), m_packed_keys(NULL)
   {}
 
-  /** Sort me... */
-  void sort_buffer(const Sort_param *param, uint count);
+  /**
+    Sort me...
+    @param scratch  Space for count pointers used by radix sort, or NULL
+                    to allocate it as needed.
+  */
+  void sort_buffer(const Sort_param *param, uint count,
+                   uchar **scratch= NULL);
 
   /// Initializes a record pointer.
   uchar *get_record_buffer(uint idx)
@@ -74,6 +84,29 @@ public:
     return m_idx_array[idx];
   }
 
+  /// Forgets the packed records and fills the buffer with packed records.
+  void start_packed_records()
+  {
+    uchar *end= reinterpret_cast<uchar*>(m_idx_array.array()) + m_size_in_bytes;
+    m_next_record= reinterpret_cast<uchar*>(m_idx_array.array());
+    m_packed_keys= reinterpret_cast<uchar**>(end - (size_t) end % sizeof(uchar*));
+  }
+
+  /// Returns space for a packed record, or NULL if the buffer is full.
+  uchar *get_packed_record_buffer()
+  {
+    uchar *end= reinterpret_cast<uchar*>(m_packed_keys - 1);
+    return m_next_record + m_record_length <= end ? m_next_record : NULL;
+  }
+
+  /// Adds the packed record written to get_packed_record_buffer().
+  void add_packed_record(uint length)
+  {
+    DBUG_ASSERT(length <= m_record_length);
+    *--m_packed_keys= m_next_record;
+    m_next_record+= length;
+  }
+
   /// Initializes all the record pointers.
   void init_record_pointers()
   {
@@ -104,6 +137,10 @@ public:
   /// Getter, for calling routines which still use the uchar** interface.
   uchar **get_sort_keys() { return m_idx_array.array(); }
 
+  /// Returns the pointers to the records, packed or not.
+  uchar **get_key_pointers()
+  { return m_packed_keys ? m_packed_keys : m_idx_array.array(); }
+
   /**
     We need an assignment operator, see filesort().
     This happens to have the same semantics as the one that would be
@@ -115,6 +152,9 @@ public:
     m_idx_array= rhs.m_idx_array;
     m_record_length= rhs.m_record_length;
     m_start_of_data= rhs.m_start_of_data;
+    m_size_in_bytes= rhs.m_size_in_bytes;
+    m_next_record= rhs.m_next_record;
+    m_packed_keys= rhs.m_packed_keys;
     return *this;
   }
 
@@ -124,6 +164,10 @@ private:
   Idx_array  m_idx_array;
   uint       m_record_length;
   uchar     *m_start_of_data;
+  size_t     m_size_in_bytes;
+  /* Where the next packed record goes, and the first pointer to them */
+  uchar     *m_next_record;
+  uchar    **m_packed_keys;
 };
 
 #endif  // FILESORT_UTILS_INCLUDED
@@ -2503,6 +2503,10 @@ public:
   Item *pushed_idx_cond;
   uint pushed_idx_cond_keyno;  /* The index which the above condition is for */
 
+  /* The state of the sampling scan, see ha_sample_init() */
+  double sample_fraction;
+  struct my_rnd_struct sample_rand;
+
   Discrete_interval auto_inc_interval_for_cur_row;
   /**
      Number of reserved auto-increment intervals. Serves as a heuristic
@@ -2631,6 +2635,41 @@ public:
     DBUG_RETURN(rnd_end());
   }
   int ha_rnd_init_with_error(bool scan) __attribute__ ((warn_unused_result));
+  /**
+    Start a scan returning a random sample of the records of the table
+
+    @param fraction  the expected share of the records in the sample
+    @param seed      the seed of the random choice of the records
+
+    @details
+    The sample is read with ha_sample_next() and the scan is ended with
+    ha_sample_end(). Each record gets into the sample with the probability
+    'fraction', though an engine may choose the records by groups stored
+    together, e.g. by blocks of the data file (see handler::sample_next()).
+    The same seed gives the same sample for the same table contents.
+  */
+  int ha_sample_init(double fraction, ulong seed)
+    __attribute__ ((warn_unused_result))
+  {
+    int result;
+    DBUG_ENTER("ha_sample_init");
+    DBUG_ASSERT(inited==NONE);
+    DBUG_ASSERT(fraction > 0.0 && fraction <= 1.0);
+    sample_fraction= fraction;
+    /* Scatter the seed: my_rnd() returns small values for small seeds */
+    my_rnd_init(&sample_rand, seed * 0x9E3779B1UL, seed * 0x85EBCA6BUL + 1);
+    inited= (result= sample_init()) ? NONE: RND;
+    end_range= NULL;
+    DBUG_RETURN(result);
+  }
+  int ha_sample_end()
+  {
+    DBUG_ENTER("ha_sample_end");
+    DBUG_ASSERT(inited==RND);
+    inited=NONE;
+    end_range= NULL;
+    DBUG_RETURN(sample_end());
+  }
   int ha_reset();
   /* this is necessary in many places, e.g. in HANDLER command */
   int ha_index_or_rnd_end()
@@ -3000,11 +3039,21 @@ private:
     return rnd_pos(record, ref);
   }
   virtual int read_first_row(uchar *buf, uint primary_key);
+protected:
+  /*
+    The sampling scan, see ha_sample_init(). By default the records are
+    read with rnd_next() and each of them is put into the sample or
+    skipped independently of the others.
+  */
+  virtual int sample_init() { return rnd_init(TRUE); }
+  virtual int sample_next(uchar *buf);
+  virtual int sample_end() { return rnd_end(); }
 public:
 
   /* Same as above, but with statistics */
   inline int ha_ft_read(uchar *buf);
   int ha_rnd_next(uchar *buf);
+  int ha_sample_next(uchar *buf);
   int ha_rnd_pos(uchar *buf, uchar *pos);
   inline int ha_rnd_pos_by_record(uchar *buf);
   inline int ha_read_first_row(uchar *buf, uint primary_key);
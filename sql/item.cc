@@ -2727,6 +2727,37 @@ Item *Item_field::get_tmp_table_item(THD *thd)
   return new_item;
 }
 
+
+/**
+  Build the evaluator of the values of the column over blocks of records
+
+  Integer columns (except BIGINT UNSIGNED, whose values may not fit into
+  longlong) and DATE columns are supported.
+*/
+
+Batch_expr *Item_field::get_batch_expr(TABLE *table, Batch_expr::Kind kind)
+{
+  if (type() != FIELD_ITEM || field->table != table)
+    return NULL;
+  switch (field->real_type()) {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONG:
+    break;
+  case MYSQL_TYPE_LONGLONG:
+    if (field->flags & UNSIGNED_FLAG)
+      return NULL;
+    break;
+  case MYSQL_TYPE_NEWDATE:
+    return kind == Batch_expr::DATE_KIND ? new Batch_field(field) : NULL;
+  default:
+    return NULL;
+  }
+  return kind == Batch_expr::INT_KIND ? new Batch_field(field) : NULL;
+}
+
+
 longlong Item_field::val_int_endpoint(bool left_endp, bool *incl_endp)
 {
   longlong res= val_int();
@@ -28,6 +28,7 @@
 #include "unireg.h"                    // REQUIRED: for other includes
 #include "thr_malloc.h"                         /* sql_calloc */
 #include "field.h"                              /* Derivation */
+#include "sql_batch_cond.h"                     /* Batch_cond */
 
 C_MODE_START
 #include <ma_dyncol.h>
@@ -1175,6 +1176,15 @@ public:
   virtual Item *real_item() { return this; }
   virtual Item *get_tmp_table_item(THD *thd) { return copy_or_same(thd); }
 
+  /*
+    Build the evaluator of the condition, or of the expression, over blocks
+    of records of the table (see sql_batch_cond.h). Return NULL if the item
+    cannot be evaluated in batches.
+  */
+  virtual Batch_cond *get_batch_cond(TABLE *table) { return NULL; }
+  virtual Batch_expr *get_batch_expr(TABLE *table, Batch_expr::Kind kind)
+  { return NULL; }
+
   static CHARSET_INFO *default_charset();
   virtual CHARSET_INFO *compare_collation() { return NULL; }
 
@@ -2308,6 +2318,7 @@ public:
     update_table_bitmaps();
   }
   Item *get_tmp_table_item(THD *thd);
+  Batch_expr *get_batch_expr(TABLE *table, Batch_expr::Kind kind);
   bool collect_item_field_processor(uchar * arg);
   bool add_field_to_set_processor(uchar * arg);
   bool find_item_in_field_list_processor(uchar *arg);
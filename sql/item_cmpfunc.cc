@@ -4774,6 +4774,181 @@ longlong Item_cond_or::val_int()
   return 0;
 }
 
+
+/*
+  Evaluation of conditions over blocks of records, see sql_batch_cond.h
+*/
+
+static Batch_cond *make_batch_cond_or(List<Batch_cond> &conds)
+{
+  Batch_cond_or *cond;
+  if (!(cond= new Batch_cond_or(conds)) || cond->init())
+    return NULL;
+  return cond;
+}
+
+
+/*
+  Check whether the evaluation of a conjunct can be skipped by a filter
+
+  The conjuncts that cannot be evaluated in batches are evaluated for the
+  remaining records with the whole condition. A filter may remove a record
+  before such a conjunct is evaluated for it only if the evaluation has no
+  effects: this is known for the comparisons of two integer columns.
+*/
+
+static bool batch_cond_can_skip(Item *item)
+{
+  if (item->type() != Item::FUNC_ITEM)
+    return FALSE;
+  Item_func *func= (Item_func*) item;
+  switch (func->functype()) {
+  case Item_func::EQ_FUNC:
+  case Item_func::EQUAL_FUNC:
+  case Item_func::NE_FUNC:
+  case Item_func::LT_FUNC:
+  case Item_func::LE_FUNC:
+  case Item_func::GT_FUNC:
+  case Item_func::GE_FUNC:
+    break;
+  default:
+    return FALSE;
+  }
+  for (uint i= 0; i < 2; i++)
+  {
+    Item *arg= func->arguments()[i];
+    if (arg->real_item()->type() != Item::FIELD_ITEM ||
+        arg->cmp_type() != INT_RESULT)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+  Build the evaluator of the conjunction over blocks of records
+
+  The conjuncts are evaluated in batches up to the first one that cannot
+  be evaluated and cannot be skipped (see batch_cond_can_skip()): the
+  records removed before it are the records for which the conjunction
+  would be found false before this conjunct is reached.
+*/
+
+Batch_cond *Item_cond_and::get_batch_cond(TABLE *table)
+{
+  List_iterator_fast<Item> li(list);
+  List<Batch_cond> conds;
+  Batch_cond *cond;
+  Item *item;
+  bool complete= TRUE;
+  while ((item= li++))
+  {
+    if (!(cond= item->get_batch_cond(table)))
+    {
+      if (batch_cond_can_skip(item))
+        continue;
+      complete= FALSE;
+      break;
+    }
+    if (conds.push_back(cond))
+      return NULL;
+    if (!cond->complete)
+    {
+      complete= FALSE;
+      break;
+    }
+  }
+  if (conds.elements == 0)
+    return NULL;
+  if (conds.elements == 1 && complete)
+    return conds.head();
+  return new Batch_cond_and(conds, complete);
+}
+
+
+Batch_cond *Item_cond_or::get_batch_cond(TABLE *table)
+{
+  List_iterator_fast<Item> li(list);
+  List<Batch_cond> conds;
+  Batch_cond *cond;
+  Item *item;
+  while ((item= li++))
+  {
+    if (!(cond= item->get_batch_cond(table)) || conds.push_back(cond))
+      return NULL;
+  }
+  return make_batch_cond_or(conds);
+}
+
+
+Batch_cond *Item_bool_rowready_func2::get_batch_cond(TABLE *table)
+{
+  Batch_cmp::Op op;
+  switch (functype()) {
+  case EQ_FUNC: op= Batch_cmp::EQ; break;
+  case NE_FUNC: op= Batch_cmp::NE; break;
+  case LT_FUNC: op= Batch_cmp::LT; break;
+  case LE_FUNC: op= Batch_cmp::LE; break;
+  case GT_FUNC: op= Batch_cmp::GT; break;
+  case GE_FUNC: op= Batch_cmp::GE; break;
+  default:
+    return NULL;                                /* <=> */
+  }
+  return make_batch_cmp(table, op, args[0], args[1]);
+}
+
+
+Batch_cond *Item_func_between::get_batch_cond(TABLE *table)
+{
+  List<Batch_cond> conds;
+  Batch_cond *low, *high;
+
+  /* The bounds must be compared with the value as in the whole predicate */
+  if (item_cmp_type(args[0]->cmp_type(), args[1]->cmp_type()) != cmp_type ||
+      item_cmp_type(args[0]->cmp_type(), args[2]->cmp_type()) != cmp_type)
+    return NULL;
+  if (negated)
+  {
+    if (!(low= make_batch_cmp(table, Batch_cmp::LT, args[0], args[1])) ||
+        !(high= make_batch_cmp(table, Batch_cmp::GT, args[0], args[2])) ||
+        conds.push_back(low) || conds.push_back(high))
+      return NULL;
+    return make_batch_cond_or(conds);
+  }
+  if (!(low= make_batch_cmp(table, Batch_cmp::GE, args[0], args[1])) ||
+      !(high= make_batch_cmp(table, Batch_cmp::LE, args[0], args[2])) ||
+      conds.push_back(low) || conds.push_back(high))
+    return NULL;
+  return new Batch_cond_and(conds, TRUE);
+}
+
+
+static Batch_cond *make_batch_isnull(TABLE *table, Item *item, bool negated)
+{
+  Field *field;
+  if (item->type() != Item::FIELD_ITEM ||
+      (field= ((Item_field*) item)->field)->table != table ||
+      !field->null_ptr)
+    return NULL;
+  return new Batch_isnull(field, negated);
+}
+
+
+Batch_cond *Item_func_isnull::get_batch_cond(TABLE *table)
+{
+  /* Item_is_not_null_test also records if it has seen a NULL value */
+  if (functype() != ISNULL_FUNC)
+    return NULL;
+  return make_batch_isnull(table, args[0], FALSE);
+}
+
+
+Batch_cond *Item_func_isnotnull::get_batch_cond(TABLE *table)
+{
+  return make_batch_isnull(table, args[0], TRUE);
+}
+
+
 /**
   Create an AND expression from two expressions.
 
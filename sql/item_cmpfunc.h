@@ -416,6 +416,7 @@ public:
   {
     return (*arg != NULL);     
   }
+  Batch_cond *get_batch_cond(TABLE *table);
 };
 
 /**
@@ -692,6 +693,7 @@ public:
   bool eval_not_null_tables(uchar *opt_arg);
   void fix_after_pullout(st_select_lex *new_parent, Item **ref);
   bool count_sargable_conds(uchar *arg);
+  Batch_cond *get_batch_cond(TABLE *table);
 };
 
 
@@ -1407,6 +1409,7 @@ public:
   optimize_type select_optimize() const { return OPTIMIZE_NULL; }
   Item *neg_transformer(THD *thd);
   CHARSET_INFO *compare_collation() { return args[0]->collation.collation; }
+  Batch_cond *get_batch_cond(TABLE *table);
 };
 
 /* Functions used by HAVING for rewriting IN subquery */
@@ -1457,6 +1460,7 @@ public:
   virtual void print(String *str, enum_query_type query_type);
   CHARSET_INFO *compare_collation() { return args[0]->collation.collation; }
   void top_level_item() { abort_on_null=1; }
+  Batch_cond *get_batch_cond(TABLE *table);
 };
 
 
@@ -2011,6 +2015,7 @@ public:
   void mark_as_condition_AND_part(TABLE_LIST *embedding);
   virtual uint exists2in_reserved_items() { return list.elements; };
   bool walk_top_and(Item_processor processor, uchar *arg);
+  Batch_cond *get_batch_cond(TABLE *table);
 };
 
 inline bool is_cond_and(Item *item)
@@ -2041,6 +2046,7 @@ public:
     return item;
   }
   Item *neg_transformer(THD *thd);
+  Batch_cond *get_batch_cond(TABLE *table);
 };
 
 class Item_func_dyncol_check :public Item_bool_func
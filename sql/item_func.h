@@ -701,6 +701,11 @@ public:
   Item_func_plus(Item *a,Item *b) :Item_func_additive_op(a,b) {}
   const char *func_name() const { return "+"; }
   longlong int_op();
+  Batch_expr *get_batch_expr(TABLE *table, Batch_expr::Kind kind)
+  {
+    return kind == Batch_expr::INT_KIND ?
+           make_batch_arith(table, Batch_arith::PLUS, this) : NULL;
+  }
   double real_op();
   my_decimal *decimal_op(my_decimal *);
 };
@@ -711,6 +716,11 @@ public:
   Item_func_minus(Item *a,Item *b) :Item_func_additive_op(a,b) {}
   const char *func_name() const { return "-"; }
   longlong int_op();
+  Batch_expr *get_batch_expr(TABLE *table, Batch_expr::Kind kind)
+  {
+    return kind == Batch_expr::INT_KIND ?
+           make_batch_arith(table, Batch_arith::MINUS, this) : NULL;
+  }
   double real_op();
   my_decimal *decimal_op(my_decimal *);
   void fix_length_and_dec();
@@ -723,6 +733,11 @@ public:
   Item_func_mul(Item *a,Item *b) :Item_num_op(a,b) {}
   const char *func_name() const { return "*"; }
   longlong int_op();
+  Batch_expr *get_batch_expr(TABLE *table, Batch_expr::Kind kind)
+  {
+    return kind == Batch_expr::INT_KIND ?
+           make_batch_arith(table, Batch_arith::MUL, this) : NULL;
+  }
   double real_op();
   my_decimal *decimal_op(my_decimal *);
   void result_precision();
@@ -551,12 +551,12 @@ err:
 
 
 const char *histogram_types[] =
-           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", 0};
+           {"SINGLE_PREC_HB", "DOUBLE_PREC_HB", "MCV_HB", 0};
 static TYPELIB hystorgam_types_typelib=
   { array_elements(histogram_types),
     "histogram_types",
     histogram_types, NULL};
-const char *representation_by_type[]= {"%.3f", "%.5f"};
+const char *representation_by_type[]= {"%.3f", "%.5f", "%.5f"};
 
 String *Item_func_decode_histogram::val_str(String *str)
 {
@@ -581,15 +581,38 @@ String *Item_func_decode_histogram::val_str(String *str)
     null_value= 1;
     return 0;
   }
-  if (type == DOUBLE_PREC_HB && res->length() % 2 != 0)
-    res->length(res->length() - 1); // one byte is unused
 
   double prev= 0.0;
-  uint i;
+  uint i= 0;
   str->length(0);
   char numbuf[32];
   const uchar *p= (uchar*)res->c_ptr();
-  for (i= 0; i < res->length(); i++)
+  if (type == MCV_HB)
+  {
+    /* show the most common values as position:frequency pairs */
+    uint mcv_count= res->length() >= MCV_HB_HEADER_SIZE ? uint2korr(p) : 0;
+    i= MCV_HB_HEADER_SIZE + mcv_count * MCV_HB_ENTRY_SIZE;
+    if (i > res->length())
+    {
+      null_value= 1;
+      return 0;
+    }
+    str->append("MCV(");
+    for (uint j= 0; j < mcv_count; j++)
+    {
+      const uchar *entry= p + MCV_HB_HEADER_SIZE + j * MCV_HB_ENTRY_SIZE;
+      int size= my_snprintf(numbuf, sizeof(numbuf), "%s%.5f:%.5f",
+                            j ? "," : "",
+                            uint2korr(entry) / ((double)((1 << 16) - 1)),
+                            uint2korr(entry + 2) / ((double)((1 << 16) - 1)));
+      str->append(numbuf, size);
+    }
+    str->append("),");
+  }
+  if (type != SINGLE_PREC_HB && (res->length() - i) % 2 != 0)
+    res->length(res->length() - 1); // one byte is unused
+
+  for (; i < res->length(); i++)
   {
     double val;
     switch (type)
@@ -598,6 +621,7 @@ String *Item_func_decode_histogram::val_str(String *str)
       val= p[i] / ((double)((1 << 8) - 1));
       break;
     case DOUBLE_PREC_HB:
+    case MCV_HB:
       val= uint2korr(p + i) / ((double)((1 << 16) - 1));
       i++;
       break;
@@ -26,11 +26,13 @@
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_MDL_map_mutex;
 static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
+static PSI_mutex_key key_MDL_context_LOCK_fast_path;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
   { &key_MDL_map_mutex, "MDL_map::mutex", 0},
-  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
+  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0},
+  { &key_MDL_context_LOCK_fast_path, "MDL_context::LOCK_fast_path", 0}
 };
 
 static PSI_rwlock_key key_MDL_lock_rwlock;
@@ -108,6 +110,9 @@ void MDL_key::init_psi_keys()
 
 static bool mdl_initialized= 0;
 
+/** Protects MDL_lock::m_fast_path_state on platforms without atomics. */
+static my_atomic_rwlock_t LOCK_mdl_atomics;
+
 
 class MDL_object_lock;
 class MDL_object_lock_cache_adapter;
@@ -124,7 +129,8 @@ class MDL_map_partition
 public:
   MDL_map_partition();
   ~MDL_map_partition();
-  inline MDL_lock *find_or_insert(const MDL_key *mdl_key);
+  inline MDL_lock *find_or_insert(const MDL_key *mdl_key,
+                                  int64 fast_path_increment, bool *fast_path);
   unsigned long get_lock_owner(const MDL_key *key);
   inline void remove(MDL_lock *lock);
 private:
@@ -172,7 +178,8 @@ class MDL_map
 public:
   void init();
   void destroy();
-  MDL_lock *find_or_insert(const MDL_key *key);
+  MDL_lock *find_or_insert(const MDL_key *key, int64 fast_path_increment,
+                           bool *fast_path);
   unsigned long get_lock_owner(const MDL_key *key);
   void remove(MDL_lock *lock);
 private:
@@ -340,12 +347,42 @@ Deadlock_detection_visitor::opt_change_victim_to(MDL_context *new_victim)
   This is an abstract class which lacks information about
   compatibility rules for lock types. They should be specified
   in its descendants.
+
+  Fast path. Lock types which are requested by DML ("unobtrusive" types:
+  S, SH, SR, SW for objects and IX for scopes) are compatible with each
+  other. As long as no lock of another ("obtrusive") type is granted or
+  pending, such locks are granted by atomically incrementing a counter
+  in m_fast_path_state without acquiring m_rwlock, and their tickets are
+  not added to m_granted. Obtrusive requests set HAS_OBTRUSIVE under
+  m_rwlock, which closes the fast path, and then take the counters into
+  account in can_grant_lock(). Tickets granted using the fast path are
+  invisible to the deadlock detector and to notify_conflicting_locks(),
+  which is fine since:
+  - a context moves all its fast path tickets to m_granted before it
+    starts waiting or requests an obtrusive lock, so contexts in the
+    wait-for graph have no such tickets;
+  - contexts which need to be notified about conflicting requests do
+    not use the fast path (see MDL_context::set_needs_thr_lock_abort()
+    and MDL_context::disable_fast_path()).
 */
 
 class MDL_lock
 {
 public:
   typedef unsigned short bitmap_t;
+  /** Type of the word holding the fast path state of the lock. */
+  typedef int64 fast_path_state_t;
+
+  /**
+    Layout of m_fast_path_state: three 20-bit counters of "unobtrusive"
+    locks granted using the fast path, followed by two flags.
+  */
+  static const fast_path_state_t FAST_PATH_COUNTER_MASK= (1LL << 20) - 1;
+  static const fast_path_state_t FAST_PATH_COUNTERS= (1LL << 60) - 1;
+  /** Obtrusive locks are granted or pending, the fast path is closed. */
+  static const fast_path_state_t HAS_OBTRUSIVE= 1LL << 60;
+  /** The list of granted or waiting tickets is not empty. */
+  static const fast_path_state_t HAS_SLOW_PATH= 1LL << 61;
 
   class Ticket_list
   {
@@ -415,11 +452,50 @@ public:
 
   bool is_empty() const
   {
-    return (m_granted.is_empty() && m_waiting.is_empty());
+    return (m_granted.is_empty() && m_waiting.is_empty() &&
+            !(fast_path_state() & FAST_PATH_COUNTERS));
   }
 
   virtual const bitmap_t *incompatible_granted_types_bitmap() const = 0;
   virtual const bitmap_t *incompatible_waiting_types_bitmap() const = 0;
+  virtual const fast_path_state_t *unobtrusive_lock_increment() const = 0;
+
+  static inline fast_path_state_t
+  get_unobtrusive_lock_increment(const MDL_request *request);
+
+  bitmap_t fast_path_granted_bitmap() const;
+  bitmap_t obtrusive_lock_types_bitmap() const;
+
+  fast_path_state_t fast_path_state() const
+  {
+    fast_path_state_t state;
+    my_atomic_rwlock_rdlock(&LOCK_mdl_atomics);
+    state= my_atomic_load64(const_cast<volatile int64*>(&m_fast_path_state));
+    my_atomic_rwlock_rdunlock(&LOCK_mdl_atomics);
+    return state;
+  }
+
+  bool fast_path_state_cas(fast_path_state_t *old_state,
+                           fast_path_state_t new_state)
+  {
+    bool res;
+    my_atomic_rwlock_wrlock(&LOCK_mdl_atomics);
+    res= my_atomic_cas64(&m_fast_path_state, old_state, new_state);
+    my_atomic_rwlock_wrunlock(&LOCK_mdl_atomics);
+    return res;
+  }
+
+  void fast_path_state_add(fast_path_state_t value)
+  {
+    my_atomic_rwlock_wrlock(&LOCK_mdl_atomics);
+    my_atomic_add64(&m_fast_path_state, value);
+    my_atomic_rwlock_wrunlock(&LOCK_mdl_atomics);
+  }
+
+  bool fast_path_acquire(fast_path_state_t increment);
+  void fast_path_release(fast_path_state_t increment);
+  void set_has_obtrusive();
+  void update_fast_path_flags();
 
   bool has_pending_conflicting_lock(enum_mdl_type type);
 
@@ -454,11 +530,22 @@ public:
   */
   ulong m_hog_lock_count;
 
+  /**
+    Counters of unobtrusive locks granted using the fast path together
+    with HAS_OBTRUSIVE and HAS_SLOW_PATH flags. Changed atomically.
+    The counters are only incremented while holding a reference which
+    prevents the object from being removed from MDL_map: for objects
+    in the hash this is MDL_map_partition::m_mutex or a ticket for the
+    same lock. The flags are only changed while holding m_rwlock.
+  */
+  volatile fast_path_state_t m_fast_path_state;
+
 public:
 
   MDL_lock(const MDL_key *key_arg, MDL_map_partition *map_part)
   : key(key_arg),
     m_hog_lock_count(0),
+    m_fast_path_state(0),
     m_ref_usage(0),
     m_ref_release(0),
     m_is_destroyed(FALSE),
@@ -557,6 +644,14 @@ public:
     return 0;
   }
 
+  virtual const fast_path_state_t *unobtrusive_lock_increment() const
+  {
+    return m_unobtrusive_lock_increment;
+  }
+
+  /** Only IX locks are granted using the fast path. */
+  static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+
 private:
   static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
   static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
@@ -585,6 +680,7 @@ public:
     key.mdl_key_init(new_key);
     /* m_granted and m_waiting should be already in the empty/initial state. */
     DBUG_ASSERT(is_empty());
+    DBUG_ASSERT(fast_path_state() == 0);
     /* Object should not be marked as destroyed. */
     DBUG_ASSERT(! m_is_destroyed);
     /*
@@ -621,6 +717,18 @@ public:
             MDL_BIT(MDL_EXCLUSIVE));
   }
 
+  virtual const fast_path_state_t *unobtrusive_lock_increment() const
+  {
+    return m_unobtrusive_lock_increment;
+  }
+
+  /**
+    S, SH, SR and SW locks, which are taken by DML, are granted using the
+    fast path. S and SH share a counter as they have the same
+    compatibility.
+  */
+  static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+
 private:
   static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
   static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
@@ -681,6 +789,7 @@ void mdl_init()
   init_mdl_psi_keys();
 #endif
 
+  my_atomic_rwlock_init(&LOCK_mdl_atomics);
   mdl_locks.init();
 }
 
@@ -698,6 +807,7 @@ void mdl_destroy()
   {
     mdl_initialized= FALSE;
     mdl_locks.destroy();
+    my_atomic_rwlock_destroy(&LOCK_mdl_atomics);
   }
 }
 
@@ -769,6 +879,25 @@ int mdl_iterate(int (*callback)(MDL_ticket *ticket, void *arg), void *arg)
     }
   }
   delete_dynamic(&locks);
+
+  /* Locks granted using the fast path are only known to their owners. */
+  if (!res)
+  {
+    THD *tmp;
+    mysql_mutex_lock(&LOCK_thread_count);
+    I_List_iterator<THD> it(threads);
+    while (!res && (tmp= it++))
+    {
+      MDL_context *ctx= &tmp->mdl_context;
+      mysql_mutex_lock(&ctx->m_LOCK_fast_path);
+      MDL_context::Fast_path_ticket_list::Iterator
+        ticket_it(ctx->m_fast_path_tickets);
+      MDL_ticket *ticket;
+      while ((ticket= ticket_it++) && !(res= callback(ticket, arg))) /* no-op */;
+      mysql_mutex_unlock(&ctx->m_LOCK_fast_path);
+    }
+    mysql_mutex_unlock(&LOCK_thread_count);
+  }
   DBUG_RETURN(res);
 }
 
@@ -848,12 +977,21 @@ MDL_map_partition::~MDL_map_partition()
   Find MDL_lock object corresponding to the key, create it
   if it does not exist.
 
+  @param      mdl_key              Key of the lock.
+  @param      fast_path_increment  If not 0, try to grant an unobtrusive
+                                   lock using the fast path by adding this
+                                   value to MDL_lock::m_fast_path_state.
+  @param[out] fast_path            Set to TRUE if the lock was granted
+                                   using the fast path.
+
   @retval non-NULL - Success. MDL_lock instance for the key with
-                     locked MDL_lock::m_rwlock.
+                     locked MDL_lock::m_rwlock, unless the lock was
+                     granted using the fast path.
   @retval NULL     - Failure (OOM).
 */
 
-MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
+MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key,
+                                  int64 fast_path_increment, bool *fast_path)
 {
   MDL_lock *lock;
 
@@ -874,6 +1012,13 @@ MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
     lock= (mdl_key->mdl_namespace() == MDL_key::GLOBAL) ? m_global_lock :
                                                           m_commit_lock;
 
+    /* These objects are never destroyed, no reference is needed. */
+    if (fast_path_increment && lock->fast_path_acquire(fast_path_increment))
+    {
+      *fast_path= TRUE;
+      return lock;
+    }
+
     mysql_prlock_wrlock(&lock->m_rwlock);
 
     return lock;
@@ -882,7 +1027,7 @@ MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
   uint part_id= mdl_key->hash_value() % mdl_locks_hash_partitions;
   MDL_map_partition *part= m_partitions.at(part_id);
 
-  return part->find_or_insert(mdl_key);
+  return part->find_or_insert(mdl_key, fast_path_increment, fast_path);
 }
 
 
@@ -890,12 +1035,17 @@ MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
   Find MDL_lock object corresponding to the key and hash value in
   MDL_map partition, create it if it does not exist.
 
+  @see MDL_map::find_or_insert() for parameters.
+
   @retval non-NULL - Success. MDL_lock instance for the key with
-                     locked MDL_lock::m_rwlock.
+                     locked MDL_lock::m_rwlock, unless the lock was
+                     granted using the fast path.
   @retval NULL     - Failure (OOM).
 */
 
-MDL_lock* MDL_map_partition::find_or_insert(const MDL_key *mdl_key)
+MDL_lock* MDL_map_partition::find_or_insert(const MDL_key *mdl_key,
+                                            int64 fast_path_increment,
+                                            bool *fast_path)
 {
   MDL_lock *lock;
 
@@ -953,6 +1103,17 @@ retry:
     }
   }
 
+  /*
+    m_mutex prevents the object from being removed from the hash,
+    so it is safe to grant a lock using the fast path.
+  */
+  if (fast_path_increment && lock->fast_path_acquire(fast_path_increment))
+  {
+    mysql_mutex_unlock(&m_mutex);
+    *fast_path= TRUE;
+    return lock;
+  }
+
   if (move_from_hash_to_lock_mutex(lock))
     goto retry;
 
@@ -1114,6 +1275,16 @@ void MDL_map::remove(MDL_lock *lock)
 void MDL_map_partition::remove(MDL_lock *lock)
 {
   mysql_mutex_lock(&m_mutex);
+  if (!lock->is_empty())
+  {
+    /*
+      A lock was granted using the fast path while we held only
+      MDL_lock::m_rwlock. Its owner will take care of removal.
+    */
+    mysql_mutex_unlock(&m_mutex);
+    mysql_prlock_unlock(&lock->m_rwlock);
+    return;
+  }
   my_hash_delete(&m_locks, (uchar*) lock);
   /*
     To let threads holding references to the MDL_lock object know that it was
@@ -1186,9 +1357,12 @@ MDL_context::MDL_context()
   :
   m_owner(NULL),
   m_needs_thr_lock_abort(FALSE),
+  m_fast_path_disabled(FALSE),
   m_waiting_for(NULL)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
+  mysql_mutex_init(key_MDL_context_LOCK_fast_path, &m_LOCK_fast_path,
+                   MY_MUTEX_INIT_FAST);
 }
 
 
@@ -1209,8 +1383,10 @@ void MDL_context::destroy()
   DBUG_ASSERT(m_tickets[MDL_STATEMENT].is_empty());
   DBUG_ASSERT(m_tickets[MDL_TRANSACTION].is_empty());
   DBUG_ASSERT(m_tickets[MDL_EXPLICIT].is_empty());
+  DBUG_ASSERT(m_fast_path_tickets.is_empty());
 
   mysql_prlock_destroy(&m_LOCK_waiting_for);
+  mysql_mutex_destroy(&m_LOCK_fast_path);
 }
 
 
@@ -1723,6 +1899,12 @@ const MDL_lock::bitmap_t MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END] =
   MDL_BIT(MDL_EXCLUSIVE), 0, 0, 0, 0, 0, 0, 0
 };
 
+const MDL_lock::fast_path_state_t
+MDL_scoped_lock::m_unobtrusive_lock_increment[MDL_TYPE_END] =
+{
+  1, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
 
 /**
   Compatibility (or rather "incompatibility") matrices for per-object
@@ -1818,6 +2000,13 @@ MDL_object_lock::m_waiting_incompatible[MDL_TYPE_END] =
 };
 
 
+const MDL_lock::fast_path_state_t
+MDL_object_lock::m_unobtrusive_lock_increment[MDL_TYPE_END] =
+{
+  0, 1, 1, 1LL << 20, 1LL << 40, 0, 0, 0, 0
+};
+
+
 /**
   Check if request for the metadata lock can be satisfied given its
   current state.
@@ -1852,7 +2041,14 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   */
   if (ignore_lock_priority || !(m_waiting.bitmap() & waiting_incompat_map))
   {
-    if (! (m_granted.bitmap() & granted_incompat_map))
+    /*
+      Locks granted using the fast path belong to other contexts, as
+      the requestor moves its own ones to m_granted before requesting
+      an obtrusive lock (see MDL_context::materialize_fast_path_locks()).
+    */
+    if (fast_path_granted_bitmap() & granted_incompat_map)
+      can_grant= FALSE;
+    else if (! (m_granted.bitmap() & granted_incompat_map))
       can_grant= TRUE;
     else
     {
@@ -1874,6 +2070,159 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
 }
 
 
+/**
+  Get the value by which m_fast_path_state is incremented when the
+  requested lock is granted using the fast path.
+
+  @retval 0  The lock type is obtrusive and is never granted using
+             the fast path.
+*/
+
+inline MDL_lock::fast_path_state_t
+MDL_lock::get_unobtrusive_lock_increment(const MDL_request *request)
+{
+  switch (request->key.mdl_namespace())
+  {
+    case MDL_key::GLOBAL:
+    case MDL_key::SCHEMA:
+    case MDL_key::COMMIT:
+      return MDL_scoped_lock::m_unobtrusive_lock_increment[request->type];
+    default:
+      return MDL_object_lock::m_unobtrusive_lock_increment[request->type];
+  }
+}
+
+
+/** Bitmap of types of locks currently granted using the fast path. */
+
+MDL_lock::bitmap_t MDL_lock::fast_path_granted_bitmap() const
+{
+  const fast_path_state_t *increment= unobtrusive_lock_increment();
+  fast_path_state_t state= fast_path_state();
+  bitmap_t bitmap= 0;
+
+  for (int i= 0; i < MDL_TYPE_END; i++)
+    if (state & (increment[i] * FAST_PATH_COUNTER_MASK))
+      bitmap|= MDL_BIT(i);
+  return bitmap;
+}
+
+
+/** Bitmap of types of locks which are never granted using the fast path. */
+
+MDL_lock::bitmap_t MDL_lock::obtrusive_lock_types_bitmap() const
+{
+  const fast_path_state_t *increment= unobtrusive_lock_increment();
+  bitmap_t bitmap= 0;
+
+  for (int i= 0; i < MDL_TYPE_END; i++)
+    if (!increment[i])
+      bitmap|= MDL_BIT(i);
+  return bitmap;
+}
+
+
+/**
+  Try to grant an unobtrusive lock by incrementing its counter in
+  m_fast_path_state, without acquiring m_rwlock.
+
+  @pre The caller holds a reference preventing the object from being
+       removed from MDL_map (see m_fast_path_state).
+
+  @retval TRUE   Lock granted.
+  @retval FALSE  There are obtrusive locks granted or pending or the
+                 counter is saturated, the slow path should be used.
+*/
+
+bool MDL_lock::fast_path_acquire(fast_path_state_t increment)
+{
+  fast_path_state_t counter_mask= increment * FAST_PATH_COUNTER_MASK;
+  fast_path_state_t old_state= fast_path_state();
+
+  do
+  {
+    if ((old_state & HAS_OBTRUSIVE) ||
+        (old_state & counter_mask) == counter_mask)
+      return FALSE;
+  } while (!fast_path_state_cas(&old_state, old_state + increment));
+  return TRUE;
+}
+
+
+/**
+  Release a lock granted using the fast path.
+
+  Only takes m_rwlock if there are obtrusive locks which may have to be
+  woken up or if this was the last reference to an object which has to
+  be removed from MDL_map.
+*/
+
+void MDL_lock::fast_path_release(fast_path_state_t increment)
+{
+  fast_path_state_t old_state= fast_path_state();
+
+  while (!(old_state & HAS_OBTRUSIVE) &&
+         (!m_map_part || old_state != increment))
+  {
+    if (fast_path_state_cas(&old_state, old_state - increment))
+      return;
+  }
+
+  mysql_prlock_wrlock(&m_rwlock);
+  fast_path_state_add(-increment);
+  if (is_empty())
+    mdl_locks.remove(this);
+  else
+  {
+    reschedule_waiters();
+    mysql_prlock_unlock(&m_rwlock);
+  }
+}
+
+
+/**
+  Close the fast path before checking whether an obtrusive lock can
+  be granted, so that no new unobtrusive locks can sneak in unnoticed.
+
+  @pre m_rwlock is write-locked.
+*/
+
+void MDL_lock::set_has_obtrusive()
+{
+  fast_path_state_t old_state= fast_path_state();
+
+  while (!(old_state & HAS_OBTRUSIVE) &&
+         !fast_path_state_cas(&old_state, old_state | HAS_OBTRUSIVE))
+  { }
+}
+
+
+/**
+  Bring flags in m_fast_path_state in line with the lists of granted
+  and waiting tickets. Should be called after these lists are changed.
+
+  @pre m_rwlock is write-locked.
+*/
+
+void MDL_lock::update_fast_path_flags()
+{
+  fast_path_state_t flags= 0;
+  fast_path_state_t old_state;
+
+  if ((m_granted.bitmap() | m_waiting.bitmap()) &
+      obtrusive_lock_types_bitmap())
+    flags|= HAS_OBTRUSIVE;
+  if (!m_granted.is_empty() || !m_waiting.is_empty())
+    flags|= HAS_SLOW_PATH;
+
+  old_state= fast_path_state();
+  while ((old_state & ~FAST_PATH_COUNTERS) != flags &&
+         !fast_path_state_cas(&old_state,
+                              (old_state & FAST_PATH_COUNTERS) | flags))
+  { }
+}
+
+
 /**
   Return thread id of the thread to which the first ticket was
   granted.
@@ -1897,6 +2246,7 @@ void MDL_lock::remove_ticket(Ticket_list MDL_lock::*list, MDL_ticket *ticket)
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
+  update_fast_path_flags();
   if (is_empty())
     mdl_locks.remove(this);
   else
@@ -2069,6 +2419,8 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       is no need to release it.
     */
     DBUG_ASSERT(! ticket->m_lock->is_empty());
+    /* Reopen the fast path closed for the failed obtrusive request. */
+    ticket->m_lock->update_fast_path_flags();
     mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
@@ -2101,6 +2453,8 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   MDL_key *key= &mdl_request->key;
   MDL_ticket *ticket;
   enum_mdl_duration found_duration;
+  MDL_lock::fast_path_state_t unobtrusive_increment;
+  bool fast_path= FALSE;
 
   DBUG_ASSERT(mdl_request->type != MDL_EXCLUSIVE ||
               is_lock_owner(MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE));
@@ -2153,8 +2507,24 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
-  /* The below call implicitly locks MDL_lock::m_rwlock on success. */
-  if (!(lock= mdl_locks.find_or_insert(key)))
+  unobtrusive_increment=
+    MDL_lock::get_unobtrusive_lock_increment(mdl_request);
+
+  /*
+    Obtrusive requests are checked against MDL_lock::m_granted, so our
+    own locks granted using the fast path have to be moved there first.
+  */
+  if (!unobtrusive_increment)
+    materialize_fast_path_locks();
+
+  /*
+    The below call implicitly locks MDL_lock::m_rwlock on success,
+    unless the lock is granted using the fast path.
+  */
+  if (!(lock= mdl_locks.find_or_insert(key,
+                                       fast_path_allowed() ?
+                                       unobtrusive_increment : 0,
+                                       &fast_path)))
   {
     MDL_ticket::destroy(ticket);
     return TRUE;
@@ -2162,9 +2532,22 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
 
   ticket->m_lock= lock;
 
+  if (fast_path)
+  {
+    ticket->m_is_fast_path= TRUE;
+    add_fast_path_ticket(ticket);
+    m_tickets[mdl_request->duration].push_front(ticket);
+    mdl_request->ticket= ticket;
+    return FALSE;
+  }
+
+  if (!unobtrusive_increment)
+    lock->set_has_obtrusive();
+
   if (lock->can_grant_lock(mdl_request->type, this, false))
   {
     lock->m_granted.add_ticket(ticket);
+    lock->update_fast_path_flags();
 
     mysql_prlock_unlock(&lock->m_rwlock);
 
@@ -2196,6 +2579,7 @@ bool
 MDL_context::clone_ticket(MDL_request *mdl_request)
 {
   MDL_ticket *ticket;
+  MDL_lock::fast_path_state_t unobtrusive_increment;
 
   /*
     By submitting mdl_request->type to MDL_ticket::create()
@@ -2213,11 +2597,24 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
   DBUG_ASSERT(mdl_request->ticket->has_stronger_or_equal_type(ticket->m_type));
 
   ticket->m_lock= mdl_request->ticket->m_lock;
-  mdl_request->ticket= ticket;
+  unobtrusive_increment=
+    MDL_lock::get_unobtrusive_lock_increment(mdl_request);
 
-  mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
-  ticket->m_lock->m_granted.add_ticket(ticket);
-  mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+  /* The original ticket keeps the lock object in MDL_map. */
+  if (unobtrusive_increment && fast_path_allowed() &&
+      ticket->m_lock->fast_path_acquire(unobtrusive_increment))
+  {
+    ticket->m_is_fast_path= TRUE;
+    add_fast_path_ticket(ticket);
+  }
+  else
+  {
+    mysql_prlock_wrlock(&ticket->m_lock->m_rwlock);
+    ticket->m_lock->m_granted.add_ticket(ticket);
+    ticket->m_lock->update_fast_path_flags();
+    mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
+  }
+  mdl_request->ticket= ticket;
 
   m_tickets[mdl_request->duration].push_front(ticket);
 
@@ -2225,6 +2622,62 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
 }
 
 
+/** Add a ticket granted using the fast path to the context's list. */
+
+void MDL_context::add_fast_path_ticket(MDL_ticket *ticket)
+{
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  m_fast_path_tickets.push_front(ticket);
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+}
+
+
+/** Remove a ticket granted using the fast path from the context's list. */
+
+void MDL_context::remove_fast_path_ticket(MDL_ticket *ticket)
+{
+  mysql_mutex_lock(&m_LOCK_fast_path);
+  m_fast_path_tickets.remove(ticket);
+  mysql_mutex_unlock(&m_LOCK_fast_path);
+}
+
+
+/**
+  Move all locks of this context which were granted using the fast path
+  to the lists of granted tickets of the corresponding MDL_lock objects.
+
+  This makes them visible to the deadlock detector and to conflicting
+  lock requests, and must be done before the context starts waiting or
+  requests an obtrusive lock.
+
+  @note Must not be called while holding MDL_lock::m_rwlock or
+        LOCK_table_share of any object.
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  MDL_ticket *ticket;
+
+  for (;;)
+  {
+    mysql_mutex_lock(&m_LOCK_fast_path);
+    ticket= m_fast_path_tickets.pop_front();
+    mysql_mutex_unlock(&m_LOCK_fast_path);
+    if (!ticket)
+      break;
+
+    MDL_lock *lock= ticket->m_lock;
+    mysql_prlock_wrlock(&lock->m_rwlock);
+    lock->m_granted.add_ticket(ticket);
+    lock->fast_path_state_add(
+      -lock->unobtrusive_lock_increment()[ticket->get_type()]);
+    lock->update_fast_path_flags();
+    mysql_prlock_unlock(&lock->m_rwlock);
+    ticket->m_is_fast_path= FALSE;
+  }
+}
+
+
 /**
   Notify threads holding a shared metadata locks on object which
   conflict with a pending X, SNW or SNRW lock.
@@ -2339,6 +2792,7 @@ MDL_context::acquire_lock(MDL_request *mdl_request, ulong lock_wait_timeout)
   lock= ticket->m_lock;
 
   lock->m_waiting.add_ticket(ticket);
+  lock->update_fast_path_flags();
 
   /*
     Once we added a pending ticket to the waiting queue,
@@ -2357,6 +2811,9 @@ MDL_context::acquire_lock(MDL_request *mdl_request, ulong lock_wait_timeout)
 
   mysql_prlock_unlock(&lock->m_rwlock);
 
+  /* Make our locks visible to the deadlock detector. */
+  materialize_fast_path_locks();
+
   will_wait_for(ticket);
 
   /* There is a shared or exclusive lock on the object. */
@@ -2581,6 +3038,7 @@ MDL_context::upgrade_shared_lock(MDL_ticket *mdl_ticket,
   mdl_ticket->m_lock->m_granted.remove_ticket(mdl_ticket);
   mdl_ticket->m_type= new_type;
   mdl_ticket->m_lock->m_granted.add_ticket(mdl_ticket);
+  mdl_ticket->m_lock->update_fast_path_flags();
 
   mysql_prlock_unlock(&mdl_ticket->m_lock->m_rwlock);
 
@@ -2858,7 +3316,14 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 
   DBUG_ASSERT(this == ticket->get_ctx());
 
-  lock->remove_ticket(&MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+  {
+    remove_fast_path_ticket(ticket);
+    lock->fast_path_release(
+      lock->unobtrusive_lock_increment()[ticket->get_type()]);
+  }
+  else
+    lock->remove_ticket(&MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2971,6 +3436,7 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->update_fast_path_flags();
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
 }
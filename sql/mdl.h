@@ -582,6 +582,8 @@ public:
   /**
     Pointers for participating in the list of satisfied/pending requests
     for the lock. Externally accessible.
+    Tickets granted using the fast path are in no such list, and use these
+    pointers for MDL_context::m_fast_path_tickets instead.
   */
   MDL_ticket *next_in_lock;
   MDL_ticket **prev_in_lock;
@@ -622,7 +624,8 @@ private:
      m_duration(duration_arg),
 #endif
      m_ctx(ctx_arg),
-     m_lock(NULL)
+     m_lock(NULL),
+     m_is_fast_path(false)
   {}
 
   static MDL_ticket *create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -651,6 +654,13 @@ private:
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the lock was granted using the fast path, i.e. it is only
+    counted in MDL_lock::m_fast_path_state and is not in the list of
+    granted tickets for the lock. Context private.
+  */
+  bool m_is_fast_path;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -745,6 +755,12 @@ public:
 
   typedef Ticket_list::Iterator Ticket_iterator;
 
+  typedef I_P_List<MDL_ticket,
+                   I_P_List_adapter<MDL_ticket,
+                                    &MDL_ticket::next_in_lock,
+                                    &MDL_ticket::prev_in_lock> >
+          Fast_path_ticket_list;
+
   MDL_context();
   void destroy();
 
@@ -814,11 +830,32 @@ public:
             will see the new value eventually.
     */
     m_needs_thr_lock_abort= needs_thr_lock_abort;
+
+    /*
+      Conflicting lock requests must be able to find the locks of
+      such a context in order to abort its waits for table-level locks.
+    */
+    if (m_needs_thr_lock_abort)
+      materialize_fast_path_locks();
   }
   bool get_needs_thr_lock_abort() const
   {
     return m_needs_thr_lock_abort;
   }
+
+  /**
+    Never use the fast path for locks of this context. Used for contexts
+    that must be notified by conflicting lock requests in other ways than
+    by aborting their waits for table-level locks.
+    @sa THD::notify_shared_lock()
+  */
+  void disable_fast_path()
+  {
+    m_fast_path_disabled= true;
+    materialize_fast_path_locks();
+  }
+
+  void materialize_fast_path_locks();
 public:
   /**
     If our request for a lock is scheduled, or aborted by the deadlock
@@ -892,6 +929,16 @@ private:
     FALSE - Otherwise.
   */
   bool m_needs_thr_lock_abort;
+  /** TRUE if disable_fast_path() was called for this context. */
+  bool m_fast_path_disabled;
+
+  /**
+    Tickets of this context that were granted using the fast path.
+    Unlike m_tickets, this list is accessed by other threads (see
+    mdl_iterate()), so it is protected by m_LOCK_fast_path.
+  */
+  Fast_path_ticket_list m_fast_path_tickets;
+  mysql_mutex_t m_LOCK_fast_path;
 
   /**
     Read-write lock protecting m_waiting_for member.
@@ -917,6 +964,12 @@ private:
   void release_lock(enum_mdl_duration duration, MDL_ticket *ticket);
   bool try_acquire_lock_impl(MDL_request *mdl_request,
                              MDL_ticket **out_ticket);
+  bool fast_path_allowed() const
+  {
+    return !m_needs_thr_lock_abort && !m_fast_path_disabled;
+  }
+  void add_fast_path_ticket(MDL_ticket *ticket);
+  void remove_fast_path_ticket(MDL_ticket *ticket);
 
 public:
   void find_deadlock();
@@ -925,9 +978,15 @@ public:
 
   bool visit_subgraph(MDL_wait_for_graph_visitor *dvisitor);
 
-  /** Inform the deadlock detector there is an edge in the wait-for graph. */
+  /**
+    Inform the deadlock detector there is an edge in the wait-for graph.
+
+    @pre Locks granted using the fast path are invisible to the deadlock
+         detector, so they must have been materialized.
+  */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    DBUG_ASSERT(m_fast_path_tickets.is_empty());
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
@@ -954,6 +1013,7 @@ private:
 
   /* metadata_lock_info plugin */
   friend int i_s_metadata_lock_info_fill_row(MDL_ticket*, void*);
+  friend int mdl_iterate(int (*)(MDL_ticket *, void *), void *);
 };
 
 
@@ -0,0 +1,356 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+    Caching of the plans of the selects of prepared statements
+*/
+
+#include "sql_priv.h"
+#include "sql_select.h"
+#include "opt_plan_cache.h"
+
+
+/*
+  Check whether the plan of a join can be cached
+
+  SYNOPSIS
+    Join_plan_cache::is_applicable()
+      join    The join being optimized
+      stat    The array of JOIN_TABs of the join
+
+  DESCRIPTION
+    Only the plans of the joins of base tables chosen in executions of
+    prepared statements are cached. The statements of stored routines,
+    including the prepared ones, have no cache. Semi-join strategies depend
+    on more state than the cache keeps, so joins with semi-join nests are
+    not cached either.
+*/
+
+bool Join_plan_cache::is_applicable(JOIN *join, JOIN_TAB *stat)
+{
+  THD *thd= join->thd;
+  if (!thd->variables.prepared_plan_cache ||
+      thd->stmt_arena == thd || !thd->stmt_arena->is_stmt_execute() ||
+      thd->spcont ||
+      join->select_lex->sj_nests.elements || join->emb_sjm_nest)
+    return FALSE;
+  for (JOIN_TAB *tab= stat; tab < stat + join->table_count; tab++)
+  {
+    TABLE *table= tab->table;
+    TABLE_LIST *tbl= table->pos_in_table_list;
+    if (table->s->tmp_table != NO_TMP_TABLE ||
+        table->is_filled_at_execution() || table->fulltext_searched ||
+        tbl->derived || tbl->schema_table || tbl->jtbm_subselect)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Check whether the tables of a join are still the ones the plan was cached
+  for
+
+  DESCRIPTION
+    The function must be called after the constant tables have been read
+    and before the range analysis.
+*/
+
+bool Join_plan_cache::is_valid(JOIN *join, JOIN_TAB *stat)
+{
+  if (table_count != join->table_count ||
+      const_tables != join->const_tables ||
+      const_table_map != join->const_table_map)
+    return FALSE;
+
+  for (uint i= 0; i < table_count; i++)
+  {
+    TABLE *table= stat[i].table;
+    ha_rows records= table->stat_records();
+    if (tables[i].ref_version != table->s->get_table_ref_version() ||
+        records >= tables[i].records * 2 || records * 2 <= tables[i].records)
+      return FALSE;
+  }
+
+  for (uint i= 0; i < table_count - const_tables; i++)
+  {
+    Table_position *pos= order + i;
+    JOIN_TAB *tab= stat + pos->tab_idx;
+    if (pos->keyuse_offset < 0)
+      continue;
+    /* The ref access must still be possible */
+    KEYUSE *keyuse= tab->keyuse;
+    KEYUSE *keyuse_end= (KEYUSE *) join->keyuse.buffer + join->keyuse.elements;
+    if (!keyuse || keyuse + pos->keyuse_offset >= keyuse_end)
+      return FALSE;
+    keyuse+= pos->keyuse_offset;
+    if (keyuse->table != tab->table || keyuse->key != pos->key)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Get the plan cached for a join if it may still be used
+
+  SYNOPSIS
+    Join_plan_cache::get()
+      join    The join being optimized
+      stat    The array of JOIN_TABs of the join
+
+  DESCRIPTION
+    The function is called by make_join_statistics() after the constant
+    tables have been read. If the cached plan may be used the caller
+    analyzes only the ranges returned by get_range_keys() and checks them
+    with check_range_estimate() before it calls restore().
+
+  RETURN
+    The cached plan
+    NULL if there is no plan cached for the join or it cannot be used
+*/
+
+Join_plan_cache *Join_plan_cache::get(JOIN *join, JOIN_TAB *stat)
+{
+  Join_plan_cache *plan_cache= join->select_lex->plan_cache;
+  if (!plan_cache || !is_applicable(join, stat) ||
+      join->const_tables == join->table_count)
+    return NULL;
+  if (!plan_cache->is_valid(join, stat))
+  {
+    join->thd->status_var.prepared_plan_cache_replans++;
+    return NULL;
+  }
+  return plan_cache;
+}
+
+
+/*
+  Get the indexes to analyze the ranges over for a table of the cached plan
+
+  SYNOPSIS
+    Join_plan_cache::get_range_keys()
+      tab_idx        Number of the JOIN_TAB of the table in the join
+      keys    IN     The indexes the ranges could be analyzed over
+              OUT    The indexes the ranges must be analyzed over
+*/
+
+void Join_plan_cache::get_range_keys(uint tab_idx, key_map *keys)
+{
+  uint key= tables[tab_idx].range_key;
+  if (key != MAX_KEY && keys->is_set(key))
+  {
+    keys->clear_all();
+    keys->set_bit(key);
+  }
+  else
+    keys->clear_all();
+}
+
+
+/*
+  Check that the parameters fall into the selectivity class of the plan
+
+  SYNOPSIS
+    Join_plan_cache::check_range_estimate()
+      join              The join being optimized
+      tab_idx           Number of the JOIN_TAB of the table in the join
+      table             The table
+      impossible_range  TRUE <=> the condition on the table is unsatisfiable
+
+  DESCRIPTION
+    The function is called after the ranges returned by get_range_keys()
+    have been analyzed for the table.
+
+  RETURN
+    TRUE   The cached plan may still be used
+    FALSE  The join must be optimized from scratch
+*/
+
+bool Join_plan_cache::check_range_estimate(JOIN *join, uint tab_idx,
+                                           TABLE *table,
+                                           bool impossible_range)
+{
+  Table_state *state= tables + tab_idx;
+  ha_rows rows, cached_rows;
+  if (impossible_range)
+    goto replan;
+  if (state->range_key == MAX_KEY)
+    return TRUE;
+  if (!table->quick_keys.is_set(state->range_key))
+    goto replan;
+  rows= table->quick_rows[state->range_key] + 1;
+  cached_rows= state->range_rows + 1;
+  if (rows < cached_rows * PLAN_CACHE_SELECTIVITY_RATIO &&
+      cached_rows < rows * PLAN_CACHE_SELECTIVITY_RATIO)
+    return TRUE;
+
+replan:
+  join->thd->status_var.prepared_plan_cache_replans++;
+  return FALSE;
+}
+
+
+/*
+  Set the plan of a join from the cache
+
+  SYNOPSIS
+    Join_plan_cache::restore()
+      join    The join being optimized
+      stat    The array of JOIN_TABs of the join
+
+  DESCRIPTION
+    The function is called by make_join_statistics() instead of
+    choose_plan(). It fills join->best_positions as choose_plan() would
+    do for the cached join order.
+*/
+
+void Join_plan_cache::restore(JOIN *join, JOIN_TAB *stat)
+{
+  THD *thd= join->thd;
+  DBUG_ENTER("Join_plan_cache::restore");
+
+  join->cur_embedding_map= 0;
+  join->cur_dups_producing_tables= 0;
+  join->cur_sj_inner_tables= 0;
+
+  memcpy((uchar*) join->best_positions, (uchar*) join->positions,
+         sizeof(POSITION)*const_tables);
+  for (uint i= 0; i < table_count - const_tables; i++)
+  {
+    Table_position *pos= order + i;
+    JOIN_TAB *tab= stat + pos->tab_idx;
+    POSITION *position= join->best_positions + const_tables + i;
+    memcpy((uchar*) position, (uchar*) (positions + i), sizeof(POSITION));
+    position->table= tab;
+    position->key= pos->keyuse_offset < 0 ? NULL :
+                   tab->keyuse + pos->keyuse_offset;
+    tab->needed_reg= tables[pos->tab_idx].needed_reg;
+  }
+  memcpy((uchar*) join->positions, (uchar*) join->best_positions,
+         sizeof(POSITION)*table_count);
+  join->best_read= best_read;
+  join->record_count= record_count;
+
+  if (thd->lex->is_single_level_stmt())
+    thd->status_var.last_query_cost= join->best_read;
+  thd->status_var.prepared_plan_cache_hits++;
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Save the plan chosen for a join in the cache
+
+  SYNOPSIS
+    Join_plan_cache::save()
+      join                   The join the plan has been chosen for
+      stat                   The array of JOIN_TABs of the join
+      range_const_table_map  The constant tables before the range analysis
+
+  DESCRIPTION
+    The function is called by make_join_statistics() after choose_plan().
+    Plans that depend on constant tables found by the range analysis or
+    that use other quick selects than range scans are not cached. The
+    cache is allocated on the memory of the prepared statement once and is
+    overwritten by the subsequent saves.
+*/
+
+void Join_plan_cache::save(JOIN *join, JOIN_TAB *stat,
+                           table_map range_const_table_map)
+{
+  Join_plan_cache *plan_cache= join->select_lex->plan_cache;
+  uint count= join->table_count;
+  uint const_count= join->const_tables;
+  DBUG_ENTER("Join_plan_cache::save");
+
+  if (!is_applicable(join, stat) ||
+      join->const_table_map != range_const_table_map)
+    DBUG_VOID_RETURN;
+
+  for (uint i= const_count; i < count; i++)
+  {
+    POSITION *position= join->best_positions + i;
+    JOIN_TAB *tab= position->table;
+    if (position->sj_strategy != SJ_OPT_NONE ||
+        (!position->key && tab->quick &&
+         tab->quick->get_type() != QUICK_SELECT_I::QS_TYPE_RANGE))
+      DBUG_VOID_RETURN;
+  }
+
+  if (!plan_cache || plan_cache->table_count != count)
+  {
+    MEM_ROOT *mem_root= join->thd->stmt_arena->mem_root;
+    if (!(plan_cache= new (mem_root) Join_plan_cache) ||
+        !multi_alloc_root(mem_root,
+                          &plan_cache->tables, sizeof(Table_state) * count,
+                          &plan_cache->order, sizeof(Table_position) * count,
+                          &plan_cache->positions, sizeof(POSITION) * count,
+                          NullS))
+      DBUG_VOID_RETURN;
+    plan_cache->table_count= count;
+    join->select_lex->plan_cache= plan_cache;
+  }
+
+  plan_cache->const_tables= const_count;
+  plan_cache->const_table_map= join->const_table_map;
+  plan_cache->best_read= join->best_read;
+  plan_cache->record_count= join->record_count;
+
+  for (uint i= 0; i < count; i++)
+  {
+    Table_state *state= plan_cache->tables + i;
+    TABLE *table= stat[i].table;
+    state->ref_version= table->s->get_table_ref_version();
+    state->records= table->stat_records();
+    state->range_key= MAX_KEY;
+    state->range_rows= 0;
+    state->needed_reg= stat[i].needed_reg;
+  }
+
+  for (uint i= const_count; i < count; i++)
+  {
+    POSITION *position= join->best_positions + i;
+    JOIN_TAB *tab= position->table;
+    TABLE *table= tab->table;
+    Table_position *pos= plan_cache->order + (i - const_count);
+    Table_state *state= plan_cache->tables + (tab - stat);
+    pos->tab_idx= (uint) (tab - stat);
+    if (position->key)
+    {
+      pos->keyuse_offset= (int) (position->key - tab->keyuse);
+      pos->key= position->key->key;
+      /* The rows of a ref access over constants are estimated by a range */
+      if (pos->key < MAX_KEY && table->quick_keys.is_set(pos->key))
+        state->range_key= pos->key;
+    }
+    else
+    {
+      pos->keyuse_offset= -1;
+      pos->key= MAX_KEY;
+      if (tab->quick)
+        state->range_key= tab->quick->index;
+    }
+    if (state->range_key != MAX_KEY)
+      state->range_rows= table->quick_rows[state->range_key];
+    memcpy((uchar*) (plan_cache->positions + i - const_count),
+           (uchar*) position, sizeof(POSITION));
+  }
+  DBUG_VOID_RETURN;
+}
@@ -0,0 +1,108 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef OPT_PLAN_CACHE_INCLUDED
+#define OPT_PLAN_CACHE_INCLUDED
+
+#include "sql_list.h"                           /* Sql_alloc */
+
+class JOIN;
+struct st_join_table;
+struct st_position;
+struct TABLE;
+
+/*
+  The estimates of the numbers of rows in the ranges the cached plan reads
+  a table by must differ less than this number of times from the estimates
+  the plan was chosen for.
+*/
+#define PLAN_CACHE_SELECTIVITY_RATIO 4
+
+/*
+  The plan of a join cached in a prepared statement
+
+  When prepared_plan_cache is set the join order and the access methods
+  chosen by make_join_statistics() for a select of a prepared statement are
+  saved in the select (st_select_lex::plan_cache) and reused by the
+  subsequent executions of the statement as long as
+  - the definitions of the tables are the same and the numbers of rows in
+    the tables changed less than twice,
+  - the same tables are found to be constant,
+  - the values of the parameters fall into the same selectivity class:
+    for every index the plan reads a table by with a range or with a ref
+    access over constants the estimate of the number of rows in the range
+    differs less than PLAN_CACHE_SELECTIVITY_RATIO times from the one the
+    plan was chosen for.
+  For the cached plan only the ranges over these indexes are analyzed and
+  the search for the join order is skipped. When the plan cannot be used
+  the join is optimized from scratch and the new plan replaces the cached
+  one.
+
+  Changes of the definitions of the tables, including the ones made by
+  ANALYZE TABLE ... PERSISTENT, also cause the prepared statement to be
+  reprepared, which drops all plans cached for it.
+*/
+
+class Join_plan_cache :public Sql_alloc
+{
+public:
+  static Join_plan_cache *get(JOIN *join, st_join_table *stat);
+  static void save(JOIN *join, st_join_table *stat,
+                   table_map range_const_table_map);
+
+  void get_range_keys(uint tab_idx, key_map *keys);
+  bool check_range_estimate(JOIN *join, uint tab_idx, TABLE *table,
+                            bool impossible_range);
+  void restore(JOIN *join, st_join_table *stat);
+
+private:
+  /* What the cached plan depends on for each table of the join */
+  struct Table_state
+  {
+    ulong ref_version;          /* TABLE_SHARE::get_table_ref_version() */
+    ha_rows records;            /* TABLE::stat_records() */
+    /*
+      The index the plan reads the table by with a range or with a ref
+      access over constants, MAX_KEY if there is none
+    */
+    uint range_key;
+    ha_rows range_rows;         /* Estimate of the rows in the range */
+    key_map needed_reg;         /* JOIN_TAB::needed_reg */
+  };
+
+  /* The position of a table in the cached join order */
+  struct Table_position
+  {
+    uint tab_idx;               /* Number of the JOIN_TAB in the join */
+    /* Offset of POSITION::key from JOIN_TAB::keyuse, -1 if no ref access */
+    int keyuse_offset;
+    uint key;                   /* KEYUSE::key of POSITION::key */
+  };
+
+  uint table_count;
+  uint const_tables;
+  table_map const_table_map;
+  Table_state *tables;
+  Table_position *order;
+  st_position *positions;       /* The non-constant part of best_positions */
+  double best_read;
+  double record_count;
+
+  static bool is_applicable(JOIN *join, st_join_table *stat);
+  bool is_valid(JOIN *join, st_join_table *stat);
+};
+
+#endif /* OPT_PLAN_CACHE_INCLUDED */
@@ -41,6 +41,7 @@ static int rr_unpack_from_buffer(READ_RECORD *info);
 static int rr_from_pointers(READ_RECORD *info);
 static int rr_from_cache(READ_RECORD *info);
 static int init_rr_cache(THD *thd, READ_RECORD *info);
+static int rr_sequential_batch(READ_RECORD *info);
 static int rr_cmp(uchar *a,uchar *b);
 static int rr_index_first(READ_RECORD *info);
 static int rr_index_last(READ_RECORD *info);
@@ -148,6 +149,8 @@ void init_read_record_idx(READ_RECORD *info, THD *thd, TABLE *table,
       Same as rr_unpack_from_buffer except that references are fetched from
       temporary file. Should obviously not really happen other than in
       strange configurations.
+      With table->sort.using_packed_addons the addon fields of each record
+      are preceded by their length, ref_length is the maximum length.
 
     rr_from_tempfile:
     -----------------
@@ -265,8 +268,11 @@ bool init_read_record(READ_RECORD *info,THD *thd, TABLE *table,
     if (table->file->ha_rnd_init_with_error(0))
       DBUG_RETURN(1);
     info->cache_pos=table->sort.record_pointers;
-    info->cache_end=info->cache_pos+ 
-                    table->sort.found_records*info->ref_length;
+    if (table->sort.addon_field && table->sort.using_packed_addons)
+      info->cache_end= table->sort.record_pointers_end;
+    else
+      info->cache_end=info->cache_pos+ 
+                      table->sort.found_records*info->ref_length;
     info->read_record= (table->sort.addon_field ?
                         rr_unpack_from_buffer : rr_from_pointers);
   }
@@ -315,6 +321,85 @@ void end_read_record(READ_RECORD *info)
   }
 }
 
+/**
+  Switch a table scan to reading in blocks of records
+
+  @param info          READ_RECORD structure initialized for rr_sequential
+  @param cond          Condition to evaluate over the blocks of records
+  @param skipped_rows  Counter to increment by the number of the records
+                       removed by the condition, or NULL
+
+  @details
+    The records are read in blocks of up to BATCH_COND_MAX_ROWS records
+    that fit into read_buff_size. The condition is evaluated over a whole
+    block, and only the records that pass it are returned one by one in
+    table->record[0]. As the handler is positioned after the last record
+    of the block the caller must not need the position of the current
+    record or lock it: this is only used for the tables read by SELECT.
+    Tables with BLOBs, whose values are kept by the handler only for the
+    last record read, and tables with virtual columns are not supported.
+
+  @retval
+    FALSE  the table is read in blocks
+  @retval
+    TRUE   the table is read record by record
+*/
+
+bool init_read_record_batch(READ_RECORD *info, Batch_cond *cond,
+                            ha_rows *skipped_rows)
+{
+  TABLE *table= info->table;
+  uint reclength= ALIGN_SIZE(table->s->reclength);
+  uint size, i;
+  uchar *pos;
+  DBUG_ENTER("init_read_record_batch");
+
+  if (info->read_record != rr_sequential ||
+      table->s->blob_fields || table->vfield)
+    DBUG_RETURN(TRUE);
+  size= (uint) MY_MIN(info->thd->variables.read_buff_size / reclength,
+                      BATCH_COND_MAX_ROWS);
+  if (size < BATCH_COND_MIN_ROWS ||
+      !(info->cache= (uchar*) my_malloc_lock(size * (reclength +
+                                                     sizeof(uchar*) +
+                                                     sizeof(uint)),
+                                             MYF(MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(TRUE);
+  info->batch_rows= (uchar**) (info->cache + size * reclength);
+  info->batch_sel= (uint*) (info->batch_rows + size);
+  for (i= 0, pos= info->cache; i < size; i++, pos+= reclength)
+    info->batch_rows[i]= pos;
+  info->batch_size= size;
+  info->batch_count= info->batch_pos= 0;
+  info->batch_error= 0;
+  info->batch_cond= cond;
+  info->batch_skipped_rows= skipped_rows;
+  info->read_record= rr_sequential_batch;
+  cond->bind();
+  DBUG_PRINT("info",("using rr_sequential_batch with %u records", size));
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Free the block of records of a scan switched by init_read_record_batch()
+
+  @note
+    init_read_record() does not free the buffers of the previous scan
+    that used the same structure, so this is to be called before a table
+    is rescanned.
+*/
+
+void end_read_record_batch(READ_RECORD *info)
+{
+  if (info->read_record == rr_sequential_batch && info->cache)
+  {
+    my_free_lock(info->cache);
+    info->cache= 0;
+  }
+}
+
+
 static int rr_handle_error(READ_RECORD *info, int error)
 {
   if (info->thd->killed)
@@ -480,6 +565,52 @@ int rr_sequential(READ_RECORD *info)
 }
 
 
+/**
+  Read the next record of a table scan in blocks of records
+
+  The next block is read when all records of the current one that passed
+  the condition have been returned. An error or the end of the table met
+  while reading a block is returned after the records of the block.
+*/
+
+static int rr_sequential_batch(READ_RECORD *info)
+{
+  TABLE *table= info->table;
+  while (info->batch_pos == info->batch_count)
+  {
+    uint count= 0;
+    int tmp= 0;
+    if (info->batch_error)
+      return info->batch_error;
+    while (count < info->batch_size)
+    {
+      if ((tmp= table->file->ha_rnd_next(info->record)))
+      {
+        /* See rr_sequential() */
+        if (info->thd->killed || tmp != HA_ERR_RECORD_DELETED)
+          break;
+        continue;
+      }
+      memcpy(info->batch_rows[count], info->record, table->s->reclength);
+      info->batch_sel[count]= count;
+      count++;
+    }
+    if (tmp)
+      info->batch_error= rr_handle_error(info, tmp);
+    info->batch_count= info->batch_cond->filter(info->batch_rows,
+                                                info->batch_sel, count);
+    info->batch_pos= 0;
+    if (info->batch_skipped_rows)
+      *info->batch_skipped_rows+= count - info->batch_count;
+    for (uint i= info->batch_count; i < count; i++)
+      info->thd->get_stmt_da()->inc_current_row_for_warning();
+  }
+  memcpy(info->record, info->batch_rows[info->batch_sel[info->batch_pos++]],
+         table->s->reclength);
+  return 0;
+}
+
+
 static int rr_from_tempfile(READ_RECORD *info)
 {
   int tmp;
@@ -518,11 +649,21 @@ static int rr_from_tempfile(READ_RECORD *info)
 
 static int rr_unpack_from_tempfile(READ_RECORD *info)
 {
-  if (my_b_read(info->io_cache, info->rec_buf, info->ref_length))
-    return -1;
   TABLE *table= info->table;
+  uint length= info->ref_length;
+  if (table->sort.using_packed_addons)
+  {
+    if (my_b_read(info->io_cache, info->rec_buf, 2))
+      return -1;
+    length= uint2korr(info->rec_buf);
+    if (length < 2 || length > info->ref_length ||
+        my_b_read(info->io_cache, info->rec_buf + 2, length - 2))
+      return -1;
+  }
+  else if (my_b_read(info->io_cache, info->rec_buf, length))
+    return -1;
   (*table->sort.unpack)(table->sort.addon_field, info->rec_buf,
-                        info->rec_buf + info->ref_length);
+                        info->rec_buf + length);
 
   return 0;
 }
@@ -575,7 +716,10 @@ static int rr_unpack_from_buffer(READ_RECORD *info)
   TABLE *table= info->table;
   (*table->sort.unpack)(table->sort.addon_field, info->cache_pos,
                         info->cache_end);
-  info->cache_pos+= info->ref_length;
+  if (table->sort.using_packed_addons)
+    info->cache_pos+= uint2korr(info->cache_pos);
+  else
+    info->cache_pos+= info->ref_length;
 
   return 0;
 }
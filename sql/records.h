@@ -19,6 +19,7 @@
 #pragma interface                      /* gcc class implementation */
 #endif
 #include <my_global.h>                /* for uint typedefs */
+#include "my_base.h"                   /* ha_rows */
 
 struct st_join_table;
 class handler;
@@ -26,6 +27,7 @@ struct TABLE;
 class THD;
 class SQL_SELECT;
 class Copy_field;
+class Batch_cond;
 
 /**
   A context for reading through a single table using a chosen access method:
@@ -70,6 +72,17 @@ struct READ_RECORD
   */
   Copy_field *copy_field;
   Copy_field *copy_field_end;
+
+  /*
+    Table scan in blocks of records with the evaluation of a condition
+    over the blocks, see rr_sequential_batch()
+  */
+  Batch_cond *batch_cond;
+  uchar **batch_rows;                  /* records of the current block */
+  uint *batch_sel;                     /* records that passed batch_cond */
+  uint batch_size, batch_count, batch_pos;
+  int batch_error;                     /* error ending the current block */
+  ha_rows *batch_skipped_rows;         /* counter of the skipped records */
 public:
   READ_RECORD() {}
 };
@@ -80,6 +93,9 @@ bool init_read_record(READ_RECORD *info, THD *thd, TABLE *reg_form,
 void init_read_record_idx(READ_RECORD *info, THD *thd, TABLE *table,
                           bool print_error, uint idx, bool reverse);
 void end_read_record(READ_RECORD *info);
+bool init_read_record_batch(READ_RECORD *info, Batch_cond *cond,
+                            ha_rows *skipped_rows);
+void end_read_record_batch(READ_RECORD *info);
 
 void rr_unlock_row(st_join_table *tab);
 
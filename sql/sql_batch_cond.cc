@@ -0,0 +1,627 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+  Evaluation of conditions over blocks of records, see sql_batch_cond.h
+*/
+
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_batch_cond.h"
+#include "sql_time.h"                           /* str_to_datetime */
+
+/*
+  The bound of the absolute values of integer expressions: a value of an
+  expression whose bounds exceed it could overflow longlong.
+*/
+#define BATCH_EXPR_MAX_VALUE 9.0e18
+
+static Batch_cmp::Op mirror_op(Batch_cmp::Op op)
+{
+  switch (op) {
+  case Batch_cmp::LT: return Batch_cmp::GT;
+  case Batch_cmp::LE: return Batch_cmp::GE;
+  case Batch_cmp::GT: return Batch_cmp::LT;
+  case Batch_cmp::GE: return Batch_cmp::LE;
+  default:            return op;
+  }
+}
+
+
+static inline bool is_batch_const(Item *item)
+{
+  /*
+    Only the literals are evaluated in advance: the evaluation of other
+    constant expressions could raise errors that the original condition
+    would not raise for an empty table.
+  */
+  return item->basic_const_item();
+}
+
+
+/*
+  Return the field of the table if the item is a column of it
+*/
+
+static Field *batch_field(TABLE *table, Item *item)
+{
+  if (item->type() != Item::FIELD_ITEM)
+    return NULL;
+  Field *field= ((Item_field*) item)->field;
+  return field->table == table ? field : NULL;
+}
+
+
+Batch_expr *make_batch_expr(TABLE *table, Item *item, Batch_expr::Kind kind)
+{
+  if (is_batch_const(item))
+  {
+    Item_result type= item->cmp_type();
+    if (kind == Batch_expr::INT_KIND ? type != INT_RESULT :
+        type != TIME_RESULT && type != STRING_RESULT)
+      return NULL;
+    return new Batch_const(item, kind);
+  }
+  return item->get_batch_expr(table, kind);
+}
+
+
+Batch_cond *make_batch_cmp(TABLE *table, Batch_cmp::Op op, Item *a, Item *b)
+{
+  Field *field;
+  if (is_batch_const(a) && !is_batch_const(b))
+  {
+    swap_variables(Item*, a, b);
+    op= mirror_op(op);
+  }
+  if (is_batch_const(a))
+    return NULL;                                /* Constant condition */
+
+  switch (item_cmp_type(a->cmp_type(), b->cmp_type())) {
+  case INT_RESULT:
+  {
+    Batch_expr *expr_a, *expr_b;
+    Batch_cmp *cmp;
+    if (!(expr_a= make_batch_expr(table, a, Batch_expr::INT_KIND)) ||
+        !(expr_b= make_batch_expr(table, b, Batch_expr::INT_KIND)) ||
+        !(cmp= new Batch_cmp(op, expr_a, expr_b)) || cmp->init())
+      return NULL;
+    return cmp;
+  }
+  case TIME_RESULT:
+  {
+    Batch_expr *expr_a, *expr_b;
+    Batch_cmp *cmp;
+    if (!batch_field(table, a) || !is_batch_const(b) ||
+        !(expr_a= make_batch_expr(table, a, Batch_expr::DATE_KIND)) ||
+        !(expr_b= make_batch_expr(table, b, Batch_expr::DATE_KIND)) ||
+        !(cmp= new Batch_cmp(op, expr_a, expr_b)) || cmp->init())
+      return NULL;
+    return cmp;
+  }
+  case DECIMAL_RESULT:
+  {
+    Batch_decimal_cmp *cmp;
+    if (!(field= batch_field(table, a)) ||
+        field->real_type() != MYSQL_TYPE_NEWDECIMAL || !is_batch_const(b) ||
+        (b->cmp_type() != INT_RESULT && b->cmp_type() != DECIMAL_RESULT) ||
+        !(cmp= new Batch_decimal_cmp(op, (Field_new_decimal*) field, b)) ||
+        cmp->init())
+      return NULL;
+    return cmp;
+  }
+  default:
+    return NULL;
+  }
+}
+
+
+Batch_expr *make_batch_arith(TABLE *table, Batch_arith::Op op,
+                             Item_func *func)
+{
+  Batch_expr *a, *b;
+  Batch_arith *arith;
+  /* Unsigned results and overflows are checked by the functions */
+  if (func->result_type() != INT_RESULT || func->unsigned_flag ||
+      !(a= make_batch_expr(table, func->arguments()[0],
+                           Batch_expr::INT_KIND)) ||
+      !(b= make_batch_expr(table, func->arguments()[1],
+                           Batch_expr::INT_KIND)) ||
+      !(arith= new Batch_arith(op, a, b)) || arith->init())
+    return NULL;
+  return arith;
+}
+
+
+/*
+  Conjunction
+*/
+
+bool Batch_cond_and::bind()
+{
+  List_iterator<Batch_cond> it(list);
+  Batch_cond *cond;
+  bool res;
+  bound_count= 0;
+  while ((cond= it++))
+  {
+    res= cond->bind();
+    /* An unbound conjunct keeps all records, the next ones are not used */
+    bound_count++;
+    if (!res)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+uint Batch_cond_and::filter(uchar **rows, uint *sel, uint n)
+{
+  List_iterator<Batch_cond> it(list);
+  Batch_cond *cond;
+  for (uint i= 0; n && i < bound_count && (cond= it++); i++)
+    n= cond->filter(rows, sel, n);
+  return n;
+}
+
+
+/*
+  Disjunction
+
+  Each disjunct is evaluated over the records that have not passed the
+  previous disjuncts.
+*/
+
+Batch_cond_or::Batch_cond_or(List<Batch_cond> &list_arg)
+  :list(list_arg), bound(FALSE)
+{
+  List_iterator<Batch_cond> it(list);
+  Batch_cond *cond;
+  while ((cond= it++))
+    complete&= cond->complete;
+}
+
+
+bool Batch_cond_or::init()
+{
+  return !(rest= (uint*) sql_alloc(sizeof(uint) * BATCH_COND_MAX_ROWS)) ||
+         !(work= (uint*) sql_alloc(sizeof(uint) * BATCH_COND_MAX_ROWS)) ||
+         !(passed= (bool*) sql_alloc(sizeof(bool) * BATCH_COND_MAX_ROWS));
+}
+
+
+bool Batch_cond_or::bind()
+{
+  List_iterator<Batch_cond> it(list);
+  Batch_cond *cond;
+  bound= TRUE;
+  while ((cond= it++))
+    bound&= cond->bind();
+  return bound;
+}
+
+
+uint Batch_cond_or::filter(uchar **rows, uint *sel, uint n)
+{
+  List_iterator<Batch_cond> it(list);
+  Batch_cond *cond;
+  uint rest_count= n;
+  uint i, k;
+
+  if (!bound)
+    return n;
+  memcpy(rest, sel, sizeof(uint) * n);
+  for (i= 0; i < n; i++)
+    passed[sel[i]]= FALSE;
+  while (rest_count && (cond= it++))
+  {
+    memcpy(work, rest, sizeof(uint) * rest_count);
+    uint count= cond->filter(rows, work, rest_count);
+    for (i= 0; i < count; i++)
+      passed[work[i]]= TRUE;
+    for (i= k= 0; i < rest_count; i++)
+    {
+      if (!passed[rest[i]])
+        rest[k++]= rest[i];
+    }
+    rest_count= k;
+  }
+  for (i= k= 0; i < n; i++)
+  {
+    if (passed[sel[i]])
+      sel[k++]= sel[i];
+  }
+  return k;
+}
+
+
+/*
+  Comparison of integer and date expressions
+*/
+
+bool Batch_cmp::init()
+{
+  return !(values_a= (longlong*) sql_alloc(sizeof(longlong) *
+                                           BATCH_COND_MAX_ROWS)) ||
+         !(values_b= (longlong*) sql_alloc(sizeof(longlong) *
+                                           BATCH_COND_MAX_ROWS)) ||
+         !(nulls_a= (bool*) sql_alloc(sizeof(bool) * BATCH_COND_MAX_ROWS)) ||
+         !(nulls_b= (bool*) sql_alloc(sizeof(bool) * BATCH_COND_MAX_ROWS));
+}
+
+
+#define BATCH_CMP_LOOP(CMP)                                             \
+  for (i= 0; i < n; i++)                                                \
+  {                                                                     \
+    if (!nulls_a[i] && !nulls_b[i] && values_a[i] CMP values_b[i])      \
+      sel[k++]= sel[i];                                                 \
+  }
+
+uint Batch_cmp::filter(uchar **rows, uint *sel, uint n)
+{
+  uint i, k= 0;
+  if (!bound)
+    return n;
+  a->val(rows, sel, n, values_a, nulls_a);
+  b->val(rows, sel, n, values_b, nulls_b);
+  switch (op) {
+  case EQ: BATCH_CMP_LOOP(==); break;
+  case NE: BATCH_CMP_LOOP(!=); break;
+  case LT: BATCH_CMP_LOOP(<);  break;
+  case LE: BATCH_CMP_LOOP(<=); break;
+  case GT: BATCH_CMP_LOOP(>);  break;
+  case GE: BATCH_CMP_LOOP(>=); break;
+  }
+  return k;
+}
+
+
+/*
+  Comparison of a DECIMAL column with a constant
+*/
+
+Batch_decimal_cmp::Batch_decimal_cmp(Batch_cmp::Op op_arg,
+                                     Field_new_decimal *field,
+                                     Item *value_arg)
+  :op(op_arg), value(value_arg), bound(FALSE), null_value(FALSE)
+{
+  uchar *record= field->table->record[0];
+  offset= (uint) (field->ptr - record);
+  null_offset= field->null_ptr ? (uint) (field->null_ptr - record) : 0;
+  null_bit= field->null_ptr ? field->null_bit : 0;
+  precision= field->precision;
+  scale= field->decimals();
+  bin_size= field->bin_size;
+}
+
+
+bool Batch_decimal_cmp::init()
+{
+  return !(bin_value= (uchar*) sql_alloc(bin_size));
+}
+
+
+bool Batch_decimal_cmp::bind()
+{
+  my_decimal buff, *dec= value->val_decimal(&buff);
+  bound= TRUE;
+  if ((null_value= value->null_value || !dec))
+    return bound;
+  /* The constant must be representable in the format of the column */
+  bound= my_decimal2binary(0, dec, bin_value, precision, scale) == E_DEC_OK;
+  return bound;
+}
+
+
+#define BATCH_DECIMAL_CMP_LOOP(CMP)                                     \
+  for (i= 0; i < n; i++)                                                \
+  {                                                                     \
+    const uchar *row= rows[sel[i]];                                     \
+    if (!(row[null_offset] & null_bit) &&                               \
+        memcmp(row + offset, bin_value, bin_size) CMP 0)                \
+      sel[k++]= sel[i];                                                 \
+  }
+
+uint Batch_decimal_cmp::filter(uchar **rows, uint *sel, uint n)
+{
+  uint i, k= 0;
+  if (!bound)
+    return n;
+  if (null_value)
+    return 0;
+  switch (op) {
+  case Batch_cmp::EQ: BATCH_DECIMAL_CMP_LOOP(==); break;
+  case Batch_cmp::NE: BATCH_DECIMAL_CMP_LOOP(!=); break;
+  case Batch_cmp::LT: BATCH_DECIMAL_CMP_LOOP(<);  break;
+  case Batch_cmp::LE: BATCH_DECIMAL_CMP_LOOP(<=); break;
+  case Batch_cmp::GT: BATCH_DECIMAL_CMP_LOOP(>);  break;
+  case Batch_cmp::GE: BATCH_DECIMAL_CMP_LOOP(>=); break;
+  }
+  return k;
+}
+
+
+/*
+  [NOT] NULL test
+*/
+
+Batch_isnull::Batch_isnull(Field *field, bool negated_arg)
+  :negated(negated_arg)
+{
+  null_offset= (uint) (field->null_ptr - field->table->record[0]);
+  null_bit= field->null_bit;
+}
+
+
+uint Batch_isnull::filter(uchar **rows, uint *sel, uint n)
+{
+  uint i, k= 0;
+  for (i= 0; i < n; i++)
+  {
+    if (MY_TEST(rows[sel[i]][null_offset] & null_bit) != negated)
+      sel[k++]= sel[i];
+  }
+  return k;
+}
+
+
+/*
+  Columns
+*/
+
+Batch_field::Batch_field(Field *field)
+  :type(field->real_type())
+{
+  uchar *record= field->table->record[0];
+  offset= (uint) (field->ptr - record);
+  null_offset= field->null_ptr ? (uint) (field->null_ptr - record) : 0;
+  null_bit= field->null_ptr ? field->null_bit : 0;
+  unsigned_flag= field->flags & UNSIGNED_FLAG;
+}
+
+
+bool Batch_field::bind()
+{
+  switch (type) {
+  case MYSQL_TYPE_TINY:
+    min_value= unsigned_flag ? 0 : INT_MIN8;
+    max_value= unsigned_flag ? UINT_MAX8 : INT_MAX8;
+    break;
+  case MYSQL_TYPE_SHORT:
+    min_value= unsigned_flag ? 0 : INT_MIN16;
+    max_value= unsigned_flag ? UINT_MAX16 : INT_MAX16;
+    break;
+  case MYSQL_TYPE_INT24:
+    min_value= unsigned_flag ? 0 : INT_MIN24;
+    max_value= unsigned_flag ? UINT_MAX24 : INT_MAX24;
+    break;
+  case MYSQL_TYPE_LONG:
+    min_value= unsigned_flag ? 0 : INT_MIN32;
+    max_value= unsigned_flag ? (longlong) UINT_MAX32 : INT_MAX32;
+    break;
+  case MYSQL_TYPE_LONGLONG:
+    min_value= LONGLONG_MIN;
+    max_value= LONGLONG_MAX;
+    break;
+  default:
+    min_value= 0;
+    max_value= 0xFFFFFF;
+    break;
+  }
+  return TRUE;
+}
+
+
+#define BATCH_FIELD_LOOP(READ)                                          \
+  for (i= 0; i < n; i++)                                                \
+  {                                                                     \
+    const uchar *ptr= rows[sel[i]] + offset;                            \
+    values[i]= READ;                                                    \
+  }
+
+void Batch_field::val(uchar **rows, const uint *sel, uint n,
+                      longlong *values, bool *nulls)
+{
+  uint i;
+  switch (type) {
+  case MYSQL_TYPE_TINY:
+    if (unsigned_flag)
+      BATCH_FIELD_LOOP(*ptr)
+    else
+      BATCH_FIELD_LOOP((signed char) *ptr)
+    break;
+  case MYSQL_TYPE_SHORT:
+    if (unsigned_flag)
+      BATCH_FIELD_LOOP(uint2korr(ptr))
+    else
+      BATCH_FIELD_LOOP(sint2korr(ptr))
+    break;
+  case MYSQL_TYPE_INT24:
+    if (unsigned_flag)
+      BATCH_FIELD_LOOP(uint3korr(ptr))
+    else
+      BATCH_FIELD_LOOP(sint3korr(ptr))
+    break;
+  case MYSQL_TYPE_LONG:
+    if (unsigned_flag)
+      BATCH_FIELD_LOOP(uint4korr(ptr))
+    else
+      BATCH_FIELD_LOOP(sint4korr(ptr))
+    break;
+  case MYSQL_TYPE_LONGLONG:
+    BATCH_FIELD_LOOP(sint8korr(ptr))
+    break;
+  case MYSQL_TYPE_NEWDATE:
+    BATCH_FIELD_LOOP(uint3korr(ptr))
+    break;
+  default:
+    DBUG_ASSERT(0);
+    break;
+  }
+  if (null_bit)
+  {
+    for (i= 0; i < n; i++)
+      nulls[i]= MY_TEST(rows[sel[i]][null_offset] & null_bit);
+  }
+  else
+    bzero(nulls, sizeof(bool) * n);
+}
+
+
+/*
+  Constants
+*/
+
+bool Batch_const::bind()
+{
+  if (kind == INT_KIND)
+  {
+    value= item->val_int();
+    if ((null_value= item->null_value))
+      return TRUE;
+    /* Values above LONGLONG_MAX are not supported */
+    if (item->unsigned_flag && value < 0)
+      return FALSE;
+  }
+  else
+  {
+    MYSQL_TIME ltime;
+    if (item->cmp_type() == TIME_RESULT)
+    {
+      if (item->get_date(&ltime, 0))
+        return (null_value= item->null_value);
+    }
+    else
+    {
+      /*
+        Strings are converted here without warnings: the constants which
+        would produce a warning are not supported.
+      */
+      char buff[MAX_DATE_STRING_REP_LENGTH * 2];
+      String tmp(buff, sizeof(buff), &my_charset_bin), *str;
+      MYSQL_TIME_STATUS status;
+      if (!(str= item->val_str(&tmp)))
+        return (null_value= TRUE);
+      my_time_status_init(&status);
+      if (str_to_datetime(str->charset(), str->ptr(), str->length(), &ltime,
+                          0, &status) || status.warnings)
+        return FALSE;
+    }
+    null_value= FALSE;
+    /* The dates with a time part are compared with the time part */
+    if ((ltime.time_type != MYSQL_TIMESTAMP_DATE &&
+         ltime.time_type != MYSQL_TIMESTAMP_DATETIME) || ltime.neg ||
+        ltime.hour || ltime.minute || ltime.second || ltime.second_part)
+      return FALSE;
+    value= ltime.day + ltime.month * 32 + ltime.year * 16 * 32;
+  }
+  min_value= max_value= value;
+  return TRUE;
+}
+
+
+void Batch_const::val(uchar **rows, const uint *sel, uint n,
+                      longlong *values, bool *nulls)
+{
+  for (uint i= 0; i < n; i++)
+  {
+    values[i]= value;
+    nulls[i]= null_value;
+  }
+}
+
+
+/*
+  Arithmetic
+*/
+
+bool Batch_arith::init()
+{
+  return !(values_b= (longlong*) sql_alloc(sizeof(longlong) *
+                                           BATCH_COND_MAX_ROWS)) ||
+         !(nulls_b= (bool*) sql_alloc(sizeof(bool) * BATCH_COND_MAX_ROWS));
+}
+
+
+/*
+  Compute the bounds of the values of the expression
+
+  RETURN VALUE
+    FALSE   the values may overflow longlong: the evaluation would raise
+            an error, and the expression must not be evaluated in batches
+    TRUE    otherwise
+*/
+
+bool Batch_arith::bind()
+{
+  double min_res, max_res;
+  if (!a->bind() || !b->bind())
+    return FALSE;
+  double a_min= (double) a->min_value, a_max= (double) a->max_value;
+  double b_min= (double) b->min_value, b_max= (double) b->max_value;
+  switch (op) {
+  case PLUS:
+    min_res= a_min + b_min;
+    max_res= a_max + b_max;
+    break;
+  case MINUS:
+    min_res= a_min - b_max;
+    max_res= a_max - b_min;
+    break;
+  case MUL:
+  default:
+  {
+    double v1= a_min * b_min, v2= a_min * b_max;
+    double v3= a_max * b_min, v4= a_max * b_max;
+    min_res= MY_MIN(MY_MIN(v1, v2), MY_MIN(v3, v4));
+    max_res= MY_MAX(MY_MAX(v1, v2), MY_MAX(v3, v4));
+    break;
+  }
+  }
+  if (min_res < -BATCH_EXPR_MAX_VALUE || max_res > BATCH_EXPR_MAX_VALUE)
+    return FALSE;
+  min_value= (longlong) min_res;
+  max_value= (longlong) max_res;
+  return TRUE;
+}
+
+
+void Batch_arith::val(uchar **rows, const uint *sel, uint n,
+                      longlong *values, bool *nulls)
+{
+  uint i;
+  a->val(rows, sel, n, values, nulls);
+  b->val(rows, sel, n, values_b, nulls_b);
+  switch (op) {
+  case PLUS:
+    for (i= 0; i < n; i++)
+      values[i]+= values_b[i];
+    break;
+  case MINUS:
+    for (i= 0; i < n; i++)
+      values[i]-= values_b[i];
+    break;
+  case MUL:
+    for (i= 0; i < n; i++)
+      values[i]*= values_b[i];
+    break;
+  }
+  for (i= 0; i < n; i++)
+    nulls[i]|= nulls_b[i];
+}
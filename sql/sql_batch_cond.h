@@ -0,0 +1,257 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_BATCH_COND_INCLUDED
+#define SQL_BATCH_COND_INCLUDED
+
+#include "sql_list.h"                           /* Sql_alloc, List */
+#include "mysql_com.h"                          /* enum_field_types */
+
+class Item;
+class Item_func;
+class Field;
+class Field_new_decimal;
+struct TABLE;
+
+/*
+  Evaluation of conditions over blocks of records
+
+  A full table scan may read the records of a table in blocks (see
+  rr_sequential_batch()) and evaluate the part of the condition pushed to
+  the table that depends only on the table over the whole block at once.
+  The evaluators are built from the Item tree of the condition by
+  Item::get_batch_cond() and Item::get_batch_expr(): each node of the tree
+  is evaluated in a tight loop over an array of the records of the block
+  instead of walking the Item tree with virtual calls for each record.
+
+  The records of a block are images of table->record[0]. A block is
+  passed as an array of pointers to the records together with a selection
+  vector: the array of the numbers of the records to be evaluated. A
+  condition compacts the selection vector leaving only the records for
+  which the condition may be true.
+
+  The evaluators are filters: a record may be kept even if the condition
+  is false for it, but a record must never be removed if the condition
+  can be true for it or if the evaluation of the condition for it could
+  raise a warning or an error. The whole condition is still evaluated for
+  the remaining records by evaluate_join_record(). Thus:
+  - only the comparisons of integer, DECIMAL and DATE columns with
+    constants and with integer arithmetic over the columns are supported,
+  - a conjunction is evaluated over its conjuncts up to the first one
+    that is not supported and could raise a warning: the original
+    condition stops at the first false conjunct, so the records removed
+    by the evaluator would never reach that conjunct,
+  - the comparisons that could overflow or whose constants could not be
+    converted without a warning stop the evaluation in the same way,
+  - the records for which the value of a comparison is UNKNOWN are
+    removed, as the evaluators are never used under a negation.
+*/
+
+/* The maximum and the minimum number of records in a block */
+#define BATCH_COND_MAX_ROWS 256
+#define BATCH_COND_MIN_ROWS 16
+
+class Batch_expr :public Sql_alloc
+{
+public:
+  /*
+    The domain of the values: integers, or dates packed as in the records
+    of the DATE columns (day + month*32 + year*16*32)
+  */
+  enum Kind { INT_KIND, DATE_KIND };
+  /* The bounds of the values, set by bind() */
+  longlong min_value, max_value;
+
+  /*
+    Prepare the evaluation for the scan of the table. Return FALSE if the
+    expression cannot be evaluated without the risk of an overflow.
+  */
+  virtual bool bind()= 0;
+  /* Evaluate the expression over the records rows[sel[0..n-1]] */
+  virtual void val(uchar **rows, const uint *sel, uint n,
+                   longlong *values, bool *nulls)= 0;
+  virtual ~Batch_expr() {}
+};
+
+
+class Batch_cond :public Sql_alloc
+{
+public:
+  /* FALSE <=> only a part of the condition is evaluated */
+  bool complete;
+
+  Batch_cond() :complete(TRUE) {}
+  /*
+    Prepare the evaluation for the scan of the table. Return FALSE if the
+    condition cannot be evaluated for this scan: then it keeps all records
+    and the conjuncts after it must not be evaluated either.
+  */
+  virtual bool bind()= 0;
+  /*
+    Remove the records for which the condition is not true from the
+    selection vector sel[0..n-1], keeping the order of the records.
+    Return the number of the remaining records.
+  */
+  virtual uint filter(uchar **rows, uint *sel, uint n)= 0;
+  virtual ~Batch_cond() {}
+};
+
+
+class Batch_cond_and :public Batch_cond
+{
+  List<Batch_cond> list;
+  uint bound_count;                     /* conjuncts to evaluate */
+public:
+  Batch_cond_and(List<Batch_cond> &list_arg, bool complete_arg)
+    :list(list_arg), bound_count(0) { complete= complete_arg; }
+  bool bind();
+  uint filter(uchar **rows, uint *sel, uint n);
+};
+
+
+class Batch_cond_or :public Batch_cond
+{
+  List<Batch_cond> list;
+  uint *rest, *work;
+  bool *passed;
+  bool bound;
+public:
+  Batch_cond_or(List<Batch_cond> &list_arg);
+  bool init();
+  bool bind();
+  uint filter(uchar **rows, uint *sel, uint n);
+};
+
+
+/* Comparison of two integer or date expressions */
+
+class Batch_cmp :public Batch_cond
+{
+public:
+  enum Op { EQ, NE, LT, LE, GT, GE };
+private:
+  Op op;
+  Batch_expr *a, *b;
+  longlong *values_a, *values_b;
+  bool *nulls_a, *nulls_b;
+  bool bound;
+public:
+  Batch_cmp(Op op_arg, Batch_expr *a_arg, Batch_expr *b_arg)
+    :op(op_arg), a(a_arg), b(b_arg), bound(FALSE) {}
+  bool init();
+  bool bind() { return (bound= a->bind() && b->bind()); }
+  uint filter(uchar **rows, uint *sel, uint n);
+};
+
+
+/*
+  Comparison of a DECIMAL column with a constant
+
+  The binary format of DECIMAL values is comparable with memcmp() for the
+  values of the same precision and scale, so the constant is converted
+  into the format of the column once per scan.
+*/
+
+class Batch_decimal_cmp :public Batch_cond
+{
+  Batch_cmp::Op op;
+  Item *value;
+  uint offset, null_offset;
+  uchar null_bit;
+  uint precision, scale, bin_size;
+  uchar *bin_value;
+  bool bound, null_value;
+public:
+  Batch_decimal_cmp(Batch_cmp::Op op_arg, Field_new_decimal *field,
+                    Item *value_arg);
+  bool init();
+  bool bind();
+  uint filter(uchar **rows, uint *sel, uint n);
+};
+
+
+/* [NOT] NULL test of a nullable column */
+
+class Batch_isnull :public Batch_cond
+{
+  uint null_offset;
+  uchar null_bit;
+  bool negated;
+public:
+  Batch_isnull(Field *field, bool negated_arg);
+  bool bind() { return TRUE; }
+  uint filter(uchar **rows, uint *sel, uint n);
+};
+
+
+/* Value of an integer or DATE column */
+
+class Batch_field :public Batch_expr
+{
+  enum_field_types type;
+  uint offset, null_offset;
+  uchar null_bit;
+  bool unsigned_flag;
+public:
+  Batch_field(Field *field);
+  bool bind();
+  void val(uchar **rows, const uint *sel, uint n,
+           longlong *values, bool *nulls);
+};
+
+
+/* Value of a constant, evaluated once per scan */
+
+class Batch_const :public Batch_expr
+{
+  Kind kind;
+  Item *item;
+  longlong value;
+  bool null_value;
+public:
+  Batch_const(Item *item_arg, Kind kind_arg) :kind(kind_arg), item(item_arg) {}
+  bool bind();
+  void val(uchar **rows, const uint *sel, uint n,
+           longlong *values, bool *nulls);
+};
+
+
+/* Integer addition, subtraction and multiplication */
+
+class Batch_arith :public Batch_expr
+{
+public:
+  enum Op { PLUS, MINUS, MUL };
+private:
+  Op op;
+  Batch_expr *a, *b;
+  longlong *values_b;
+  bool *nulls_b;
+public:
+  Batch_arith(Op op_arg, Batch_expr *a_arg, Batch_expr *b_arg)
+    :op(op_arg), a(a_arg), b(b_arg) {}
+  bool init();
+  bool bind();
+  void val(uchar **rows, const uint *sel, uint n,
+           longlong *values, bool *nulls);
+};
+
+
+Batch_expr *make_batch_expr(TABLE *table, Item *item, Batch_expr::Kind kind);
+Batch_cond *make_batch_cmp(TABLE *table, Batch_cmp::Op op, Item *a, Item *b);
+Batch_expr *make_batch_arith(TABLE *table, Batch_arith::Op op, Item_func *func);
+
+#endif /* SQL_BATCH_COND_INCLUDED */
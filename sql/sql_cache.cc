@@ -641,16 +641,21 @@ bool Query_cache::try_lock(THD *thd, Cache_try_lock_mode mode)
       */
       if (mode == WAIT)
       {
+        lock_waits++;
         mysql_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
       }
       else if (mode == TIMEOUT)
       {
         struct timespec waittime;
         set_timespec_nsec(waittime,(ulong)(50000000L));  /* Wait for 50 msec */
+        lock_waits++;
         int res= mysql_cond_timedwait(&COND_cache_status_changed,
                                       &structure_guard_mutex, &waittime);
         if (res == ETIMEDOUT)
+        {
+          lock_timeouts++;
           break;
+        }
       }
       else
       {
@@ -724,7 +729,10 @@ void Query_cache::lock(THD *thd)
   m_requests_in_progress++;
   fix_local_query_cache_mode(thd);
   while (m_cache_lock_status != Query_cache::UNLOCKED)
+  {
+    lock_waits++;
     mysql_cond_wait(&COND_cache_status_changed, &structure_guard_mutex);
+  }
   m_cache_lock_status= Query_cache::LOCKED;
 #ifndef DBUG_OFF
   m_cache_lock_thread_id= thd->thread_id;
@@ -1113,8 +1121,8 @@ Query_cache::insert(Query_cache_tls *query_cache_tls,
     header->result(result);
     DBUG_PRINT("qcache", ("free query 0x%lx", (ulong) query_block));
     // The following call will remove the lock on query_block
-    query_cache.free_query(query_block);
-    query_cache.refused++;
+    free_query(query_block);
+    refused++;
     // append_result_data no success => we need unlock
     unlock();
     DBUG_VOID_RETURN;
@@ -1225,9 +1233,9 @@ void Query_cache::end_of_result(THD *thd)
     }
     last_result_block= header->result()->prev;
     allign_size= ALIGN_SIZE(last_result_block->used);
-    len= MY_MAX(query_cache.min_allocation_unit, allign_size);
-    if (last_result_block->length >= query_cache.min_allocation_unit + len)
-      query_cache.split_block(last_result_block,len);
+    len= MY_MAX(min_allocation_unit, allign_size);
+    if (last_result_block->length >= min_allocation_unit + len)
+      split_block(last_result_block,len);
 
     header->found_rows(limit_found_rows);
     header->result()->type= Query_cache_block::RESULT;
@@ -1262,6 +1270,232 @@ void mysql_query_cache_invalidate4(THD *thd,
 }
 
 
+/*****************************************************************************
+   Partitioned_query_cache methods
+*****************************************************************************/
+
+Partitioned_query_cache::Partitioned_query_cache()
+  :query_cache_size(0), partitions(&default_partition), n_partitions(1),
+   refused(0)
+{}
+
+
+/**
+  Pick the partition that stores the query with the given key.
+*/
+
+Query_cache *Partitioned_query_cache::get_partition(const char *key,
+                                                    ulong key_length)
+{
+  if (n_partitions == 1)
+    return partitions;
+  return partitions + my_checksum(0, (const uchar*) key, key_length) %
+                      n_partitions;
+}
+
+
+void Partitioned_query_cache::init()
+{
+  DBUG_ENTER("Partitioned_query_cache::init");
+  if (query_cache_partitions > 1)
+  {
+    partitions= new Query_cache[query_cache_partitions];
+    n_partitions= (uint) query_cache_partitions;
+  }
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].init();
+  DBUG_VOID_RETURN;
+}
+
+
+void Partitioned_query_cache::destroy()
+{
+  DBUG_ENTER("Partitioned_query_cache::destroy");
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].destroy();
+  if (partitions != &default_partition)
+  {
+    delete [] partitions;
+    partitions= &default_partition;
+    n_partitions= 1;
+  }
+  query_cache_size= 0;
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Resize the query cache. The memory is divided evenly between the
+  partitions.
+
+  @return the memory actually used by all partitions, 0 if disabled
+*/
+
+ulong Partitioned_query_cache::resize(ulong query_cache_size_arg)
+{
+  ulong new_query_cache_size= 0;
+  DBUG_ENTER("Partitioned_query_cache::resize");
+
+  if (global_system_variables.query_cache_type == 0)
+  {
+    DBUG_ASSERT(query_cache_size_arg == 0);
+    if (query_cache_size_arg != 0)
+      my_error(ER_QUERY_CACHE_IS_DISABLED, MYF(0));
+    DBUG_RETURN(0);
+  }
+
+  for (uint i= 0; i < n_partitions; i++)
+    new_query_cache_size+=
+      partitions[i].resize(query_cache_size_arg / n_partitions);
+  /*
+    If any partition is too small to be used the whole cache is
+    disabled, so that is_disabled() tells the truth about all of them.
+  */
+  for (uint i= 0; i < n_partitions; i++)
+  {
+    if (partitions[i].query_cache_size == 0)
+    {
+      for (uint j= 0; j < n_partitions; j++)
+        partitions[j].resize(0);
+      new_query_cache_size= 0;
+      break;
+    }
+  }
+  query_cache_size= new_query_cache_size;
+  DBUG_RETURN(new_query_cache_size);
+}
+
+
+void Partitioned_query_cache::result_size_limit(ulong limit)
+{
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].result_size_limit(limit);
+}
+
+
+ulong Partitioned_query_cache::set_min_res_unit(ulong size)
+{
+  ulong new_size= size;
+  for (uint i= 0; i < n_partitions; i++)
+    new_size= partitions[i].set_min_res_unit(size);
+  return new_size;
+}
+
+
+void Partitioned_query_cache::disable_query_cache(THD *thd)
+{
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].disable_query_cache(thd);
+}
+
+
+void Partitioned_query_cache::invalidate(THD *thd, char *db)
+{
+  DBUG_ENTER("Partitioned_query_cache::invalidate (db)");
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].invalidate(thd, db);
+  DBUG_VOID_RETURN;
+}
+
+
+void Partitioned_query_cache::flush()
+{
+  DBUG_ENTER("Partitioned_query_cache::flush");
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].flush();
+  DBUG_VOID_RETURN;
+}
+
+
+void Partitioned_query_cache::pack(THD *thd, ulong join_limit,
+                                   uint iteration_limit)
+{
+  DBUG_ENTER("Partitioned_query_cache::pack");
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].pack(thd, join_limit, iteration_limit);
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  The result of a statement goes to the partition that registered it in
+  store_query(). Like there, first_query_block is tested without a lock;
+  the partition tests it again once it is locked.
+*/
+
+void Partitioned_query_cache::insert(Query_cache_tls *query_cache_tls,
+                                     const char *packet, ulong length,
+                                     unsigned pkt_nr)
+{
+  if (query_cache_tls->first_query_block == NULL)
+    return;
+  query_cache_tls->partition->insert(query_cache_tls, packet, length, pkt_nr);
+}
+
+
+void Partitioned_query_cache::end_of_result(THD *thd)
+{
+  if (thd->query_cache_tls.first_query_block == NULL)
+    return;
+  thd->query_cache_tls.partition->end_of_result(thd);
+}
+
+
+void Partitioned_query_cache::abort(Query_cache_tls *query_cache_tls)
+{
+  if (query_cache_tls->first_query_block == NULL)
+    return;
+  query_cache_tls->partition->abort(query_cache_tls);
+}
+
+
+/**
+  Sum a statistics counter over all partitions.
+*/
+
+ulong Partitioned_query_cache::total(ulong Query_cache::*counter)
+{
+  ulong sum= 0;
+  for (uint i= 0; i < n_partitions; i++)
+    sum+= partitions[i].*counter;
+  if (counter == &Query_cache::refused)
+    sum+= refused;
+  return sum;
+}
+
+
+/**
+  Reset the counters that FLUSH STATUS resets.
+*/
+
+void Partitioned_query_cache::reset_counters()
+{
+  for (uint i= 0; i < n_partitions; i++)
+  {
+    Query_cache *qc= partitions + i;
+    qc->hits= qc->inserts= qc->refused= qc->lowmem_prunes= 0;
+    qc->lock_waits= qc->lock_timeouts= 0;
+  }
+  refused= 0;
+}
+
+
+void Partitioned_query_cache::wreck(uint line, const char *message)
+{
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].wreck(line, message);
+}
+
+
+my_bool Partitioned_query_cache::check_integrity(bool not_locked)
+{
+  my_bool result= 0;
+  for (uint i= 0; i < n_partitions; i++)
+    result|= partitions[i].check_integrity(not_locked);
+  return result;
+}
+
+
 /*****************************************************************************
    Query_cache methods
 *****************************************************************************/
@@ -1275,6 +1509,7 @@ Query_cache::Query_cache(ulong query_cache_limit_arg,
    query_cache_limit(query_cache_limit_arg),
    queries_in_cache(0), hits(0), inserts(0), refused(0),
    total_blocks(0), lowmem_prunes(0),
+   lock_waits(0), lock_timeouts(0),
    m_cache_status(OK),
    min_allocation_unit(ALIGN_SIZE(min_allocation_unit_arg)),
    min_result_data_size(ALIGN_SIZE(min_result_data_size_arg)),
@@ -1366,14 +1601,77 @@ ulong Query_cache::set_min_res_unit(ulong size)
 }
 
 
-void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
+/**
+  Fill the flags that are part of the query cache key of a statement.
+*/
+
+static void make_query_cache_flags(THD *thd, Query_cache_query_flags *flags)
+{
+  // fill all gaps between fields with 0 to get repeatable key
+  bzero(flags, QUERY_CACHE_FLAGS_SIZE);
+  flags->client_long_flag= MY_TEST(thd->client_capabilities & CLIENT_LONG_FLAG);
+  flags->client_protocol_41= MY_TEST(thd->client_capabilities &
+                                     CLIENT_PROTOCOL_41);
+  /*
+    Protocol influences result format, so statement results in the binary
+    protocol (COM_EXECUTE) cannot be served to statements asking for results
+    in the text protocol (COM_QUERY) and vice-versa.
+  */
+  flags->protocol_type= (unsigned int) thd->protocol->type();
+  flags->more_results_exists= MY_TEST(thd->server_status &
+                                      SERVER_MORE_RESULTS_EXISTS);
+  flags->in_trans= thd->in_active_multi_stmt_transaction();
+  flags->autocommit= MY_TEST(thd->server_status & SERVER_STATUS_AUTOCOMMIT);
+  flags->pkt_nr= thd->net.pkt_nr;
+  flags->character_set_client_num=
+    thd->variables.character_set_client->number;
+  flags->character_set_results_num=
+    (thd->variables.character_set_results ?
+     thd->variables.character_set_results->number :
+     UINT_MAX);
+  flags->collation_connection_num=
+    thd->variables.collation_connection->number;
+  flags->limit= thd->variables.select_limit;
+  flags->time_zone= thd->variables.time_zone;
+  flags->sql_mode= thd->variables.sql_mode;
+  flags->max_sort_length= thd->variables.max_sort_length;
+  flags->lc_time_names= thd->variables.lc_time_names;
+  flags->group_concat_max_len= thd->variables.group_concat_max_len;
+  flags->div_precision_increment= thd->variables.div_precincrement;
+  flags->default_week_format= thd->variables.default_week_format;
+  DBUG_PRINT("qcache", ("\
+long %d, 4.1: %d, bin_proto: %d, more results %d, pkt_nr: %d, \
+CS client: %u, CS result: %u, CS conn: %u, limit: %lu, TZ: 0x%lx, \
+sql mode: 0x%llx, sort len: %lu, conncat len: %lu, div_precision: %lu, \
+def_week_frmt: %lu, in_trans: %d, autocommit: %d",
+                        (int)flags->client_long_flag,
+                        (int)flags->client_protocol_41,
+                        (int)flags->protocol_type,
+                        (int)flags->more_results_exists,
+                        flags->pkt_nr,
+                        flags->character_set_client_num,
+                        flags->character_set_results_num,
+                        flags->collation_connection_num,
+                        (ulong) flags->limit,
+                        (ulong) flags->time_zone,
+                        flags->sql_mode,
+                        flags->max_sort_length,
+                        flags->group_concat_max_len,
+                        flags->div_precision_increment,
+                        flags->default_week_format,
+                        (int)flags->in_trans,
+                        (int)flags->autocommit));
+}
+
+
+void Partitioned_query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
 {
   TABLE_COUNTER_TYPE local_tables;
   ulong tot_length;
   const char *query;
   size_t query_length;
   uint8 tables_type;
-  DBUG_ENTER("Query_cache::store_query");
+  DBUG_ENTER("Partitioned_query_cache::store_query");
   /*
     Testing 'query_cache_size' without a lock here is safe: the thing
     we may loose is that the query won't be cached, but we save on
@@ -1398,67 +1696,13 @@ void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used)
               thd->base_query.ptr() == thd->query());
 
   tables_type= 0;
-  if ((local_tables= is_cacheable(thd, thd->lex, tables_used,
-				  &tables_type)))
+  if ((local_tables= Query_cache::is_cacheable(thd, thd->lex, tables_used,
+                                               &tables_type)))
   {
-    NET *net= &thd->net;
     Query_cache_query_flags flags;
-    // fill all gaps between fields with 0 to get repeatable key
-    bzero(&flags, QUERY_CACHE_FLAGS_SIZE);
-    flags.client_long_flag= MY_TEST(thd->client_capabilities & CLIENT_LONG_FLAG);
-    flags.client_protocol_41= MY_TEST(thd->client_capabilities &
-                                      CLIENT_PROTOCOL_41);
-    /*
-      Protocol influences result format, so statement results in the binary
-      protocol (COM_EXECUTE) cannot be served to statements asking for results
-      in the text protocol (COM_QUERY) and vice-versa.
-    */
-    flags.protocol_type= (unsigned int) thd->protocol->type();
+    make_query_cache_flags(thd, &flags);
     /* PROTOCOL_LOCAL results are not cached. */
     DBUG_ASSERT(flags.protocol_type != (unsigned int) Protocol::PROTOCOL_LOCAL);
-    flags.more_results_exists= MY_TEST(thd->server_status &
-                                       SERVER_MORE_RESULTS_EXISTS);
-    flags.in_trans= thd->in_active_multi_stmt_transaction();
-    flags.autocommit= MY_TEST(thd->server_status & SERVER_STATUS_AUTOCOMMIT);
-    flags.pkt_nr= net->pkt_nr;
-    flags.character_set_client_num=
-      thd->variables.character_set_client->number;
-    flags.character_set_results_num=
-      (thd->variables.character_set_results ?
-       thd->variables.character_set_results->number :
-       UINT_MAX);
-    flags.collation_connection_num=
-      thd->variables.collation_connection->number;
-    flags.limit= thd->variables.select_limit;
-    flags.time_zone= thd->variables.time_zone;
-    flags.sql_mode= thd->variables.sql_mode;
-    flags.max_sort_length= thd->variables.max_sort_length;
-    flags.lc_time_names= thd->variables.lc_time_names;
-    flags.group_concat_max_len= thd->variables.group_concat_max_len;
-    flags.div_precision_increment= thd->variables.div_precincrement;
-    flags.default_week_format= thd->variables.default_week_format;
-    DBUG_PRINT("qcache", ("\
-long %d, 4.1: %d, bin_proto: %d, more results %d, pkt_nr: %d, \
-CS client: %u, CS result: %u, CS conn: %u, limit: %lu, TZ: 0x%lx, \
-sql mode: 0x%llx, sort len: %lu, conncat len: %lu, div_precision: %lu, \
-def_week_frmt: %lu, in_trans: %d, autocommit: %d",
-                          (int)flags.client_long_flag,
-                          (int)flags.client_protocol_41,
-                          (int)flags.protocol_type,
-                          (int)flags.more_results_exists,
-                          flags.pkt_nr,
-                          flags.character_set_client_num,
-                          flags.character_set_results_num,
-                          flags.collation_connection_num,
-                          (ulong) flags.limit,
-                          (ulong) flags.time_zone,
-                          flags.sql_mode,
-                          flags.max_sort_length,
-                          flags.group_concat_max_len,
-                          flags.div_precision_increment,
-                          flags.default_week_format,
-                          (int)flags.in_trans,
-                          (int)flags.autocommit));
 
     /*
      Make InnoDB to release the adaptive hash index latch before
@@ -1466,33 +1710,6 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
     */
     ha_release_temporary_latches(thd);
 
-    /*
-      A table- or a full flush operation can potentially take a long time to
-      finish. We choose not to wait for them and skip caching statements
-      instead.
-
-      In case the wait time can't be determined there is an upper limit which
-      causes try_lock() to abort with a time out.
-
-      The 'TIMEOUT' parameter indicate that the lock is allowed to timeout
-
-    */
-    if (try_lock(thd, Query_cache::TIMEOUT))
-      DBUG_VOID_RETURN;
-    if (query_cache_size == 0)
-    {
-      unlock();
-      DBUG_VOID_RETURN;
-    }
-    DUMP(this);
-
-    if (ask_handler_allowance(thd, tables_used))
-    {
-      refused++;
-      unlock();
-      DBUG_VOID_RETURN;
-    }
-
     query=        thd->base_query.ptr();
     query_length= thd->base_query.length();
 
@@ -1517,73 +1734,116 @@ def_week_frmt: %lu, in_trans: %d, autocommit: %d",
     memcpy((void*) (query + (tot_length - QUERY_CACHE_FLAGS_SIZE)),
 	   &flags, QUERY_CACHE_FLAGS_SIZE);
 
-    /* Check if another thread is processing the same query? */
-    Query_cache_block *competitor = (Query_cache_block *)
-      my_hash_search(&queries, (uchar*) query, tot_length);
-    DBUG_PRINT("qcache", ("competitor 0x%lx", (ulong) competitor));
-    if (competitor == 0)
-    {
-      /* Query is not in cache and no one is working with it; Store it */
-      Query_cache_block *query_block;
-      query_block= write_block_data(tot_length, (uchar*) query,
-				    ALIGN_SIZE(sizeof(Query_cache_query)),
-				    Query_cache_block::QUERY, local_tables);
-      if (query_block != 0)
-      {
-	DBUG_PRINT("qcache", ("query block 0x%lx allocated, %lu",
-			    (ulong) query_block, query_block->used));
+    get_partition(query, tot_length)->store_query(thd, tables_used,
+                                                  query, tot_length,
+                                                  local_tables, tables_type);
+  }
+  else
+    statistic_increment(refused, &LOCK_status);
 
-	Query_cache_query *header = query_block->query();
-	header->init_n_lock();
-	if (my_hash_insert(&queries, (uchar*) query_block))
-	{
-	  refused++;
-	  DBUG_PRINT("qcache", ("insertion in query hash"));
-	  header->unlock_n_destroy();
-	  free_memory_block(query_block);
-          unlock();
-	  goto end;
-	}
-	if (!register_all_tables(thd, query_block, tables_used, local_tables))
-	{
-	  refused++;
-	  DBUG_PRINT("warning", ("tables list including failed"));
-	  my_hash_delete(&queries, (uchar *) query_block);
-	  header->unlock_n_destroy();
-	  free_memory_block(query_block);
-          unlock();
-	  goto end;
-	}
-	double_linked_list_simple_include(query_block, &queries_blocks);
-	inserts++;
-	queries_in_cache++;
-	thd->query_cache_tls.first_query_block= query_block;
-	header->writer(&thd->query_cache_tls);
-	header->tables_type(tables_type);
+  DBUG_VOID_RETURN;
+}
 
-        unlock();
 
-	// init_n_lock make query block locked
-	BLOCK_UNLOCK_WR(query_block);
+void Query_cache::store_query(THD *thd, TABLE_LIST *tables_used,
+                              const char *query, ulong tot_length,
+                              TABLE_COUNTER_TYPE local_tables,
+                              uint8 tables_type)
+{
+  DBUG_ENTER("Query_cache::store_query");
+
+  /*
+    A table- or a full flush operation can potentially take a long time to
+    finish. We choose not to wait for them and skip caching statements
+    instead.
+
+    In case the wait time can't be determined there is an upper limit which
+    causes try_lock() to abort with a time out.
+
+    The 'TIMEOUT' parameter indicate that the lock is allowed to timeout
+
+  */
+  if (try_lock(thd, Query_cache::TIMEOUT))
+    DBUG_VOID_RETURN;
+  if (query_cache_size == 0)
+  {
+    unlock();
+    DBUG_VOID_RETURN;
+  }
+  DUMP(this);
+
+  if (ask_handler_allowance(thd, tables_used))
+  {
+    refused++;
+    unlock();
+    DBUG_VOID_RETURN;
+  }
+
+  /* Check if another thread is processing the same query? */
+  Query_cache_block *competitor = (Query_cache_block *)
+    my_hash_search(&queries, (uchar*) query, tot_length);
+  DBUG_PRINT("qcache", ("competitor 0x%lx", (ulong) competitor));
+  if (competitor == 0)
+  {
+    /* Query is not in cache and no one is working with it; Store it */
+    Query_cache_block *query_block;
+    query_block= write_block_data(tot_length, (uchar*) query,
+                                  ALIGN_SIZE(sizeof(Query_cache_query)),
+                                  Query_cache_block::QUERY, local_tables);
+    if (query_block != 0)
+    {
+      DBUG_PRINT("qcache", ("query block 0x%lx allocated, %lu",
+                            (ulong) query_block, query_block->used));
+
+      Query_cache_query *header = query_block->query();
+      header->init_n_lock();
+      if (my_hash_insert(&queries, (uchar*) query_block))
+      {
+        refused++;
+        DBUG_PRINT("qcache", ("insertion in query hash"));
+        header->unlock_n_destroy();
+        free_memory_block(query_block);
+        unlock();
+        goto end;
       }
-      else
+      if (!register_all_tables(thd, query_block, tables_used, local_tables))
       {
-	// We have not enough memory to store query => do nothing
-	refused++;
+        refused++;
+        DBUG_PRINT("warning", ("tables list including failed"));
+        my_hash_delete(&queries, (uchar *) query_block);
+        header->unlock_n_destroy();
+        free_memory_block(query_block);
         unlock();
-	DBUG_PRINT("warning", ("Can't allocate query"));
+        goto end;
       }
+      double_linked_list_simple_include(query_block, &queries_blocks);
+      inserts++;
+      queries_in_cache++;
+      thd->query_cache_tls.first_query_block= query_block;
+      thd->query_cache_tls.partition= this;
+      header->writer(&thd->query_cache_tls);
+      header->tables_type(tables_type);
+
+      unlock();
+
+      // init_n_lock make query block locked
+      BLOCK_UNLOCK_WR(query_block);
     }
     else
     {
-      // Another thread is processing the same query => do nothing
+      // We have not enough memory to store query => do nothing
       refused++;
       unlock();
-      DBUG_PRINT("qcache", ("Another thread process same query"));
+      DBUG_PRINT("warning", ("Can't allocate query"));
     }
   }
   else
-    statistic_increment(refused, &structure_guard_mutex);
+  {
+    // Another thread is processing the same query => do nothing
+    refused++;
+    unlock();
+    DBUG_PRINT("qcache", ("Another thread process same query"));
+  }
 
 end:
   DBUG_VOID_RETURN;
@@ -1696,19 +1956,13 @@ size_t build_normalized_name(char *buff, size_t bufflen,
 */
 
 int
-Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
+Partitioned_query_cache::send_result_to_client(THD *thd, char *org_sql,
+                                               uint query_length)
 {
-  ulonglong engine_data;
-  Query_cache_query *query;
-#ifndef EMBEDDED_LIBRARY
-  Query_cache_block *first_result_block;
-#endif
-  Query_cache_block *result_block;
-  Query_cache_block_table *block_table, *block_table_end;
   ulong tot_length;
   Query_cache_query_flags flags;
   const char *sql, *sql_end, *found_brace= 0;
-  DBUG_ENTER("Query_cache::send_result_to_client");
+  DBUG_ENTER("Partitioned_query_cache::send_result_to_client");
 
   /*
     Testing without a lock here is safe: the thing
@@ -1847,22 +2101,12 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
     }
   }
   /*
-    Try to obtain an exclusive lock on the query cache. If the cache is
-    disabled or if a full cache flush is in progress, the attempt to
-    get the lock is aborted.
-
-    The TIMEOUT parameter indicate that the lock is allowed to timeout.
+    Testing without a lock is safe here, see above. The partition
+    checks the size again once it has locked itself.
   */
-  if (try_lock(thd, Query_cache::TIMEOUT))
-    goto err;
-
   if (query_cache_size == 0)
-  {
-    thd->query_cache_is_applicable= 0;            // Query can't be cached
-    goto err_unlock;
-  }
+    goto err;
 
-  Query_cache_block *query_block;
   if (thd->variables.query_cache_strip_comments)
   {
     if (found_brace)
@@ -1896,55 +2140,61 @@ Query_cache::send_result_to_client(THD *thd, char *org_sql, uint query_length)
 
   THD_STAGE_INFO(thd, stage_checking_query_cache_for_query);
 
-  // fill all gaps between fields with 0 to get repeatable key
-  bzero(&flags, QUERY_CACHE_FLAGS_SIZE);
-  flags.client_long_flag= MY_TEST(thd->client_capabilities & CLIENT_LONG_FLAG);
-  flags.client_protocol_41= MY_TEST(thd->client_capabilities &
-                                    CLIENT_PROTOCOL_41);
-  flags.protocol_type= (unsigned int) thd->protocol->type();
-  flags.more_results_exists= MY_TEST(thd->server_status &
-                                     SERVER_MORE_RESULTS_EXISTS);
-  flags.in_trans= thd->in_active_multi_stmt_transaction();
-  flags.autocommit= MY_TEST(thd->server_status & SERVER_STATUS_AUTOCOMMIT);
-  flags.pkt_nr= thd->net.pkt_nr;
-  flags.character_set_client_num= thd->variables.character_set_client->number;
-  flags.character_set_results_num=
-    (thd->variables.character_set_results ?
-     thd->variables.character_set_results->number :
-     UINT_MAX);
-  flags.collation_connection_num= thd->variables.collation_connection->number;
-  flags.limit= thd->variables.select_limit;
-  flags.time_zone= thd->variables.time_zone;
-  flags.sql_mode= thd->variables.sql_mode;
-  flags.max_sort_length= thd->variables.max_sort_length;
-  flags.group_concat_max_len= thd->variables.group_concat_max_len;
-  flags.div_precision_increment= thd->variables.div_precincrement;
-  flags.default_week_format= thd->variables.default_week_format;
-  flags.lc_time_names= thd->variables.lc_time_names;
-  DBUG_PRINT("qcache", ("\
-long %d, 4.1: %d, bin_proto: %d, more results %d, pkt_nr: %d, \
-CS client: %u, CS result: %u, CS conn: %u, limit: %lu, TZ: 0x%lx, \
-sql mode: 0x%llx, sort len: %lu, conncat len: %lu, div_precision: %lu, \
-def_week_frmt: %lu, in_trans: %d, autocommit: %d",
-                          (int)flags.client_long_flag,
-                          (int)flags.client_protocol_41,
-                          (int)flags.protocol_type,
-                          (int)flags.more_results_exists,
-                          flags.pkt_nr,
-                          flags.character_set_client_num,
-                          flags.character_set_results_num,
-                          flags.collation_connection_num,
-                          (ulong) flags.limit,
-                          (ulong) flags.time_zone,
-                          flags.sql_mode,
-                          flags.max_sort_length,
-                          flags.group_concat_max_len,
-                          flags.div_precision_increment,
-                          flags.default_week_format,
-                          (int)flags.in_trans,
-                          (int)flags.autocommit));
+  make_query_cache_flags(thd, &flags);
   memcpy((uchar *)(sql + (tot_length - QUERY_CACHE_FLAGS_SIZE)),
 	 (uchar*) &flags, QUERY_CACHE_FLAGS_SIZE);
+
+  DBUG_RETURN(get_partition(sql, tot_length)->
+              send_result_to_client(thd, sql, tot_length));
+
+err:
+  thd->query_cache_is_applicable= 0;            // Query can't be cached
+  DBUG_RETURN(0);				// Query was not cached
+}
+
+
+/*
+  Look a query up in this partition and send its result to the client
+  if it is there.
+
+  @param thd Pointer to the thread handler
+  @param sql The query cache key of the statement, built by
+             Partitioned_query_cache::send_result_to_client()
+  @param tot_length Length of the key
+
+  @return see Partitioned_query_cache::send_result_to_client()
+*/
+
+int
+Query_cache::send_result_to_client(THD *thd, const char *sql,
+                                   ulong tot_length)
+{
+  ulonglong engine_data;
+  Query_cache_query *query;
+#ifndef EMBEDDED_LIBRARY
+  Query_cache_block *first_result_block;
+#endif
+  Query_cache_block *result_block;
+  Query_cache_block_table *block_table, *block_table_end;
+  Query_cache_block *query_block;
+  DBUG_ENTER("Query_cache::send_result_to_client");
+
+  /*
+    Try to obtain an exclusive lock on the query cache. If the cache is
+    disabled or if a full cache flush is in progress, the attempt to
+    get the lock is aborted.
+
+    The TIMEOUT parameter indicate that the lock is allowed to timeout.
+  */
+  if (try_lock(thd, Query_cache::TIMEOUT))
+    goto err;
+
+  if (query_cache_size == 0)
+  {
+    thd->query_cache_is_applicable= 0;            // Query can't be cached
+    goto err_unlock;
+  }
+
   query_block = (Query_cache_block *)  my_hash_search(&queries, (uchar*) sql,
                                                       tot_length);
   /* Quick abort on unlocked data */
@@ -2177,10 +2427,10 @@ err:
   Remove all cached queries that uses any of the tables in the list
 */
 
-void Query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
-			     my_bool using_transactions)
+void Partitioned_query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
+                                         my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (table list)");
+  DBUG_ENTER("Partitioned_query_cache::invalidate (table list)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2208,9 +2458,9 @@ void Query_cache::invalidate(THD *thd, TABLE_LIST *tables_used,
   DBUG_VOID_RETURN;
 }
 
-void Query_cache::invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used)
+void Partitioned_query_cache::invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used)
 {
-  DBUG_ENTER("Query_cache::invalidate (changed table list)");
+  DBUG_ENTER("Partitioned_query_cache::invalidate (changed table list)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2236,10 +2486,10 @@ void Query_cache::invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used)
   NOTE
     can be used only for opened tables
 */
-void Query_cache::invalidate_locked_for_write(THD *thd,
-                                              TABLE_LIST *tables_used)
+void Partitioned_query_cache::invalidate_locked_for_write(THD *thd,
+                                                          TABLE_LIST *tables_used)
 {
-  DBUG_ENTER("Query_cache::invalidate_locked_for_write");
+  DBUG_ENTER("Partitioned_query_cache::invalidate_locked_for_write");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2259,10 +2509,10 @@ void Query_cache::invalidate_locked_for_write(THD *thd,
   Remove all cached queries that uses the given table
 */
 
-void Query_cache::invalidate(THD *thd, TABLE *table, 
-			     my_bool using_transactions)
+void Partitioned_query_cache::invalidate(THD *thd, TABLE *table, 
+                                         my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (table)");
+  DBUG_ENTER("Partitioned_query_cache::invalidate (table)");
   if (is_disabled())
     DBUG_VOID_RETURN;
 
@@ -2277,10 +2527,10 @@ void Query_cache::invalidate(THD *thd, TABLE *table,
   DBUG_VOID_RETURN;
 }
 
-void Query_cache::invalidate(THD *thd, const char *key, uint32  key_length,
-			     my_bool using_transactions)
+void Partitioned_query_cache::invalidate(THD *thd, const char *key, uint32  key_length,
+                                         my_bool using_transactions)
 {
-  DBUG_ENTER("Query_cache::invalidate (key)");
+  DBUG_ENTER("Partitioned_query_cache::invalidate (key)");
   if (is_disabled())
    DBUG_VOID_RETURN;
 
@@ -2371,9 +2621,9 @@ void Query_cache::invalidate(THD *thd, char *db)
 }
 
 
-void Query_cache::invalidate_by_MyISAM_filename(const char *filename)
+void Partitioned_query_cache::invalidate_by_MyISAM_filename(const char *filename)
 {
-  DBUG_ENTER("Query_cache::invalidate_by_MyISAM_filename");
+  DBUG_ENTER("Partitioned_query_cache::invalidate_by_MyISAM_filename");
 
   if (is_disabled())
     DBUG_VOID_RETURN;
@@ -2381,7 +2631,8 @@ void Query_cache::invalidate_by_MyISAM_filename(const char *filename)
   /* Calculate the key outside the lock to make the lock shorter */
   char key[MAX_DBKEY_LENGTH];
   uint32 db_length;
-  uint key_length= filename_2_table_key(key, filename, &db_length);
+  uint key_length= Query_cache::filename_2_table_key(key, filename,
+                                                     &db_length);
   THD *thd= current_thd;
   invalidate_table(thd,(uchar *)key, key_length);
   DBUG_VOID_RETURN;
@@ -2405,7 +2656,7 @@ void Query_cache::flush()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   unlock();
   DBUG_VOID_RETURN;
 }
@@ -3208,7 +3459,8 @@ my_bool Query_cache::allocate_data_chain(Query_cache_block **result_block,
   Invalidate the first table in the table_list
 */
 
-void Query_cache::invalidate_table(THD *thd, TABLE_LIST *table_list)
+void Partitioned_query_cache::invalidate_table(THD *thd,
+                                               TABLE_LIST *table_list)
 {
   if (table_list->table != 0)
     invalidate_table(thd, table_list->table);	// Table is open
@@ -3223,12 +3475,24 @@ void Query_cache::invalidate_table(THD *thd, TABLE_LIST *table_list)
   }
 }
 
-void Query_cache::invalidate_table(THD *thd, TABLE *table)
+void Partitioned_query_cache::invalidate_table(THD *thd, TABLE *table)
 {
   invalidate_table(thd, (uchar*) table->s->table_cache_key.str,
                    table->s->table_cache_key.length);
 }
 
+/*
+  A query that uses the table may be stored in any partition, so all of
+  them are visited.
+*/
+
+void Partitioned_query_cache::invalidate_table(THD *thd, uchar *key,
+                                               uint32 key_length)
+{
+  for (uint i= 0; i < n_partitions; i++)
+    partitions[i].invalidate_table(thd, key, key_length);
+}
+
 void Query_cache::invalidate_table(THD *thd, uchar * key, uint32  key_length)
 {
   DEBUG_SYNC(thd, "wait_in_query_cache_invalidate1");
@@ -4173,7 +4437,7 @@ void Query_cache::pack_cache()
 {
   DBUG_ENTER("Query_cache::pack_cache");
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
 
   uchar *border = 0;
   Query_cache_block *before = 0;
@@ -4205,7 +4469,7 @@ void Query_cache::pack_cache()
     DUMP(this);
   }
 
-  DBUG_EXECUTE("check_querycache",query_cache.check_integrity(1););
+  DBUG_EXECUTE("check_querycache",check_integrity(1););
   DBUG_VOID_RETURN;
 }
 
@@ -62,6 +62,9 @@ typedef struct st_changed_table_list CHANGED_TABLE_LIST;
    of list of free blocks */
 #define QUERY_CACHE_MEM_BIN_TRY                 5
 
+/* maximum number of query cache partitions */
+#define QUERY_CACHE_MAX_PARTITIONS		64
+
 /* packing parameters */
 #define QUERY_CACHE_PACK_ITERATION		2
 #define QUERY_CACHE_PACK_LIMIT			(512*1024L)
@@ -74,6 +77,7 @@ struct Query_cache_table;
 struct Query_cache_query;
 struct Query_cache_result;
 class Query_cache;
+class Partitioned_query_cache;
 struct Query_cache_tls;
 struct LEX;
 class THD;
@@ -287,14 +291,22 @@ struct Query_cache_memory_bin_step
   }
 };
 
+/**
+  One partition of the query cache, see Partitioned_query_cache.
+  Each partition has its own memory, query hash, table hash and lock.
+*/
+
 class Query_cache
 {
+  friend class Partitioned_query_cache;
 public:
   /* Info */
   ulong query_cache_size, query_cache_limit;
   /* statistics */
   ulong free_memory, queries_in_cache, hits, inserts, refused,
     free_memory_blocks, total_blocks, lowmem_prunes;
+  /* times a thread waited for the lock, and gave up waiting */
+  ulong lock_waits, lock_timeouts;
 
 
 private:
@@ -360,8 +372,6 @@ protected:
 			      ulong data_len,
 			      Query_cache_block *query_block,
 			      my_bool first_block);
-  void invalidate_table(THD *thd, TABLE_LIST *table);
-  void invalidate_table(THD *thd, TABLE *table);
   void invalidate_table(THD *thd, uchar *key, uint32  key_length);
   void invalidate_table(THD *thd, Query_cache_block *table_block);
   void invalidate_query_block_list(THD *thd, 
@@ -427,12 +437,12 @@ protected:
     If query is cacheable return number tables in query
     (query without tables not cached)
   */
-  TABLE_COUNTER_TYPE is_cacheable(THD *thd,
-                                  LEX *lex, TABLE_LIST *tables_used,
-                                  uint8 *tables_type);
-  TABLE_COUNTER_TYPE process_and_count_tables(THD *thd,
-                                              TABLE_LIST *tables_used,
-                                              uint8 *tables_type);
+  static TABLE_COUNTER_TYPE is_cacheable(THD *thd,
+                                         LEX *lex, TABLE_LIST *tables_used,
+                                         uint8 *tables_type);
+  static TABLE_COUNTER_TYPE process_and_count_tables(THD *thd,
+                                                     TABLE_LIST *tables_used,
+                                                     uint8 *tables_type);
 
   static my_bool ask_handler_allowance(THD *thd, TABLE_LIST *tables_used);
  public:
@@ -456,30 +466,20 @@ protected:
   /* set minimal result data allocation unit size */
   ulong set_min_res_unit(ulong size);
 
-  /* register query in cache */
-  void store_query(THD *thd, TABLE_LIST *used_tables);
+  /* register query with the given key in cache */
+  void store_query(THD *thd, TABLE_LIST *used_tables,
+                   const char *key, ulong key_length,
+                   TABLE_COUNTER_TYPE local_tables, uint8 tables_type);
 
   /*
-    Check if the query is in the cache and if this is true send the
-    data to client.
+    Check if the query with the given key is in the cache and if this is
+    true send the data to client.
   */
-  int send_result_to_client(THD *thd, char *query, uint query_length);
-
-  /* Remove all queries that uses any of the listed following tables */
-  void invalidate(THD *thd, TABLE_LIST *tables_used,
-		  my_bool using_transactions);
-  void invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used);
-  void invalidate_locked_for_write(THD *thd, TABLE_LIST *tables_used);
-  void invalidate(THD *thd, TABLE *table, my_bool using_transactions);
-  void invalidate(THD *thd, const char *key, uint32  key_length,
-		  my_bool using_transactions);
+  int send_result_to_client(THD *thd, const char *key, ulong key_length);
 
   /* Remove all queries that uses any of the tables in following database */
   void invalidate(THD *thd, char *db);
 
-  /* Remove all queries that uses any of the listed following table */
-  void invalidate_by_MyISAM_filename(const char *filename);
-
   void flush();
   void pack(THD *thd,
             ulong join_limit = QUERY_CACHE_PACK_LIMIT,
@@ -533,6 +533,100 @@ protected:
   void disable_query_cache(THD *thd);
 };
 
+
+/**
+  The query cache, split into independently locked partitions.
+
+  Every partition is a complete Query_cache. A statement is stored in and
+  served from the partition its key (text, database and flags) hashes to,
+  so lookups in one partition never wait for stores, lookups or
+  invalidations in another one. Each partition keeps its own table hash
+  of the tables its queries use; invalidation of a table visits the
+  partitions one at a time.
+*/
+
+class Partitioned_query_cache
+{
+public:
+  /* Info */
+  ulong query_cache_size;                       // of all partitions
+
+private:
+  Query_cache default_partition;                // used while there is one
+  Query_cache *partitions;
+  uint n_partitions;
+  /* statements refused before a partition was chosen */
+  ulong refused;
+
+  Query_cache *get_partition(const char *key, ulong key_length);
+  void invalidate_table(THD *thd, TABLE_LIST *table);
+  void invalidate_table(THD *thd, TABLE *table);
+  void invalidate_table(THD *thd, uchar *key, uint32 key_length);
+
+public:
+  Partitioned_query_cache();
+
+  inline uint partition_count() { return n_partitions; }
+  inline Query_cache *partition(uint i) { return partitions + i; }
+
+  inline bool is_disabled(void) { return partitions->is_disabled(); }
+  inline bool is_disable_in_progress(void)
+  { return partitions->is_disable_in_progress(); }
+
+  /* initialize cache with query_cache_partitions partitions */
+  void init();
+  void destroy();
+  /* resize query cache (return real query size, 0 if disabled) */
+  ulong resize(ulong query_cache_size);
+  void result_size_limit(ulong limit);
+  ulong set_min_res_unit(ulong size);
+  void disable_query_cache(THD *thd);
+
+  /* register query in cache */
+  void store_query(THD *thd, TABLE_LIST *used_tables);
+
+  /*
+    Check if the query is in the cache and if this is true send the
+    data to client.
+  */
+  int send_result_to_client(THD *thd, char *query, uint query_length);
+
+  /* Remove all queries that uses any of the listed following tables */
+  void invalidate(THD *thd, TABLE_LIST *tables_used,
+		  my_bool using_transactions);
+  void invalidate(THD *thd, CHANGED_TABLE_LIST *tables_used);
+  void invalidate_locked_for_write(THD *thd, TABLE_LIST *tables_used);
+  void invalidate(THD *thd, TABLE *table, my_bool using_transactions);
+  void invalidate(THD *thd, const char *key, uint32  key_length,
+		  my_bool using_transactions);
+
+  /* Remove all queries that uses any of the tables in following database */
+  void invalidate(THD *thd, char *db);
+
+  /* Remove all queries that uses any of the listed following table */
+  void invalidate_by_MyISAM_filename(const char *filename);
+
+  void flush();
+  void pack(THD *thd,
+            ulong join_limit = QUERY_CACHE_PACK_LIMIT,
+	    uint iteration_limit = QUERY_CACHE_PACK_ITERATION);
+
+  void insert(Query_cache_tls *query_cache_tls,
+              const char *packet,
+              ulong length,
+              unsigned pkt_nr);
+  void end_of_result(THD *thd);
+  void abort(Query_cache_tls *query_cache_tls);
+
+  /* Statistics summed over all partitions */
+  ulong total(ulong Query_cache::*counter);
+  void reset_counters();
+
+  /* Debugging, see Query_cache */
+  void wreck(uint line, const char *message);
+  my_bool check_integrity(bool not_locked);
+};
+
 #ifdef HAVE_QUERY_CACHE
 struct Query_cache_query_flags
 {
@@ -596,5 +690,5 @@ struct Query_cache_query_flags
 #define query_cache_is_cacheable_query(L) 0
 #endif /*HAVE_QUERY_CACHE*/
 
-extern Query_cache query_cache;
+extern Partitioned_query_cache query_cache;
 #endif
@@ -65,6 +65,7 @@
 #include "sql_callback.h"
 #include "lock.h"
 #include "sql_connect.h"
+#include "sql_parse_cache.h"                    // parse_cache_free
 
 /*
   The following is used to initialise Table_ident with a internal
@@ -862,6 +863,7 @@ bool Drop_table_error_handler::handle_condition(THD *thd,
 THD::THD()
    :Statement(&main_lex, &main_mem_root, STMT_CONVENTIONAL_EXECUTION,
               /* statement id */ 0),
+   tdc_hash_pins(0),
    rli_fake(0), rgi_fake(0), rgi_slave(NULL),
    in_sub_stmt(0), log_all_errors(0),
    binlog_unsafe_warning_flags(0),
@@ -1017,6 +1019,7 @@ THD::THD()
 
   sp_proc_cache= NULL;
   sp_func_cache= NULL;
+  parse_cache= NULL;
 
   /* For user vars replication*/
   if (opt_bin_log)
@@ -1493,6 +1496,7 @@ void THD::change_user(void)
   cleanup_done= 0;
   init();
   stmt_map.reset();
+  parse_cache_free(this);
   my_hash_init(&user_vars, system_charset_info, USER_VARS_HASH_SIZE, 0, 0,
                (my_hash_get_key) get_var_key,
                (my_hash_free_key) free_user_var, 0);
@@ -1588,10 +1592,12 @@ THD::~THD()
   net_end(&net);
 #endif
   stmt_map.reset();                     /* close all prepared statements */
+  parse_cache_free(this);
   if (!cleanup_done)
     cleanup();
 
   mdl_context.destroy();
+  tdc_release_pins(this);
   ha_close_connection(this);
   mysql_audit_release(this);
   plugin_thdvar_cleanup(this);
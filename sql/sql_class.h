@@ -67,6 +67,7 @@ class Load_log_event;
 class Slave_log_event;
 class sp_rcontext;
 class sp_cache;
+class Parse_cache;
 class Lex_input_stream;
 class Parser_state;
 class Rows_log_event;
@@ -378,6 +379,7 @@ class MY_LOCALE;
 */
 
 struct Query_cache_block;
+class Query_cache;
 
 struct Query_cache_tls
 {
@@ -386,12 +388,17 @@ struct Query_cache_tls
     functions and methods to maintain proper locking.
   */
   Query_cache_block *first_query_block;
+  /*
+    The query cache partition 'first_query_block' was allocated in;
+    set together with it and never reset.
+  */
+  Query_cache *partition;
   void set_first_query_block(Query_cache_block *first_query_block_arg)
   {
     first_query_block= first_query_block_arg;
   }
 
-  Query_cache_tls() :first_query_block(NULL) {}
+  Query_cache_tls() :first_query_block(NULL), partition(NULL) {}
 };
 
 /* SIGNAL / RESIGNAL / GET DIAGNOSTICS */
@@ -558,6 +565,7 @@ typedef struct system_variables
   ulong profiling_history_size;
   ulong read_buff_size;
   ulong read_rnd_buff_size;
+  ulong sort_threads;
   ulong mrr_buff_size;
   ulong div_precincrement;
   /* Total size of all buffers used by the subselect_rowid_merge_engine. */
@@ -568,6 +576,7 @@ typedef struct system_variables
   ulong range_alloc_block_size;
   ulong query_alloc_block_size;
   ulong query_prealloc_size;
+  ulong parse_cache_size;
   ulong trans_alloc_block_size;
   ulong trans_prealloc_size;
   ulong log_warnings;
@@ -575,6 +584,8 @@ typedef struct system_variables
   ulong log_slow_rate_limit; 
   ulong binlog_format; ///< binlog format for this thd (see enum_binlog_format)
   ulong progress_report_time;
+  ulong threadpool_high_prio_mode;
+  uint threadpool_high_prio_tickets;
   my_bool binlog_annotate_row_events;
   my_bool binlog_direct_non_trans_update;
   my_bool sql_log_bin;
@@ -610,6 +621,7 @@ typedef struct system_variables
   my_bool old_passwords;
   my_bool big_tables;
   my_bool query_cache_strip_comments;
+  my_bool prepared_plan_cache;
 
   plugin_ref table_plugin;
 
@@ -640,6 +652,7 @@ typedef struct system_variables
   ulong wt_timeout_long, wt_deadlock_search_depth_long;
 
   double long_query_time_double;
+  double analyze_sample_percentage;
 
   my_bool pseudo_slave_mode;
 
@@ -715,6 +728,10 @@ typedef struct system_status_var
   ulong com_stmt_fetch;
   ulong com_stmt_reset;
   ulong com_stmt_close;
+  ulong prepared_plan_cache_hits;
+  ulong prepared_plan_cache_replans;
+  ulong parse_cache_hits;
+  ulong parse_cache_misses;
 
   /* Features used */
   ulong feature_dynamic_columns;    /* +1 when creating a dynamic column */
@@ -1818,6 +1835,8 @@ private:
 
 public:
   MDL_context mdl_context;
+  /* Pins of the table definition cache hash, see tdc_acquire_share() */
+  LF_PINS *tdc_hash_pins;
 
   /* Used to execute base64 coded binlog events in MySQL server */
   Relay_log_info* rli_fake;
@@ -1889,6 +1908,8 @@ public:
 
   /* all prepared statements and cursors of this connection */
   Statement_map stmt_map;
+  /* the statements prepared by the parse cache, see sql_parse_cache.h */
+  Parse_cache *parse_cache;
   /*
     A pointer to the stack frame of handle_one_connection(),
     which is called first in the thread for handling a client
@@ -74,6 +74,7 @@
 
 #define MAX_SORT_MEMORY 2048*1024
 #define MIN_SORT_MEMORY 1024
+#define MAX_SORT_THREADS 16
 
 /* Some portable defines */
 
@@ -324,6 +324,8 @@ typedef struct st_explain_bka_type
 {
   bool incremental;
   const char *join_alg;
+  /* The number of partitions of the grace hash join, 0 if not used */
+  uint partitions;
   StringBuffer<64> mrr_type;
 
 } EXPLAIN_BKA_TYPE;
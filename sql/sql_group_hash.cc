@@ -0,0 +1,229 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+  In-memory hash table for GROUP BY with aggregate functions
+*/
+
+#include "sql_priv.h"
+#include "sql_group_hash.h"
+#include "key.h"                                /* key_hashnr */
+
+#define GROUP_HASH_INIT_SIZE   256
+#define GROUP_HASH_BLOCK_SIZE  (32*1024)
+
+
+/*
+  Initialize the hash table
+
+  SYNOPSIS
+    init()
+      group_arg        the grouping expressions of the temporary table
+      group_buff_arg   the group buffer of the temporary table
+      key_info_arg     descriptor of the group key of the temporary table
+      key_parts_arg    number of the parts of the group key
+      key_length_arg   length of the group key in the group buffer
+      rec_length_arg   length of the records of the temporary table
+      max_memory_arg   memory the hash table is allowed to use
+
+  RETURN VALUE
+    TRUE    out of memory
+    FALSE   otherwise
+*/
+
+bool Group_hash_table::init(ORDER *group_arg, uchar *group_buff_arg,
+                            KEY *key_info_arg, uint key_parts_arg,
+                            uint key_length_arg, uint rec_length_arg,
+                            size_t max_memory_arg)
+{
+  DBUG_ENTER("Group_hash_table::init");
+  free();
+  group= group_arg;
+  group_buff= group_buff_arg;
+  key_info= key_info_arg;
+  key_parts= key_parts_arg;
+  key_length= key_length_arg;
+  rec_length= rec_length_arg;
+  max_memory= max_memory_arg;
+  key_offset= ALIGN_SIZE(sizeof(Entry));
+  rec_offset= key_offset + ALIGN_SIZE(key_length);
+
+  hash_size= GROUP_HASH_INIT_SIZE;
+  if (!(hash_table= (Entry**) my_malloc(hash_size * sizeof(Entry*),
+                                        MYF(MY_WME | MY_ZEROFILL |
+                                            MY_THREAD_SPECIFIC))))
+    DBUG_RETURN(TRUE);
+  init_sql_alloc(&mem_root, GROUP_HASH_BLOCK_SIZE, 0, MYF(MY_THREAD_SPECIFIC));
+  used_memory= hash_size * sizeof(Entry*);
+  elements= 0;
+  first= curr= 0;
+  last_next= &first;
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Double the size of the array of the hash table and rehash the entries
+*/
+
+bool Group_hash_table::grow()
+{
+  ulong new_size= hash_size * 2;
+  ulong mask= new_size - 1;
+  Entry **new_table;
+
+  if (!(new_table= (Entry**) my_malloc(new_size * sizeof(Entry*),
+                                       MYF(MY_WME | MY_ZEROFILL |
+                                           MY_THREAD_SPECIFIC))))
+    return TRUE;
+  for (Entry *entry= first; entry; entry= entry->next)
+  {
+    ulong idx= entry->hash_value & mask;
+    while (new_table[idx])
+      idx= (idx + 1) & mask;
+    new_table[idx]= entry;
+  }
+  my_free(hash_table);
+  used_memory+= (new_size - hash_size) * sizeof(Entry*);
+  hash_table= new_table;
+  hash_size= new_size;
+  return FALSE;
+}
+
+
+/*
+  Compare two keys in the format of the group buffer
+
+  RETURN VALUE
+    TRUE    the keys are different
+    FALSE   the keys are equal
+*/
+
+bool Group_hash_table::key_cmp(const uchar *key1, const uchar *key2)
+{
+  for (ORDER *ord= group; ord; ord= ord->next)
+  {
+    size_t offset= (uchar*) ord->buff - group_buff;
+    const uchar *pos1= key1 + offset;
+    const uchar *pos2= key2 + offset;
+    if ((*ord->item)->maybe_null)
+    {
+      /* The NULL flag is just before the value, see end_update() */
+      if (pos1[-1] != pos2[-1])
+        return TRUE;
+      if (pos1[-1])
+        continue;
+    }
+    if (ord->field->cmp(pos1, pos2))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/*
+  Find the group with the given key or add a new one
+
+  SYNOPSIS
+    find_or_add()
+      key     the value of the group key in the format of the group buffer
+      added   OUT: TRUE if a new group has been added
+
+  DESCRIPTION
+    The function looks for the entry of the group with the given key.
+    If there is no such group and the memory allowed for the hash table is
+    not exhausted a new entry is added with the copy of the key. The record
+    image of a new entry is not initialized.
+
+  RETURN VALUE
+    pointer to the record image of the group, or NULL if the group is
+    not found and the hash table is full
+*/
+
+uchar *Group_hash_table::find_or_add(const uchar *key, bool *added)
+{
+  ulong hash_value= key_hashnr(key_info, key_parts, key);
+  ulong mask= hash_size - 1;
+  ulong idx= hash_value & mask;
+  Entry *entry;
+
+  *added= FALSE;
+  while ((entry= hash_table[idx]))
+  {
+    if (entry->hash_value == hash_value &&
+        !key_cmp((uchar*) entry + key_offset, key))
+      return (uchar*) entry + rec_offset;
+    idx= (idx + 1) & mask;
+  }
+
+  size_t size= rec_offset + rec_length;
+  if (used_memory + size > max_memory)
+    return NULL;
+  /* Keep the load factor below 1/2 */
+  if ((elements + 1) * 2 > hash_size)
+  {
+    if (used_memory + size + hash_size * sizeof(Entry*) > max_memory ||
+        grow())
+      return NULL;
+    mask= hash_size - 1;
+    for (idx= hash_value & mask; hash_table[idx]; idx= (idx + 1) & mask) ;
+  }
+  if (!(entry= (Entry*) alloc_root(&mem_root, size)))
+    return NULL;
+  used_memory+= size;
+  entry->next= 0;
+  entry->hash_value= hash_value;
+  memcpy((uchar*) entry + key_offset, key, key_length);
+  *last_next= entry;
+  last_next= &entry->next;
+  hash_table[idx]= entry;
+  elements++;
+  *added= TRUE;
+  return (uchar*) entry + rec_offset;
+}
+
+
+/*
+  Remove all groups from the hash table keeping it initialized
+*/
+
+void Group_hash_table::reset()
+{
+  if (!hash_table)
+    return;
+  free_root(&mem_root, MYF(MY_MARK_BLOCKS_FREE));
+  bzero(hash_table, hash_size * sizeof(Entry*));
+  used_memory= hash_size * sizeof(Entry*);
+  elements= 0;
+  first= curr= 0;
+  last_next= &first;
+}
+
+
+void Group_hash_table::free()
+{
+  if (!hash_table)
+    return;
+  free_root(&mem_root, MYF(0));
+  my_free(hash_table);
+  hash_table= 0;
+  hash_size= 0;
+  elements= 0;
+  first= curr= 0;
+}
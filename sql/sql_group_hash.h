@@ -0,0 +1,107 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_GROUP_HASH_INCLUDED
+#define SQL_GROUP_HASH_INCLUDED
+
+#include "sql_class.h"                          /* Sql_alloc */
+
+/*
+  In-memory hash table for grouping with aggregate functions
+
+  The table maps the values of the group key, as built in the group buffer
+  of the temporary table for GROUP BY, to images of the records of the
+  temporary table holding the values of the aggregate functions for the
+  groups. This allows end_hash_update() to aggregate the rows of a join
+  without a lookup in the index of the temporary table for each row:
+  the records are written into the temporary table only once per group.
+
+  The hash table uses open addressing with linear probing over an array of
+  pointers to the entries. The entries are allocated in a memory root and
+  are linked in the order of their insertion, so that the groups are
+  written into the temporary table in the same order as by end_update().
+  Keys are hashed with key_hashnr() and compared with the fields of the
+  group buffer, so that the groups are the same as in the index of the
+  temporary table: e.g. the values 'a' and 'a ' of a VARCHAR column are in
+  the same group.
+*/
+
+class Group_hash_table :public Sql_alloc
+{
+  struct Entry
+  {
+    Entry *next;                                /* next in insertion order */
+    ulong hash_value;
+  };
+
+  MEM_ROOT mem_root;                            /* memory for the entries */
+  ORDER *group;
+  uchar *group_buff;
+  KEY *key_info;
+  uint key_parts;
+  uint key_length;
+  uint rec_length;
+  /* Offsets of the key and of the record image in an entry */
+  uint key_offset, rec_offset;
+
+  Entry **hash_table;
+  ulong hash_size;                              /* always a power of 2 */
+  ulong elements;
+  Entry *first, **last_next;
+  Entry *curr;                                  /* iterator position */
+
+  size_t used_memory, max_memory;
+
+  bool grow();
+  bool key_cmp(const uchar *key1, const uchar *key2);
+
+public:
+  Group_hash_table() :hash_table(0), hash_size(0), elements(0), first(0),
+    curr(0), used_memory(0), max_memory(0) {}
+  ~Group_hash_table() { free(); }
+
+  bool init(ORDER *group_arg, uchar *group_buff_arg, KEY *key_info_arg,
+            uint key_parts_arg, uint key_length_arg, uint rec_length_arg,
+            size_t max_memory_arg);
+
+  uchar *find_or_add(const uchar *key, bool *added);
+
+  /* Iterate over the records of the groups in the order of insertion */
+  uchar *first_record()
+  {
+    curr= first;
+    return curr ? (uchar*) curr + rec_offset : NULL;
+  }
+  uchar *next_record()
+  {
+    curr= curr->next;
+    return curr ? (uchar*) curr + rec_offset : NULL;
+  }
+
+  ulong get_elements() { return elements; }
+
+  /* Size of memory taken by one group, used by the cost estimates */
+  static size_t entry_size(uint key_length, uint rec_length)
+  {
+    return ALIGN_SIZE(sizeof(Entry)) + ALIGN_SIZE(key_length) + rec_length +
+           2 * sizeof(Entry*);
+  }
+
+  void reset();
+  void free();
+};
+
+#endif /* SQL_GROUP_HASH_INCLUDED */
@@ -2801,7 +2801,10 @@ pthread_handler_t handle_delayed_insert(void *arg)
       the target table for the insert and add them to the list of granted
       metadata locks held by the handler thread. This is safe since the
       handler thread is not holding nor waiting on any metadata locks.
+      Conflicting lock requests kill the handler thread, so its locks
+      must be visible to them (see THD::notify_shared_lock()).
     */
+    thd->mdl_context.disable_fast_path();
     if (thd->mdl_context.clone_ticket(&di->grl_protection) ||
         thd->mdl_context.clone_ticket(&di->table_list.mdl_request))
     {
@@ -3031,7 +3034,7 @@ bool Delayed_insert::handle_inserts(void)
 
   THD_STAGE_INFO(&thd, stage_insert);
   max_rows= delayed_insert_limit;
-  if (thd.killed || table->s->tdc.flushed)
+  if (thd.killed || table->s->tdc->flushed)
   {
     thd.killed= KILL_SYSTEM_THREAD;
     max_rows= ULONG_MAX;                     // Do as much as possible
@@ -2577,6 +2577,7 @@ finish:
 void JOIN_CACHE::save_explain_data(struct st_explain_bka_type *explain)
 {
   explain->incremental= MY_TEST(prev_cache);
+  explain->partitions= 0;
 
   switch (get_join_alg()) {
   case BNL_JOIN_ALG:
@@ -3102,6 +3103,23 @@ bool JOIN_CACHE_HASHED::key_search(uchar *key, uint key_len,
 } 
 
 
+/* Calculate the hash value of a key considered as a byte array */
+
+static inline ulong key_bytes_hashnr(uchar *key, uint key_len)
+{
+  ulong nr= 1;
+  ulong nr2= 4;
+  uchar *pos= key;
+  uchar *end= key+key_len;
+  for (; pos < end ; pos++)
+  {
+    nr^= (ulong) ((((uint) nr & 63)+nr2)*((uint) *pos))+ (nr << 8);
+    nr2+= 3;
+  }
+  return nr;
+}
+
+
 /* 
   Hash function that considers a key in the hash table as byte array
 
@@ -3122,16 +3140,7 @@ bool JOIN_CACHE_HASHED::key_search(uchar *key, uint key_len,
 inline
 uint JOIN_CACHE_HASHED::get_hash_idx_simple(uchar* key, uint key_len)
 {
-  ulong nr= 1;
-  ulong nr2= 4;
-  uchar *pos= key;
-  uchar *end= key+key_len;
-  for (; pos < end ; pos++)
-  {
-    nr^= (ulong) ((((uint) nr & 63)+nr2)*((uint) *pos))+ (nr << 8);
-    nr2+= 3;
-  }
-  return nr % hash_entries;
+  return key_bytes_hashnr(key, key_len) % hash_entries;
 }
 
 
@@ -3166,6 +3175,32 @@ uint JOIN_CACHE_HASHED::get_hash_idx_complex(uchar *key, uint key_len)
 }
 
 
+/*
+  Get the hash value of a key
+
+  SYNOPSIS
+    get_hash_value()
+      key             pointer to the key value
+      key_len         key value length
+
+  DESCRIPTION
+    The function calculates the hash value for the given key the same way
+    as the hash function of the hash table does, but does not reduce it to
+    an index of a hash entry. Equal keys get equal hash values even if they
+    differ as byte sequences.
+
+  RETURN VALUE
+    the hash value for the given key
+*/
+
+ulong JOIN_CACHE_HASHED::get_hash_value(uchar *key, uint key_len)
+{
+  if (hash_func == &JOIN_CACHE_HASHED::get_hash_idx_complex)
+    return key_hashnr(ref_key_info, ref_used_key_parts, key);
+  return key_bytes_hashnr(key, key_len);
+}
+
+
 /* 
   Compare two key entries in the hash table as sequence of bytes
 
@@ -3452,6 +3487,148 @@ void JOIN_TAB_SCAN::close()
 }
 
 
+/*
+  Write the current row of the joined table into a partition file
+
+  SYNOPSIS
+    write_row()
+      part_file   the partition file to write into
+
+  DESCRIPTION
+    The function writes the image of the record buffer of join_tab into
+    the partition file followed by the data of the non-null blob fields
+    from the read set of the table.
+
+  RETURN VALUE
+    TRUE    the write has failed
+    FALSE   otherwise
+*/
+
+bool JOIN_TAB_SCAN_PARTITION::write_row(IO_CACHE *part_file)
+{
+  TABLE *table= join_tab->table;
+  uint reclength= table->s->reclength;
+  size_t length= reclength;
+  uchar len_buff[4];
+  uint i;
+
+  for (i= 0; i < table->s->blob_fields; i++)
+  {
+    Field_blob *blob_field=
+      (Field_blob *) table->field[table->s->blob_field[i]];
+    if (bitmap_is_set(table->read_set, blob_field->field_index) &&
+        !blob_field->is_null())
+      length+= blob_field->get_length();
+  }
+  int4store(len_buff, length);
+  if (my_b_write(part_file, len_buff, sizeof(len_buff)) ||
+      my_b_write(part_file, table->record[0], reclength))
+    return TRUE;
+  for (i= 0; i < table->s->blob_fields; i++)
+  {
+    Field_blob *blob_field=
+      (Field_blob *) table->field[table->s->blob_field[i]];
+    if (bitmap_is_set(table->read_set, blob_field->field_index) &&
+        !blob_field->is_null())
+    {
+      uchar *data;
+      blob_field->get_ptr(&data);
+      if (my_b_write(part_file, data, blob_field->get_length()))
+        return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+
+/*
+  Initiate the iteration over the rows of join_tab from a partition
+
+  SYNOPSIS
+    open()
+
+  RETURN VALUE   
+    0            the initiation is a success 
+    error code   otherwise     
+*/
+
+int JOIN_TAB_SCAN_PARTITION::open()
+{
+  save_or_restore_used_tabs(join_tab, FALSE);
+  rows_left= rows;
+  if (rows && reinit_io_cache(file, READ_CACHE, 0L, 0, 0))
+    return 1;
+  return 0;
+}
+
+
+/*
+  Read the next row of join_tab from the partition
+
+  SYNOPSIS
+    next()
+
+  DESCRIPTION
+    The function restores the next row written by write_row() into
+    the record buffer of join_tab. The blob fields refer to the data
+    in the buffer row_buff. The rows in the partition have already
+    been checked against the condition pushed to join_tab.
+
+  RETURN VALUE   
+    0            the next row has been successfully read
+    -1           there are no more rows in the partition
+    1            an error occurred
+*/
+
+int JOIN_TAB_SCAN_PARTITION::next()
+{
+  TABLE *table= join_tab->table;
+  uint reclength= table->s->reclength;
+  uchar len_buff[4];
+  size_t length;
+  uchar *data;
+
+  if (!rows_left)
+    return -1;
+  rows_left--;
+  if (my_b_read(file, len_buff, sizeof(len_buff)))
+    return 1;
+  length= uint4korr(len_buff);
+  if (length > row_buff_length)
+  {
+    if (!(row_buff= (uchar *) my_realloc(row_buff, length,
+                                         MYF(MY_WME | MY_ALLOW_ZERO_PTR |
+                                             MY_FREE_ON_ERROR |
+                                             MY_THREAD_SPECIFIC))))
+    {
+      row_buff_length= 0;
+      return 1;
+    }
+    row_buff_length= length;
+  }
+  if (my_b_read(file, row_buff, length))
+    return 1;
+
+  memcpy(table->record[0], row_buff, reclength);
+  data= row_buff+reclength;
+  for (uint i= 0; i < table->s->blob_fields; i++)
+  {
+    Field_blob *blob_field=
+      (Field_blob *) table->field[table->s->blob_field[i]];
+    if (bitmap_is_set(table->read_set, blob_field->field_index) &&
+        !blob_field->is_null())
+    {
+      uint32 blob_len= blob_field->get_length();
+      blob_field->set_ptr(blob_len, data);
+      data+= blob_len;
+    }
+  }
+  table->status= 0;
+  table->null_row= 0;
+  return 0;
+}
+
+
 /*
   Prepare to iterate over the BNL join cache buffer to look for matches 
 
@@ -3783,12 +3960,598 @@ void JOIN_CACHE_BNLH::read_next_candidate_for_match(uchar *rec_ptr)
 
 int JOIN_CACHE_BNLH::init(bool for_explain)
 {
+  int rc;
   DBUG_ENTER("JOIN_CACHE_BNLH::init");
 
   if (!(join_tab_scan= new JOIN_TAB_SCAN(join, join_tab)))
     DBUG_RETURN(1);
 
-  DBUG_RETURN(JOIN_CACHE_HASHED::init(for_explain));
+  if ((rc= JOIN_CACHE_HASHED::init(for_explain)))
+    DBUG_RETURN(rc);
+
+  choose_partitions();
+  if (partitions && !for_explain &&
+      !(partition_scan= new JOIN_TAB_SCAN_PARTITION(join, join_tab)))
+    partitions= 0;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Reallocate the join buffer of the BNLH join cache
+
+  DESCRIPTION
+    Additionally to what the parent implementation does the function
+    chooses the number of partitions for the grace hash join again,
+    as it depends on the size of the join buffer.
+*/
+
+int JOIN_CACHE_BNLH::realloc_buffer()
+{
+  int rc= JOIN_CACHE_HASHED::realloc_buffer();
+  choose_partitions();
+  if (partitions && !partition_scan &&
+      !(partition_scan= new JOIN_TAB_SCAN_PARTITION(join, join_tab)))
+    partitions= 0;
+  return rc;
+}
+
+
+/*
+  Choose the number of partitions for the grace hash join
+
+  SYNOPSIS
+    choose_partitions()
+
+  DESCRIPTION
+    If the records of the partial join are not expected to fit into the
+    join buffer, the BNLH join algorithm scans join_tab once for each
+    refill of the buffer. The grace hash join reads join_tab only once:
+    the records of the partial join and the rows of join_tab are written
+    into partition files by the hash value of the join key, and then the
+    records of each partition are loaded into the join buffer and joined
+    with the rows of join_tab from the same partition.
+    The function compares the cost of the repeated scans of join_tab with
+    the cost of writing and reading both sides of the join, and sets the
+    number of partitions such that each partition is expected to fit into
+    the join buffer.
+    The grace hash join is not used for linked caches, as their records
+    refer to the records in the previous join buffers, and when the rowids
+    of join_tab are needed, as the rows are read back from the partitions.
+
+  RETURN VALUE
+    none
+*/
+
+void JOIN_CACHE_BNLH::choose_partitions()
+{
+  partitions= 0;
+  if (prev_cache || join_tab->keep_current_rowid || !buff_size ||
+      !optimizer_flag(join->thd, OPTIMIZER_SWITCH_JOIN_CACHE_GRACE))
+    return;
+
+  TABLE *table= join_tab->table;
+  double records= (join_tab-1)->get_partial_join_cardinality();
+  double refills= records * space_per_record / buff_size;
+  if (refills <= 1)
+    return;
+
+  double rows= (double) table->file->stats.records;
+  double scan_cost= table->file->scan_time() + rows / TIME_FOR_COMPARE;
+  double spill_cost= 2 * (records * avg_record_length +
+                          rows * table->s->reclength) / IO_SIZE;
+  if ((ceil(refills) - 1) * scan_cost <= spill_cost)
+    return;
+
+  /* Leave some room for an uneven distribution of the keys */
+  partitions= (uint) MY_MIN(ceil(refills * 1.25), JOIN_CACHE_MAX_PARTITIONS);
+  DBUG_PRINT("info", ("grace hash join partitions: %u", partitions));
+}
+
+
+/* Get the number of the partition for a join key */
+
+uint JOIN_CACHE_BNLH::get_partition_no(uchar *key)
+{
+  /*
+    Mix the hash value, so that the partition does not determine the
+    hash table entry of the key when the partition is loaded
+  */
+  ulonglong nr= (ulonglong) get_hash_value(key, key_length) *
+                0x9E3779B97F4A7C15ULL;
+  return (uint) ((nr >> 32) % partitions);
+}
+
+
+/* Open a partition file for writing if it has not been opened yet */
+
+bool JOIN_CACHE_BNLH::open_partition_file(IO_CACHE *file)
+{
+  if (my_b_inited(file))
+    return FALSE;
+  size_t cache_size= buff_size / partitions;
+  set_if_bigger(cache_size, IO_SIZE);
+  set_if_smaller(cache_size, DISK_BUFFER_SIZE);
+  return open_cached_file(file, mysql_tmpdir, TEMP_PREFIX, cache_size,
+                          MYF(MY_WME));
+}
+
+
+/* Close the partition files and forget the records written into them */
+
+void JOIN_CACHE_BNLH::close_partition_files()
+{
+  if (outer_files)
+  {
+    for (uint i= 0; i < partitions; i++)
+    {
+      close_cached_file(&outer_files[i]);
+      close_cached_file(&inner_files[i]);
+      outer_records[i]= inner_records[i]= 0;
+    }
+  }
+  spilled= FALSE;
+  spill_error= FALSE;
+}
+
+
+/*
+  Move the records of the partial join from the join buffer into partitions
+
+  SYNOPSIS
+    spill_join_buffer()
+
+  DESCRIPTION
+    The function is called when the join buffer becomes full for the first
+    time and the grace hash join is to be used. It writes all records from
+    the join buffer into the partition files, after which all the following
+    records of the partial join are written directly into the partitions.
+    The record buffers are restored to the last record put into the buffer,
+    as the previous tables continue the iteration over their records.
+
+  RETURN VALUE
+    TRUE    writing into a partition has failed
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::spill_join_buffer()
+{
+  DBUG_ENTER("JOIN_CACHE_BNLH::spill_join_buffer");
+  DBUG_PRINT("info", ("spilling %lu records into %u partitions",
+                      (ulong) records, partitions));
+
+  if (!outer_files)
+  {
+    if (!(outer_files= (IO_CACHE *) join->thd->calloc(2 * partitions *
+                                                      sizeof(IO_CACHE))) ||
+        !(outer_records= (ha_rows *) join->thd->calloc(2 * partitions *
+                                                       sizeof(ha_rows))))
+    {
+      outer_files= 0;
+      spill_error= TRUE;
+      DBUG_RETURN(TRUE);
+    }
+    inner_files= outer_files + partitions;
+    inner_records= outer_records + partitions;
+  }
+  spilled= TRUE;
+
+  reset(FALSE);
+  while (!get_record())
+  {
+    if (write_spilled_record())
+      break;
+  }
+  restore_last_record();
+  reset(TRUE);
+  DBUG_RETURN(spill_error);
+}
+
+
+/*
+  Write the record of the partial join into its partition
+
+  SYNOPSIS
+    write_spilled_record()
+
+  DESCRIPTION
+    The function writes the fields of the record of the partial join from
+    the record buffers into the partition file determined by the join key
+    built over the record. The same fields as in the join buffer are
+    written, blob values are written together with their data.
+
+  RETURN VALUE
+    TRUE    writing into the partition has failed
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::write_spilled_record()
+{
+  TABLE_REF *ref= &join_tab->ref;
+  CACHE_FIELD *copy;
+  CACHE_FIELD *copy_end= field_descr+fields;
+  CACHE_FIELD *flags_end= field_descr+flag_fields;
+  size_t len= 0;
+  uint part;
+  uchar *cp;
+
+  cp_buffer_from_ref(join->thd, join_tab->table, ref);
+  part= get_partition_no(ref->key_buff);
+
+  /* The match flag is not written: it is set anew when the record is read */
+  for (copy= field_descr+MY_TEST(with_match_flag); copy < copy_end; copy++)
+  {
+    if (copy->type == CACHE_ROWID && !copy->length)
+    {
+      /* See the comment for CACHE_ROWID in write_record_data() */
+      TABLE *table= (TABLE *) copy->str;
+      copy->str= table->file->ref;
+      copy->length= table->file->ref_length;
+    }
+    len+= copy->length;
+    if (copy->type == CACHE_BLOB && !copy->field->is_null())
+      len+= ((Field_blob *) copy->field)->get_length();
+  }
+  if (len > spill_buff_length)
+  {
+    if (!(spill_buff= (uchar *) my_realloc(spill_buff, len,
+                                           MYF(MY_WME | MY_ALLOW_ZERO_PTR |
+                                               MY_FREE_ON_ERROR |
+                                               MY_THREAD_SPECIFIC))))
+    {
+      spill_buff_length= 0;
+      return (spill_error= TRUE);
+    }
+    spill_buff_length= len;
+  }
+
+  cp= spill_buff;
+  for (copy= field_descr+MY_TEST(with_match_flag); copy < flags_end; copy++)
+  {
+    memcpy(cp, copy->str, copy->length);
+    cp+= copy->length;
+  }
+  for ( ; copy < copy_end; copy++)
+  {
+    Field *field= copy->field;
+    if (field && field->maybe_null() && field->is_null())
+      continue;
+    switch (copy->type) {
+    case CACHE_BLOB:
+    {
+      Field_blob *blob_field= (Field_blob *) field;
+      uint blob_len= blob_field->get_length();
+      uchar *data;
+      blob_field->get_image(cp, copy->length, blob_field->charset());
+      blob_field->get_ptr(&data);
+      memcpy(cp+copy->length, data, blob_len);
+      cp+= copy->length+blob_len;
+      break;
+    }
+    case CACHE_VARSTR1:
+      memcpy(cp, copy->str, (uint) copy->str[0] + 1);
+      cp+= (uint) copy->str[0] + 1;
+      break;
+    case CACHE_VARSTR2:
+      memcpy(cp, copy->str, uint2korr(copy->str) + 2);
+      cp+= uint2korr(copy->str) + 2;
+      break;
+    case CACHE_ROWID:
+      if (!copy->str)
+      {
+        cp+= copy->length;
+        break;
+      }
+      /* fall through */
+    default:
+      memcpy(cp, copy->str, copy->length);
+      cp+= copy->length;
+    }
+  }
+
+  uchar len_buff[4];
+  len= (size_t) (cp-spill_buff);
+  int4store(len_buff, len);
+  if (open_partition_file(&outer_files[part]) ||
+      my_b_write(&outer_files[part], len_buff, sizeof(len_buff)) ||
+      my_b_write(&outer_files[part], spill_buff, len))
+    return (spill_error= TRUE);
+  outer_records[part]++;
+  return FALSE;
+}
+
+
+/*
+  Read the next record of the partial join from a partition
+
+  SYNOPSIS
+    read_spilled_record()
+      file      the partition file to read from
+
+  DESCRIPTION
+    The function reads the next record written by write_spilled_record()
+    from the partition file into the record buffers. The values of blob
+    fields refer to the data in the buffer spill_buff.
+
+  RETURN VALUE
+    TRUE    reading from the partition has failed
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::read_spilled_record(IO_CACHE *file)
+{
+  CACHE_FIELD *copy;
+  CACHE_FIELD *copy_end= field_descr+fields;
+  CACHE_FIELD *flags_end= field_descr+flag_fields;
+  uchar len_buff[4];
+  size_t len;
+  uchar *cp;
+
+  if (my_b_read(file, len_buff, sizeof(len_buff)))
+    return TRUE;
+  len= uint4korr(len_buff);
+  if (len > spill_buff_length)
+  {
+    if (!(spill_buff= (uchar *) my_realloc(spill_buff, len,
+                                           MYF(MY_WME | MY_ALLOW_ZERO_PTR |
+                                               MY_FREE_ON_ERROR |
+                                               MY_THREAD_SPECIFIC))))
+    {
+      spill_buff_length= 0;
+      return TRUE;
+    }
+    spill_buff_length= len;
+  }
+  if (my_b_read(file, spill_buff, len))
+    return TRUE;
+
+  cp= spill_buff;
+  for (copy= field_descr+MY_TEST(with_match_flag); copy < flags_end; copy++)
+  {
+    memcpy(copy->str, cp, copy->length);
+    cp+= copy->length;
+  }
+  for ( ; copy < copy_end; copy++)
+  {
+    Field *field= copy->field;
+    if (field && field->maybe_null() && field->is_null())
+      continue;
+    switch (copy->type) {
+    case CACHE_BLOB:
+    {
+      Field_blob *blob_field= (Field_blob *) field;
+      blob_field->set_ptr(cp, cp+copy->length);
+      cp+= copy->length+blob_field->get_length();
+      break;
+    }
+    case CACHE_VARSTR1:
+      memcpy(copy->str, cp, (uint) cp[0] + 1);
+      cp+= (uint) cp[0] + 1;
+      break;
+    case CACHE_VARSTR2:
+      memcpy(copy->str, cp, uint2korr(cp) + 2);
+      cp+= uint2korr(cp) + 2;
+      break;
+    case CACHE_ROWID:
+      if (!copy->str)
+      {
+        cp+= copy->length;
+        break;
+      }
+      /* fall through */
+    default:
+      memcpy(copy->str, cp, copy->length);
+      cp+= copy->length;
+    }
+  }
+  return FALSE;
+}
+
+
+/*
+  Add a record into the join buffer of the BNLH cache or into a partition
+
+  SYNOPSIS
+    put_record()
+
+  DESCRIPTION
+    This implementation of the virtual function put_record writes the
+    record into the join buffer as the parent implementation does. If the
+    join buffer becomes full and the grace hash join has been chosen, the
+    records from the buffer and all the following records are written
+    into the partition files instead, and the join is performed only
+    when all records of the partial join have been received.
+
+  RETURN VALUE
+    TRUE    if it has been decided that it should be the last record
+            in the join buffer, or if writing into a partition has failed
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_BNLH::put_record()
+{
+  if (spilled)
+    return write_spilled_record();
+  if (!JOIN_CACHE_HASHED::put_record())
+    return FALSE;
+  if (!partitions || join_tab->keep_current_rowid)
+    return TRUE;
+  return spill_join_buffer();
+}
+
+
+/*
+  Write the rows of join_tab into the partitions
+
+  SYNOPSIS
+    spill_join_tab_records()
+
+  DESCRIPTION
+    The function scans join_tab once and writes each row that passes the
+    condition pushed to join_tab into the partition determined by its join
+    key. Rows of the partitions without records of the partial join are
+    skipped, as they cannot have any matches.
+
+  RETURN VALUE
+    one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::spill_join_tab_records()
+{
+  int error;
+  enum_nested_loop_state rc= NESTED_LOOP_OK;
+  TABLE *table= join_tab->table;
+  KEY *keyinfo= join_tab->get_keyinfo_by_key_no(join_tab->ref.key);
+  DBUG_ENTER("JOIN_CACHE_BNLH::spill_join_tab_records");
+
+  table->null_row= 0;
+  if ((rc= join_tab_execution_startup(join_tab)) < 0)
+    DBUG_RETURN(rc);
+
+  if (!(error= join_tab_scan->open()))
+  {
+    while (!(error= join_tab_scan->next()))
+    {
+      if (join->thd->check_killed())
+      {
+        join->thd->send_kill_message();
+        rc= NESTED_LOOP_KILLED;
+        break;
+      }
+      key_copy(key_buff, table->record[0], keyinfo, key_length, TRUE);
+      uint part= get_partition_no(key_buff);
+      if (!outer_records[part])
+        continue;
+      if (open_partition_file(&inner_files[part]) ||
+          partition_scan->write_row(&inner_files[part]))
+      {
+        rc= NESTED_LOOP_ERROR;
+        break;
+      }
+      inner_records[part]++;
+    }
+  }
+  if (error > 0)
+    rc= NESTED_LOOP_ERROR;
+  join_tab_scan->close();
+  DBUG_RETURN(rc);
+}
+
+
+/*
+  Join the records of the partial join with join_tab partition by partition
+
+  SYNOPSIS
+    join_partitions()
+
+  DESCRIPTION
+    The function first distributes the rows of join_tab over the partitions.
+    Then for each partition it loads the records of the partial join into
+    the join buffer and joins them with the rows of join_tab from the same
+    partition in the same way as for a refilled join buffer. If the records
+    of a partition do not fit into the join buffer, the rows of join_tab from
+    the partition are read once per refill.
+
+  RETURN VALUE
+    one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_partitions()
+{
+  enum_nested_loop_state rc;
+  JOIN_TAB_SCAN *save_join_tab_scan= join_tab_scan;
+  DBUG_ENTER("JOIN_CACHE_BNLH::join_partitions");
+
+  if (spill_error)
+    DBUG_RETURN(NESTED_LOOP_ERROR);
+  if ((rc= spill_join_tab_records()) != NESTED_LOOP_OK)
+    DBUG_RETURN(rc);
+
+  join_tab_scan= partition_scan;
+  for (uint i= 0; i < partitions; i++)
+  {
+    ha_rows rem_records= outer_records[i];
+    if (!rem_records)
+      continue;
+    if (reinit_io_cache(&outer_files[i], READ_CACHE, 0L, 0, 0))
+    {
+      rc= NESTED_LOOP_ERROR;
+      break;
+    }
+    partition_scan->set_partition(&inner_files[i], inner_records[i]);
+    DBUG_PRINT("info", ("partition %u: %lu records, %lu rows", i,
+                        (ulong) outer_records[i], (ulong) inner_records[i]));
+    while (rem_records)
+    {
+      bool is_full= FALSE;
+      while (rem_records && !is_full)
+      {
+        if (read_spilled_record(&outer_files[i]))
+        {
+          rc= NESTED_LOOP_ERROR;
+          goto finish;
+        }
+        rem_records--;
+        is_full= JOIN_CACHE_HASHED::put_record();
+      }
+      rc= JOIN_CACHE::join_records(FALSE);
+      if (rc != NESTED_LOOP_OK && rc != NESTED_LOOP_NO_MORE_ROWS)
+        goto finish;
+    }
+    rc= NESTED_LOOP_OK;
+  }
+
+finish:
+  join_tab_scan= save_join_tab_scan;
+  DBUG_RETURN(rc);
+}
+
+
+/*
+  Join records from the BNLH join buffer or from the partitions
+
+  SYNOPSIS
+    join_records()
+      skip_last    do not find matches for the last record from the buffer
+
+  DESCRIPTION
+    If the records of the partial join have been written into partitions
+    the function is called only when all of them have been received. In
+    this case the partitions are joined one by one, otherwise the function
+    does what the parent implementation does.
+
+  RETURN VALUE
+    one of enum_nested_loop_state
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNLH::join_records(bool skip_last)
+{
+  enum_nested_loop_state rc;
+  if (!spilled)
+    return JOIN_CACHE::join_records(skip_last);
+  DBUG_ASSERT(!skip_last);
+  rc= join_partitions();
+  close_partition_files();
+  return rc;
+}
+
+
+void JOIN_CACHE_BNLH::save_explain_data(struct st_explain_bka_type *explain)
+{
+  JOIN_CACHE::save_explain_data(explain);
+  explain->partitions= partitions;
+}
+
+
+void JOIN_CACHE_BNLH::free()
+{
+  close_partition_files();
+  my_free(spill_buff);
+  spill_buff= 0;
+  spill_buff_length= 0;
+  if (partition_scan)
+    partition_scan->free();
+  JOIN_CACHE::free();
 }
 
 
@@ -34,6 +34,9 @@
 #define CACHE_VARSTR2   4        /* long string value (length takes 2 bytes) */
 #define CACHE_ROWID     5        /* ROWID field */
 
+/* The maximum number of partitions used by the grace hash join */
+#define JOIN_CACHE_MAX_PARTITIONS 128
+
 /*
   The CACHE_FIELD structure used to describe fields of records that
   are written into a join cache buffer from record buffers and backward.
@@ -659,7 +662,7 @@ public:
   }
      
   /* Join records from the join buffer with records from the next join table */ 
-  enum_nested_loop_state join_records(bool skip_last);
+  virtual enum_nested_loop_state join_records(bool skip_last);
 
   /* Add a comment on the join algorithm employed by the join cache */
   virtual void save_explain_data(struct st_explain_bka_type *explain);
@@ -668,7 +671,7 @@ public:
 
   virtual ~JOIN_CACHE() {}
   void reset_join(JOIN *j) { join= j; }
-  void free()
+  virtual void free()
   { 
     my_free(buff);
     buff= 0;
@@ -849,6 +852,9 @@ protected:
 
   uint get_size_of_key_offset() { return size_of_key_ofs; }
 
+  /* Get the full hash value of a key, not reduced to a hash table entry */
+  ulong get_hash_value(uchar *key, uint key_len);
+
   /* 
     Get the position of the next_key_ptr field pointed to by 
     a linking reference stored at the position key_ref_ptr. 
@@ -1086,6 +1092,59 @@ public:
 
 };
 
+
+/*
+  The class JOIN_TAB_SCAN_PARTITION is a companion class for the class
+  JOIN_CACHE_BNLH when the grace hash join is employed. The rows of the
+  joined table join_tab are read only once and written into partition
+  files. An object of this class then iterates over the rows of one
+  partition, restoring them into the record buffer of join_tab.
+  A row is written into a partition as the image of the record buffer
+  followed by the data of the blob fields from the read set.
+*/
+
+class JOIN_TAB_SCAN_PARTITION: public JOIN_TAB_SCAN
+{
+private:
+  /* The partition file to iterate over */
+  IO_CACHE *file;
+  /* The number of rows written into the partition file */
+  ha_rows rows;
+  /* The number of rows that have not been read yet */
+  ha_rows rows_left;
+  /* Buffer for the row read from the partition, blob data stay there */
+  uchar *row_buff;
+  size_t row_buff_length;
+
+public:
+
+  JOIN_TAB_SCAN_PARTITION(JOIN *j, JOIN_TAB *tab)
+    :JOIN_TAB_SCAN(j, tab), file(0), rows(0), rows_left(0),
+     row_buff(0), row_buff_length(0) {}
+
+  /* Set the partition to iterate over */
+  void set_partition(IO_CACHE *part_file, ha_rows part_rows)
+  {
+    file= part_file;
+    rows= part_rows;
+  }
+
+  /* Write the current row of join_tab into a partition file */
+  bool write_row(IO_CACHE *part_file);
+
+  int open();
+
+  int next();
+
+  void free()
+  {
+    my_free(row_buff);
+    row_buff= 0;
+    row_buff_length= 0;
+  }
+};
+
+
 /*
   The class JOIN_CACHE_BNL is used when the BNL join algorithm is
   employed to perform a join operation   
@@ -1178,6 +1237,51 @@ protected:
 
   void read_next_candidate_for_match(uchar *rec_ptr);
 
+  /*
+    The number of partitions for the grace hash join, 0 if the join buffer
+    is refilled instead. When the records of the partial join do not fit
+    into the join buffer they are spilled into partition files by the hash
+    of the join key together with the rows of join_tab, and the partitions
+    are joined one by one.
+  */
+  uint partitions;
+  /* Set when the records of the partial join are written into partitions */
+  bool spilled;
+  /* Set when writing a record into a partition has failed */
+  bool spill_error;
+  /* Partition files for the records of the partial join and for join_tab */
+  IO_CACHE *outer_files;
+  IO_CACHE *inner_files;
+  /* The numbers of records written into the partition files */
+  ha_rows *outer_records;
+  ha_rows *inner_records;
+  /* Buffer for a record of the partial join written into/read from a file */
+  uchar *spill_buff;
+  size_t spill_buff_length;
+  /* The object to iterate over the rows of join_tab from a partition */
+  JOIN_TAB_SCAN_PARTITION *partition_scan;
+
+  /* Choose the number of partitions for the grace hash join by cost */
+  void choose_partitions();
+
+  uint get_partition_no(uchar *key);
+
+  bool open_partition_file(IO_CACHE *file);
+
+  void close_partition_files();
+
+  bool spill_join_buffer();
+
+  bool write_spilled_record();
+
+  bool read_spilled_record(IO_CACHE *file);
+
+  enum_nested_loop_state spill_join_tab_records();
+
+  enum_nested_loop_state join_partitions();
+
+  int realloc_buffer();
+
 public:
 
   /* 
@@ -1185,7 +1289,10 @@ public:
     used to join table 'tab' to the result of joining the previous tables 
     specified by the 'j' parameter.
   */   
-  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab) : JOIN_CACHE_HASHED(j, tab) {}
+  JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab)
+    : JOIN_CACHE_HASHED(j, tab), partitions(0), spilled(0), spill_error(0),
+      outer_files(0), spill_buff(0), spill_buff_length(0),
+      partition_scan(0) {}
 
   /* 
     This constructor creates a linked BNLH join cache. The cache is to be 
@@ -1194,7 +1301,9 @@ public:
     cache object to which this cache is linked.
   */   
   JOIN_CACHE_BNLH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev) 
-    : JOIN_CACHE_HASHED(j, tab, prev) {}
+    : JOIN_CACHE_HASHED(j, tab, prev), partitions(0), spilled(0),
+      spill_error(0), outer_files(0), spill_buff(0), spill_buff_length(0),
+      partition_scan(0) {}
 
   /* Initialize the BNLH cache */       
   int init(bool for_explain);
@@ -1203,6 +1312,16 @@ public:
 
   bool is_key_access() { return TRUE; }
 
+  /* Add a record into the join buffer or into a partition file */
+  bool put_record();
+
+  /* Join the records from the join buffer or from the partitions */
+  enum_nested_loop_state join_records(bool skip_last);
+
+  void save_explain_data(struct st_explain_bka_type *explain);
+
+  void free();
+
 };
 
 
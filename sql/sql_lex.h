@@ -532,6 +532,7 @@ typedef class st_select_lex_node SELECT_LEX_NODE;
 class THD;
 class select_result;
 class JOIN;
+class Join_plan_cache;
 class select_union;
 class Procedure;
 class Explain_query;
@@ -724,6 +725,8 @@ public:
   List<TABLE_LIST> leaf_tables_exec;
   List<TABLE_LIST> leaf_tables_prep;
   bool is_prep_leaf_list_saved;
+  /* The plan cached for the select of a prepared statement */
+  Join_plan_cache *plan_cache;
   uint insert_tables;
   st_select_lex *merged_into; /* select which this select is merged into */
                               /* (not 0 only for views/derived tables)   */
@@ -6362,8 +6362,14 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
   if (query_cache_send_result_to_client(thd, rawbuf, length) <= 0)
   {
     LEX *lex= thd->lex;
+    bool err;
 
-    bool err= parse_sql(thd, parser_state, NULL, true);
+    /* Try to execute the statement without parsing it */
+    if (thd->variables.parse_cache_size &&
+        parse_cache_execute(thd, rawbuf, length))
+      goto end_of_statement;
+
+    err= parse_sql(thd, parser_state, NULL, true);
 
     if (!err)
     {
@@ -6429,6 +6435,7 @@ void mysql_parse(THD *thd, char *rawbuf, uint length,
 
       query_cache_abort(&thd->query_cache_tls);
     }
+end_of_statement:
     THD_STAGE_INFO(thd, stage_freeing_items);
     sp_cache_enforce_limit(thd->sp_proc_cache, stored_program_cache_size);
     sp_cache_enforce_limit(thd->sp_func_cache, stored_program_cache_size);
@@ -0,0 +1,664 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/**
+  @file
+
+  @brief
+  The cache of the parsed statements of a connection, see sql_parse_cache.h
+*/
+
+#include "sql_priv.h"
+#include "sql_class.h"
+#include "sql_parse_cache.h"
+#include "sql_prepare.h"                        /* prepare_for_parse_cache */
+#include "sql_connect.h"                        /* check_mqh */
+
+/* A normalized statement and its prepared statement */
+
+class Parse_cache_entry :public ilink
+{
+public:
+  char *key;
+  uint key_length;
+  /* NULL if the statement cannot be cached */
+  Statement *stmt;
+
+  Parse_cache_entry() :key(NULL), stmt(NULL) {}
+  ~Parse_cache_entry()
+  {
+    delete stmt;
+    my_free(key);
+  }
+};
+
+
+extern "C" uchar *parse_cache_get_key(const uchar *record, size_t *length,
+                                      my_bool not_used __attribute__((unused)))
+{
+  Parse_cache_entry *entry= (Parse_cache_entry *) record;
+  *length= entry->key_length;
+  return (uchar *) entry->key;
+}
+
+
+extern "C" void parse_cache_free_entry(void *record)
+{
+  delete (Parse_cache_entry *) record;
+}
+
+
+Parse_cache::Parse_cache()
+{
+  my_hash_init(&hash, &my_charset_bin, 16, 0, 0, parse_cache_get_key,
+               parse_cache_free_entry, 0);
+}
+
+
+Parse_cache::~Parse_cache()
+{
+  my_hash_free(&hash);
+}
+
+
+/*
+  Remove the least recently used statements from the cache
+
+  SYNOPSIS
+    Parse_cache::shrink()
+      size    The number of statements to leave in the cache
+*/
+
+void Parse_cache::shrink(ulong size)
+{
+  Parse_cache_entry *entry;
+  while (hash.records > size && (entry= lru.get()))
+    my_hash_delete(&hash, (uchar *) entry);
+}
+
+
+/*
+  Skip a quoted string or identifier
+
+  RETURN
+    The position after the closing quote
+    NULL if the string is not terminated
+*/
+
+static const char *skip_quoted(const char *p, const char *end, bool escapes)
+{
+  char quote= *p++;
+  while (p < end)
+  {
+    char c= *p++;
+    if (c == '\\' && escapes)
+    {
+      if (p++ == end)
+        return NULL;
+    }
+    else if (c == quote)
+    {
+      if (p == end || *p != quote)
+        return p;
+      p++;
+    }
+  }
+  return NULL;
+}
+
+
+/*
+  Resolve the escapes of a string literal as the lexer does
+
+  RETURN
+    The length of the resolved string
+*/
+
+static uint unescape_string(const char *from, const char *end, char quote,
+                            bool escapes, char *to)
+{
+  char *start= to;
+  while (from < end)
+  {
+    char c= *from++;
+    if (c == '\\' && escapes && from < end)
+    {
+      switch ((c= *from++)) {
+      case 'n':
+        *to++= '\n';
+        break;
+      case 't':
+        *to++= '\t';
+        break;
+      case 'r':
+        *to++= '\r';
+        break;
+      case 'b':
+        *to++= '\b';
+        break;
+      case '0':
+        *to++= 0;
+        break;
+      case 'Z':
+        *to++= '\032';
+        break;
+      case '_':
+      case '%':
+        *to++= '\\';                            /* Kept for LIKE */
+        /* Fall through */
+      default:
+        *to++= c;
+        break;
+      }
+    }
+    else
+    {
+      *to++= c;
+      if (c == quote)
+        from++;                                 /* Doubled quote */
+    }
+  }
+  return (uint) (to - start);
+}
+
+
+/*
+  Normalize the text of a statement
+
+  SYNOPSIS
+    normalize_query()
+      thd            Thread handle
+      query          The text of the statement
+      length         Length of the text
+      to        OUT  The normalized text, at least length bytes
+      to_length OUT  Length of the normalized text
+      literals  OUT  The literals of the statement
+      max_literals   The size of the literals array
+      literal_count OUT The number of the literals
+
+  DESCRIPTION
+    The comments are removed, the whitespace is collapsed to single spaces
+    and the string and number literals are replaced with parameter
+    markers. The texts the lexer could read in a way the normalized text
+    would not be read, as well as the ones with parameter markers, several
+    statements, executable comments, hexadecimal and bit literals and
+    literals with character set introducers, are not normalized.
+
+  RETURN
+    FALSE  OK
+    TRUE   The text cannot be normalized
+*/
+
+static bool normalize_query(THD *thd, const char *query, uint length,
+                            char *to, uint *to_length,
+                            Parse_cache_literal *literals, uint max_literals,
+                            uint *literal_count)
+{
+  CHARSET_INFO *cs= thd->charset();
+  const uchar *ident_map= cs->ident_map;
+  bool escapes= !(thd->variables.sql_mode & MODE_NO_BACKSLASH_ESCAPES);
+  bool ansi_quotes= MY_TEST(thd->variables.sql_mode & MODE_ANSI_QUOTES);
+  const char *p= query, *end= query + length;
+  char *start= to;
+  bool space= FALSE;
+  uint count= 0;
+
+  /* A backslash may be a part of a multi-byte character */
+  if (cs->escape_with_backslash_is_dangerous)
+    return TRUE;
+
+  while (p < end)
+  {
+    char c= *p;
+
+    if (my_isspace(cs, c))
+    {
+      space= TRUE;
+      p++;
+      continue;
+    }
+    if (c == '#' ||
+        (c == '-' && p + 1 < end && p[1] == '-' &&
+         (p + 2 == end || my_isspace(cs, p[2]) || my_iscntrl(cs, p[2]))))
+    {
+      while (p < end && *p != '\n')
+        p++;
+      space= TRUE;
+      continue;
+    }
+    if (c == '/' && p + 1 < end && p[1] == '*')
+    {
+      if (p + 2 < end &&
+          (p[2] == '!' || (p[2] == 'M' && p + 3 < end && p[3] == '!')))
+        return TRUE;                            /* Executable comment */
+      for (p+= 2; p + 1 < end && (p[0] != '*' || p[1] != '/'); p++) ;
+      if (p + 1 >= end)
+        return TRUE;
+      p+= 2;
+      space= TRUE;
+      continue;
+    }
+
+    if (space && to > start)
+      *to++= ' ';
+    space= FALSE;
+
+    if (c == '\'' || (c == '"' && !ansi_quotes))
+    {
+      const char *str_end= skip_quoted(p, end, escapes);
+      if (!str_end)
+        return TRUE;
+      if (p > query && p[-1] == '@')
+      {
+        /* The name of a variable */
+        memcpy(to, p, str_end - p);
+        to+= str_end - p;
+        p= str_end;
+        continue;
+      }
+      /* N'...', X'...', _latin1'...' and alike */
+      if (p > query && ident_map[(uchar) p[-1]])
+        return TRUE;
+      if (count == max_literals)
+        return TRUE;
+      char *str= (char *) thd->alloc((uint) (str_end - p));
+      if (!str)
+        return TRUE;
+      literals[count].type= Parse_cache_literal::STRING_LITERAL;
+      literals[count].str= str;
+      literals[count].length= unescape_string(p + 1, str_end - 1, c,
+                                              escapes, str);
+      count++;
+      *to++= '?';
+      p= str_end;
+    }
+    else if (c == '`' || c == '"')
+    {
+      const char *ident_end= skip_quoted(p, end, FALSE);
+      if (!ident_end)
+        return TRUE;
+      memcpy(to, p, ident_end - p);
+      to+= ident_end - p;
+      p= ident_end;
+    }
+    else if (my_isdigit(&my_charset_latin1, c))
+    {
+      const char *num= p;
+      Parse_cache_literal::Type type= Parse_cache_literal::INT_LITERAL;
+      while (p < end && my_isdigit(&my_charset_latin1, *p))
+        p++;
+      if (p < end && *p == '.')
+      {
+        type= Parse_cache_literal::DECIMAL_LITERAL;
+        for (p++; p < end && my_isdigit(&my_charset_latin1, *p); p++) ;
+      }
+      if (p < end && (*p == 'e' || *p == 'E'))
+      {
+        const char *exp= p + 1;
+        if (exp < end && (*exp == '+' || *exp == '-'))
+          exp++;
+        if (exp < end && my_isdigit(&my_charset_latin1, *exp))
+        {
+          type= Parse_cache_literal::REAL_LITERAL;
+          for (p= exp; p < end && my_isdigit(&my_charset_latin1, *p); p++) ;
+        }
+      }
+      /* 0x1F, 0b01, 1abc, 1.2.3 and alike */
+      if (p < end && (ident_map[(uchar) *p] || *p == '.'))
+        return TRUE;
+      if (count == max_literals)
+        return TRUE;
+      /* The integers that may not fit into longlong, which has 19 digits */
+      if (type == Parse_cache_literal::INT_LITERAL &&
+          p - num > 18)
+        type= Parse_cache_literal::DECIMAL_LITERAL;
+      literals[count].type= type;
+      literals[count].str= num;
+      literals[count].length= (uint) (p - num);
+      count++;
+      *to++= '?';
+    }
+    else if (ident_map[(uchar) c])
+    {
+      do
+        *to++= *p++;
+      while (p < end && ident_map[(uchar) *p]);
+      if (p < end && (*p == '\'' || *p == '"'))
+        return TRUE;                            /* N'...' and alike */
+    }
+    else if (c == '?' || c == ';' || c == '\\' ||
+             (c == '*' && p + 1 < end && p[1] == '/') ||
+             (c == '.' && p + 1 < end && my_isdigit(&my_charset_latin1, p[1])))
+      return TRUE;
+    else
+      *to++= *p++;
+  }
+  *to_length= (uint) (to - start);
+  *literal_count= count;
+  return FALSE;
+}
+
+
+/*
+  Check whether a normalized text begins with a command the cache handles
+*/
+
+static bool is_cached_command(THD *thd, const char *text, uint length)
+{
+  static const LEX_CSTRING commands[]=
+  {
+    { C_STRING_WITH_LEN("SELECT") },
+    { C_STRING_WITH_LEN("INSERT") },
+    { C_STRING_WITH_LEN("UPDATE") }
+  };
+  for (uint i= 0; i < array_elements(commands); i++)
+  {
+    uint cmd_length= commands[i].length;
+    if (length > cmd_length &&
+        !my_strnncoll(system_charset_info,
+                      (const uchar *) text, cmd_length,
+                      (const uchar *) commands[i].str, cmd_length) &&
+        !thd->charset()->ident_map[(uchar) text[cmd_length]])
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/*
+  Mark the part of the primary key a conjunct compares with a parameter
+
+  RETURN
+    FALSE  OK
+    TRUE   The conjunct is not an equality of a column and a parameter
+*/
+
+static bool mark_primary_key_part(TABLE *table, Item *conjunct,
+                                  key_part_map *covered)
+{
+  KEY *key= table->key_info + table->s->primary_key;
+  Item **args;
+  Field *field= NULL;
+
+  if (conjunct->type() != Item::FUNC_ITEM ||
+      ((Item_func *) conjunct)->functype() != Item_func::EQ_FUNC)
+    return TRUE;
+  args= ((Item_func *) conjunct)->arguments();
+  for (uint i= 0; i < 2 && !field; i++)
+  {
+    Item *item= args[i]->real_item();
+    if (item->type() == Item::FIELD_ITEM &&
+        args[1 - i]->type() == Item::PARAM_ITEM)
+      field= ((Item_field *) item)->field;
+  }
+  if (!field || field->table != table)
+    return TRUE;
+  for (uint i= 0; i < key->user_defined_key_parts; i++)
+  {
+    if (key->key_part[i].fieldnr == field->field_index + 1)
+      *covered|= (key_part_map) 1 << i;
+  }
+  return FALSE;
+}
+
+
+/*
+  Check whether a condition compares all the columns of the primary key of
+  a table with parameters and nothing else
+*/
+
+static bool is_primary_key_lookup(TABLE *table, Item *cond)
+{
+  key_part_map covered= 0;
+  uint key_parts;
+
+  if (!cond || table->s->primary_key == MAX_KEY)
+    return FALSE;
+  key_parts= table->key_info[table->s->primary_key].user_defined_key_parts;
+  if (cond->type() == Item::COND_ITEM &&
+      ((Item_cond *) cond)->functype() == Item_func::COND_AND_FUNC)
+  {
+    List_iterator_fast<Item> it(*((Item_cond *) cond)->argument_list());
+    Item *item;
+    while ((item= it++))
+    {
+      if (mark_primary_key_part(table, item, &covered))
+        return FALSE;
+    }
+  }
+  else if (mark_primary_key_part(table, cond, &covered))
+    return FALSE;
+  return covered == make_prev_keypart_map(key_parts);
+}
+
+
+/*
+  Check whether all the values of a list are parameters or NULL or DEFAULT
+*/
+
+static bool are_literals(List<Item> &values)
+{
+  List_iterator_fast<Item> it(values);
+  Item *item;
+  while ((item= it++))
+  {
+    if (item->type() != Item::PARAM_ITEM && item->type() != Item::NULL_ITEM &&
+        item->type() != Item::DEFAULT_VALUE_ITEM)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Check whether a statement prepared for the cache is of a shape it handles
+
+  SYNOPSIS
+    Parse_cache::check_shape()
+      lex    The statement
+
+  DESCRIPTION
+    The function is called by Prepared_statement::prepare() while the
+    tables of the statement are still open. Only the statements with
+    the values replaced with parameters in the positions where a parameter
+    has the same meaning as a literal are cached: a number in ORDER BY or
+    GROUP BY is a position of a column, and expressions over parameters
+    are typed before the values of the parameters are known.
+
+  RETURN
+    TRUE   The statement may be cached
+    FALSE  The statement must not be cached
+*/
+
+bool Parse_cache::check_shape(LEX *lex)
+{
+  SELECT_LEX *select_lex= &lex->select_lex;
+  TABLE_LIST *tbl= select_lex->table_list.first;
+  TABLE *table;
+
+  if (lex->describe || lex->all_selects_list->next_select_in_list() ||
+      lex->uses_stored_routines() || lex->proc_list.elements ||
+      select_lex->table_list.elements != 1 || !(table= tbl->table) ||
+      tbl->view || tbl->derived || tbl->schema_table ||
+      table->s->tmp_table != NO_TMP_TABLE)
+    return FALSE;
+
+  switch (lex->sql_command) {
+  case SQLCOM_SELECT:
+  {
+    List_iterator_fast<Item> it(select_lex->item_list);
+    Item *item;
+    while ((item= it++))
+    {
+      if (item->real_item()->type() != Item::FIELD_ITEM)
+        return FALSE;
+    }
+    if (select_lex->group_list.elements || select_lex->order_list.elements ||
+        select_lex->having)
+      return FALSE;
+    return is_primary_key_lookup(table, select_lex->where);
+  }
+  case SQLCOM_INSERT:
+    if (lex->duplicates == DUP_UPDATE || lex->many_values.elements != 1 ||
+        tbl->lock_type == TL_WRITE_DELAYED)
+      return FALSE;
+    return are_literals(*lex->many_values.head());
+  case SQLCOM_UPDATE:
+    if (select_lex->order_list.elements)
+      return FALSE;
+    return are_literals(lex->value_list) &&
+           is_primary_key_lookup(table, select_lex->where);
+  default:
+    return FALSE;
+  }
+}
+
+
+/*
+  Execute a text statement with a statement prepared for its shape
+
+  SYNOPSIS
+    Parse_cache::execute()
+      thd      Thread handle
+      query    The text of the statement
+      length   Length of the text
+
+  DESCRIPTION
+    The function is called by mysql_parse() before the statement is
+    parsed. A statement of a normalized text not found in the cache is
+    prepared and added to the cache. The errors and warnings of the
+    preparation are not reported: if the statement cannot be prepared it
+    is parsed and executed as usual, which reports them.
+
+  RETURN
+    TRUE   The statement has been executed
+    FALSE  The statement must be parsed and executed
+*/
+
+bool Parse_cache::execute(THD *thd, char *query, uint length)
+{
+  Parse_cache_entry *entry;
+  Parse_cache_literal *literals;
+  uint header_length= thd->db_length + 1 + 8 + 2 + 2;
+  uint max_literals= MY_MIN((length + 1) / 2, PARSE_CACHE_MAX_LITERALS);
+  uint text_length, literal_count;
+  char *key, *text;
+  bool hit= FALSE;
+  DBUG_ENTER("Parse_cache::execute");
+
+  if (!(key= (char *) thd->alloc(header_length + length)) ||
+      !(literals= (Parse_cache_literal *)
+                  thd->alloc(sizeof(Parse_cache_literal) * max_literals)))
+    DBUG_RETURN(FALSE);
+  text= key + header_length;
+  if (normalize_query(thd, query, length, text, &text_length,
+                      literals, max_literals, &literal_count) ||
+      !is_cached_command(thd, text, text_length))
+    DBUG_RETURN(FALSE);
+
+  /* What the statement is parsed with */
+  if (thd->db_length)
+    memcpy(key, thd->db, thd->db_length);
+  key[thd->db_length]= 0;
+  int8store(key + thd->db_length + 1, thd->variables.sql_mode);
+  int2store(key + thd->db_length + 9,
+            thd->variables.character_set_client->number);
+  int2store(key + thd->db_length + 11,
+            thd->variables.collation_connection->number);
+
+  if ((entry= (Parse_cache_entry *) my_hash_search(&hash, (uchar *) key,
+                                                   header_length +
+                                                   text_length)))
+  {
+    /* Make the entry the most recently used one */
+    entry->unlink();
+    lru.push_back(entry);
+    hit= TRUE;
+  }
+  else
+  {
+    Statement *stmt= NULL;
+    if (prepare_for_parse_cache(thd, text, text_length, &stmt) < 0)
+      goto miss;
+    shrink(thd->variables.parse_cache_size - 1);
+    if (!(entry= new Parse_cache_entry))
+    {
+      delete stmt;
+      goto miss;
+    }
+    entry->stmt= stmt;
+    entry->key_length= header_length + text_length;
+    if (!(entry->key= (char *) my_memdup(key, entry->key_length, MYF(0))) ||
+        my_hash_insert(&hash, (uchar *) entry))
+    {
+      delete entry;
+      goto miss;
+    }
+    lru.push_back(entry);
+  }
+
+  if (!entry->stmt ||
+      set_parse_cache_params(entry->stmt, literals, literal_count))
+    goto miss;
+
+  if (hit)
+    thd->status_var.parse_cache_hits++;
+  else
+    thd->status_var.parse_cache_misses++;
+  thd->lex->sql_command= entry->stmt->lex->sql_command;
+  thd->m_statement_psi=
+    MYSQL_REFINE_STATEMENT(thd->m_statement_psi,
+                           sql_statement_info[thd->lex->sql_command].m_key);
+#ifndef NO_EMBEDDED_ACCESS_CHECKS
+  if (mqh_used && thd->user_connect &&
+      check_mqh(thd, thd->lex->sql_command))
+  {
+    thd->net.error= 0;
+    DBUG_RETURN(TRUE);
+  }
+#endif
+  (void) execute_from_parse_cache(thd, entry->stmt, query, length);
+  DBUG_RETURN(TRUE);
+
+miss:
+  thd->status_var.parse_cache_misses++;
+  DBUG_RETURN(FALSE);
+}
+
+
+/*
+  Execute a text statement with the parse cache of the connection
+
+  RETURN
+    TRUE   The statement has been executed
+    FALSE  The statement must be parsed and executed
+*/
+
+bool parse_cache_execute(THD *thd, char *query, uint length)
+{
+  if (thd->slave_thread || thd->in_sub_stmt || thd->spcont)
+    return FALSE;
+  if (!thd->parse_cache && !(thd->parse_cache= new Parse_cache))
+    return FALSE;
+  return thd->parse_cache->execute(thd, query, length);
+}
+
+
+void parse_cache_free(THD *thd)
+{
+  delete thd->parse_cache;
+  thd->parse_cache= NULL;
+}
@@ -0,0 +1,88 @@
+/*
+   Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef SQL_PARSE_CACHE_INCLUDED
+#define SQL_PARSE_CACHE_INCLUDED
+
+#include "sql_list.h"                           /* I_List */
+#include "hash.h"                               /* HASH */
+
+class THD;
+class Statement;
+struct LEX;
+
+/* The maximum number of literals of a statement the cache handles */
+#define PARSE_CACHE_MAX_LITERALS 256
+
+/* A literal of a statement replaced with a parameter marker */
+struct Parse_cache_literal
+{
+  enum Type { INT_LITERAL, DECIMAL_LITERAL, REAL_LITERAL, STRING_LITERAL };
+  Type type;
+  /* The text of the literal, with the escapes resolved for strings */
+  const char *str;
+  uint length;
+};
+
+class Parse_cache_entry;
+
+/*
+  The cache of the parsed statements of a connection
+
+  When parse_cache_size is set the text statements of the shapes the cache
+  handles are normalized: the comments are removed, the whitespace is
+  collapsed and the literals are replaced with parameter markers. A
+  statement of a normalized text not seen yet is prepared as a prepared
+  statement that is kept in the cache, together with the current database,
+  sql_mode and character sets the text was parsed with. The subsequent
+  statements of the same normalized text are executed by the cached
+  prepared statement with their literals as the values of the parameters
+  and are not parsed.
+
+  Only the following shapes are cached:
+  - SELECT of columns of one base table by all the columns of its primary
+    key compared with literals,
+  - INSERT of a single row of literals into a base table,
+  - UPDATE of one base table setting columns to literals by all the
+    columns of its primary key compared with literals,
+  all without subqueries and stored functions. The normalized texts of
+  the other statements beginning with SELECT, INSERT or UPDATE are cached
+  too, to not try to prepare them again.
+
+  The least recently used statements are removed from the cache when it
+  holds more than parse_cache_size statements.
+*/
+
+class Parse_cache
+{
+public:
+  Parse_cache();
+  ~Parse_cache();
+  bool execute(THD *thd, char *query, uint length);
+  void shrink(ulong size);
+
+  static bool check_shape(LEX *lex);
+
+private:
+  HASH hash;
+  /* The entries from the least recently used to the most recently used */
+  I_List<Parse_cache_entry> lru;
+};
+
+bool parse_cache_execute(THD *thd, char *query, uint length);
+void parse_cache_free(THD *thd);
+
+#endif /* SQL_PARSE_CACHE_INCLUDED */
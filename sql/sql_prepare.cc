@@ -117,6 +117,7 @@ When one supplies long data for a placeholder:
 #include "lock.h"                               // MYSQL_OPEN_FORCE_SHARED_MDL
 #include "sql_handler.h"
 #include "transaction.h"                        // trans_rollback_implicit
+#include "sql_parse_cache.h"                    // Parse_cache
 
 /**
   A result class used to send cursor rows using the binary protocol.
@@ -150,7 +151,9 @@ public:
   enum flag_values
   {
     IS_IN_USE= 1,
-    IS_SQL_PREPARE= 2
+    IS_SQL_PREPARE= 2,
+    /* Prepared by the parse cache: not logged nor counted */
+    IS_PARSE_CACHE= 4
   };
 
   THD *thd;
@@ -160,6 +163,8 @@ public:
   uint param_count;
   uint last_errno;
   uint flags;
+  /* Prepared by the parse cache and of a shape it handles */
+  bool parse_cacheable;
   char last_error[MYSQL_ERRMSG_SIZE];
 #ifndef EMBEDDED_LIBRARY
   bool (*set_params)(Prepared_statement *st, uchar *data, uchar *data_end,
@@ -181,6 +186,8 @@ public:
   inline bool is_in_use() { return flags & (uint) IS_IN_USE; }
   inline bool is_sql_prepare() const { return flags & (uint) IS_SQL_PREPARE; }
   void set_sql_prepare() { flags|= (uint) IS_SQL_PREPARE; }
+  inline bool is_parse_cache() const { return flags & (uint) IS_PARSE_CACHE; }
+  void set_parse_cache() { flags|= (uint) IS_PARSE_CACHE; }
   bool prepare(const char *packet, uint packet_length);
   bool execute_loop(String *expanded_query,
                     bool open_cursor,
@@ -2780,6 +2787,190 @@ void mysql_sql_stmt_execute(THD *thd)
 }
 
 
+/**
+  An error handler that hides the conditions raised while a statement is
+  prepared for the parse cache.
+*/
+
+class Parse_cache_error_handler : public Internal_error_handler
+{
+public:
+  Parse_cache_error_handler()
+    : m_sql_errno(0), m_got_condition(FALSE)
+  {}
+
+  bool handle_condition(THD *thd,
+                        uint sql_errno,
+                        const char* sqlstate,
+                        Sql_condition::enum_warning_level level,
+                        const char* msg,
+                        Sql_condition ** cond_hdl)
+  {
+    if (level == Sql_condition::WARN_LEVEL_ERROR && !m_sql_errno)
+      m_sql_errno= sql_errno;
+    m_got_condition= TRUE;
+    return TRUE;
+  }
+
+  uint m_sql_errno;
+  bool m_got_condition;
+};
+
+
+/**
+  Prepare a statement for the parse cache.
+
+    The statement is prepared as an SQL prepared statement that is neither
+    logged nor counted in the Com_stmt_* status variables. The errors and
+    warnings of the preparation are not reported to the client.
+
+  @param thd          thread handle
+  @param query        the normalized text of the statement
+  @param length       length of the text
+  @param[out] stmt    the prepared statement if it can be cached
+
+  @retval 0   the statement is prepared and may be cached
+  @retval 1   the statement must not be cached
+  @retval -1  the statement cannot be prepared now
+*/
+
+int prepare_for_parse_cache(THD *thd, const char *query, uint length,
+                            Statement **stmt)
+{
+  Parse_cache_error_handler error_handler;
+  Prepared_statement *prepared;
+  bool error;
+  int res;
+  DBUG_ENTER("prepare_for_parse_cache");
+
+  if (!(prepared= new Prepared_statement(thd)))
+    DBUG_RETURN(-1);
+  prepared->set_sql_prepare();
+  prepared->set_parse_cache();
+
+  thd->push_internal_handler(&error_handler);
+  error= prepared->prepare(query, length);
+  thd->pop_internal_handler();
+
+  /*
+    A text that is not parsed and a statement with warnings of its own,
+    like the deprecated syntax, cannot be cached until the next change of
+    the tables. Other errors may depend on the state of the tables.
+  */
+  if (error)
+    res= error_handler.m_sql_errno == ER_PARSE_ERROR ? 1 : -1;
+  else
+    res= error_handler.m_got_condition || !prepared->parse_cacheable ? 1 : 0;
+  if (res)
+    delete prepared;
+  else
+    *stmt= prepared;
+  DBUG_RETURN(res);
+}
+
+
+/**
+  Set the parameters of a statement of the parse cache to the literals of
+  an executed text.
+
+  @param statement    the prepared statement
+  @param literals     the literals in the order of the parameters
+  @param count        the number of the literals
+
+  @retval TRUE   a literal is not a valid value of its parameter: the text
+                 must be parsed
+  @retval FALSE  success
+*/
+
+bool set_parse_cache_params(Statement *statement,
+                            const Parse_cache_literal *literals, uint count)
+{
+  Prepared_statement *stmt= (Prepared_statement *) statement;
+  THD *thd= stmt->thd;
+  DBUG_ENTER("set_parse_cache_params");
+
+  if (count != stmt->param_count)
+    DBUG_RETURN(TRUE);
+  for (uint i= 0; i < count; i++)
+  {
+    Item_param *param= stmt->param_array[i];
+    const Parse_cache_literal *literal= literals + i;
+    char *end= (char *) literal->str + literal->length;
+    int error;
+
+    /* The parser accepts only integers in LIMIT */
+    if (param->limit_clause_param &&
+        literal->type != Parse_cache_literal::INT_LITERAL)
+      DBUG_RETURN(TRUE);
+    param->unsigned_flag= FALSE;
+    switch (literal->type) {
+    case Parse_cache_literal::INT_LITERAL:
+      param->set_int(my_strtoll10(literal->str, &end, &error),
+                     MY_INT64_NUM_DECIMAL_DIGITS);
+      param->item_result_type= INT_RESULT;
+      param->item_type= Item::INT_ITEM;
+      param->param_type= MYSQL_TYPE_LONGLONG;
+      break;
+    case Parse_cache_literal::DECIMAL_LITERAL:
+      param->set_decimal(literal->str, literal->length);
+      param->item_result_type= DECIMAL_RESULT;
+      param->item_type= Item::DECIMAL_ITEM;
+      param->param_type= MYSQL_TYPE_NEWDECIMAL;
+      break;
+    case Parse_cache_literal::REAL_LITERAL:
+      param->set_double(my_strtod(literal->str, &end, &error));
+      param->item_result_type= REAL_RESULT;
+      param->item_type= Item::REAL_ITEM;
+      param->param_type= MYSQL_TYPE_DOUBLE;
+      break;
+    case Parse_cache_literal::STRING_LITERAL:
+    {
+      CHARSET_INFO *fromcs= thd->variables.character_set_client;
+      CHARSET_INFO *tocs= thd->variables.collation_connection;
+      uint32 dummy_offset;
+
+      param->value.cs_info.character_set_of_placeholder= fromcs;
+      param->value.cs_info.character_set_client= fromcs;
+      param->value.cs_info.final_character_set_of_str_value=
+        String::needs_conversion(0, fromcs, tocs, &dummy_offset) ?
+        tocs : fromcs;
+      param->item_result_type= STRING_RESULT;
+      param->item_type= Item::STRING_ITEM;
+      param->param_type= MYSQL_TYPE_VARCHAR;
+      if (param->set_str(literal->str, literal->length) ||
+          param->convert_str_value(thd))
+        DBUG_RETURN(TRUE);
+      break;
+    }
+    }
+  }
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Execute a text statement with a statement of the parse cache.
+
+  @param thd          thread handle
+  @param statement    the prepared statement with the parameters set
+  @param query        the text of the statement, used for logging and
+                      replication
+  @param length       length of the text
+
+  @retval TRUE   an error occurred
+  @retval FALSE  success
+*/
+
+bool execute_from_parse_cache(THD *thd, Statement *statement,
+                              const char *query, uint length)
+{
+  Prepared_statement *stmt= (Prepared_statement *) statement;
+  String expanded_query(query, length, thd->charset());
+  DBUG_ENTER("execute_from_parse_cache");
+  DBUG_RETURN(stmt->execute_loop(&expanded_query, FALSE, NULL, NULL));
+}
+
+
 /**
   COM_STMT_FETCH handler: fetches requested amount of rows from cursor.
 
@@ -3183,7 +3374,8 @@ Prepared_statement::Prepared_statement(THD *thd_arg)
   cursor(0),
   param_count(0),
   last_errno(0),
-  flags((uint) IS_IN_USE)
+  flags((uint) IS_IN_USE),
+  parse_cacheable(FALSE)
 {
   init_sql_alloc(&main_mem_root, thd_arg->variables.query_alloc_block_size,
                  thd_arg->variables.query_prealloc_size, MYF(MY_THREAD_SPECIFIC));
@@ -3349,7 +3541,8 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
     However, it seems handy if com_stmt_prepare is increased always,
     no matter what kind of prepare is processed.
   */
-  status_var_increment(thd->status_var.com_stmt_prepare);
+  if (!is_parse_cache())
+    status_var_increment(thd->status_var.com_stmt_prepare);
 
   if (! (lex= new (mem_root) st_lex_local))
     DBUG_RETURN(TRUE);
@@ -3426,6 +3619,10 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
   if (error == 0)
     error= check_prepared_statement(this);
 
+  /* The shape is checked while the tables are open */
+  if (error == 0 && is_parse_cache())
+    parse_cacheable= Parse_cache::check_shape(lex);
+
   /*
     Currently CREATE PROCEDURE/TRIGGER/EVENT are prohibited in prepared
     statements: ensure we have no memory leak here if by someone tries
@@ -3483,7 +3680,7 @@ bool Prepared_statement::prepare(const char *packet, uint packet_len)
       sub-statements inside stored procedures are not logged into
       the general log.
     */
-    if (thd->spcont == NULL)
+    if (thd->spcont == NULL && !is_parse_cache())
       general_log_write(thd, COM_STMT_PREPARE, query(), query_length());
   }
   DBUG_RETURN(error);
@@ -3519,9 +3716,13 @@ Prepared_statement::set_parameters(String *expanded_query,
 
   if (is_sql_ps)
   {
-    /* SQL prepared statement */
-    res= set_params_from_vars(this, thd->lex->prepared_stmt_params,
-                              expanded_query);
+    /*
+      SQL prepared statement. The parameters of the statements of the
+      parse cache are set by set_parse_cache_params().
+    */
+    if (!is_parse_cache())
+      res= set_params_from_vars(this, thd->lex->prepared_stmt_params,
+                                expanded_query);
   }
   else if (param_count)
   {
@@ -3706,6 +3907,8 @@ Prepared_statement::reprepare()
   Prepared_statement copy(thd);
 
   copy.set_sql_prepare(); /* To suppress sending metadata to the client. */
+  if (is_parse_cache())
+    copy.set_parse_cache();
 
   status_var_increment(thd->status_var.com_stmt_reprepare);
 
@@ -3863,7 +4066,8 @@ bool Prepared_statement::execute(String *expanded_query, bool open_cursor)
 
   LEX_STRING stmt_db_name= { db, db_length };
 
-  status_var_increment(thd->status_var.com_stmt_execute);
+  if (!is_parse_cache())
+    status_var_increment(thd->status_var.com_stmt_execute);
 
   if (flags & (uint) IS_IN_USE)
   {
@@ -4041,7 +4245,7 @@ bool Prepared_statement::execute(String *expanded_query, bool open_cursor)
     sub-statements inside stored procedures are not logged into
     the general log.
   */
-  if (error == 0 && thd->spcont == NULL)
+  if (error == 0 && thd->spcont == NULL && !is_parse_cache())
     general_log_write(thd, COM_STMT_EXECUTE, thd->query(), thd->query_length());
 
 error:
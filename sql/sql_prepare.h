@@ -20,6 +20,8 @@
 
 class THD;
 struct LEX;
+class Statement;
+struct Parse_cache_literal;
 
 /**
   An interface that is used to take an action when
@@ -76,6 +78,12 @@ void mysqld_stmt_fetch(THD *thd, char *packet, uint packet_length);
 void mysqld_stmt_reset(THD *thd, char *packet);
 void mysql_stmt_get_longdata(THD *thd, char *pos, ulong packet_length);
 void reinit_stmt_before_use(THD *thd, LEX *lex);
+int prepare_for_parse_cache(THD *thd, const char *query, uint length,
+                            Statement **stmt);
+bool set_parse_cache_params(Statement *statement,
+                            const Parse_cache_literal *literals, uint count);
+bool execute_from_parse_cache(THD *thd, Statement *statement,
+                              const char *query, uint length);
 
 /**
   Execute a fragment of server code in an isolated context, so that
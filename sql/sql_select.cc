@@ -52,6 +52,8 @@
 #include "log_slow.h"
 #include "sql_derived.h"
 #include "sql_statistics.h"
+#include "sql_group_hash.h"      // Group_hash_table
+#include "opt_plan_cache.h"      // Join_plan_cache
 
 #include "debug_sync.h"          // DEBUG_SYNC
 #include <m_ctype.h>
@@ -169,6 +171,8 @@ static enum_nested_loop_state
 end_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 static enum_nested_loop_state
 end_unique_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records);
 
 static int test_if_group_changed(List<Cached_item> &list);
 static int join_read_const_table(JOIN_TAB *tab, POSITION *pos);
@@ -3396,6 +3400,8 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
   SARGABLE_PARAM *sargables= 0;
   List_iterator<TABLE_LIST> ti(tables_list);
   TABLE_LIST *tables;
+  Join_plan_cache *plan_cache;
+  table_map range_const_table_map;
   DBUG_ENTER("make_join_statistics");
 
   LINT_INIT(table); /* inited in all loops */
@@ -3862,8 +3868,17 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
     }     
   }
 
+  /*
+    A plan cached for the select of a prepared statement may be reused,
+    see Join_plan_cache. Then only the ranges the plan depends on are
+    analyzed.
+  */
+  plan_cache= Join_plan_cache::get(join, stat);
+  range_const_table_map= join->const_table_map;
+
   /* Calc how many (possible) matched records in each table */
 
+range_analysis:
   for (s=stat ; s < stat_end ; s++)
   {
     s->startup_cost= 0;
@@ -3925,7 +3940,10 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
       bool impossible_range= FALSE;
       ha_rows records= HA_POS_ERROR;
       SQL_SELECT *select= 0;
-      if (!s->const_keys.is_clear_all())
+      key_map keys_to_use= s->const_keys;
+      if (plan_cache)
+        plan_cache->get_range_keys((uint) (s - stat), &keys_to_use);
+      if (!keys_to_use.is_clear_all())
       {
         select= make_select(s->table, found_const_table_map,
 			    found_const_table_map,
@@ -3934,7 +3952,7 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
         if (!select)
           goto error;
         records= get_quick_record_count(join->thd, select, s->table,
-				        &s->const_keys, join->row_limit);
+				        &keys_to_use, join->row_limit);
         s->quick=select->quick;
         s->needed_reg=select->needed_reg;
         select->quick=0;
@@ -3952,6 +3970,23 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
           records= 0;
         }
       }
+      if (plan_cache &&
+          !plan_cache->check_range_estimate(join, (uint) (s - stat), s->table,
+                                            impossible_range))
+      {
+        /*
+          The parameters are out of the selectivity class of the cached
+          plan: analyze all ranges and search for a new plan.
+        */
+        delete select;
+        for (JOIN_TAB *tab= stat; tab <= s; tab++)
+        {
+          delete tab->quick;
+          tab->quick= 0;
+        }
+        plan_cache= NULL;
+        goto range_analysis;
+      }
       if (impossible_range)
       {
 	/*
@@ -4019,8 +4054,14 @@ make_join_statistics(JOIN *join, List<TABLE_LIST> &tables_list,
     /* Find an optimal join order of the non-constant tables. */
     if (join->const_tables != join->table_count)
     {
-      if (choose_plan(join, all_table_map & ~join->const_table_map))
-        goto error;
+      if (plan_cache)
+        plan_cache->restore(join, stat);
+      else
+      {
+        if (choose_plan(join, all_table_map & ~join->const_table_map))
+          goto error;
+        Join_plan_cache::save(join, stat, range_const_table_map);
+      }
     }
     else
     {
@@ -7241,21 +7282,26 @@ double table_multi_eq_cond_selectivity(JOIN *join, uint idx, JOIN_TAB *s,
         If ref == 0 and there are no fields in the multiple equality
         item_equal that belong to the tables joined prior to s
         then the selectivity of multiple equality will be set to 1.0.
+        Otherwise it is the biggest of the selectivities of the equalities
+        over the fields of s and of the tables joined prior to s.
       */
-      double eq_fld_sel= 1.0;
+      double eq_fld_sel= 0.0;
+      bool prior_fld_found= FALSE;
       fi.rewind();
       while ((fi++))
       {
         double curr_eq_fld_sel;
         fld= fi.get_curr_field();
-        if (!fld->table->map & ~(table_bit | rem_tables))
+        if (fld->table->map & rem_tables)
           continue;
-        curr_eq_fld_sel= get_column_avg_frequency(fld) /
-                         fld->table->stat_records();
+        if (fld->table->map != table_bit)
+          prior_fld_found= TRUE;
+        curr_eq_fld_sel= get_column_eq_join_selectivity(fld);
         if (curr_eq_fld_sel < 1.0)
           set_if_bigger(eq_fld_sel, curr_eq_fld_sel);
       }
-      sel*= eq_fld_sel;
+      if (prior_fld_found && eq_fld_sel > 0.0)
+        sel*= eq_fld_sel;
     }
   } 
   return sel;
@@ -10942,6 +10988,8 @@ make_join_readinfo(JOIN *join, ulonglong options, uint no_jbuf_after)
     uint jcl= tab->used_join_cache_level;
     tab->read_record.table= table;
     tab->read_record.unlock_row= rr_unlock_row;
+    tab->batch_cond= NULL;
+    tab->batch_cond_source= NULL;
     tab->sorted= sorted;
     sorted= 0;                                  // only first must be sorted
     
@@ -17120,6 +17168,116 @@ free_tmp_table(THD *thd, TABLE *entry)
 }
 
 
+/**
+  Get the memory that can be used for grouping in memory
+
+  @note The same limit is used for in-memory temporary tables.
+*/
+
+static size_t group_hash_memory_limit(THD *thd)
+{
+  return (size_t) MY_MIN(thd->variables.tmp_table_size,
+                         thd->variables.max_heap_table_size);
+}
+
+
+/**
+  Estimate the number of groups from the index statistics
+
+  @param group  the list of the grouping expressions
+
+  @details
+  The number of distinct values of a grouping column is estimated from the
+  statistics of an index starting with the column. The estimate for
+  the list is the product of the estimates for its elements.
+
+  @return
+    estimated number of groups, or 0 if there are no statistics for some
+    of the grouping expressions
+*/
+
+static double estimate_group_count(ORDER *group)
+{
+  double groups= 1.0;
+  for ( ; group; group= group->next)
+  {
+    Item *item= (*group->item)->real_item();
+    if (item->type() != Item::FIELD_ITEM)
+      return 0.0;
+    Field *field= ((Item_field *) item)->field;
+    TABLE *tab= field->table;
+    double distinct= 0.0;
+    for (uint key= 0; key < tab->s->keys; key++)
+    {
+      KEY *keyinfo= tab->key_info + key;
+      if (field->key_start.is_set(key) && keyinfo->rec_per_key &&
+          keyinfo->actual_rec_per_key(0) > 0)
+      {
+        distinct= rows2double(tab->stat_records()) /
+                  keyinfo->actual_rec_per_key(0);
+        break;
+      }
+    }
+    if (distinct <= 0)
+      return 0.0;
+    groups*= distinct;
+  }
+  return groups;
+}
+
+
+/**
+  Check whether to group in an in-memory hash table instead of
+  the temporary table
+
+  @param join   the join whose rows are grouped
+
+  @details
+  Grouping in the temporary table requires an index lookup for each row
+  of the join and an update of the found record. With end_hash_update()
+  the groups are looked up in a hash table in memory and are written into
+  the temporary table once. The records with blobs cannot be copied into
+  the hash table. If the groups are not expected to fit into memory the
+  temporary table is used right away, otherwise the hash table is used
+  and the groups are moved into the temporary table if it becomes full.
+  The number of groups is estimated from the index statistics and by the
+  number of rows of the join.
+
+  @retval TRUE   use end_hash_update()
+  @retval FALSE  use end_update()
+*/
+
+static bool use_hash_group_by(JOIN *join)
+{
+  TABLE *table= join->tmp_table;
+  TMP_TABLE_PARAM *tmp_tbl= &join->tmp_table_param;
+
+  if (!optimizer_flag(join->thd, OPTIMIZER_SWITCH_HASH_GROUP_BY) ||
+      table->s->blob_fields || table->s->uniques || !tmp_tbl->group_buff)
+    return FALSE;
+
+  /*
+    LIMIT ROWS EXAMINED counts the accesses to the temporary table too:
+    keep them for the queries with the limit.
+  */
+  if (join->thd->lex->limit_rows_examined_cnt != ULONGLONG_MAX)
+    return FALSE;
+
+  /*
+    Without the statistics the number of groups is not known: try the hash
+    table, as the groups are moved into the temporary table if they do not
+    fit into memory.
+  */
+  double groups= estimate_group_count(table->group);
+  if (groups <= 0)
+    return TRUE;
+  set_if_smaller(groups, join->record_count);
+  return groups * Group_hash_table::entry_size(tmp_tbl->group_length,
+                                               table->s->reclength) <=
+         group_hash_memory_limit(join->thd);
+}
+
+
 /**
   @details
   Rows produced by a join sweep may end up in a temporary table or be sent
@@ -17144,7 +17302,12 @@ Next_select_func setup_end_select_func(JOIN *join)
     if (table->group && tmp_tbl->sum_func_count && 
         !tmp_tbl->precomputed_group_by)
     {
-      if (table->s->keys)
+      if (table->s->keys && use_hash_group_by(join))
+      {
+	DBUG_PRINT("info",("Using end_hash_update"));
+	end_select=end_hash_update;
+      }
+      else if (table->s->keys)
       {
 	DBUG_PRINT("info",("Using end_update"));
 	end_select=end_update;
@@ -17239,6 +17402,17 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
   }
   /* Set up select_end */
   Next_select_func end_select= setup_end_select_func(join);
+  if (end_select == end_hash_update)
+  {
+    TMP_TABLE_PARAM *tmp_tbl= &join->tmp_table_param;
+    if ((!join->group_hash && !(join->group_hash= new Group_hash_table)) ||
+        join->group_hash->init(table->group, tmp_tbl->group_buff,
+                               table->key_info,
+                               table->key_info->user_defined_key_parts,
+                               tmp_tbl->group_length, table->s->reclength,
+                               group_hash_memory_limit(join->thd)))
+      end_select= end_update;
+  }
   if (join->table_count)
   {
     join->join_tab[join->top_join_tab_count - 1].next_select= end_select;
@@ -17314,6 +17488,8 @@ do_select(JOIN *join,List<Item> *fields,TABLE *table,Procedure *procedure)
   if (table)
   {
     int tmp, new_errno= 0;
+    if (join->group_hash)
+      join->group_hash->free();
     if ((tmp=table->file->extra(HA_EXTRA_NO_CACHE)))
     {
       DBUG_PRINT("error",("extra(HA_EXTRA_NO_CACHE) failed"));
@@ -18520,15 +18696,66 @@ bool test_if_use_dynamic_range_scan(JOIN_TAB *join_tab)
     return (join_tab->use_quick == 2 && test_if_quick_select(join_tab) > 0);
 }
 
+/**
+  Check whether the table scan can evaluate select_cond over blocks of records
+
+  @details
+    The part of select_cond that depends only on the table is evaluated
+    over blocks of records read by the scan (see rr_sequential_batch()).
+    The scan reads up to a block of records ahead, so it is not used when
+    the scan may be abandoned early or the position of the current record
+    is needed: for the queries with LIMIT, for the tables whose scan is
+    ended by the first match, and when the row ids are kept.
+
+  @retval TRUE   tab->batch_cond is to be used for the scan
+  @retval FALSE  otherwise
+*/
+
+static bool use_batch_cond(JOIN_TAB *tab)
+{
+  JOIN *join= tab->join;
+  THD *thd= join->thd;
+  TABLE *table= tab->table;
+
+  if (!optimizer_flag(thd, OPTIMIZER_SWITCH_BATCH_COND) ||
+      thd->lex->sql_command != SQLCOM_SELECT ||
+      join->unit->select_limit_cnt != HA_POS_ERROR ||
+      tab->keep_current_rowid || tab->do_firstmatch ||
+      tab->loosescan_match_tab || tab->shortcut_for_distinct ||
+      table->reginfo.not_exists_optimize ||
+      table->reginfo.lock_type > TL_READ_NO_INSERT ||
+      table->file->stats.records < BATCH_COND_MIN_ROWS)
+    return FALSE;
+
+  if (tab->batch_cond_source != tab->select_cond)
+  {
+    tab->batch_cond_source= tab->select_cond;
+    tab->batch_cond= tab->select_cond ?
+                     tab->select_cond->get_batch_cond(table) : NULL;
+  }
+  return tab->batch_cond != NULL;
+}
+
+
 int join_init_read_record(JOIN_TAB *tab)
 {
   if (tab->select && tab->select->quick && tab->select->quick->reset())
     return 1;
   if (!tab->preread_init_done && tab->preread_init())
     return 1;
+  end_read_record_batch(&tab->read_record);
   if (init_read_record(&tab->read_record, tab->join->thd, tab->table,
                        tab->select,1,1, FALSE))
     return 1;
+  if (use_batch_cond(tab))
+  {
+    /*
+      The records skipped by a join cache scan are not counted as examined,
+      see JOIN_TAB_SCAN::next()
+    */
+    init_read_record_batch(&tab->read_record, tab->batch_cond,
+                           tab->cache ? NULL : &tab->join->examined_rows);
+  }
   return (*tab->read_record.read_record)(&tab->read_record);
 }
 
@@ -19135,6 +19362,125 @@ end_unique_update(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
 }
 
 
+/**
+  Write the groups from the hash table of end_hash_update() into
+  the temporary table
+
+  @note If the in-memory temporary table becomes full it is converted to
+  an on-disk table and the following rows of the join are grouped by
+  end_unique_update().
+
+  @retval FALSE  ok
+  @retval TRUE   error
+*/
+
+static bool flush_group_hash(JOIN *join)
+{
+  TABLE *table= join->tmp_table;
+  Group_hash_table *group_hash= join->group_hash;
+  int error;
+  DBUG_ENTER("flush_group_hash");
+  DBUG_PRINT("info", ("groups: %lu", group_hash->get_elements()));
+
+  for (uchar *rec= group_hash->first_record(); rec;
+       rec= group_hash->next_record())
+  {
+    memcpy(table->record[0], rec, table->s->reclength);
+    if ((error= table->file->ha_write_tmp_row(table->record[0])))
+    {
+      if (create_internal_tmp_table_from_heap(join->thd, table,
+                                              join->tmp_table_param.start_recinfo,
+                                              &join->tmp_table_param.recinfo,
+                                              error, 0, NULL))
+        DBUG_RETURN(TRUE);                      // Not a table_is_full error
+      if ((error= table->file->ha_index_init(0, 0)))
+      {
+        table->file->print_error(error, MYF(0));
+        DBUG_RETURN(TRUE);
+      }
+      join->join_tab[join->top_join_tab_count-1].next_select=
+        end_unique_update;
+    }
+  }
+  group_hash->reset();
+  DBUG_RETURN(FALSE);
+}
+
+
+/**
+  Group by searching after group record in an in-memory hash table
+
+  @details
+  Like end_update(), but the records of the groups are kept in the hash
+  table join->group_hash and are written into the temporary table only
+  at the end. If the hash table becomes full the groups are written into
+  the temporary table and grouping continues with end_update().
+*/
+
+static enum_nested_loop_state
+end_hash_update(JOIN *join, JOIN_TAB *join_tab, bool end_of_records)
+{
+  TABLE *table=join->tmp_table;
+  ORDER   *group;
+  uchar   *rec;
+  bool    added;
+  DBUG_ENTER("end_hash_update");
+
+  if (end_of_records)
+    DBUG_RETURN(flush_group_hash(join) ? NESTED_LOOP_ERROR : NESTED_LOOP_OK);
+
+  copy_fields(&join->tmp_table_param);		// Groups are copied twice.
+  /* Make a key of group index */
+  for (group=table->group ; group ; group=group->next)
+  {
+    Item *item= *group->item;
+    if (group->fast_field_copier_setup != group->field)
+    {
+      group->fast_field_copier_setup= group->field;
+      group->fast_field_copier_func=
+        item->setup_fast_field_copier(group->field);
+    }
+    item->save_org_in_field(group->field, group->fast_field_copier_func);
+    /* Store in the used key if the field was 0 */
+    if (item->maybe_null)
+      group->buff[-1]= (char) group->field->is_null();
+  }
+  if (!(rec= join->group_hash->find_or_add(join->tmp_table_param.group_buff,
+                                           &added)))
+  {
+    /* Out of memory for the hash table: continue in the temporary table */
+    DBUG_PRINT("info", ("Using end_update"));
+    join->join_tab[join->top_join_tab_count-1].next_select= end_update;
+    if (flush_group_hash(join))
+      DBUG_RETURN(NESTED_LOOP_ERROR);
+    DBUG_RETURN((*join->join_tab[join->top_join_tab_count-1].next_select)
+                (join, join_tab, end_of_records));
+  }
+
+  join->found_records++;
+  if (added)
+  {
+    init_tmptable_sum_functions(join->sum_funcs);
+    if (copy_funcs(join->tmp_table_param.items_to_copy, join->thd))
+      DBUG_RETURN(NESTED_LOOP_ERROR);           /* purecov: inspected */
+    join->send_records++;
+  }
+  else
+  {						/* Update old record */
+    memcpy(table->record[0], rec, table->s->reclength);
+    update_tmptable_sum_func(join->sum_funcs,table);
+  }
+  memcpy(rec, table->record[0], table->s->reclength);
+
+  if (join->thd->check_killed())
+  {
+    join->thd->send_kill_message();
+    DBUG_RETURN(NESTED_LOOP_KILLED);             /* purecov: inspected */
+  }
+  DBUG_RETURN(NESTED_LOOP_OK);
+}
+
+
 	/* ARGSUSED */
 enum_nested_loop_state
 end_write_group(JOIN *join, JOIN_TAB *join_tab __attribute__((unused)),
@@ -196,6 +196,7 @@ int rr_sequential_and_unpack(READ_RECORD *info);
  *************************************************************************************/
 
 class JOIN_CACHE;
+class Group_hash_table;
 class SJ_TMP_TABLE;
 class JOIN_TAB_RANGE;
 
@@ -218,6 +219,13 @@ typedef struct st_join_table {
     NULL means no index condition pushdown was performed.
   */
   Item          *pre_idx_push_select_cond;
+  /*
+    The evaluator of the part of select_cond that depends only on this
+    table over blocks of records read by a table scan, and the value of
+    select_cond it has been built for (see join_init_read_record()).
+  */
+  Batch_cond    *batch_cond;
+  Item          *batch_cond_source;
   /*
     Pointer to the associated ON expression. on_expr_ref=!NULL except for
     degenerate joins. 
@@ -1080,6 +1088,8 @@ public:
   TABLE    *tmp_table;
   /// used to store 2 possible tmp table of SELECT
   TABLE    *exec_tmp_table1, *exec_tmp_table2;
+  /* In-memory hash table used by end_hash_update() for grouping */
+  Group_hash_table *group_hash;
   THD	   *thd;
   Item_sum  **sum_funcs, ***sum_funcs_end;
   /** second copy of sumfuncs (for queries with 2 temporary tables */
@@ -1288,6 +1298,7 @@ public:
     examined_rows= 0;
     exec_tmp_table1= 0;
     exec_tmp_table2= 0;
+    group_hash= 0;
     sortorder= 0;
     table_reexec[0]= 0;
     join_tab_reexec= 0;
@@ -32,6 +32,13 @@ struct TABLE;
 
 #define MERGEBUFF		7
 #define MERGEBUFF2		15
+/*
+  When the merge buffer is large, merge_many_buff() merges more than
+  MERGEBUFF2 runs at once, as long as each run gets at least
+  MERGE_MIN_READ_SIZE bytes of the buffer, up to MERGEBUFF_MAX runs.
+*/
+#define MERGE_MIN_READ_SIZE	(IO_SIZE*4)
+#define MERGEBUFF_MAX		1024
 
 /*
    The structure SORT_ADDON_FIELD describes a fixed layout
@@ -59,6 +66,26 @@ typedef struct st_sort_addon_field
   uint8  null_bit;       /* Null bit mask for the field */
 } SORT_ADDON_FIELD;
 
+/*
+  The structure SORT_KEY_PART describes a part of packed sort keys.
+  Packed records are stored as their length (2 bytes), the key parts and
+  the result: the record reference, or the length of the addon fields
+  (2 bytes, included) followed by their null bits and packed values.
+  A fixed size key part is stored as in fixed size records. A packed key
+  part is stored as its length (2 bytes) and that many first bytes of the
+  fixed size key part, the stripped bytes being equal to the same bytes of
+  the pad. So the keys compare as the fixed size keys whatever the pad is,
+  the pad only decides how much is stripped. A NULL value is stored as its
+  NULL marker only, which orders it before or after all other values.
+*/
+
+typedef struct st_sort_key_part
+{
+  uint   length;         /* Length of the fixed size key part */
+  uchar *pad;            /* Key part of an empty string, or NULL if fixed */
+  bool   maybe_null;     /* If the first byte is the NULL marker */
+} SORT_KEY_PART;
+
 struct BUFFPEK_COMPARE_CONTEXT
 {
   qsort_cmp2 key_compare;
@@ -81,6 +108,9 @@ public:
   SORT_FIELD *local_sortorder;
   SORT_FIELD *end;
   SORT_ADDON_FIELD *addon_field; // Descriptors for companion fields.
+  SORT_KEY_PART *key_parts;   // Parts of packed sort keys, if records are packed.
+  SORT_KEY_PART *key_parts_end;
+  ha_rows written_rows;       // Number of keys written to the temporary file.
   uchar *unique_buff;
   bool not_killable;
   char* tmp_buffer;
@@ -95,9 +125,13 @@ public:
   void init_for_filesort(uint sortlen, TABLE *table,
                          ulong max_length_for_sort_data,
                          ha_rows maxrows, bool sort_positions);
+  bool init_packed_records();
+  bool using_packed_records() const { return key_parts != NULL; }
 };
 
 
+int cmp_packed_sort_keys(const Sort_param *param, uchar **a, uchar **b);
+uint get_merge_fanin(ha_rows keys_per_buffer, uint elem_size);
 int merge_many_buff(Sort_param *param, uchar *sort_buffer,
 		    BUFFPEK *buffpek,
 		    uint *maxbuffer, IO_CACHE *t_file);
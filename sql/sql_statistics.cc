@@ -185,7 +185,7 @@ public:
 
   inline void init(THD *thd, Field * table_field);
   inline bool add(ha_rows rowno);
-  inline void finish(ha_rows rows); 
+  inline void finish(ha_rows rows, double sample_fraction);
   inline void cleanup();
 };
 
@@ -876,12 +876,12 @@ public:
     @details
     This implementation of a purely virtual method sets the value of the
     columns 'min_value', 'max_value', 'nulls_ratio', 'avg_length',
-    'avg_frequency', 'hist_size', 'hist_type' and 'histogram'  of the 
-    stistical table columns_stat according to the contents of the bitmap
-    write_stat.column_stat_nulls and the values of the fields min_value,
-    max_value, nulls_ratio, avg_length, avg_frequency, hist_size, hist_type
-    and histogram of the structure write_stat from the Field structure
-    for the field 'table_field'.
+    'avg_frequency', 'hist_size', 'hist_type', 'histogram' and 'sample_size'
+    of the stistical table columns_stat according to the contents of the
+    bitmap write_stat.column_stat_nulls and the values of the fields
+    min_value, max_value, nulls_ratio, avg_length, avg_frequency, hist_size,
+    hist_type, histogram and sample_size of the structure write_stat from
+    the Field structure for the field 'table_field'.
     The value of the k-th column in the table columns_stat is set to NULL
     if the k-th bit in the bitmap 'column_stat_nulls' is set to 1. 
 
@@ -897,9 +897,12 @@ public:
     char buff[MAX_FIELD_WIDTH];
     String val(buff, sizeof(buff), &my_charset_utf8_bin);
 
-    for (uint i= COLUMN_STAT_MIN_VALUE; i <= COLUMN_STAT_HISTOGRAM; i++)
+    for (uint i= COLUMN_STAT_MIN_VALUE; i <= COLUMN_STAT_SAMPLE_SIZE; i++)
     {  
       Field *stat_field= stat_table->field[i];
+      /* Older versions created column_stats without 'sample_size' */
+      if (!stat_field)
+        break;
       if (table_field->collected_stats->is_null(i))
         stat_field->set_null();
       else
@@ -941,6 +944,7 @@ public:
                             1);
           break;
         case COLUMN_STAT_HISTOGRAM:
+        {
           const char * col_histogram=
           (const char *) (table_field->collected_stats->histogram.get_values());
 	  stat_field->store(col_histogram,
@@ -948,6 +952,10 @@ public:
                             &my_charset_bin);
           break;           
         }
+        case COLUMN_STAT_SAMPLE_SIZE:
+          stat_field->store(table_field->collected_stats->sample_size, TRUE);
+          break;
+        }
       }
     }
   }
@@ -1058,7 +1066,8 @@ public:
       table_field->read_stats->set_not_null(fldno);
       stat_field->val_str(&val);
       memcpy(table_field->read_stats->histogram.get_values(),
-             val.ptr(), table_field->read_stats->histogram.get_size());
+             val.ptr(), MY_MIN(val.length(),
+                               table_field->read_stats->histogram.get_size()));
     }
   }
 
@@ -1279,8 +1288,18 @@ class Histogram_builder
   uint hist_width;         /* the number of points in the histogram        */
   double bucket_capacity;  /* number of rows in a bucket of the histogram  */ 
   uint curr_bucket;        /* number of the current bucket to be built     */
+  uint mcv_count;          /* number of the most common values to skip     */
   ulonglong count;         /* number of values retrieved                   */
   ulonglong count_distinct;    /* number of distinct values retrieved      */
+  ulonglong count_single;  /* number of values retrieved only once         */
+
+  /* Check whether the value 'elem' is in the list of most common values */
+  bool is_mcv(void *elem)
+  {
+    column->store_field_value((uchar *) elem, col_length);
+    double pos= column->pos_in_interval(min_value, max_value);
+    return histogram->find_mcv(histogram->get_pos_value(pos)) >= 0;
+  }
 
 public: 
   Histogram_builder(Field *col, uint col_len, ha_rows rows)
@@ -1293,15 +1312,23 @@ public:
     hist_width= histogram->get_width();
     bucket_capacity= (double) records / (hist_width + 1);
     curr_bucket= 0;
+    mcv_count= histogram->get_mcv_count();
     count= 0;
     count_distinct= 0;    
+    count_single= 0;
   }
 
   ulonglong get_count_distinct() { return count_distinct; }
 
+  ulonglong get_count_single() { return count_single; }
+
   int next(void *elem, element_count elem_cnt)
   {
+    if (mcv_count && is_mcv(elem))
+      return 0;
     count_distinct++;
+    if (elem_cnt == 1)
+      count_single++;
     count+= elem_cnt;
     if (curr_bucket == hist_width)
       return 0;
@@ -1323,6 +1350,149 @@ public:
 };
 
 
+/*
+  Mcv_collector is a helper class that is used to find the most common
+  values of a column for a histogram of the type MCV_HB. The values are
+  identified by their positions in the histogram: the values that have
+  the same position are counted as one value.
+*/
+
+struct Mcv_candidate
+{
+  ulonglong count;         /* number of rows with the value                */
+  uint pos_value;          /* position of the value in the histogram       */
+};
+
+class Mcv_collector
+{
+  Field *column;           /* table field for which the list is built      */
+  uint col_length;         /* size of this field                           */
+  Field *min_value;        /* pointer to the minimal value for the field   */
+  Field *max_value;        /* pointer to the maximal value for the field   */
+  Histogram *histogram;    /* the histogram location                       */
+  uint max_count;          /* max number of values the list can hold       */
+  Mcv_candidate *candidates; /* the most common values found so far        */
+  QUEUE queue;             /* the candidates with the least count on top   */
+  Mcv_candidate curr;      /* the current run of values with one position  */
+  ulonglong count_distinct;    /* number of distinct values retrieved      */
+  ulonglong count_single;  /* number of values retrieved only once         */
+
+  void add_candidate()
+  {
+    if (!curr.count || !max_count)
+      return;
+    if (queue.elements < max_count)
+    {
+      Mcv_candidate *cand= candidates + queue.elements;
+      *cand= curr;
+      queue_insert(&queue, (uchar *) cand);
+    }
+    else if (curr.count > ((Mcv_candidate *) queue_top(&queue))->count)
+    {
+      *((Mcv_candidate *) queue_top(&queue))= curr;
+      queue_replace_top(&queue);
+    }
+  }
+
+public:
+  Mcv_collector(Field *col, uint col_len)
+    : column(col), col_length(col_len), candidates(NULL)
+  {
+    Column_statistics *col_stats= col->collected_stats;
+    min_value= col_stats->min_value;
+    max_value= col_stats->max_value;
+    histogram= &col_stats->histogram;
+    max_count= histogram->get_max_mcv_count();
+    curr.count= 0;
+    count_distinct= 0;
+    count_single= 0;
+    bzero(&queue, sizeof(queue));
+  }
+
+  ~Mcv_collector()
+  {
+    delete_queue(&queue);
+    my_free(candidates);
+  }
+
+  bool init()
+  {
+    if (!max_count)
+      return FALSE;
+    return !(candidates= (Mcv_candidate *) my_malloc(sizeof(Mcv_candidate) *
+                                                      max_count, MYF(0))) ||
+           init_queue(&queue, max_count, 0, 0, mcv_candidate_cmp, NULL, 0, 0);
+  }
+
+  ulonglong get_count_distinct() { return count_distinct; }
+
+  ulonglong get_count_single() { return count_single; }
+
+  int next(void *elem, element_count elem_cnt)
+  {
+    count_distinct++;
+    if (elem_cnt == 1)
+      count_single++;
+    column->store_field_value((uchar *) elem, col_length);
+    uint pos_value= histogram->get_pos_value(column->pos_in_interval(min_value,
+                                                                     max_value));
+    if (curr.count && curr.pos_value == pos_value)
+    {
+      curr.count+= elem_cnt;
+      return 0;
+    }
+    add_candidate();
+    curr.pos_value= pos_value;
+    curr.count= elem_cnt;
+    return 0;
+  }
+
+  /*
+    Store the list of the most common values into the histogram and
+    return the number of rows with these values. Unless all values fit
+    into the list, only the values that are noticeably more common than
+    the average value get there.
+  */
+  ulonglong store(ha_rows rows)
+  {
+    uint i, count= 0;
+    ulonglong mcv_rows= 0;
+    add_candidate();
+    double min_rows= 0;
+    if (count_distinct > queue.elements)
+      min_rows= MY_MAX(2.0, 1.25 * rows / count_distinct);
+    for (i= 0; i < queue.elements; i++)
+    {
+      if (candidates[i].count >= min_rows)
+        candidates[count++]= candidates[i];
+    }
+    my_qsort(candidates, count, sizeof(Mcv_candidate), mcv_candidate_pos_cmp);
+    histogram->set_mcv_count(count);
+    for (i= 0; i < count; i++)
+    {
+      histogram->set_mcv(i, candidates[i].pos_value,
+                         (double) candidates[i].count / rows);
+      mcv_rows+= candidates[i].count;
+    }
+    return mcv_rows;
+  }
+
+  static int mcv_candidate_cmp(void *arg, uchar *a, uchar *b)
+  {
+    ulonglong count_a= ((Mcv_candidate *) a)->count;
+    ulonglong count_b= ((Mcv_candidate *) b)->count;
+    return count_a < count_b ? -1 : (count_a > count_b ? 1 : 0);
+  }
+
+  static int mcv_candidate_pos_cmp(const void *a, const void *b)
+  {
+    uint pos_a= ((Mcv_candidate *) a)->pos_value;
+    uint pos_b= ((Mcv_candidate *) b)->pos_value;
+    return pos_a < pos_b ? -1 : (pos_a > pos_b ? 1 : 0);
+  }
+};
+
+
 C_MODE_START
 
 int histogram_build_walk(void *elem, element_count elem_cnt, void *arg)
@@ -1331,6 +1501,25 @@ int histogram_build_walk(void *elem, element_count elem_cnt, void *arg)
   return hist_builder->next(elem, elem_cnt);
 }
 
+int mcv_collect_walk(void *elem, element_count elem_cnt, void *arg)
+{
+  Mcv_collector *mcv_collector= (Mcv_collector *) arg;
+  return mcv_collector->next(elem, elem_cnt);
+}
+
+/*
+  Count the distinct values and the values encountered only once:
+  arg points to an array of two counters for them
+*/
+
+int count_distinct_single_walk(void *elem, element_count elem_cnt, void *arg)
+{
+  ((ulonglong *) arg)[0]++;
+  if (elem_cnt == 1)
+    ((ulonglong *) arg)[1]++;
+  return 0;
+}
+
 C_MODE_END
 
 
@@ -1418,14 +1607,58 @@ public:
     return count;
   }
 
+  /*
+    @brief
+    Calculate the number of elements accumulated in the container of 'tree'
+    and the number of the elements that have been added only once
+  */
+  ulonglong get_value_and_singles(ulonglong *singles)
+  {
+    ulonglong counts[2]= { 0, 0 };
+    tree->walk(table_field->table, count_distinct_single_walk,
+               (void*) counts);
+    *singles= counts[1];
+    return counts[0];
+  }
+
   /*
     @brief
     Build the histogram for the elements accumulated in the container of 'tree'
   */
-  ulonglong get_value_with_histogram(ha_rows rows)
+  ulonglong get_value_with_histogram(ha_rows rows, ulonglong *singles)
   {
+    Histogram *histogram= &table_field->collected_stats->histogram;
+    if (histogram->get_type() == MCV_HB)
+    {
+      /*
+        The first pass over the values finds the most common of them, the
+        second one builds the height-balanced part for the rest values
+      */
+      ulonglong mcv_rows;
+      Mcv_collector mcv_collector(table_field, tree_key_length);
+      if (mcv_collector.init())
+      {
+        histogram->set_size(0);
+        return get_value_and_singles(singles);
+      }
+      tree->walk(table_field->table, mcv_collect_walk, (void *) &mcv_collector);
+      mcv_rows= mcv_collector.store(rows);
+      if (mcv_rows == rows)
+        histogram->set_size(MCV_HB_HEADER_SIZE +
+                            histogram->get_mcv_count() * MCV_HB_ENTRY_SIZE);
+      else
+      {
+        Histogram_builder hist_builder(table_field, tree_key_length,
+                                       rows - mcv_rows);
+        tree->walk(table_field->table, histogram_build_walk,
+                   (void *) &hist_builder);
+      }
+      *singles= mcv_collector.get_count_single();
+      return mcv_collector.get_count_distinct();
+    }
     Histogram_builder hist_builder(table_field, tree_key_length, rows);
     tree->walk(table_field->table,  histogram_build_walk, (void *) &hist_builder);
+    *singles= hist_builder.get_count_single();
     return hist_builder.get_count_distinct();
   }
 
@@ -1847,6 +2080,8 @@ int alloc_statistics_for_table(THD* thd, TABLE *table)
   uint hist_size= thd->variables.histogram_size;
   Histogram_type hist_type= (Histogram_type) (thd->variables.histogram_type);
   uchar *histogram= NULL;
+  if (hist_type == MCV_HB && hist_size < MCV_HB_HEADER_SIZE)
+    hist_size= 0;
   if (hist_size > 0)
     histogram= (uchar *) alloc_root(&table->mem_root, hist_size * columns);
 
@@ -2244,14 +2479,30 @@ bool Column_statistics_collected::add(ha_rows rowno)
   Get the results of aggregation when collecting the statistics on a column
   
   @param
-  rows          The total number of rows in the table 
+  rows             The number of rows the statistics is collected from
+  @param
+  sample_fraction  The fraction of the rows of the table in the sample
+
+  @details
+  When the statistics is collected from a sample the nulls ratio, the
+  average length and the histogram of the sample are taken as the
+  estimates for the table. The number of distinct values is estimated
+  with the Duj1 estimator of Haas and Stokes: D= n*d / (n - (1-q)*f1),
+  where n is the number of not null values in the sample, d is the number
+  of distinct values among them, f1 is the number of the values found in
+  the sample only once, and q is the sampled fraction of the rows. With
+  n/q not null values in the table the average frequency of a value is
+  estimated as (n - (1-q)*f1) / (q*d), which is never less than 1.
 */
 
 inline
-void Column_statistics_collected::finish(ha_rows rows)
+void Column_statistics_collected::finish(ha_rows rows, double sample_fraction)
 {
   double val;
 
+  sample_size= rows;
+  set_not_null(COLUMN_STAT_SAMPLE_SIZE);
+
   if (rows)
   {
      val= (double) nulls / rows;
@@ -2266,15 +2517,25 @@ void Column_statistics_collected::finish(ha_rows rows)
   }
   if (count_distinct)
   {
-    ulonglong distincts;
+    ulonglong distincts, singles= 0;
     uint hist_size= count_distinct->get_hist_size();
-    if (hist_size == 0)
-      distincts= count_distinct->get_value();
+    if (hist_size)
+    {
+      distincts= count_distinct->get_value_with_histogram(rows - nulls,
+                                                          &singles);
+      hist_size= count_distinct->get_hist_size();
+    }
+    else if (sample_fraction < 1.0)
+      distincts= count_distinct->get_value_and_singles(&singles);
     else
-      distincts= count_distinct->get_value_with_histogram(rows - nulls);
+      distincts= count_distinct->get_value();
     if (distincts)
     {
-      val= (double) (rows - nulls) / distincts;
+      if (sample_fraction < 1.0)
+        val= ((rows - nulls) - (1.0 - sample_fraction) * singles) /
+             (sample_fraction * distincts);
+      else
+        val= (double) (rows - nulls) / distincts;
       set_avg_frequency(val); 
       set_not_null(COLUMN_STAT_AVG_FREQUENCY);
     }
@@ -2453,6 +2714,8 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
   Field *table_field;
   ha_rows rows= 0;
   handler *file=table->file;
+  double sample_fraction= thd->variables.analyze_sample_percentage / 100;
+  bool sampling= sample_fraction < 1.0;
 
   DBUG_ENTER("collect_statistics_for_table");
 
@@ -2467,12 +2730,26 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
     table_field->collected_stats->init(thd, table_field);
   }
 
-  /* Perform a full table scan to collect statistics on 'table's columns */
-  if (!(rc= file->ha_rnd_init(TRUE)))
+  /*
+    Perform a full table scan, or a scan of a sample of the table if
+    analyze_sample_percentage is less than 100, to collect statistics
+    on 'table's columns. The seed of the sampling depends only on the
+    size of the table, so the sample is the same for the same data.
+  */
+  if (sampling)
+  {
+    file->info(HA_STATUS_VARIABLE | HA_STATUS_NO_LOCK);
+    rc= file->ha_sample_init(sample_fraction,
+                             (ulong) (file->stats.records + 1));
+  }
+  else
+    rc= file->ha_rnd_init(TRUE);
+  if (!rc)
   {  
     DEBUG_SYNC(table->in_use, "statistics_collection_start");
 
-    while ((rc= file->ha_rnd_next(table->record[0])) != HA_ERR_END_OF_FILE)
+    while ((rc= sampling ? file->ha_sample_next(table->record[0]) :
+                file->ha_rnd_next(table->record[0])) != HA_ERR_END_OF_FILE)
     {
       if (thd->killed)
         break;
@@ -2496,7 +2773,10 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
         break;
       rows++;
     }
-    file->ha_rnd_end();
+    if (sampling)
+      file->ha_sample_end();
+    else
+      file->ha_rnd_end();
   }
   rc= (rc == HA_ERR_END_OF_FILE && !thd->killed) ? 0 : 1;
 
@@ -2508,7 +2788,22 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
   if (!rc)
   {
     table->collected_stats->cardinality_is_null= FALSE;
-    table->collected_stats->cardinality= rows;
+    if (!sampling)
+      table->collected_stats->cardinality= rows;
+    else if (file->ha_table_flags() & HA_STATS_RECORDS_IS_EXACT)
+    {
+      /*
+        The share of the rows actually sampled is a better estimate of
+        the fraction than the requested one, especially when the rows
+        are sampled by blocks.
+      */
+      table->collected_stats->cardinality= file->stats.records;
+      if (file->stats.records)
+        sample_fraction= MY_MIN((double) rows / file->stats.records, 1.0);
+    }
+    else
+      table->collected_stats->cardinality=
+        (ha_rows) (rows / sample_fraction + 0.5);
   }
 
   bitmap_clear_all(table->write_set);
@@ -2519,7 +2814,8 @@ int collect_statistics_for_table(THD *thd, TABLE *table)
       continue;
     bitmap_set_bit(table->write_set, table_field->field_index); 
     if (!rc)
-      table_field->collected_stats->finish(rows);
+      table_field->collected_stats->finish(rows, sampling ? sample_fraction :
+                                                            1.0);
     else
       table_field->collected_stats->cleanup();
   }
@@ -3459,6 +3755,48 @@ double get_column_avg_frequency(Field * field)
 } 
 
 
+/**
+  @brief
+  Get the selectivity of an equality of a column in an equi-join
+
+  @param
+  field       The column from the equality
+
+  @details
+  The function estimates the fraction of rows of the table of 'field'
+  that match a row of the other table joined by an equality over 'field'.
+  Without a histogram of the type MCV_HB the estimate is
+  avg_frequency/cardinality. With such a histogram the skew of the values
+  of the column is taken into account: see Histogram::eq_join_selectivity().
+*/
+
+double get_column_eq_join_selectivity(Field *field)
+{
+  TABLE *table= field->table;
+  double records= table->stat_records();
+  double sel= get_column_avg_frequency(field) / records;
+
+  if (!table->s->field)
+    return sel;
+
+  Column_statistics *col_stats= table->s->field[field->field_index]->read_stats;
+  if (col_stats && col_stats->histogram.get_type() == MCV_HB &&
+      col_stats->histogram.is_available() &&
+      !col_stats->is_null(COLUMN_STAT_AVG_FREQUENCY))
+  {
+    double non_nulls= records * (1.0 - col_stats->get_nulls_ratio());
+    if (non_nulls >= 1.0)
+    {
+      double avg_sel= col_stats->get_avg_frequency() / non_nulls;
+      set_if_smaller(avg_sel, 1.0);
+      sel= col_stats->histogram.eq_join_selectivity(avg_sel) *
+           non_nulls / records;
+    }
+  }
+  return sel;
+}
+
+
 /**
   @brief
   Estimate the number of rows in a column range using data from stat tables 
@@ -3560,7 +3898,9 @@ double get_column_range_cardinality(Field *field,
       if (!hist->is_available())
         sel= (max_mp_pos - min_mp_pos);
       else
-        sel= hist->range_selectivity(min_mp_pos, max_mp_pos);
+        sel= hist->range_selectivity(min_mp_pos, max_mp_pos,
+                                     (min_endp ? range_flag & NEAR_MIN : 0) |
+                                     (max_endp ? range_flag & NEAR_MAX : 0));
       res= col_non_nulls * sel;
       set_if_bigger(res, col_stats->get_avg_frequency());
     }
@@ -3607,7 +3947,7 @@ double get_column_range_cardinality(Field *field,
       value.
 */
 
-double Histogram::point_selectivity(double pos, double avg_sel)
+double Histogram::hb_point_selectivity(double pos, double avg_sel)
 {
   double sel;
   /* Find the bucket that contains the value 'pos'. */
@@ -3688,3 +4028,112 @@ double Histogram::point_selectivity(double pos, double avg_sel)
   return sel;
 }
 
+
+/*
+  Estimate selectivity of "col=const" using a histogram of the type MCV_HB
+
+  @param pos      Position of the "const" between column's min_value and 
+                  max_value.  This is a number in [0..1] range.
+  @param avg_sel  Average selectivity of condition "col=const" in this table.
+
+  @details
+    The frequency of the value is taken from the list of the most common
+    values if the value is there. Otherwise the value is looked for in the
+    height-balanced part of the histogram that covers the rest of the rows
+    and the rest of the distinct values.
+*/
+
+double Histogram::mcv_point_selectivity(double pos, double avg_sel)
+{
+  uint mcv_count= get_mcv_count();
+  int mcv= find_mcv(get_pos_value(pos));
+  if (mcv >= 0)
+    return get_mcv_frequency(mcv);
+
+  double rest_sel= 1.0;
+  double min_mcv_sel= 1.0;
+  for (uint i= 0; i < mcv_count; i++)
+  {
+    double freq= get_mcv_frequency(i);
+    rest_sel-= freq;
+    set_if_smaller(min_mcv_sel, freq);
+  }
+  double rest_distincts= 1.0 / avg_sel - mcv_count;
+  if (rest_sel * prec_factor() < 1.0 || rest_distincts < 1.0)
+  {
+    /*
+      All values of the column are in the list: if the value is there
+      at all it is rarer than any value from the list.
+    */
+    return min_mcv_sel / 2;
+  }
+  if (!get_width())
+    return rest_sel / rest_distincts;
+  return rest_sel * hb_point_selectivity(pos, 1.0 / rest_distincts);
+}
+
+
+/*
+  Estimate selectivity of "min_pos <= col <= max_pos" using a histogram
+  of the type MCV_HB: the most common values at the excluded ends of the
+  range are not counted
+*/
+
+double Histogram::mcv_range_selectivity(double min_pos, double max_pos,
+                                        uint range_flag)
+{
+  uint min_value= get_pos_value(min_pos);
+  uint max_value= get_pos_value(max_pos);
+  double sel= 0.0;
+  double rest_sel= 1.0;
+  for (uint i= 0; i < get_mcv_count(); i++)
+  {
+    double freq= get_mcv_frequency(i);
+    uint val= get_mcv_value(i);
+    rest_sel-= freq;
+    if ((val > min_value || (val == min_value && !(range_flag & NEAR_MIN))) &&
+        (val < max_value || (val == max_value && !(range_flag & NEAR_MAX))))
+      sel+= freq;
+  }
+  if (rest_sel * prec_factor() >= 1.0 && get_width())
+    sel+= rest_sel * hb_range_selectivity(min_pos, max_pos);
+  set_if_smaller(sel, 1.0);
+  return sel;
+}
+
+
+/*
+  Estimate selectivity of "col=expr" using a histogram when the values of
+  expr are distributed as the values of the column, as it is for the
+  equi-joins over the columns with the same data
+
+  @param avg_sel  Average selectivity of condition "col=const" in this table.
+
+  @details
+    The selectivity is the sum of the squares of the frequencies of the
+    values. It is computed exactly for the most common values, while the
+    rest of the values are considered to have the same frequency. For the
+    skewed columns this is bigger than avg_sel, as the most common values
+    match more rows more often.
+*/
+
+double Histogram::eq_join_selectivity(double avg_sel)
+{
+  uint mcv_count= get_mcv_count();
+  if (!mcv_count)
+    return avg_sel;
+
+  double sel= 0.0;
+  double rest_sel= 1.0;
+  for (uint i= 0; i < mcv_count; i++)
+  {
+    double freq= get_mcv_frequency(i);
+    sel+= freq * freq;
+    rest_sel-= freq;
+  }
+  double rest_distincts= 1.0 / avg_sel - mcv_count;
+  if (rest_sel * prec_factor() >= 1.0 && rest_distincts >= 1.0)
+    sel+= rest_sel * rest_sel / rest_distincts;
+  return sel;
+}
+
@@ -28,7 +28,8 @@ typedef
 enum enum_histogram_type
 {
   SINGLE_PREC_HB,
-  DOUBLE_PREC_HB
+  DOUBLE_PREC_HB,
+  MCV_HB
 } Histogram_type;
 
 enum enum_stat_tables
@@ -67,7 +68,8 @@ enum enum_column_stat_col
   COLUMN_STAT_AVG_FREQUENCY,
   COLUMN_STAT_HIST_SIZE,
   COLUMN_STAT_HIST_TYPE,
-  COLUMN_STAT_HISTOGRAM
+  COLUMN_STAT_HISTOGRAM,
+  COLUMN_STAT_SAMPLE_SIZE
 };
 
 enum enum_index_stat_col
@@ -103,17 +105,35 @@ void set_statistics_for_table(THD *thd, TABLE *table);
 
 double get_column_avg_frequency(Field * field);
 
+double get_column_eq_join_selectivity(Field *field);
+
 double get_column_range_cardinality(Field *field,
                                     key_range *min_endp,
                                     key_range *max_endp,
                                     uint range_flag);
 
+/*
+  The histograms of the type MCV_HB consist of two parts. The first part is
+  the list of the most common values of the column together with their
+  frequencies. The second part is a double precision height-balanced
+  histogram built for the rest of the values. The layout of the array of
+  values of such a histogram is:
+    - the number k of the most common values (2 bytes),
+    - k pairs of the position of a value and of its frequency among the
+      not null values (2+2 bytes), sorted by the positions,
+    - the bounds of the buckets of the height-balanced part (2 bytes each).
+  If all values of the column fit into the list the histogram is a
+  frequency histogram: its second part is empty.
+*/
+#define MCV_HB_HEADER_SIZE 2
+#define MCV_HB_ENTRY_SIZE  4
+
 class Histogram
 {
 
 private:
   Histogram_type type;
-  uint8 size; /* Size of values array, in bytes */
+  uint16 size; /* Size of values array, in bytes */
   uchar *values;
 
   uint prec_factor()
@@ -122,11 +142,20 @@ private:
     case SINGLE_PREC_HB:
       return ((uint) (1 << 8) - 1);
     case DOUBLE_PREC_HB:
+    case MCV_HB:
       return ((uint) (1 << 16) - 1);
     }
     return 1;
   }
 
+  /* The bounds of the buckets of the height-balanced part */
+  uchar *get_bucket_values()
+  {
+    if (type == MCV_HB)
+      return values + MCV_HB_HEADER_SIZE + get_mcv_count() * MCV_HB_ENTRY_SIZE;
+    return values;
+  }
+
 public:
   uint get_width()
   {
@@ -135,10 +164,32 @@ public:
       return size;
     case DOUBLE_PREC_HB:
       return size / 2;
+    case MCV_HB:
+      if (size < MCV_HB_HEADER_SIZE)
+        return 0;
+      return (size - MCV_HB_HEADER_SIZE -
+              get_mcv_count() * MCV_HB_ENTRY_SIZE) / 2;
     }
     return 0;
   }
 
+  /* The number of the most common values in a histogram of type MCV_HB */
+  uint get_mcv_count()
+  {
+    if (type != MCV_HB || size < MCV_HB_HEADER_SIZE)
+      return 0;
+    return (uint) uint2korr(values);
+  }
+
+  /* The maximal number of the most common values a histogram can hold */
+  uint get_max_mcv_count()
+  {
+    if (type != MCV_HB || size < MCV_HB_HEADER_SIZE)
+      return 0;
+    /* The list takes at most a half of the histogram */
+    return (size - MCV_HB_HEADER_SIZE) / (2 * MCV_HB_ENTRY_SIZE);
+  }
+
 private:
   uint get_value(uint i)
   {
@@ -147,11 +198,26 @@ private:
     case SINGLE_PREC_HB:
       return (uint) (((uint8 *) values)[i]);
     case DOUBLE_PREC_HB:
-      return (uint) uint2korr(values + i * 2);
+    case MCV_HB:
+      return (uint) uint2korr(get_bucket_values() + i * 2);
     }
     return 0;
   }
 
+  uint get_mcv_value(uint i)
+  {
+    DBUG_ASSERT(i < get_mcv_count());
+    return (uint) uint2korr(values + MCV_HB_HEADER_SIZE +
+                            i * MCV_HB_ENTRY_SIZE);
+  }
+
+  double get_mcv_frequency(uint i)
+  {
+    DBUG_ASSERT(i < get_mcv_count());
+    return (double) uint2korr(values + MCV_HB_HEADER_SIZE +
+                              i * MCV_HB_ENTRY_SIZE + 2) / prec_factor();
+  }
+
   /* Find the bucket which value 'pos' falls into. */
   uint find_bucket(double pos, bool first)
   {
@@ -191,6 +257,21 @@ private:
     return i;
   }
 
+  double hb_range_selectivity(double min_pos, double max_pos)
+  {
+    double sel;
+    double bucket_sel= 1.0/(get_width() + 1);  
+    uint min= find_bucket(min_pos, TRUE);
+    uint max= find_bucket(max_pos, FALSE);
+    sel= bucket_sel * (max - min + 1);
+    return sel;
+  } 
+
+  double hb_point_selectivity(double pos, double avg_sel);
+  double mcv_range_selectivity(double min_pos, double max_pos,
+                               uint range_flag);
+  double mcv_point_selectivity(double pos, double avg_sel);
+
 public:
 
   uint get_size() { return (uint) size; }
@@ -199,13 +280,17 @@ public:
 
   uchar *get_values() { return (uchar *) values; }
 
-  void set_size (ulonglong sz) { size= (uint8) sz; }
+  void set_size (ulonglong sz) { size= (uint16) sz; }
 
   void set_type (Histogram_type t) { type= t; }
 
   void set_values (uchar *vals) { values= (uchar *) vals; }
 
-  bool is_available() { return get_size() > 0 && get_values(); }
+  bool is_available()
+  {
+    return get_size() > 0 && get_values() &&
+           (get_width() > 0 || get_mcv_count() > 0);
+  }
 
   void set_value(uint i, double val)
   {
@@ -214,7 +299,8 @@ public:
       ((uint8 *) values)[i]= (uint8) (val * prec_factor());
       return;
     case DOUBLE_PREC_HB:
-      int2store(values + i * 2, val * prec_factor());
+    case MCV_HB:
+      int2store(get_bucket_values() + i * 2, val * prec_factor());
       return;
     }
   }
@@ -226,25 +312,74 @@ public:
       ((uint8 *) values)[i]= ((uint8 *) values)[i-1];
       return;
     case DOUBLE_PREC_HB:
-      int2store(values + i * 2, uint2korr(values + i * 2 - 2));
+    case MCV_HB:
+      uchar *bucket_values= get_bucket_values();
+      int2store(bucket_values + i * 2, uint2korr(bucket_values + i * 2 - 2));
       return;
     }
   }
 
-  double range_selectivity(double min_pos, double max_pos)
+  void set_mcv_count(uint count)
   {
-    double sel;
-    double bucket_sel= 1.0/(get_width() + 1);  
-    uint min= find_bucket(min_pos, TRUE);
-    uint max= find_bucket(max_pos, FALSE);
-    sel= bucket_sel * (max - min + 1);
-    return sel;
+    DBUG_ASSERT(count <= get_max_mcv_count());
+    int2store(values, count);
+  }
+
+  void set_mcv(uint i, uint pos_value, double frequency)
+  {
+    uchar *entry= values + MCV_HB_HEADER_SIZE + i * MCV_HB_ENTRY_SIZE;
+    int2store(entry, pos_value);
+    /* A value from the list never gets zero frequency */
+    int2store(entry + 2, MY_MAX((uint) (frequency * prec_factor() + 0.5), 1));
+  }
+
+  /* Get the value at the position 'pos' scaled as stored in the histogram */
+  uint get_pos_value(double pos) { return (uint) (pos * prec_factor()); }
+
+  /*
+    Find the most common value at the position 'pos_value' scaled by
+    prec_factor(). Return its number in the list or -1 if it is not there.
+  */
+  int find_mcv(uint pos_value)
+  {
+    int lp= 0;
+    int rp= (int) get_mcv_count() - 1;
+    while (lp <= rp)
+    {
+      int i= (lp + rp) / 2;
+      uint val= get_mcv_value(i);
+      if (val == pos_value)
+        return i;
+      if (val < pos_value)
+        lp= i + 1;
+      else
+        rp= i - 1;
+    }
+    return -1;
+  }
+
+  /*
+    Estimate selectivity of a range using a histogram: NEAR_MIN/NEAR_MAX
+    in range_flag exclude the ends of the range
+  */
+  double range_selectivity(double min_pos, double max_pos, uint range_flag)
+  {
+    if (type == MCV_HB)
+      return mcv_range_selectivity(min_pos, max_pos, range_flag);
+    return hb_range_selectivity(min_pos, max_pos);
   } 
   
   /*
     Estimate selectivity of "col=const" using a histogram
   */
-  double point_selectivity(double pos, double avg_sel);
+  double point_selectivity(double pos, double avg_sel)
+  {
+    if (type == MCV_HB)
+      return mcv_point_selectivity(pos, avg_sel);
+    return hb_point_selectivity(pos, avg_sel);
+  }
+
+  double eq_join_selectivity(double avg_sel);
 };
 
 
@@ -332,11 +467,14 @@ private:
 public:
 
   Histogram histogram;
+
+  /* The number of rows the statistics has been collected from */
+  ha_rows sample_size;
  
   void set_all_nulls()
   {
     column_stat_nulls= 
-      ((1 << (COLUMN_STAT_HISTOGRAM-COLUMN_STAT_COLUMN_NAME))-1) <<
+      ((1 << (COLUMN_STAT_SAMPLE_SIZE-COLUMN_STAT_COLUMN_NAME))-1) <<
       (COLUMN_STAT_COLUMN_NAME+1);
   }
 
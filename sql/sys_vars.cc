@@ -2144,6 +2144,15 @@ static Sys_var_ulong Sys_optimizer_use_condition_selectivity(
        SESSION_VAR(optimizer_use_condition_selectivity), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, 5), DEFAULT(1), BLOCK_SIZE(1));
 
+static Sys_var_mybool Sys_prepared_plan_cache(
+       "prepared_plan_cache",
+       "Reuse the join orders and the access methods chosen for the selects "
+       "of a prepared statement in its subsequent executions, while the "
+       "tables and their statistics do not change and the parameters fall "
+       "into the same selectivity classes",
+       SESSION_VAR(prepared_plan_cache), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
 /** Warns about deprecated value 63 */
 static bool fix_optimizer_search_depth(sys_var *self, THD *thd,
                                        enum_var_type type)
@@ -2194,6 +2203,9 @@ export const char *optimizer_switch_names[]=
   "table_elimination",
   "extended_keys",
   "exists_to_in",
+  "join_cache_grace",
+  "hash_group_by",
+  "batch_cond",
   "default", NullS
 };
 /** propagates changes to @@engine_condition_pushdown */
@@ -2236,7 +2248,10 @@ static Sys_var_flagset Sys_optimizer_switch(
         "subquery_cache, "
         "table_elimination, "
         "extended_keys, "
-        "exists_to_in "
+        "exists_to_in, "
+        "join_cache_grace, "
+        "hash_group_by, "
+        "batch_cond "
        "} and val is one of {on, off, default}",
        SESSION_VAR(optimizer_switch), CMD_LINE(REQUIRED_ARG),
        optimizer_switch_names, DEFAULT(OPTIMIZER_SWITCH_DEFAULT),
@@ -2615,6 +2630,15 @@ static Sys_var_ulong Sys_query_cache_limit(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(NULL),
        ON_UPDATE(fix_query_cache_limit));
 
+static Sys_var_ulong Sys_query_cache_partitions(
+       "query_cache_partitions",
+       "Number of independently locked partitions the query cache is "
+       "split into. Statements are assigned to partitions by a hash of "
+       "their text, database and flags",
+       READ_ONLY GLOBAL_VAR(query_cache_partitions), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, QUERY_CACHE_MAX_PARTITIONS), DEFAULT(1),
+       BLOCK_SIZE(1));
+
 static bool fix_qcache_min_res_unit(sys_var *self, THD *thd, enum_var_type type)
 {
   query_cache_min_res_unit=
@@ -2842,6 +2866,15 @@ static Sys_var_ulonglong Sys_sort_buffer(
        VALID_RANGE(MIN_SORT_MEMORY, SIZE_T_MAX), DEFAULT(MAX_SORT_MEMORY),
        BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_sort_threads(
+       "sort_threads",
+       "Number of background threads which sort and write the runs of a "
+       "sort that does not fit into sort_buffer_size, while more rows are "
+       "read. Each thread uses its own buffer of sort_buffer_size. "
+       "0 sorts in the connection thread only",
+       SESSION_VAR(sort_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, MAX_SORT_THREADS), DEFAULT(0), BLOCK_SIZE(1));
+
 export ulonglong expand_sql_mode(ulonglong sql_mode)
 {
   if (sql_mode & MODE_ANSI)
@@ -3068,6 +3101,15 @@ static Sys_var_ulong Sys_table_cache_size(
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(fix_table_open_cache));
 
+static Sys_var_uint Sys_table_cache_instances(
+       "table_open_cache_instances",
+       "Number of table cache instances. Unused tables are kept in the "
+       "instance of the CPU the thread that used them ran on, so threads "
+       "on different CPUs don't contend for the same lock when they open "
+       "and close tables",
+       READ_ONLY GLOBAL_VAR(tc_instances), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(8), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_thread_cache_size(
        "thread_cache_size",
        "How many threads we should keep in a cache for reuse",
@@ -3143,6 +3185,37 @@ static Sys_var_uint Sys_threadpool_oversubscribe(
   GLOBAL_VAR(threadpool_oversubscribe), CMD_LINE(REQUIRED_ARG),
   VALID_RANGE(1, 1000), DEFAULT(3), BLOCK_SIZE(1)
 );
+static Sys_var_mybool Sys_threadpool_work_stealing(
+  "thread_pool_work_stealing",
+  "Allow idle worker threads to handle events queued in other thread "
+  "groups. Groups that last ran on the same NUMA node are preferred.",
+  GLOBAL_VAR(threadpool_work_stealing), CMD_LINE(OPT_ARG),
+  DEFAULT(TRUE)
+);
+static const char *threadpool_high_prio_mode_names[]=
+{ "transactions", "statements", "none", 0 };
+static Sys_var_enum Sys_threadpool_high_prio_mode(
+  "thread_pool_high_prio_mode",
+  "High priority queue mode: one of 'transactions', 'statements' or 'none'. "
+  "In the 'transactions' mode the thread pool uses both high- and "
+  "low-priority queues depending on whether an event is generated by an "
+  "already started transaction or a connection holding locks, and whether "
+  "it has any high priority tickets left. In the 'statements' mode all "
+  "events (i.e. individual statements) always go to the high priority "
+  "queue, regardless of the transactional state and high priority tickets. "
+  "'none' is the opposite of 'statements', i.e. disables the high priority "
+  "queue completely.",
+  SESSION_VAR(threadpool_high_prio_mode), CMD_LINE(REQUIRED_ARG),
+  threadpool_high_prio_mode_names, DEFAULT(TP_HIGH_PRIO_MODE_TRANSACTIONS)
+);
+static Sys_var_uint Sys_threadpool_high_prio_tickets(
+  "thread_pool_high_prio_tickets",
+  "Number of tickets to enter the high priority event queue for each "
+  "transaction. Limits how many events in a row a connection can put "
+  "ahead of the low priority queue, so that it is not starved.",
+  SESSION_VAR(threadpool_high_prio_tickets), CMD_LINE(REQUIRED_ARG),
+  VALID_RANGE(0, UINT_MAX), DEFAULT(UINT_MAX), BLOCK_SIZE(1)
+);
 static Sys_var_uint Sys_threadpool_size(
  "thread_pool_size",
  "Number of thread groups in the pool. "
@@ -4698,7 +4771,15 @@ static Sys_var_ulong Sys_histogram_size(
        "Number of bytes used for a histogram. "
        "If set to 0, no histograms are created by ANALYZE.",
        SESSION_VAR(histogram_size), CMD_LINE(REQUIRED_ARG),
-       VALID_RANGE(0, 255), DEFAULT(0), BLOCK_SIZE(1));
+       VALID_RANGE(0, 65535), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_double Sys_analyze_sample_percentage(
+       "analyze_sample_percentage",
+       "Percentage of rows from the table ANALYZE TABLE will sample to "
+       "collect the engine-independent statistics on the columns. "
+       "If set to 100, all rows are read.",
+       SESSION_VAR(analyze_sample_percentage), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0.01, 100), DEFAULT(100));
 
 extern const char *histogram_types[];
 static Sys_var_enum Sys_histogram_type(
@@ -4706,7 +4787,9 @@ static Sys_var_enum Sys_histogram_type(
        "Specifies type of the histograms created by ANALYZE. "
        "Possible values are: "
        "SINGLE_PREC_HB - single precision height-balanced, "
-       "DOUBLE_PREC_HB - double precision height-balanced.",
+       "DOUBLE_PREC_HB - double precision height-balanced, "
+       "MCV_HB - most common values with their frequencies and "
+       "double precision height-balanced for the rest values.",
        SESSION_VAR(histogram_type), CMD_LINE(REQUIRED_ARG),
        histogram_types, DEFAULT(0));
 
@@ -325,7 +325,7 @@ TABLE_SHARE *alloc_table_share(const char *db, const char *table_name,
                      &share->LOCK_share, MY_MUTEX_INIT_SLOW);
     mysql_mutex_init(key_TABLE_SHARE_LOCK_ha_data,
                      &share->LOCK_ha_data, MY_MUTEX_INIT_FAST);
-    tdc_init_share(share);
+    tdc_assign_new_table_id(share);
   }
   DBUG_RETURN(share);
 }
@@ -422,7 +422,6 @@ void TABLE_SHARE::destroy()
   {
     mysql_mutex_destroy(&LOCK_share);
     mysql_mutex_destroy(&LOCK_ha_data);
-    tdc_deinit_share(this);
   }
   my_hash_free(&name_hash);
 
@@ -3840,16 +3839,16 @@ bool TABLE_SHARE::visit_subgraph(Wait_for_flush *wait_for_flush,
 
   /*
     To protect all_tables list from being concurrently modified
-    while we are iterating through it we increment tdc.all_tables_refs.
+    while we are iterating through it we increment tdc->all_tables_refs.
     This does not introduce deadlocks in the deadlock detector
-    because we won't try to acquire tdc.LOCK_table_share while
+    because we won't try to acquire tdc->LOCK_table_share while
     holding a write-lock on MDL_lock::m_rwlock.
   */
-  mysql_mutex_lock(&tdc.LOCK_table_share);
-  tdc.all_tables_refs++;
-  mysql_mutex_unlock(&tdc.LOCK_table_share);
+  mysql_mutex_lock(&tdc->LOCK_table_share);
+  tdc->all_tables_refs++;
+  mysql_mutex_unlock(&tdc->LOCK_table_share);
 
-  All_share_tables_list::Iterator tables_it(tdc.all_tables);
+  All_share_tables_list::Iterator tables_it(tdc->all_tables);
 
   /*
     In case of multiple searches running in parallel, avoid going
@@ -3867,7 +3866,7 @@ bool TABLE_SHARE::visit_subgraph(Wait_for_flush *wait_for_flush,
 
   while ((table= tables_it++))
   {
-    DBUG_ASSERT(table->in_use && tdc.flushed);
+    DBUG_ASSERT(table->in_use && tdc->flushed);
     if (gvisitor->inspect_edge(&table->in_use->mdl_context))
     {
       goto end_leave_node;
@@ -3877,7 +3876,7 @@ bool TABLE_SHARE::visit_subgraph(Wait_for_flush *wait_for_flush,
   tables_it.rewind();
   while ((table= tables_it++))
   {
-    DBUG_ASSERT(table->in_use && tdc.flushed);
+    DBUG_ASSERT(table->in_use && tdc->flushed);
     if (table->in_use->mdl_context.visit_subgraph(gvisitor))
     {
       goto end_leave_node;
@@ -3890,10 +3889,10 @@ end_leave_node:
   gvisitor->leave_node(src_ctx);
 
 end:
-  mysql_mutex_lock(&tdc.LOCK_table_share);
-  if (!--tdc.all_tables_refs)
-    mysql_cond_broadcast(&tdc.COND_release);
-  mysql_mutex_unlock(&tdc.LOCK_table_share);
+  mysql_mutex_lock(&tdc->LOCK_table_share);
+  if (!--tdc->all_tables_refs)
+    mysql_cond_broadcast(&tdc->COND_release);
+  mysql_mutex_unlock(&tdc->LOCK_table_share);
 
   return result;
 }
@@ -3901,7 +3900,7 @@ end:
 
 /**
   Wait until the subject share is removed from the table
-  definition cache and make sure it's destroyed.
+  definition cache.
 
   @param mdl_context     MDL context for thread which is going to wait.
   @param abstime         Timeout for waiting as absolute time value.
@@ -3928,15 +3927,16 @@ bool TABLE_SHARE::wait_for_old_version(THD *thd, struct timespec *abstime,
   Wait_for_flush ticket(mdl_context, this, deadlock_weight);
   MDL_wait::enum_wait_status wait_status;
 
-  mysql_mutex_assert_owner(&tdc.LOCK_table_share);
-  DBUG_ASSERT(tdc.flushed);
+  mysql_mutex_assert_owner(&tdc->LOCK_table_share);
+  DBUG_ASSERT(tdc->flushed);
 
-  tdc.m_flush_tickets.push_front(&ticket);
+  tdc->m_flush_tickets.push_front(&ticket);
 
   mdl_context->m_wait.reset_status();
 
-  mysql_mutex_unlock(&tdc.LOCK_table_share);
+  mysql_mutex_unlock(&tdc->LOCK_table_share);
 
+  mdl_context->materialize_fast_path_locks();
   mdl_context->will_wait_for(&ticket);
 
   mdl_context->find_deadlock();
@@ -3946,34 +3946,17 @@ bool TABLE_SHARE::wait_for_old_version(THD *thd, struct timespec *abstime,
 
   mdl_context->done_waiting_for();
 
-  mysql_mutex_lock(&tdc.LOCK_table_share);
-
-  tdc.m_flush_tickets.remove(&ticket);
-
-  if (tdc.m_flush_tickets.is_empty() && tdc.ref_count == 0)
-  {
-    /*
-      If our thread was the last one using the share,
-      we must destroy it here.
-    */
-    mysql_mutex_unlock(&tdc.LOCK_table_share);
-    destroy();
-  }
-  else
-    mysql_mutex_unlock(&tdc.LOCK_table_share);
-
-
   /*
-    In cases when our wait was aborted by KILL statement,
-    a deadlock or a timeout, the share might still be referenced,
-    so we don't delete it. Note, that we can't determine this
-    condition by checking wait_status alone, since, for example,
-    a timeout can happen after all references to the table share
-    were released, but before the share is removed from the
-    cache and we receive the notification. This is why
-    we first destroy the share, and then look at
-    wait_status.
+    The thread removing the share from the cache waits for all tickets
+    to be removed before it frees the share, so it's safe to use it
+    until LOCK_table_share is released.
   */
+  TDC_element *element= tdc;
+  mysql_mutex_lock(&element->LOCK_table_share);
+  element->m_flush_tickets.remove(&ticket);
+  mysql_cond_broadcast(&element->COND_release);
+  mysql_mutex_unlock(&element->LOCK_table_share);
+
   switch (wait_status)
   {
   case MDL_wait::GRANTED:
@@ -4006,7 +3989,7 @@ bool TABLE_SHARE::wait_for_old_version(THD *thd, struct timespec *abstime,
 
 void TABLE::init(THD *thd, TABLE_LIST *tl)
 {
-  DBUG_ASSERT(s->tdc.ref_count > 0 || s->tmp_table != NO_TMP_TABLE);
+  DBUG_ASSERT(s->tmp_table != NO_TMP_TABLE || s->tdc->ref_count > 0);
 
   if (thd->lex->need_correct_ident())
     alias_name_used= my_strcasecmp(table_alias_charset,
@@ -333,7 +333,9 @@ public:
   struct st_sort_addon_field *addon_field;     /* Pointer to the fields info */
   void    (*unpack)(struct st_sort_addon_field *, uchar *, uchar *); /* To unpack back */
   uchar     *record_pointers;    /* If sorted in memory */
+  uchar     *record_pointers_end; /* End of packed addons in record_pointers */
   ha_rows   found_records;      /* How many records in sort */
+  bool      using_packed_addons; /* Addons are stored with their length */
 
   /** Sort filesort_buffer */
   void sort_buffer(Sort_param *param, uint count)
@@ -348,6 +350,9 @@ public:
   uchar **get_sort_keys()
   { return filesort_buffer.get_sort_keys(); }
 
+  Filesort_buffer *get_filesort_buffer()
+  { return &filesort_buffer; }
+
   uchar **alloc_sort_buffer(uint num_records, uint record_length)
   { return filesort_buffer.alloc_sort_buffer(num_records, record_length); }
 
@@ -490,6 +495,8 @@ TABLE_CATEGORY get_table_category(const LEX_STRING *db,
 
 struct TABLE_share;
 struct All_share_tables;
+struct TC_unused_tables;
+struct TDC_element;
 
 typedef struct st_table_field_type
 {
@@ -613,30 +620,12 @@ struct TABLE_SHARE
 
   typedef I_P_List <TABLE, TABLE_share> TABLE_list;
   typedef I_P_List <TABLE, All_share_tables> All_share_tables_list;
-  struct
-  {
-    /**
-      Protects ref_count, m_flush_tickets, all_tables, free_tables, flushed,
-      all_tables_refs.
-    */
-    mysql_mutex_t LOCK_table_share;
-    mysql_cond_t COND_release;
-    TABLE_SHARE *next, **prev;            /* Link to unused shares */
-    uint ref_count;                       /* How many TABLE objects uses this */
-    uint all_tables_refs;                 /* Number of refs to all_tables */
-    /**
-      List of tickets representing threads waiting for the share to be flushed.
-    */
-    Wait_for_flush_list m_flush_tickets;
-    /*
-      Doubly-linked (back-linked) lists of used and unused TABLE objects
-      for this share.
-    */
-    All_share_tables_list all_tables;
-    TABLE_list free_tables;
-    ulong version;
-    bool flushed;
-  } tdc;
+  /**
+    Table definition cache element of this share: reference counting,
+    TABLE objects and flush state. NULL for shares that are not in the
+    table definition cache.
+  */
+  TDC_element *tdc;
 
   LEX_CUSTRING tabledef_version;
 
@@ -1025,12 +1014,18 @@ private:
   */
   TABLE *share_all_next, **share_all_prev;
   friend struct All_share_tables;
+  /**
+     Links for the LRU list of unused TABLE objects of a table cache
+     instance.
+  */
+  TABLE *tc_unused_next, **tc_unused_prev;
+  friend struct TC_unused_tables;
 
 public:
 
   THD	*in_use;                        /* Which thread uses this */
-  /* Time when table was released to table cache. Valid for unused tables. */
-  ulonglong tc_time;
+  /* Table cache instance holding the table. Valid for unused tables. */
+  uint tc_instance;
   Field **field;			/* Pointer to fields */
 
   uchar *record[2];			/* Pointer to records */
@@ -1416,6 +1411,19 @@ struct All_share_tables
 };
 
 
+struct TC_unused_tables
+{
+  static inline TABLE **next_ptr(TABLE *l)
+  {
+    return &l->tc_unused_next;
+  }
+  static inline TABLE ***prev_ptr(TABLE *l)
+  {
+    return &l->tc_unused_prev;
+  }
+};
+
+
 enum enum_schema_table_state
 { 
   NOT_PROCESSED= 0,
@@ -43,24 +43,62 @@
   - free_table_share()
 
   Table cache invariants:
-  - TABLE_SHARE::free_tables shall not contain objects with TABLE::in_use != 0
-  - TABLE_SHARE::free_tables shall not receive new objects if
-    TABLE_SHARE::tdc.flushed is true
+  - TDC_element::free_tables shall not contain objects with TABLE::in_use != 0
+  - TDC_element::free_tables shall not receive new objects if
+    TDC_element::flushed is true
+
+  Table definition cache is a lock-free hash of TDC_element objects,
+  so looking up a share doesn't take any global lock. Unused TABLE
+  objects are split between tc_instances table cache instances, each
+  with its own mutex and LRU list. A thread acquires and releases TABLE
+  objects through the instance of the CPU it is running on, so that
+  acquire/release of a cached TABLE doesn't lock the share.
+
+  Lock order: TDC_element::LOCK_table_share before
+  Table_cache_instance::LOCK_table_cache; LOCK_unused_shares before
+  TDC_element::LOCK_table_share.
 */
 
 #include "my_global.h"
 #include "hash.h"
 #include "table.h"
 #include "sql_base.h"
+#ifdef HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
 
 /** Configuration. */
 ulong tdc_size; /**< Table definition cache threshold for LRU eviction. */
 ulong tc_size; /**< Table cache threshold for LRU eviction. */
+uint tc_instances; /**< Number of table cache instances. */
+
+/**
+  Table cache instance.
+
+  Protects TDC_element::free_tables of this instance and holds all unused
+  TABLE objects of the instance in LRU order, least recently used first.
+*/
+
+struct Table_cache_instance
+{
+  mysql_mutex_t LOCK_table_cache;
+  I_P_List <TABLE, TC_unused_tables,
+            I_P_List_null_counter, I_P_List_fast_push_back<TABLE> >
+    free_tables;
+  /** Avoid false sharing between instances */
+  char pad[TC_CACHE_LINE_SIZE];
+};
+
 
 /** Data collections. */
-static HASH tdc_hash; /**< Collection of TABLE_SHARE objects. */
+static LF_HASH tdc_hash; /**< Collection of TABLE_SHARE objects. */
 /** Collection of unused TABLE_SHARE objects. */
-static TABLE_SHARE *oldest_unused_share, end_of_unused_share;
+static I_P_List <TDC_element,
+                 I_P_List_adapter<TDC_element, &TDC_element::next,
+                                  &TDC_element::prev>,
+                 I_P_List_null_counter,
+                 I_P_List_fast_push_back<TDC_element> > unused_shares;
+static Table_cache_instance *tc;
 
 static int64 tdc_version;  /* Increments on each reload */
 static int64 last_table_id;
@@ -72,28 +110,22 @@ static int32 tc_count; /**< Number of TABLE objects in table cache. */
 /**
   Protects unused shares list.
 
-  TABLE_SHARE::tdc.prev
-  TABLE_SHARE::tdc.next
-  oldest_unused_share
-  end_of_unused_share
+  TDC_element::prev
+  TDC_element::next
+  unused_shares
 */
 
 static mysql_mutex_t LOCK_unused_shares;
-static mysql_rwlock_t LOCK_tdc; /**< Protects tdc_hash. */
 my_atomic_rwlock_t LOCK_tdc_atomics; /**< Protects tdc_version. */
 
 #ifdef HAVE_PSI_INTERFACE
-static PSI_mutex_key key_LOCK_unused_shares, key_TABLE_SHARE_LOCK_table_share;
+static PSI_mutex_key key_LOCK_unused_shares, key_TABLE_SHARE_LOCK_table_share,
+                     key_LOCK_table_cache;
 static PSI_mutex_info all_tc_mutexes[]=
 {
   { &key_LOCK_unused_shares, "LOCK_unused_shares", PSI_FLAG_GLOBAL },
-  { &key_TABLE_SHARE_LOCK_table_share, "TABLE_SHARE::tdc.LOCK_table_share", 0 }
-};
-
-static PSI_rwlock_key key_rwlock_LOCK_tdc;
-static PSI_rwlock_info all_tc_rwlocks[]=
-{
-  { &key_rwlock_LOCK_tdc, "LOCK_tdc", PSI_FLAG_GLOBAL }
+  { &key_TABLE_SHARE_LOCK_table_share, "TABLE_SHARE::tdc.LOCK_table_share", 0 },
+  { &key_LOCK_table_cache, "LOCK_table_cache", 0 }
 };
 
 
@@ -112,15 +144,41 @@ static void init_tc_psi_keys(void)
   count= array_elements(all_tc_mutexes);
   mysql_mutex_register(category, all_tc_mutexes, count);
 
-  count= array_elements(all_tc_rwlocks);
-  mysql_rwlock_register(category, all_tc_rwlocks, count);
-
   count= array_elements(all_tc_conds);
   mysql_cond_register(category, all_tc_conds, count);
 }
 #endif
 
 
+/**
+  Get pins of the table definition cache hash for this thread.
+
+  @return Pins, or NULL if out of memory
+*/
+
+static LF_PINS *tdc_thd_pins(THD *thd)
+{
+  if (unlikely(!thd->tdc_hash_pins))
+    thd->tdc_hash_pins= lf_hash_get_pins(&tdc_hash);
+  return thd->tdc_hash_pins;
+}
+
+
+/**
+  Release pins of the table definition cache hash owned by this thread.
+*/
+
+void tdc_release_pins(THD *thd)
+{
+  /* The pins are gone with the hash if the THD outlives it. */
+  if (thd->tdc_hash_pins && tdc_inited)
+  {
+    lf_hash_put_pins(thd->tdc_hash_pins);
+    thd->tdc_hash_pins= 0;
+  }
+}
+
+
 /*
   Auxiliary routines for manipulating with per-share all/unused lists
   and tc_count counter.
@@ -145,46 +203,84 @@ uint tc_records(void)
 }
 
 
+/**
+  Get table cache instance to be used by the calling thread.
+
+  Threads running on the same CPU share an instance. If the CPU cannot
+  be determined, the instance is picked by thread id.
+*/
+
+static uint tc_current_instance(THD *thd)
+{
+#ifdef HAVE_SCHED_GETCPU
+  int cpu= sched_getcpu();
+  if (cpu >= 0)
+    return (uint) cpu % tc_instances;
+#endif
+  return (uint) (thd->thread_id % tc_instances);
+}
+
+
 /**
   Remove TABLE object from table cache.
 
   - decrement tc_count
-  - remove object from TABLE_SHARE::tdc.all_tables
+  - remove object from TDC_element::all_tables
 */
 
 static void tc_remove_table(TABLE *table)
 {
+  mysql_mutex_assert_owner(&table->s->tdc->LOCK_table_share);
   my_atomic_rwlock_wrlock(&LOCK_tdc_atomics);
   my_atomic_add32(&tc_count, -1);
   my_atomic_rwlock_wrunlock(&LOCK_tdc_atomics);
-  table->s->tdc.all_tables.remove(table);
+  table->s->tdc->all_tables.remove(table);
 }
 
 
 /**
   Wait for MDL deadlock detector to complete traversing tdc.all_tables.
 
-  Must be called before updating TABLE_SHARE::tdc.all_tables.
+  Must be called before updating TDC_element::all_tables.
 */
 
-static void tc_wait_for_mdl_deadlock_detector(TABLE_SHARE *share)
+static void tc_wait_for_mdl_deadlock_detector(TDC_element *element)
 {
-  while (share->tdc.all_tables_refs)
-    mysql_cond_wait(&share->tdc.COND_release, &share->tdc.LOCK_table_share);
+  while (element->all_tables_refs)
+    mysql_cond_wait(&element->COND_release, &element->LOCK_table_share);
 }
 
 
 /**
-  Get last element of tdc.free_tables.
+  Move all unused TABLE objects of a share to purge_tables.
+
+  While locked:
+  - remove unused objects from TDC_element::free_tables of each instance
+    and from TDC_element::all_tables
+  - decrement tc_count
+
+  @pre Caller holds TDC_element::LOCK_table_share and has waited for
+       the MDL deadlock detector.
 */
 
-static TABLE *tc_free_tables_back(TABLE_SHARE *share)
+static void tc_remove_all_unused_tables(TDC_element *element,
+                                        TABLE_SHARE::TABLE_list *purge_tables)
 {
-  TABLE_SHARE::TABLE_list::Iterator it(share->tdc.free_tables);
-  TABLE *entry, *last= 0;
-   while ((entry= it++))
-     last= entry;
-  return last;
+  TABLE *table;
+
+  mysql_mutex_assert_owner(&element->LOCK_table_share);
+  DBUG_ASSERT(!element->all_tables_refs);
+  for (uint i= 0; i < tc_instances; i++)
+  {
+    mysql_mutex_lock(&tc[i].LOCK_table_cache);
+    while ((table= element->free_tables[i].list.pop_front()))
+    {
+      tc[i].free_tables.remove(table);
+      tc_remove_table(table);
+      purge_tables->push_front(table);
+    }
+    mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+  }
 }
 
 
@@ -192,8 +288,8 @@ static TABLE *tc_free_tables_back(TABLE_SHARE *share)
   Free all unused TABLE objects.
 
   While locked:
-  - remove unused objects from TABLE_SHARE::tdc.free_tables and
-    TABLE_SHARE::tdc.all_tables
+  - remove unused objects from TDC_element::free_tables and
+    TDC_element::all_tables
   - decrement tc_count
 
   While unlocked:
@@ -203,32 +299,74 @@ static TABLE *tc_free_tables_back(TABLE_SHARE *share)
         periodicly flush all not used tables.
 */
 
+struct tc_purge_arg
+{
+  TABLE_SHARE::TABLE_list purge_tables;
+  bool mark_flushed;
+};
+
+
+static my_bool tc_purge_callback(TDC_element *element, tc_purge_arg *arg)
+{
+  mysql_mutex_lock(&element->LOCK_table_share);
+  tc_wait_for_mdl_deadlock_detector(element);
+  if (arg->mark_flushed)
+    element->flushed= true;
+  tc_remove_all_unused_tables(element, &arg->purge_tables);
+  mysql_mutex_unlock(&element->LOCK_table_share);
+  return FALSE;
+}
+
+
 void tc_purge(bool mark_flushed)
 {
-  TABLE_SHARE *share;
+  tc_purge_arg argument;
   TABLE *table;
-  TDC_iterator tdc_it;
-  TABLE_SHARE::TABLE_list purge_tables;
 
-  tdc_it.init();
-  while ((share= tdc_it.next()))
-  {
-    mysql_mutex_lock(&share->tdc.LOCK_table_share);
-    tc_wait_for_mdl_deadlock_detector(share);
+  argument.mark_flushed= mark_flushed;
+  tdc_iterate(0, (my_hash_walk_action) tc_purge_callback, &argument);
+  while ((table= argument.purge_tables.pop_front()))
+    intern_close_table(table);
+}
+
+
+/**
+  Evict the least recently used TABLE object of an instance.
 
-    if (mark_flushed)
-      share->tdc.flushed= true;
-    while ((table= share->tdc.free_tables.pop_front()))
+  The share of the evicted object is locked with trylock, because the
+  instance is locked first, contrary to the lock order. If it is busy,
+  nothing is evicted: number of objects in table cache will normalize
+  eventually.
+
+  @return Evicted object or NULL.
+*/
+
+static TABLE *tc_evict_lru_table(uint i)
+{
+  TABLE *table;
+  TDC_element *element;
+
+  mysql_mutex_lock(&tc[i].LOCK_table_cache);
+  if ((table= tc[i].free_tables.front()))
+  {
+    element= table->s->tdc;
+    if (!mysql_mutex_trylock(&element->LOCK_table_share))
     {
-      tc_remove_table(table);
-      purge_tables.push_front(table);
+      if (!element->all_tables_refs)
+      {
+        element->free_tables[i].list.remove(table);
+        tc[i].free_tables.remove(table);
+        tc_remove_table(table);
+      }
+      else
+        table= 0;
+      mysql_mutex_unlock(&element->LOCK_table_share);
     }
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+    else
+      table= 0;
   }
-  tdc_it.deinit();
-
-  while ((table= purge_tables.pop_front()))
-    intern_close_table(table);
+  mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+  return table;
 }
 
 
@@ -240,7 +378,7 @@ void tc_purge(bool mark_flushed)
   Added object cannot be evicted or acquired.
 
   While locked:
-  - add object to TABLE_SHARE::tdc.all_tables
+  - add object to TDC_element::all_tables
   - increment tc_count
   - evict LRU object from table cache if we reached threshold
 
@@ -252,10 +390,10 @@ void tc_add_table(THD *thd, TABLE *table)
 {
   bool need_purge;
   DBUG_ASSERT(table->in_use == thd);
-  mysql_mutex_lock(&table->s->tdc.LOCK_table_share);
-  tc_wait_for_mdl_deadlock_detector(table->s);
-  table->s->tdc.all_tables.push_front(table);
-  mysql_mutex_unlock(&table->s->tdc.LOCK_table_share);
+  mysql_mutex_lock(&table->s->tdc->LOCK_table_share);
+  tc_wait_for_mdl_deadlock_detector(table->s->tdc);
+  table->s->tdc->all_tables.push_front(table);
+  mysql_mutex_unlock(&table->s->tdc->LOCK_table_share);
 
   /* If we have too many TABLE instances around, try to get rid of them */
   my_atomic_rwlock_wrlock(&LOCK_tdc_atomics);
@@ -264,48 +402,14 @@ void tc_add_table(THD *thd, TABLE *table)
 
   if (need_purge)
   {
-    TABLE_SHARE *purge_share= 0;
-    TABLE_SHARE *share;
-    TABLE *entry;
-    ulonglong UNINIT_VAR(purge_time);
-    TDC_iterator tdc_it;
-
-    tdc_it.init();
-    while ((share= tdc_it.next()))
-    {
-      mysql_mutex_lock(&share->tdc.LOCK_table_share);
-      if ((entry= tc_free_tables_back(share)) &&
-          (!purge_share || entry->tc_time < purge_time))
-      {
-          purge_share= share;
-          purge_time= entry->tc_time;
-      }
-      mysql_mutex_unlock(&share->tdc.LOCK_table_share);
-    }
-
-    if (purge_share)
-    {
-      mysql_mutex_lock(&purge_share->tdc.LOCK_table_share);
-      tc_wait_for_mdl_deadlock_detector(purge_share);
-      tdc_it.deinit();
-      /*
-        It may happen that oldest table was acquired meanwhile. In this case
-        just go ahead, number of objects in table cache will normalize
-        eventually.
-      */
-      if ((entry= tc_free_tables_back(purge_share)) &&
-          entry->tc_time == purge_time)
-      {
-        entry->s->tdc.free_tables.remove(entry);
-        tc_remove_table(entry);
-        mysql_mutex_unlock(&purge_share->tdc.LOCK_table_share);
-        intern_close_table(entry);
-      }
-      else
-        mysql_mutex_unlock(&purge_share->tdc.LOCK_table_share);
-    }
-    else
-      tdc_it.deinit();
+    uint n= tc_current_instance(thd);
+    TABLE *entry= 0;
+
+    /* Prefer the instance of this thread, then look at the others. */
+    for (uint i= 0; i < tc_instances && !entry; i++)
+      entry= tc_evict_lru_table((n + i) % tc_instances);
+    if (entry)
+      intern_close_table(entry);
   }
 }
 
@@ -317,32 +421,45 @@ void tc_add_table(THD *thd, TABLE *table)
 
   Acquired object cannot be evicted or acquired again.
 
-  While locked:
-  - pop object from TABLE_SHARE::tdc.free_tables
+  The instance of the calling thread is tried first. If it has no unused
+  objects of the share, other instances are tried, so that objects left
+  by threads that ran on other CPUs are still reused.
 
-  While unlocked:
-  - mark object used by thd
+  While locked:
+  - pop object from TDC_element::free_tables
 
   @return TABLE object, or NULL if no unused objects.
 */
 
-static TABLE *tc_acquire_table(THD *thd, TABLE_SHARE *share)
+static TABLE *tc_acquire_table(THD *thd, TDC_element *element)
 {
-  TABLE *table;
+  uint n= tc_current_instance(thd);
 
-  mysql_mutex_lock(&share->tdc.LOCK_table_share);
-  table= share->tdc.free_tables.pop_front();
-  if (table)
+  for (uint j= 0; j < tc_instances; j++)
   {
-    DBUG_ASSERT(!table->in_use);
-    table->in_use= thd;
-    /* The ex-unused table must be fully functional. */
-    DBUG_ASSERT(table->db_stat && table->file);
-    /* The children must be detached from the table. */
-    DBUG_ASSERT(!table->file->extra(HA_EXTRA_IS_ATTACHED_CHILDREN));
+    uint i= (n + j) % tc_instances;
+    TABLE *table;
+
+    /* Dirty read: don't lock instances that have no objects for us. */
+    if (element->free_tables[i].list.is_empty())
+      continue;
+
+    mysql_mutex_lock(&tc[i].LOCK_table_cache);
+    if ((table= element->free_tables[i].list.pop_front()))
+    {
+      tc[i].free_tables.remove(table);
+      DBUG_ASSERT(!table->in_use);
+      table->in_use= thd;
+      mysql_mutex_unlock(&tc[i].LOCK_table_cache);
+      /* The ex-unused table must be fully functional. */
+      DBUG_ASSERT(table->db_stat && table->file);
+      /* The children must be detached from the table. */
+      DBUG_ASSERT(!table->file->extra(HA_EXTRA_IS_ATTACHED_CHILDREN));
+      return table;
+    }
+    mysql_mutex_unlock(&tc[i].LOCK_table_cache);
   }
-  mysql_mutex_unlock(&share->tdc.LOCK_table_share);
-  return table;
+  return 0;
 }
 
 
@@ -355,17 +472,17 @@ static TABLE *tc_acquire_table(THD *thd, TABLE_SHARE *share)
 
   While locked:
   - if object is marked for purge, decrement tc_count
-  - add object to TABLE_SHARE::tdc.free_tables
-  - evict LRU object from table cache if we reached threshold
+  - add object to TDC_element::free_tables
 
   While unlocked:
   - mark object not in use by any thread
-  - free evicted/purged object
+  - free purged object
 
   @note Another thread may mark share for purge any moment (even
   after version check). It means to-be-purged object may go to
-  unused lists. This other thread is expected to call tc_purge(),
-  which is synchronized with us on TABLE_SHARE::tdc.LOCK_table_share.
+  unused lists. This other thread is expected to call
+  tc_remove_all_unused_tables(), which is synchronized with us on
+  Table_cache_instance::LOCK_table_cache.
 
   @return
     @retval true  object purged
@@ -374,20 +491,26 @@ static TABLE *tc_acquire_table(THD *thd, TABLE_SHARE *share)
 
 bool tc_release_table(TABLE *table)
 {
+  TDC_element *element= table->s->tdc;
+  uint i;
   DBUG_ASSERT(table->in_use);
   DBUG_ASSERT(table->file);
 
   if (table->needs_reopen() || tc_records() > tc_size)
-  {
-    mysql_mutex_lock(&table->s->tdc.LOCK_table_share);
     goto purge;
-  }
 
-  table->tc_time= my_interval_timer();
-
-  mysql_mutex_lock(&table->s->tdc.LOCK_table_share);
-  if (table->s->tdc.flushed)
+  i= tc_current_instance(table->in_use);
+  mysql_mutex_lock(&tc[i].LOCK_table_cache);
+  /*
+    flushed is set under LOCK_table_share before the free lists of all
+    instances are purged, so if we don't see it here, our object will
+    be purged with the others.
+  */
+  if (element->flushed)
+  {
+    mysql_mutex_unlock(&tc[i].LOCK_table_cache);
     goto purge;
+  }
   /*
     in_use doesn't really need mutex protection, but must be reset after
     checking tdc.flushed and before this table appears in free_tables.
@@ -395,15 +518,18 @@ bool tc_release_table(TABLE *table)
     list_open_tables().
   */
   table->in_use= 0;
+  table->tc_instance= i;
   /* Add table to the list of unused TABLE objects for this share. */
-  table->s->tdc.free_tables.push_front(table);
-  mysql_mutex_unlock(&table->s->tdc.LOCK_table_share);
+  element->free_tables[i].list.push_front(table);
+  tc[i].free_tables.push_back(table);
+  mysql_mutex_unlock(&tc[i].LOCK_table_cache);
   return false;
 
 purge:
-  tc_wait_for_mdl_deadlock_detector(table->s);
+  mysql_mutex_lock(&element->LOCK_table_share);
+  tc_wait_for_mdl_deadlock_detector(element);
   tc_remove_table(table);
-  mysql_mutex_unlock(&table->s->tdc.LOCK_table_share);
+  mysql_mutex_unlock(&element->LOCK_table_share);
   table->in_use= 0;
   intern_close_table(table);
   return true;
@@ -413,60 +539,119 @@ purge:
 extern "C" uchar *tdc_key(const uchar *record, size_t *length,
                           my_bool not_used __attribute__((unused)))
 {
-  TABLE_SHARE *entry= (TABLE_SHARE*) record;
-  *length= entry->table_cache_key.length;
-  return (uchar*) entry->table_cache_key.str;
+  TDC_element *element= (TDC_element*) record;
+  *length= element->m_key_length;
+  return element->m_key;
+}
+
+
+/**
+  Initialize TDC_element when it is allocated by the hash.
+
+  Elements are reused after removal from the hash, so only the key is
+  copied by lf_hash_insert() and the rest must be left clean on removal.
+*/
+
+static void tdc_element_init(uchar *arg)
+{
+  TDC_element *element= (TDC_element*) (arg + LF_HASH_OVERHEAD);
+  DBUG_ENTER("tdc_element_init");
+  mysql_mutex_init(key_TABLE_SHARE_LOCK_table_share,
+                   &element->LOCK_table_share, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_TABLE_SHARE_COND_release, &element->COND_release, 0);
+  element->share= 0;
+  element->next= 0;
+  element->prev= 0;
+  element->ref_count= 0;
+  element->all_tables_refs= 0;
+  element->m_flush_tickets.empty();
+  element->all_tables.empty();
+  for (uint i= 0; i < tc_instances; i++)
+    element->free_tables[i].list.empty();
+  DBUG_VOID_RETURN;
+}
+
+
+static void tdc_element_destroy(uchar *arg)
+{
+  TDC_element *element= (TDC_element*) (arg + LF_HASH_OVERHEAD);
+  DBUG_ENTER("tdc_element_destroy");
+  DBUG_ASSERT(!element->share);
+  mysql_cond_destroy(&element->COND_release);
+  mysql_mutex_destroy(&element->LOCK_table_share);
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Check that a TDC_element is clean before it goes back to the allocator.
+*/
+
+static void tdc_assert_clean_element(TDC_element *element)
+{
+  DBUG_ASSERT(!element->share);
+  DBUG_ASSERT(element->ref_count == 0);
+  DBUG_ASSERT(element->m_flush_tickets.is_empty());
+  DBUG_ASSERT(element->all_tables.is_empty());
+  DBUG_ASSERT(element->all_tables_refs == 0);
+  DBUG_ASSERT(!element->prev);
+  DBUG_ASSERT(!element->next);
+#ifndef DBUG_OFF
+  for (uint i= 0; i < tc_instances; i++)
+    DBUG_ASSERT(element->free_tables[i].list.is_empty());
+#endif
 }
 
 
 /**
   Delete share from hash and free share object.
 
-  @return
-    @retval 0 Success
-    @retval 1 Share is referenced
+  @pre element is locked, not referenced and not in unused_shares.
+  @post element is unlocked.
+
+  Threads waiting for the share to be flushed are notified, and the share
+  is freed after all of them stopped waiting, because their tickets refer
+  to it.
 */
 
-static int tdc_delete_share_from_hash(TABLE_SHARE *share)
+static void tdc_delete_share_from_hash(TDC_element *element)
 {
+  THD *thd= current_thd;
+  LF_PINS *pins;
+  TABLE_SHARE *share;
   DBUG_ENTER("tdc_delete_share_from_hash");
-  mysql_rwlock_wrlock(&LOCK_tdc);
-  mysql_mutex_lock(&share->tdc.LOCK_table_share);
-  if (--share->tdc.ref_count)
-  {
-    mysql_cond_broadcast(&share->tdc.COND_release);
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
-    mysql_rwlock_unlock(&LOCK_tdc);
-    DBUG_RETURN(1);
-  }
-  my_hash_delete(&tdc_hash, (uchar*) share);
+
+  mysql_mutex_assert_owner(&element->LOCK_table_share);
+  DBUG_ASSERT(!element->ref_count);
+  share= element->share;
+  DBUG_ASSERT(share);
+  element->share= 0;
   /* Notify PFS early, while still locked. */
   PSI_CALL_release_table_share(share->m_psi);
   share->m_psi= 0;
-  mysql_rwlock_unlock(&LOCK_tdc);
 
-  if (share->tdc.m_flush_tickets.is_empty())
-  {
-    /* No threads are waiting for this share to be flushed, destroy it. */
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
-    free_table_share(share);
-  }
-  else
+  if (!element->m_flush_tickets.is_empty())
   {
-    Wait_for_flush_list::Iterator it(share->tdc.m_flush_tickets);
+    Wait_for_flush_list::Iterator it(element->m_flush_tickets);
     Wait_for_flush *ticket;
     while ((ticket= it++))
       (void) ticket->get_ctx()->m_wait.set_status(MDL_wait::GRANTED);
-    /*
-      If there are threads waiting for this share to be flushed,
-      the last one to receive the notification will destroy the
-      share. At this point the share is removed from the table
-      definition cache, so is OK to proceed here without waiting
-      for this thread to do the work.
-    */
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+
+    do
+    {
+      mysql_cond_wait(&element->COND_release, &element->LOCK_table_share);
+    } while (!element->m_flush_tickets.is_empty());
   }
-  DBUG_RETURN(0);
+  mysql_mutex_unlock(&element->LOCK_table_share);
+
+  pins= thd ? tdc_thd_pins(thd) : lf_hash_get_pins(&tdc_hash);
+  DBUG_ASSERT(pins); // What can we do about it?
+  tdc_assert_clean_element(element);
+  lf_hash_delete(&tdc_hash, pins, element->m_key, element->m_key_length);
+  if (!thd)
+    lf_hash_put_pins(pins);
+  free_table_share(share);
+  DBUG_VOID_RETURN;
 }
 
 
@@ -483,16 +668,31 @@ int tdc_init(void)
 #ifdef HAVE_PSI_INTERFACE
   init_tc_psi_keys();
 #endif
+  if (!(tc= (Table_cache_instance*)
+        my_malloc(sizeof(Table_cache_instance) * tc_instances,
+                  MYF(MY_WME | MY_ZEROFILL))))
+    DBUG_RETURN(1);
+  for (uint i= 0; i < tc_instances; i++)
+  {
+    mysql_mutex_init(key_LOCK_table_cache, &tc[i].LOCK_table_cache,
+                     MY_MUTEX_INIT_FAST);
+    tc[i].free_tables.empty();
+  }
   tdc_inited= true;
   mysql_mutex_init(key_LOCK_unused_shares, &LOCK_unused_shares,
                    MY_MUTEX_INIT_FAST);
-  mysql_rwlock_init(key_rwlock_LOCK_tdc, &LOCK_tdc);
   my_atomic_rwlock_init(&LOCK_tdc_atomics);
-  oldest_unused_share= &end_of_unused_share;
-  end_of_unused_share.tdc.prev= &oldest_unused_share;
+  unused_shares.empty();
   tdc_version= 1L;  /* Increments on each reload */
-  DBUG_RETURN(my_hash_init(&tdc_hash, &my_charset_bin, tdc_size, 0, 0, tdc_key,
-                           0, 0));
+  lf_hash_init(&tdc_hash, sizeof(TDC_element) +
+                          sizeof(Share_free_tables) * (tc_instances - 1),
+               LF_HASH_UNIQUE, 0, 0, (my_hash_get_key) tdc_key,
+               &my_charset_bin);
+  tdc_hash.alloc.constructor= tdc_element_init;
+  tdc_hash.alloc.destructor= tdc_element_destroy;
+  /* Only the key is copied on insert, see tdc_element_init(). */
+  tdc_hash.element_size= offsetof(TDC_element, LOCK_table_share);
+  DBUG_RETURN(0);
 }
 
 
@@ -532,10 +732,13 @@ void tdc_deinit(void)
   if (tdc_inited)
   {
     tdc_inited= false;
-    my_hash_free(&tdc_hash);
+    lf_hash_destroy(&tdc_hash);
     my_atomic_rwlock_destroy(&LOCK_tdc_atomics);
-    mysql_rwlock_destroy(&LOCK_tdc);
     mysql_mutex_destroy(&LOCK_unused_shares);
+    for (uint i= 0; i < tc_instances; i++)
+      mysql_mutex_destroy(&tc[i].LOCK_table_cache);
+    my_free(tc);
+    tc= 0;
   }
   DBUG_VOID_RETURN;
 }
@@ -551,9 +754,9 @@ ulong tdc_records(void)
 {
   ulong records;
   DBUG_ENTER("tdc_records");
-  mysql_rwlock_rdlock(&LOCK_tdc);
-  records= tdc_hash.records;
-  mysql_rwlock_unlock(&LOCK_tdc);
+  my_atomic_rwlock_rdlock(&LOCK_tdc_atomics);
+  records= my_atomic_load32(&tdc_hash.count);
+  my_atomic_rwlock_rdunlock(&LOCK_tdc_atomics);
   DBUG_RETURN(records);
 }
 
@@ -563,71 +766,33 @@ void tdc_purge(bool all)
   DBUG_ENTER("tdc_purge");
   while (all || tdc_records() > tdc_size)
   {
-    TABLE_SHARE *share;
+    TDC_element *element;
 
     mysql_mutex_lock(&LOCK_unused_shares);
-    if (!oldest_unused_share->tdc.next)
+    if (!(element= unused_shares.pop_front()))
     {
       mysql_mutex_unlock(&LOCK_unused_shares);
       break;
     }
 
-    share= oldest_unused_share;
-    *share->tdc.prev= share->tdc.next;
-    share->tdc.next->tdc.prev= share->tdc.prev;
     /* Concurrent thread may start using share again, reset prev and next. */
-    share->tdc.prev= 0;
-    share->tdc.next= 0;
-    mysql_mutex_lock(&share->tdc.LOCK_table_share);
-    share->tdc.ref_count++;
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+    element->prev= 0;
+    element->next= 0;
+    mysql_mutex_lock(&element->LOCK_table_share);
+    if (element->ref_count)
+    {
+      mysql_mutex_unlock(&element->LOCK_table_share);
+      mysql_mutex_unlock(&LOCK_unused_shares);
+      continue;
+    }
     mysql_mutex_unlock(&LOCK_unused_shares);
 
-    tdc_delete_share_from_hash(share);
+    tdc_delete_share_from_hash(element);
   }
   DBUG_VOID_RETURN;
 }
 
 
-/**
-  Prepeare table share for use with table definition cache.
-*/
-
-void tdc_init_share(TABLE_SHARE *share)
-{
-  DBUG_ENTER("tdc_init_share");
-  mysql_mutex_init(key_TABLE_SHARE_LOCK_table_share,
-                   &share->tdc.LOCK_table_share, MY_MUTEX_INIT_FAST);
-  mysql_cond_init(key_TABLE_SHARE_COND_release, &share->tdc.COND_release, 0);
-  share->tdc.m_flush_tickets.empty();
-  share->tdc.all_tables.empty();
-  share->tdc.free_tables.empty();
-  tdc_assign_new_table_id(share);
-  share->tdc.version= tdc_refresh_version();
-  share->tdc.flushed= false;
-  share->tdc.all_tables_refs= 0;
-  DBUG_VOID_RETURN;
-}
-
-
-/**
-  Release table definition cache specific resources of table share.
-*/
-
-void tdc_deinit_share(TABLE_SHARE *share)
-{
-  DBUG_ENTER("tdc_deinit_share");
-  DBUG_ASSERT(share->tdc.ref_count == 0);
-  DBUG_ASSERT(share->tdc.m_flush_tickets.is_empty());
-  DBUG_ASSERT(share->tdc.all_tables.is_empty());
-  DBUG_ASSERT(share->tdc.free_tables.is_empty());
-  DBUG_ASSERT(share->tdc.all_tables_refs == 0);
-  mysql_cond_destroy(&share->tdc.COND_release);
-  mysql_mutex_destroy(&share->tdc.LOCK_table_share);
-  DBUG_VOID_RETURN;
-}
-
-
 /**
   Lock table share.
 
@@ -640,27 +805,48 @@ void tdc_deinit_share(TABLE_SHARE *share)
 
   Caller is expected to unlock table share with tdc_unlock_share().
 
-  @retval  0 Share not found
-  @retval !0 Pointer to locked table share
+  @retval 0         Share not found
+  @retval MY_ERRPTR OOM
+  @retval ptr       Pointer to locked table share element
 */
 
-TABLE_SHARE *tdc_lock_share(const char *db, const char *table_name)
+TDC_element *tdc_lock_share(THD *thd, const char *db, const char *table_name)
 {
+  TDC_element *element;
+  LF_PINS *pins;
   char key[MAX_DBKEY_LENGTH];
-  uint key_length;
 
   DBUG_ENTER("tdc_lock_share");
-  key_length= tdc_create_key(key, db, table_name);
+  if (!(pins= tdc_thd_pins(thd)))
+    DBUG_RETURN((TDC_element*) MY_ERRPTR);
 
-  mysql_rwlock_rdlock(&LOCK_tdc);
-  TABLE_SHARE* share= (TABLE_SHARE*) my_hash_search(&tdc_hash,
-                                                    (uchar*) key, key_length);
-  if (share && !share->error)
-    mysql_mutex_lock(&share->tdc.LOCK_table_share);
-  else
-    share= 0;
-  mysql_rwlock_unlock(&LOCK_tdc);
-  DBUG_RETURN(share);
+  element= (TDC_element*) lf_hash_search(&tdc_hash, pins, (uchar*) key,
+                                         tdc_create_key(key, db, table_name));
+  if (element == MY_ERRPTR)
+  {
+    lf_hash_search_unpin(pins);
+    DBUG_RETURN(element);
+  }
+  if (element)
+  {
+    /*
+      Don't wait for a share that is being opened: the thread opening it
+      may be the one asking, e.g. from discovery.
+    */
+    if (element->share)
+    {
+      mysql_mutex_lock(&element->LOCK_table_share);
+      if (!element->share || element->share->error)
+      {
+        mysql_mutex_unlock(&element->LOCK_table_share);
+        element= 0;
+      }
+    }
+    else
+      element= 0;
+    lf_hash_search_unpin(pins);
+  }
+  DBUG_RETURN(element);
 }
 
 
@@ -668,10 +854,10 @@ TABLE_SHARE *tdc_lock_share(const char *db, const char *table_name)
   Unlock share locked by tdc_lock_share().
 */
 
-void tdc_unlock_share(TABLE_SHARE *share)
+void tdc_unlock_share(TDC_element *element)
 {
   DBUG_ENTER("tdc_unlock_share");
-  mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+  mysql_mutex_unlock(&element->LOCK_table_share);
   DBUG_VOID_RETURN;
 }
 
@@ -690,6 +876,11 @@ void tdc_unlock_share(TABLE_SHARE *share)
     Get a table definition from the table definition cache.
     If it doesn't exist, create a new from the table definition file.
 
+    A new element is inserted to the hash before the share is opened,
+    and it is locked while the share is opened, so that concurrent
+    threads wait for the share instead of opening it too. If opening
+    fails, the element is removed and those threads retry.
+
   RETURN
    0  Error
    #  Share for table
@@ -701,60 +892,86 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, const char *db, const char *table_name,
                                TABLE **out_table)
 {
   TABLE_SHARE *share;
+  TDC_element *element;
+  LF_PINS *pins;
   bool was_unused;
   DBUG_ENTER("tdc_acquire_share");
 
-  mysql_rwlock_rdlock(&LOCK_tdc);
-  share= (TABLE_SHARE*) my_hash_search_using_hash_value(&tdc_hash, hash_value,
-                                                        (uchar*) key,
-                                                        key_length);
-  if (!share)
+  if (!(pins= tdc_thd_pins(thd)))
+  {
+    my_error(ER_OUTOFMEMORY, MYF(0), 0);
+    DBUG_RETURN(0);
+  }
+
+retry:
+  while (!(element= (TDC_element*)
+           lf_hash_search_using_hash_value(&tdc_hash, pins, hash_value,
+                                           (uchar*) key, key_length)))
   {
-    TABLE_SHARE *new_share;
-    mysql_rwlock_unlock(&LOCK_tdc);
+    TDC_element tmp;
+    int res;
 
-    if (!(new_share= alloc_table_share(db, table_name, key, key_length)))
+    tmp.m_key_length= key_length;
+    memcpy(tmp.m_key, key, key_length);
+    if ((res= lf_hash_insert(&tdc_hash, pins, &tmp)) == -1)
+    {
+      my_error(ER_OUTOFMEMORY, MYF(0), 0);
       DBUG_RETURN(0);
-    new_share->error= OPEN_FRM_OPEN_ERROR;
+    }
+    else if (res == 1)
+      continue; /* Concurrent thread inserted it, look it up again. */
 
-    mysql_rwlock_wrlock(&LOCK_tdc);
-    share= (TABLE_SHARE*) my_hash_search_using_hash_value(&tdc_hash, hash_value,
-                                                          (uchar*) key,
-                                                          key_length);
-    if (!share)
+    element= (TDC_element*)
+      lf_hash_search_using_hash_value(&tdc_hash, pins, hash_value,
+                                      (uchar*) key, key_length);
+    if (element == MY_ERRPTR)
     {
-      bool need_purge;
+      lf_hash_search_unpin(pins);
+      my_error(ER_OUTOFMEMORY, MYF(0), 0);
+      DBUG_RETURN(0);
+    }
+    /* Nobody else removes an element while its share is NULL. */
+    DBUG_ASSERT(element);
+    mysql_mutex_lock(&element->LOCK_table_share);
+    lf_hash_search_unpin(pins);
 
-      share= new_share;
-      mysql_mutex_lock(&share->tdc.LOCK_table_share);
-      if (my_hash_insert(&tdc_hash, (uchar*) share))
-      {
-        mysql_mutex_unlock(&share->tdc.LOCK_table_share);
-        mysql_rwlock_unlock(&LOCK_tdc);
-        free_table_share(share);
-        DBUG_RETURN(0);
-      }
-      need_purge= tdc_hash.records > tdc_size;
-      mysql_rwlock_unlock(&LOCK_tdc);
+    if (!(share= alloc_table_share(db, table_name, key, key_length)))
+    {
+      mysql_mutex_unlock(&element->LOCK_table_share);
+      lf_hash_delete(&tdc_hash, pins, key, key_length);
+      DBUG_RETURN(0);
+    }
 
-      /* note that tdc_acquire_share() *always* uses discovery */
-      open_table_def(thd, share, flags | GTS_USE_DISCOVERY);
-      share->tdc.ref_count++;
-      mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+    /* note that tdc_acquire_share() *always* uses discovery */
+    open_table_def(thd, share, flags | GTS_USE_DISCOVERY);
 
-      if (share->error)
-      {
-        tdc_delete_share_from_hash(share);
-        DBUG_RETURN(0);
-      }
-      else if (need_purge)
-        tdc_purge(false);
-      if (out_table)
-        *out_table= 0;
-      share->m_psi= PSI_CALL_get_table_share(false, share);
-      goto end;
+    if (share->error)
+    {
+      mysql_mutex_unlock(&element->LOCK_table_share);
+      lf_hash_delete(&tdc_hash, pins, key, key_length);
+      free_table_share(share);
+      DBUG_RETURN(0);
     }
-    free_table_share(new_share);
+
+    element->share= share;
+    share->tdc= element;
+    element->ref_count++;
+    element->version= tdc_refresh_version();
+    element->flushed= false;
+    mysql_mutex_unlock(&element->LOCK_table_share);
+
+    tdc_purge(false);
+    if (out_table)
+      *out_table= 0;
+    share->m_psi= PSI_CALL_get_table_share(false, share);
+    goto end;
+  }
+
+  if (element == MY_ERRPTR)
+  {
+    lf_hash_search_unpin(pins);
+    my_error(ER_OUTOFMEMORY, MYF(0), 0);
+    DBUG_RETURN(0);
   }
 
   /* cannot force discovery of a cached share */
@@ -762,18 +979,31 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, const char *db, const char *table_name,
 
   if (out_table && (flags & GTS_TABLE))
   {
-    if ((*out_table= tc_acquire_table(thd, share)))
+    /*
+      An unused TABLE holds a reference to the share, so if we find one
+      the share is not going away.
+    */
+    if ((*out_table= tc_acquire_table(thd, element)))
     {
-      mysql_rwlock_unlock(&LOCK_tdc);
+      lf_hash_search_unpin(pins);
+      share= (*out_table)->s;
       DBUG_ASSERT(!(flags & GTS_NOLOCK));
+      DBUG_ASSERT(share->tdc == element);
       DBUG_ASSERT(!share->error);
       DBUG_ASSERT(!share->is_view);
       DBUG_RETURN(share);
     }
   }
 
-  mysql_mutex_lock(&share->tdc.LOCK_table_share);
-  mysql_rwlock_unlock(&LOCK_tdc);
+  mysql_mutex_lock(&element->LOCK_table_share);
+  if (!(share= element->share))
+  {
+    /* The share is being removed or failed to open. */
+    mysql_mutex_unlock(&element->LOCK_table_share);
+    lf_hash_search_unpin(pins);
+    goto retry;
+  }
+  lf_hash_search_unpin(pins);
 
   /*
      We found an existing table definition. Return it if we didn't get
@@ -796,30 +1026,29 @@ TABLE_SHARE *tdc_acquire_share(THD *thd, const char *db, const char *table_name,
     goto err;
   }
 
-  was_unused= !share->tdc.ref_count;
-  share->tdc.ref_count++;
-  mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+  was_unused= !element->ref_count;
+  element->ref_count++;
+  mysql_mutex_unlock(&element->LOCK_table_share);
   if (was_unused)
   {
     mysql_mutex_lock(&LOCK_unused_shares);
-    if (share->tdc.prev)
+    if (element->prev)
     {
       /*
         Share was not used before and it was in the old_unused_share list
         Unlink share from this list
       */
       DBUG_PRINT("info", ("Unlinking from not used list"));
-      *share->tdc.prev= share->tdc.next;
-      share->tdc.next->tdc.prev= share->tdc.prev;
-      share->tdc.next= 0;
-      share->tdc.prev= 0;
+      unused_shares.remove(element);
+      element->next= 0;
+      element->prev= 0;
     }
     mysql_mutex_unlock(&LOCK_unused_shares);
   }
 
 end:
   DBUG_PRINT("exit", ("share: 0x%lx  ref_count: %u",
-                      (ulong) share, share->tdc.ref_count));
+                      (ulong) share, share->tdc->ref_count));
   if (flags & GTS_NOLOCK)
   {
     tdc_release_share(share);
@@ -835,7 +1064,7 @@ end:
   DBUG_RETURN(share);
 
 err:
-  mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+  mysql_mutex_unlock(&element->LOCK_table_share);
   DBUG_RETURN(0);
 }
 
@@ -846,48 +1075,47 @@ err:
 
 void tdc_release_share(TABLE_SHARE *share)
 {
+  TDC_element *element= share->tdc;
   DBUG_ENTER("tdc_release_share");
 
-  mysql_mutex_lock(&share->tdc.LOCK_table_share);
+  mysql_mutex_lock(&element->LOCK_table_share);
   DBUG_PRINT("enter",
              ("share: 0x%lx  table: %s.%s  ref_count: %u  version: %lu",
               (ulong) share, share->db.str, share->table_name.str,
-              share->tdc.ref_count, share->tdc.version));
-  DBUG_ASSERT(share->tdc.ref_count);
+              element->ref_count, element->version));
+  DBUG_ASSERT(element->ref_count);
 
-  if (share->tdc.ref_count > 1)
+  if (element->ref_count > 1)
   {
-    share->tdc.ref_count--;
+    element->ref_count--;
     if (!share->is_view)
-      mysql_cond_broadcast(&share->tdc.COND_release);
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+      mysql_cond_broadcast(&element->COND_release);
+    mysql_mutex_unlock(&element->LOCK_table_share);
     DBUG_VOID_RETURN;
   }
-  mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+  mysql_mutex_unlock(&element->LOCK_table_share);
 
   mysql_mutex_lock(&LOCK_unused_shares);
-  mysql_mutex_lock(&share->tdc.LOCK_table_share);
-  if (share->tdc.flushed)
+  mysql_mutex_lock(&element->LOCK_table_share);
+  if (--element->ref_count)
   {
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+    if (!share->is_view)
+      mysql_cond_broadcast(&element->COND_release);
+    mysql_mutex_unlock(&element->LOCK_table_share);
     mysql_mutex_unlock(&LOCK_unused_shares);
-    tdc_delete_share_from_hash(share);
     DBUG_VOID_RETURN;
   }
-  if (--share->tdc.ref_count)
+  if (element->flushed)
   {
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
     mysql_mutex_unlock(&LOCK_unused_shares);
+    tdc_delete_share_from_hash(element);
     DBUG_VOID_RETURN;
   }
   /* Link share last in used_table_share list */
   DBUG_PRINT("info", ("moving share to unused list"));
-  DBUG_ASSERT(share->tdc.next == 0);
-  share->tdc.prev= end_of_unused_share.tdc.prev;
-  *end_of_unused_share.tdc.prev= share;
-  end_of_unused_share.tdc.prev= &share->tdc.next;
-  share->tdc.next= &end_of_unused_share;
-  mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+  DBUG_ASSERT(element->next == 0);
+  unused_shares.push_back(element);
+  mysql_mutex_unlock(&element->LOCK_table_share);
   mysql_mutex_unlock(&LOCK_unused_shares);
 
   /* Delete the least used share to preserve LRU order. */
@@ -896,39 +1124,6 @@ void tdc_release_share(TABLE_SHARE *share)
 }
 
 
-static TABLE_SHARE *tdc_delete_share(const char *db, const char *table_name)
-{
-  TABLE_SHARE *share;
-  DBUG_ENTER("tdc_delete_share");
-
-  while ((share= tdc_lock_share(db, table_name)))
-  {
-    share->tdc.ref_count++;
-    if (share->tdc.ref_count > 1)
-    {
-      tdc_unlock_share(share);
-      DBUG_RETURN(share);
-    }
-    tdc_unlock_share(share);
-
-    mysql_mutex_lock(&LOCK_unused_shares);
-    if (share->tdc.prev)
-    {
-      *share->tdc.prev= share->tdc.next;
-      share->tdc.next->tdc.prev= share->tdc.prev;
-      /* Concurrent thread may start using share again, reset prev and next. */
-      share->tdc.prev= 0;
-      share->tdc.next= 0;
-    }
-    mysql_mutex_unlock(&LOCK_unused_shares);
-
-    if (!tdc_delete_share_from_hash(share))
-      break;
-  }
-  DBUG_RETURN(0);
-}
-
-
 /**
    Remove all or some (depending on parameter) instances of TABLE and
    TABLE_SHARE from the table definition cache.
@@ -972,9 +1167,10 @@ bool tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
                       const char *db, const char *table_name,
                       bool kill_delayed_threads)
 {
+  TABLE_SHARE::TABLE_list purge_tables;
   TABLE *table;
-  TABLE_SHARE *share;
-  bool found= false;
+  TDC_element *element;
+  uint my_refs= 1;
   DBUG_ENTER("tdc_remove_table");
   DBUG_PRINT("enter",("name: %s  remove_type: %d", table_name, remove_type));
 
@@ -982,83 +1178,99 @@ bool tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
               thd->mdl_context.is_lock_owner(MDL_key::TABLE, db, table_name,
                                              MDL_EXCLUSIVE));
 
-  if ((share= tdc_delete_share(db, table_name)))
+  mysql_mutex_lock(&LOCK_unused_shares);
+  if (!(element= tdc_lock_share(thd, db, table_name)))
   {
-    I_P_List <TABLE, TABLE_share> purge_tables;
-    uint my_refs= 1;
-
-    mysql_mutex_lock(&share->tdc.LOCK_table_share);
-    tc_wait_for_mdl_deadlock_detector(share);
-    /*
-      Mark share flushed in order to ensure that it gets
-      automatically deleted once it is no longer referenced.
+    mysql_mutex_unlock(&LOCK_unused_shares);
+    DBUG_ASSERT(remove_type != TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE);
+    DBUG_RETURN(false);
+  }
 
-      Note that code in TABLE_SHARE::wait_for_old_version() assumes that
-      marking share flushed is followed by purge of unused table
-      shares.
-    */
-    if (remove_type != TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE)
-      share->tdc.flushed= true;
+  DBUG_ASSERT(element != MY_ERRPTR); // What can we do about it?
 
-    while ((table= share->tdc.free_tables.pop_front()))
+  if (!element->ref_count)
+  {
+    if (element->prev)
     {
-      tc_remove_table(table);
-      purge_tables.push_front(table);
+      unused_shares.remove(element);
+      element->prev= 0;
+      element->next= 0;
     }
-    if (kill_delayed_threads)
-      kill_delayed_threads_for_table(share);
+    mysql_mutex_unlock(&LOCK_unused_shares);
 
-    if (remove_type == TDC_RT_REMOVE_NOT_OWN ||
-        remove_type == TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE)
-    {
-      TABLE_SHARE::All_share_tables_list::Iterator it(share->tdc.all_tables);
-      while ((table= it++))
-      {
-        my_refs++;
-        DBUG_ASSERT(table->in_use == thd);
-      }
-    }
-    DBUG_ASSERT(share->tdc.all_tables.is_empty() || remove_type != TDC_RT_REMOVE_ALL);
-    mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+    tdc_delete_share_from_hash(element);
+    DBUG_RETURN(true);
+  }
+  mysql_mutex_unlock(&LOCK_unused_shares);
 
-    while ((table= purge_tables.pop_front()))
-      intern_close_table(table);
+  element->ref_count++;
 
-    if (remove_type != TDC_RT_REMOVE_UNUSED)
+  tc_wait_for_mdl_deadlock_detector(element);
+  /*
+    Mark share flushed in order to ensure that it gets
+    automatically deleted once it is no longer referenced.
+
+    Note that code in TABLE_SHARE::wait_for_old_version() assumes that
+    marking share flushed is followed by purge of unused table
+    shares.
+  */
+  if (remove_type != TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE)
+    element->flushed= true;
+
+  tc_remove_all_unused_tables(element, &purge_tables);
+
+  if (kill_delayed_threads)
+    kill_delayed_threads_for_table(element);
+
+  if (remove_type == TDC_RT_REMOVE_NOT_OWN ||
+      remove_type == TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE)
+  {
+    TABLE_SHARE::All_share_tables_list::Iterator it(element->all_tables);
+    while ((table= it++))
     {
-      /*
-        Even though current thread holds exclusive metadata lock on this share
-        (asserted above), concurrent FLUSH TABLES threads may be in process of
-        closing unused table instances belonging to this share. E.g.:
-        thr1 (FLUSH TABLES): table= share->tdc.free_tables.pop_front();
-        thr1 (FLUSH TABLES): share->tdc.all_tables.remove(table);
-        thr2 (ALTER TABLE): tdc_remove_table();
-        thr1 (FLUSH TABLES): intern_close_table(table);
-
-        Current remove type assumes that all table instances (except for those
-        that are owned by current thread) must be closed before
-        thd_remove_table() returns. Wait for such tables now.
-
-        intern_close_table() decrements ref_count and signals COND_release. When
-        ref_count drops down to number of references owned by current thread
-        waiting is completed.
-
-        Unfortunately TABLE_SHARE::wait_for_old_version() cannot be used here
-        because it waits for all table instances, whereas we have to wait only
-        for those that are not owned by current thread.
-      */
-      mysql_mutex_lock(&share->tdc.LOCK_table_share);
-      while (share->tdc.ref_count > my_refs)
-        mysql_cond_wait(&share->tdc.COND_release, &share->tdc.LOCK_table_share);
-      mysql_mutex_unlock(&share->tdc.LOCK_table_share);
+      my_refs++;
+      DBUG_ASSERT(table->in_use == thd);
     }
+  }
+  DBUG_ASSERT(element->all_tables.is_empty() ||
+              remove_type != TDC_RT_REMOVE_ALL);
+  mysql_mutex_unlock(&element->LOCK_table_share);
 
-    tdc_release_share(share);
+  while ((table= purge_tables.pop_front()))
+    intern_close_table(table);
 
-    found= true;
+  if (remove_type != TDC_RT_REMOVE_UNUSED)
+  {
+    /*
+      Even though current thread holds exclusive metadata lock on this share
+      (asserted above), concurrent FLUSH TABLES threads may be in process of
+      closing unused table instances belonging to this share. E.g.:
+      thr1 (FLUSH TABLES): table= share->tdc->free_tables[i].list.pop_front();
+      thr1 (FLUSH TABLES): share->tdc->all_tables.remove(table);
+      thr2 (ALTER TABLE): tdc_remove_table();
+      thr1 (FLUSH TABLES): intern_close_table(table);
+
+      Current remove type assumes that all table instances (except for those
+      that are owned by current thread) must be closed before
+      thd_remove_table() returns. Wait for such tables now.
+
+      intern_close_table() decrements ref_count and signals COND_release. When
+      ref_count drops down to number of references owned by current thread
+      waiting is completed.
+
+      Unfortunately TABLE_SHARE::wait_for_old_version() cannot be used here
+      because it waits for all table instances, whereas we have to wait only
+      for those that are not owned by current thread.
+    */
+    mysql_mutex_lock(&element->LOCK_table_share);
+    while (element->ref_count > my_refs)
+      mysql_cond_wait(&element->COND_release, &element->LOCK_table_share);
+    mysql_mutex_unlock(&element->LOCK_table_share);
   }
-  DBUG_ASSERT(found || remove_type != TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE);
-  DBUG_RETURN(found);
+
+  tdc_release_share(element->share);
+
+  DBUG_RETURN(true);
 }
 
 
@@ -1080,21 +1292,21 @@ int tdc_wait_for_old_version(THD *thd, const char *db, const char *table_name,
                              ulong wait_timeout, uint deadlock_weight,
                              ulong refresh_version)
 {
-  TABLE_SHARE *share;
-  int res= FALSE;
+  TDC_element *element;
 
-  if ((share= tdc_lock_share(db, table_name)))
+  if (!(element= tdc_lock_share(thd, db, table_name)))
+    return FALSE;
+  else if (element == MY_ERRPTR)
+    return TRUE;
+  else if (element->flushed && refresh_version > element->version)
   {
-    if (share->tdc.flushed && refresh_version > share->tdc.version)
-    {
-      struct timespec abstime;
-      set_timespec(abstime, wait_timeout);
-      res= share->wait_for_old_version(thd, &abstime, deadlock_weight);
-    }
-    else
-      tdc_unlock_share(share);
+    struct timespec abstime;
+    set_timespec(abstime, wait_timeout);
+    return element->share->wait_for_old_version(thd, &abstime,
+                                                deadlock_weight);
   }
-  return res;
+  tdc_unlock_share(element);
+  return FALSE;
 }
 
 
@@ -1118,50 +1330,103 @@ ulong tdc_increment_refresh_version(void)
 
 
 /**
-  Initialize table definition cache iterator.
+  Auxiliary structure for tdc_iterate() with no_dups: remembers visited
+  elements by key, since lf_hash_iterate() may visit an element twice.
 */
 
-void TDC_iterator::init(void)
+struct eliminate_duplicates_arg
 {
-  DBUG_ENTER("TDC_iterator::init");
-  idx= 0;
-  mysql_rwlock_rdlock(&LOCK_tdc);
-  DBUG_VOID_RETURN;
+  HASH hash;
+  MEM_ROOT root;
+  my_hash_walk_action action;
+  void *argument;
+};
+
+
+static uchar *eliminate_duplicates_get_key(const uchar *element,
+                                           size_t *length,
+                                           my_bool not_used __attribute__((unused)))
+{
+  LEX_STRING *key= (LEX_STRING *) element;
+  *length= key->length;
+  return (uchar *) key->str;
+}
+
+
+static my_bool eliminate_duplicates(TDC_element *element,
+                                    eliminate_duplicates_arg *arg)
+{
+  LEX_STRING *key= (LEX_STRING *) alloc_root(&arg->root, sizeof(LEX_STRING));
+
+  if (!key || !(key->str= (char*) memdup_root(&arg->root, element->m_key,
+                                              element->m_key_length)))
+    return FALSE;
+
+  key->length= element->m_key_length;
+
+  if (my_hash_insert(&arg->hash, (uchar *) key))
+    return FALSE;
+
+  return arg->action(element, arg->argument);
 }
 
 
 /**
-  Deinitialize table definition cache iterator.
+  Call action for every element of table definition cache.
+
+  The element passed to action is protected against reuse for another
+  table, but not against removal: action must lock
+  TDC_element::LOCK_table_share and check TDC_element::share before
+  using the share. Action must not acquire or release shares, since the
+  thread's pins are in use by the walk.
+
+  @param thd       Thread context, may be NULL
+  @param action    Called for each element until it returns TRUE
+  @param argument  Passed to action
+  @param no_dups   Visit each element at most once
+
+  @retval 0 All elements were visited
+  @retval 1 Action returned TRUE
+  @retval ER_OUTOFMEMORY Out of memory
 */
 
-void TDC_iterator::deinit(void)
+int tdc_iterate(THD *thd, my_hash_walk_action action, void *argument,
+                bool no_dups)
 {
-  DBUG_ENTER("TDC_iterator::deinit");
-  mysql_rwlock_unlock(&LOCK_tdc);
-  DBUG_VOID_RETURN;
-}
+  eliminate_duplicates_arg no_dups_argument;
+  LF_PINS *pins;
+  int res;
 
+  if (thd)
+    pins= tdc_thd_pins(thd);
+  else
+    pins= lf_hash_get_pins(&tdc_hash);
 
-/**
-  Get next TABLE_SHARE object from table definition cache.
+  if (!pins)
+    return ER_OUTOFMEMORY;
 
-  Object is protected against removal from table definition cache.
+  if (no_dups)
+  {
+    init_alloc_root(&no_dups_argument.root, 4096, 4096, MYF(0));
+    my_hash_init(&no_dups_argument.hash, &my_charset_bin, tdc_records(), 0, 0,
+                 eliminate_duplicates_get_key, 0, 0);
+    no_dups_argument.action= action;
+    no_dups_argument.argument= argument;
+    action= (my_hash_walk_action) eliminate_duplicates;
+    argument= &no_dups_argument;
+  }
 
-  @note Returned TABLE_SHARE is not guaranteed to be fully initialized:
-  tdc_acquire_share() added new share, but didn't open it yet. If caller
-  needs fully initializer share, it must lock table share mutex.
-*/
+  res= lf_hash_iterate(&tdc_hash, pins, action, argument);
 
-TABLE_SHARE *TDC_iterator::next(void)
-{
-  TABLE_SHARE *share= 0;
-  DBUG_ENTER("TDC_iterator::next");
-  if (idx < tdc_hash.records)
+  if (!thd)
+    lf_hash_put_pins(pins);
+
+  if (no_dups)
   {
-    share= (TABLE_SHARE*) my_hash_element(&tdc_hash, idx);
-    idx++;
+    my_hash_free(&no_dups_argument.hash);
+    free_root(&no_dups_argument.root, MYF(0));
   }
-  DBUG_RETURN(share);
+  return res;
 }
 
 
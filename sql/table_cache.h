@@ -24,18 +24,81 @@ enum enum_tdc_remove_table_type
   TDC_RT_REMOVE_NOT_OWN_KEEP_SHARE
 };
 
+/** Size of a cache line, used to keep table cache instances apart. */
+#define TC_CACHE_LINE_SIZE 64
+
+/**
+  Unused TABLE objects of a share that belong to one table cache
+  instance. Protected by Table_cache_instance::LOCK_table_cache of that
+  instance.
+*/
+
+struct Share_free_tables
+{
+  TABLE_SHARE::TABLE_list list;
+  /** Avoid false sharing between instances */
+  char pad[TC_CACHE_LINE_SIZE];
+};
+
+
+/**
+  Element of the table definition cache.
+
+  Elements are stored in a lock-free hash and are never freed while the
+  server is running: an element removed from the hash goes back to the
+  allocator and may be reused for another table, but only after no
+  thread has it pinned. A thread that found an element must lock
+  LOCK_table_share and check that share is not NULL before it uses the
+  element, since the share may have been removed meanwhile.
+*/
+
+struct TDC_element
+{
+  /** Table cache key (db\0table_name\0), copied by lf_hash_insert(). */
+  uint m_key_length;
+  uchar m_key[MAX_DBKEY_LENGTH];
+
+  /**
+    Protects share, ref_count, m_flush_tickets, all_tables, flushed,
+    all_tables_refs. The members above are set when the element is
+    inserted and never change while it is in the hash.
+  */
+  mysql_mutex_t LOCK_table_share;
+  mysql_cond_t COND_release;
+  /** NULL while the share is being opened or after it was removed. */
+  TABLE_SHARE *share;
+  TDC_element *next, **prev;            /* Link to unused shares */
+  uint ref_count;                       /* How many TABLE objects uses this */
+  uint all_tables_refs;                 /* Number of refs to all_tables */
+  ulong version;
+  bool flushed;
+  /**
+    List of tickets representing threads waiting for the share to be flushed.
+  */
+  Wait_for_flush_list m_flush_tickets;
+  /*
+    Doubly-linked (back-linked) lists of used and unused TABLE objects
+    for this share.
+  */
+  TABLE_SHARE::All_share_tables_list all_tables;
+  /** Unused TABLE objects, one list per table cache instance. */
+  Share_free_tables free_tables[1];
+};
+
+
 extern ulong tdc_size;
 extern ulong tc_size;
+extern uint tc_instances;
 
 extern int tdc_init(void);
 extern void tdc_start_shutdown(void);
 extern void tdc_deinit(void);
+extern void tdc_release_pins(THD *thd);
 extern ulong tdc_records(void);
 extern void tdc_purge(bool all);
-extern void tdc_init_share(TABLE_SHARE *share);
-extern void tdc_deinit_share(TABLE_SHARE *share);
-extern TABLE_SHARE *tdc_lock_share(const char *db, const char *table_name);
-extern void tdc_unlock_share(TABLE_SHARE *share);
+extern TDC_element *tdc_lock_share(THD *thd, const char *db,
+                                   const char *table_name);
+extern void tdc_unlock_share(TDC_element *element);
 extern TABLE_SHARE *tdc_acquire_share(THD *thd, const char *db,
                                       const char *table_name,
                                       const char *key, uint key_length,
@@ -52,6 +115,8 @@ extern int tdc_wait_for_old_version(THD *thd, const char *db,
 extern ulong tdc_refresh_version(void);
 extern ulong tdc_increment_refresh_version(void);
 extern void tdc_assign_new_table_id(TABLE_SHARE *share);
+extern int tdc_iterate(THD *thd, my_hash_walk_action action, void *argument,
+                       bool no_dups= false);
 
 extern uint tc_records(void);
 extern void tc_purge(bool mark_flushed= false);
@@ -125,13 +190,3 @@ static inline TABLE_SHARE *tdc_acquire_share_shortlived(THD *thd, TABLE_LIST *tl
   return tdc_acquire_share(thd, tl->db, tl->table_name, key, key_length,
                            tl->mdl_request.key.tc_hash_value(), flags, 0);
 }
-
-
-class TDC_iterator
-{
-  ulong idx;
-public:
-  void init(void);
-  void deinit(void);
-  TABLE_SHARE *next(void);
-};
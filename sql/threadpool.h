@@ -23,6 +23,15 @@ extern uint threadpool_max_size;
 extern uint threadpool_stall_limit;  /* time interval in 10 ms units for stall checks*/
 extern uint threadpool_max_threads;  /* Maximum threads in pool */
 extern uint threadpool_oversubscribe;  /* Maximum active threads in group */
+extern my_bool threadpool_work_stealing; /* Idle workers help other groups */
+
+/* Which connections get their events into the high priority queue */
+enum tp_high_prio_mode_t
+{
+  TP_HIGH_PRIO_MODE_TRANSACTIONS,
+  TP_HIGH_PRIO_MODE_STATEMENTS,
+  TP_HIGH_PRIO_MODE_NONE
+};
 
 
 
@@ -57,6 +66,31 @@ struct TP_STATISTICS
 
 extern TP_STATISTICS tp_stats;
 
+/*
+  Queue latency histogram: bucket i counts events that waited less than
+  TP_QUEUE_LATENCY_MIN * 10^i microseconds, the last bucket the rest.
+*/
+#define TP_QUEUE_LATENCY_BUCKETS 6
+#define TP_QUEUE_LATENCY_MIN 100
+
+/* Per group statistics, used by the THREAD_POOL_GROUPS plugin */
+struct TP_GROUP_STATS
+{
+  uint connections;
+  uint threads;
+  uint active_threads;
+  uint queue_length;
+  uint high_prio_queue_length;
+  ulonglong high_prio_events;
+  ulonglong low_prio_events;
+  ulonglong steals;
+  ulonglong stolen;
+  ulonglong queue_latency[TP_QUEUE_LATENCY_BUCKETS];
+};
+
+extern uint tp_get_group_count();
+extern bool tp_get_group_stats(uint group_id, TP_GROUP_STATS *stats);
+
 
 /* Functions to set threadpool parameters */
 extern void tp_set_min_threads(uint val);
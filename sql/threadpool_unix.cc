@@ -31,6 +31,9 @@
 #include <time.h>
 #ifdef __linux__
 #include <sys/epoll.h>
+#ifdef HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
 typedef struct epoll_event native_event;
 #elif defined(HAVE_KQUEUE)
 #include <sys/event.h>
@@ -113,9 +116,15 @@ struct connection_t
 
   THD *thd;
   thread_group_t *thread_group;
+  /* Group of the worker that currently handles the connection */
+  thread_group_t *worker_group;
   connection_t *next_in_queue;
   connection_t **prev_in_queue;
   ulonglong abs_wait_timeout;
+  /* Time the connection was put into the queue, for latency statistics */
+  ulonglong enqueue_time;
+  /* Remaining consecutive events that may go to the high priority queue */
+  uint tickets;
   bool logged_in;
   bool bound_to_poll_descriptor;
   bool waiting;
@@ -132,6 +141,9 @@ connection_queue_t;
 struct thread_group_t 
 {
   mysql_mutex_t mutex;
+  /* Events of connections inside a transaction, or holding locks */
+  connection_queue_t high_prio_queue;
+  /* Everything else */
   connection_queue_t queue;
   worker_list_t waiting_threads; 
   worker_thread_t *listener;
@@ -147,6 +159,17 @@ struct thread_group_t
   int  shutdown_pipe[2];
   bool shutdown;
   bool stalled;
+  /* NUMA node the group's workers last ran on */
+  int  numa_node;
+  /* Events this group's workers took from other groups' queues */
+  ulonglong steals;
+  /* Events other groups' workers took from this group's queue */
+  ulonglong stolen;
+  /* Histogram of the time events spent in the queue */
+  ulonglong queue_latency[TP_QUEUE_LATENCY_BUCKETS];
+  /* Events taken from the high and low priority queues */
+  ulonglong high_prio_events;
+  ulonglong low_prio_events;
   
 } MY_ALIGNED(512);
 
@@ -411,21 +434,278 @@ static void* native_event_get_userdata(native_event *event)
 #endif
 
 
-/* Dequeue element from a workqueue */
+/* Check whether both queues of a group are empty */
+
+static bool queue_is_empty(thread_group_t *thread_group)
+{
+  return thread_group->high_prio_queue.is_empty() &&
+    thread_group->queue.is_empty();
+}
+
+
+/* Dequeue element from a workqueue, the high priority queue first */
 
 static connection_t *queue_get(thread_group_t *thread_group)
 {
   DBUG_ENTER("queue_get");
   thread_group->queue_event_count++;
-  connection_t *c= thread_group->queue.front();
+  connection_t *c= thread_group->high_prio_queue.front();
   if (c)
+  {
+    thread_group->high_prio_queue.remove(c);
+    thread_group->high_prio_events++;
+  }
+  else if ((c= thread_group->queue.front()))
   {
     thread_group->queue.remove(c);
+    thread_group->low_prio_events++;
+  }
+
+  if (c)
+  {
+
+    /* Account the time the event spent in the queue */
+    ulonglong latency= microsecond_interval_timer() - c->enqueue_time;
+    ulonglong bound= TP_QUEUE_LATENCY_MIN;
+    uint i;
+    for (i= 0; i < TP_QUEUE_LATENCY_BUCKETS - 1 && latency >= bound; i++)
+      bound*= 10;
+    thread_group->queue_latency[i]++;
   }
   DBUG_RETURN(c);  
 }
 
 
+/*
+  Check whether the next event of a connection should go to the high
+  priority queue. In the "transactions" mode, these are connections
+  that are inside a transaction or hold locks, so that they release
+  them sooner. The tickets limit how many events in a row a connection
+  gets this treatment, so that it cannot starve the low priority queue.
+*/
+
+static bool connection_is_high_prio(connection_t *c)
+{
+  THD *thd= c->thd;
+
+  if (!c->logged_in)
+    return false;
+
+  switch (thd->variables.threadpool_high_prio_mode) {
+  case TP_HIGH_PRIO_MODE_STATEMENTS:
+    return true;
+  case TP_HIGH_PRIO_MODE_TRANSACTIONS:
+    return c->tickets > 0 &&
+      (thd->in_active_multi_stmt_transaction() ||
+       thd->locked_tables_mode != LTM_NONE ||
+       thd->global_read_lock.is_acquired() ||
+       thd->mdl_context.has_locks());
+  default:
+    return false;
+  }
+}
+
+
+/* Put an event at the end of the workqueue */
+
+static void queue_push(thread_group_t *thread_group, connection_t *c,
+                       ulonglong now)
+{
+  c->enqueue_time= now;
+  if (connection_is_high_prio(c))
+  {
+    c->tickets--;
+    thread_group->high_prio_queue.push_back(c);
+  }
+  else
+  {
+    c->tickets= c->thd->variables.threadpool_high_prio_tickets;
+    thread_group->queue.push_back(c);
+  }
+}
+
+
+/*
+  Map from CPU number to NUMA node, read from sysfs at startup.
+  Empty if the machine has a single node, or the platform does not
+  tell which CPU a thread runs on.
+*/
+#define TP_MAX_CPUS 4096
+static uchar *numa_cpu_node;
+static int numa_node_count;
+
+static void numa_init()
+{
+  numa_node_count= 0;
+#if defined(__linux__) && defined(HAVE_SCHED_GETCPU)
+  int nodes= 0;
+  for (int node= 0; node < 256; node++)
+  {
+    char path[64];
+    char buf[1024];
+    my_snprintf(path, sizeof(path),
+                "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *f= fopen(path, "r");
+    if (!f)
+      break;
+    bool ok= fgets(buf, sizeof(buf), f) != NULL;
+    fclose(f);
+    if (!ok)
+      break;
+
+    if (!numa_cpu_node &&
+        !(numa_cpu_node= (uchar *) my_malloc(TP_MAX_CPUS, MYF(MY_ZEROFILL))))
+      return;
+
+    /* The list looks like "0-3,8-11" */
+    for (char *p= buf; *p && *p != '\n';)
+    {
+      char *end;
+      long first= strtol(p, &end, 10);
+      long last= first;
+      if (end == p)
+        break;
+      if (*end == '-')
+      {
+        p= end + 1;
+        last= strtol(p, &end, 10);
+      }
+      for (long cpu= first; cpu <= last && cpu < TP_MAX_CPUS; cpu++)
+        numa_cpu_node[cpu]= (uchar) node;
+      p= (*end == ',') ? end + 1 : end;
+    }
+    nodes++;
+  }
+
+  if (nodes > 1)
+    numa_node_count= nodes;
+  else
+  {
+    my_free(numa_cpu_node);
+    numa_cpu_node= NULL;
+  }
+#endif
+}
+
+
+static void numa_end()
+{
+  my_free(numa_cpu_node);
+  numa_cpu_node= NULL;
+  numa_node_count= 0;
+}
+
+
+/* NUMA node of the CPU the calling thread is running on */
+
+static int current_numa_node()
+{
+#if defined(__linux__) && defined(HAVE_SCHED_GETCPU)
+  if (numa_node_count)
+  {
+    int cpu= sched_getcpu();
+    if (cpu >= 0 && cpu < TP_MAX_CPUS)
+      return numa_cpu_node[cpu];
+  }
+#endif
+  return 0;
+}
+
+
+/*
+  Take an event from the queue of another group.
+
+  Called by a worker that found nothing to do in its own group, with
+  the mutex of its own group held. Victims are only try-locked, so two
+  workers stealing from each other's groups cannot deadlock. Groups
+  that last ran on the same NUMA node are tried first, then the rest,
+  in both cases starting with the next group, so that different thieves
+  spread over different victims.
+*/
+
+static connection_t *queue_steal(thread_group_t *thread_group)
+{
+  DBUG_ENTER("queue_steal");
+  uint count= group_count;
+  uint own= (uint)(thread_group - all_groups);
+
+  if (!threadpool_work_stealing || count < 2 || own >= count)
+    DBUG_RETURN(NULL);
+
+  int node= thread_group->numa_node;
+  for (int pass= numa_node_count ? 0 : 1; pass < 2; pass++)
+  {
+    for (uint i= 1; i < count; i++)
+    {
+      thread_group_t *victim= &all_groups[(own + i) % count];
+
+      if (numa_node_count && (victim->numa_node == node) != (pass == 0))
+        continue;
+
+      /* Dirty read, recheck under the mutex */
+      if (queue_is_empty(victim) || victim->shutdown)
+        continue;
+
+      if (mysql_mutex_trylock(&victim->mutex))
+        continue;
+
+      connection_t *connection= NULL;
+      if (!victim->shutdown)
+        connection= queue_get(victim);
+      if (connection)
+        victim->stolen++;
+      mysql_mutex_unlock(&victim->mutex);
+
+      if (connection)
+      {
+        thread_group->steals++;
+        DBUG_RETURN(connection);
+      }
+    }
+  }
+  DBUG_RETURN(NULL);
+}
+
+
+/*
+  Wake an idle worker of another group, so that it steals
+  the events of a stalled group. Caller holds the mutex of the
+  stalled group.
+
+  @return 0 if a worker was woken, 1 otherwise
+*/
+
+static int wake_thief(thread_group_t *thread_group)
+{
+  uint count= group_count;
+  uint own= (uint)(thread_group - all_groups);
+
+  if (!threadpool_work_stealing || count < 2 || own >= count)
+    return 1;
+
+  for (uint i= 1; i < count; i++)
+  {
+    thread_group_t *group= &all_groups[(own + i) % count];
+
+    /* Only groups with nothing to do can spare a worker */
+    if (group->active_thread_count || group->waiting_threads.is_empty())
+      continue;
+
+    if (mysql_mutex_trylock(&group->mutex))
+      continue;
+
+    int ret= 1;
+    if (!group->active_thread_count && !group->shutdown &&
+        queue_is_empty(group))
+      ret= wake_thread(group);
+    mysql_mutex_unlock(&group->mutex);
+    if (!ret)
+      return 0;
+  }
+  return 1;
+}
+
+
 /* 
   Handle wait timeout : 
   Find connections that have been idle for too long and kill them.
@@ -591,10 +871,15 @@ void check_stall(thread_group_t *thread_group)
     do wait and indicate that via thd_wait_begin/end callbacks, thread creation
     will be faster.
   */
-  if (!thread_group->queue.is_empty() && !thread_group->queue_event_count)
+  if (!queue_is_empty(thread_group) && !thread_group->queue_event_count)
   {
     thread_group->stalled= true;
-    wake_or_create_thread(thread_group);
+    /*
+      An idle worker of another group can take the events without
+      creating a new thread. If there is none, grow this group.
+    */
+    if (wake_thief(thread_group))
+      wake_or_create_thread(thread_group);
   }
   
   /* Reset queue event count */
@@ -709,17 +994,20 @@ static connection_t * listener(worker_thread_t *current_thread,
      more workers.
     */
     
-    bool listener_picks_event= thread_group->queue.is_empty();
+    bool listener_picks_event= queue_is_empty(thread_group);
+    DBUG_EXECUTE_IF("threadpool_queue_all_events",
+                    listener_picks_event= false;);
     
     /* 
       If listener_picks_event is set, listener thread will handle first event, 
       and put the rest into the queue. If listener_pick_event is not set, all 
       events go to the queue.
     */
+    ulonglong now= microsecond_interval_timer();
     for(int i=(listener_picks_event)?1:0; i < cnt ; i++)
     {
       connection_t *c= (connection_t *)native_event_get_userdata(&ev[i]);
-      thread_group->queue.push_back(c);
+      queue_push(thread_group, c, now);
     }
     
     if (listener_picks_event)
@@ -911,6 +1199,7 @@ int thread_group_init(thread_group_t *thread_group, pthread_attr_t* thread_attr)
   thread_group->pollfd= -1;
   thread_group->shutdown_pipe[0]= -1;
   thread_group->shutdown_pipe[1]= -1;
+  thread_group->high_prio_queue.empty();
   thread_group->queue.empty();
   DBUG_RETURN(0);
 }
@@ -1017,7 +1306,7 @@ static void queue_put(thread_group_t *thread_group, connection_t *connection)
   DBUG_ENTER("queue_put");
 
   mysql_mutex_lock(&thread_group->mutex);
-  thread_group->queue.push_back(connection);
+  queue_push(thread_group, connection, microsecond_interval_timer());
 
   if (thread_group->active_thread_count == 0)
     wake_or_create_thread(thread_group);
@@ -1105,12 +1394,18 @@ connection_t *get_event(worker_thread_t *current_thread,
     if (!oversubscribed)
     {
       native_event nev;
-      if (io_poll_wait(thread_group->pollfd,&nev,1, 0) == 1)
+      if (!DBUG_EVALUATE_IF("threadpool_queue_all_events", 1, 0) &&
+          io_poll_wait(thread_group->pollfd,&nev,1, 0) == 1)
       {
         thread_group->io_event_count++;
         connection = (connection_t *)native_event_get_userdata(&nev);
         break;
       }
+
+      /* Nothing to do in this group, help out another one */
+      connection= queue_steal(thread_group);
+      if (connection)
+        break;
     }
 
     /* And now, finally sleep */ 
@@ -1169,10 +1464,9 @@ void wait_begin(thread_group_t *thread_group)
   thread_group->active_thread_count--;
   
   DBUG_ASSERT(thread_group->active_thread_count >=0);
-  DBUG_ASSERT(thread_group->connection_count > 0);
  
   if ((thread_group->active_thread_count == 0) && 
-     (thread_group->queue.is_empty() || !thread_group->listener))
+     (queue_is_empty(thread_group) || !thread_group->listener))
   {
     /* 
       Group might stall while this thread waits, thus wake 
@@ -1211,8 +1505,10 @@ connection_t *alloc_connection(THD *thd)
   if (connection)
   {
     connection->thd = thd;
+    connection->worker_group= NULL;
     connection->waiting= false;
     connection->logged_in= false;
+    connection->tickets= thd->variables.threadpool_high_prio_tickets;
     connection->bound_to_poll_descriptor= false;
     connection->abs_wait_timeout= ULONGLONG_MAX;
   }
@@ -1293,8 +1589,10 @@ void tp_wait_begin(THD *thd, int type)
   if (connection)
   {
     DBUG_ASSERT(!connection->waiting);
+    /* The worker may be from a group without connections, if it stole */
+    DBUG_ASSERT(connection->thread_group->connection_count > 0);
     connection->waiting= true;
-    wait_begin(connection->thread_group);
+    wait_begin(connection->worker_group);
   }
   DBUG_VOID_RETURN;
 }
@@ -1314,7 +1612,7 @@ void tp_wait_end(THD *thd)
   {
     DBUG_ASSERT(connection->waiting);
     connection->waiting = false;
-    wait_end(connection->thread_group);
+    wait_end(connection->worker_group);
   }
   DBUG_VOID_RETURN;
 }
@@ -1493,6 +1791,13 @@ static void *worker_main(void *param)
     if (!connection)
       break;
     this_thread.event_count++;
+    /*
+      The event may come from another group's queue. Waits are accounted
+      in the group of the worker, which is the one that counts it active.
+    */
+    connection->worker_group= thread_group;
+    if (numa_node_count)
+      thread_group->numa_node= current_numa_node();
     handle_event(connection);
   }
 
@@ -1527,6 +1832,7 @@ bool tp_init()
   }
   threadpool_started= true;
   scheduler_init();
+  numa_init();
 
   for (uint i= 0; i < threadpool_max_size; i++)
   {
@@ -1562,6 +1868,7 @@ void tp_end()
   {
     thread_group_close(&all_groups[i]);
   }
+  numa_end();
   threadpool_started= false;
   DBUG_VOID_RETURN;
 }
@@ -1628,6 +1935,49 @@ int tp_get_idle_thread_count()
 }
 
 
+/** Number of thread groups in use, for the statistics plugin */
+
+uint tp_get_group_count()
+{
+  return threadpool_started ? group_count : 0;
+}
+
+
+/**
+ Copy statistics of one thread group.
+
+ @return false on success, true if there is no such group
+*/
+
+bool tp_get_group_stats(uint group_id, TP_GROUP_STATS *stats)
+{
+  if (!threadpool_started || group_id >= group_count)
+    return true;
+
+  thread_group_t *group= &all_groups[group_id];
+  mysql_mutex_lock(&group->mutex);
+  stats->connections= group->connection_count;
+  stats->threads= group->thread_count;
+  stats->active_threads= group->active_thread_count;
+  stats->high_prio_queue_length= 0;
+  connection_queue_t::Iterator high_prio_it(group->high_prio_queue);
+  while (high_prio_it++)
+    stats->high_prio_queue_length++;
+  stats->queue_length= stats->high_prio_queue_length;
+  connection_queue_t::Iterator it(group->queue);
+  while (it++)
+    stats->queue_length++;
+  stats->high_prio_events= group->high_prio_events;
+  stats->low_prio_events= group->low_prio_events;
+  stats->steals= group->steals;
+  stats->stolen= group->stolen;
+  memcpy(stats->queue_latency, group->queue_latency,
+         sizeof(stats->queue_latency));
+  mysql_mutex_unlock(&group->mutex);
+  return false;
+}
+
+
 /* Report threadpool problems */
 
 /** 
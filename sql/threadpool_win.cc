@@ -745,3 +745,19 @@ int tp_get_idle_thread_count()
   return 0;
 }
 
+
+
+/**
+ Per group statistics. Thread groups are managed by Windows,
+ thus there are none to report.
+*/
+uint tp_get_group_count()
+{
+  return 0;
+}
+
+
+bool tp_get_group_stats(uint, TP_GROUP_STATS *)
+{
+  return true;
+}
@@ -186,6 +186,7 @@ static double get_merge_buffers_cost(uint *buff_elems, uint elem_size,
       max_n_elems   # of elements in first maxbuffer buffers
       last_n_elems  # of elements in last buffer
       elem_size     size of buffer element
+      max_keys      # of elements which fit into the merge buffer
 
   NOTES
     maxbuffer+1 buffers are merged, where first maxbuffer buffers contain
@@ -201,11 +202,14 @@ static double get_merge_buffers_cost(uint *buff_elems, uint elem_size,
 static double get_merge_many_buffs_cost(uint *buffer,
                                         uint maxbuffer, uint max_n_elems,
                                         uint last_n_elems, int elem_size,
+                                        ha_rows max_keys,
                                         uint compare_factor)
 {
   register int i;
   double total_cost= 0.0;
   uint *buff_elems= buffer; /* #s of elements in each of merged sequences */
+  const uint mergebuff2= get_merge_fanin(max_keys, elem_size);
+  const uint mergebuff= mergebuff2 / 2;
 
   /*
     Set initial state: first maxbuffer sequences contain max_n_elems elements
@@ -219,16 +223,16 @@ static double get_merge_many_buffs_cost(uint *buffer,
     Do it exactly as merge_many_buff function does, calling
     get_merge_buffers_cost to get cost of merge_buffers.
   */
-  if (maxbuffer >= MERGEBUFF2)
+  if (maxbuffer >= mergebuff2)
   {
-    while (maxbuffer >= MERGEBUFF2)
+    while (maxbuffer >= mergebuff2)
     {
       uint lastbuff= 0;
-      for (i = 0; i <= (int) maxbuffer - MERGEBUFF*3/2; i += MERGEBUFF)
+      for (i = 0; i <= (int) maxbuffer - (int) mergebuff*3/2; i += mergebuff)
       {
         total_cost+=get_merge_buffers_cost(buff_elems, elem_size,
                                            buff_elems + i,
-                                           buff_elems + i + MERGEBUFF-1,
+                                           buff_elems + i + mergebuff-1,
                                            compare_factor);
 	lastbuff++;
       }
@@ -347,6 +351,7 @@ double Unique::get_use_cost(uint *buffer, size_t nkeys, uint key_size,
   double merge_cost= get_merge_many_buffs_cost(buffer, n_full_trees,
                                                max_elements_in_tree,
                                                last_tree_elems, key_size,
+                                               max_in_memory_size / key_size,
                                                compare_factor);
   result += merge_cost;
   /*
@@ -1800,6 +1800,64 @@ int ha_myisam::rnd_next(uchar *buf)
   return error;
 }
 
+/*
+  The sampling scan reads or skips the data file by blocks of at most
+  MI_SAMPLE_BLOCK_SIZE bytes. Smaller tables are divided into at least
+  MI_SAMPLE_MIN_BLOCKS blocks to keep the sample representative.
+*/
+#define MI_SAMPLE_BLOCK_SIZE (16*1024)
+#define MI_SAMPLE_MIN_BLOCKS 1024
+
+int ha_myisam::sample_init()
+{
+  MYISAM_SHARE *share= file->s;
+  if (share->data_file_type == STATIC_RECORD)
+  {
+    ulong reclength= share->base.pack_reclength;
+    my_off_t block_records= MY_MIN(MI_SAMPLE_BLOCK_SIZE / reclength,
+                                   file->state->data_file_length / reclength /
+                                   MI_SAMPLE_MIN_BLOCKS);
+    sample_block_length= MY_MAX(block_records, 1) * reclength;
+  }
+  sample_pos= sample_block_end= share->pack.header_length;
+  return mi_scan_init(file);
+}
+
+/*
+  Read the next record of the sample, see handler::ha_sample_init()
+
+  The positions of the fixed length records are known, so the data file
+  is sampled by blocks: the blocks that do not get into the sample are
+  not read. The records of the other formats are sampled one by one
+  while the whole data file is scanned.
+*/
+
+int ha_myisam::sample_next(uchar *buf)
+{
+  MYISAM_SHARE *share= file->s;
+  if (share->data_file_type != STATIC_RECORD)
+    return handler::sample_next(buf);
+
+  for (;;)
+  {
+    int error;
+    if (sample_pos >= sample_block_end)
+    {
+      do
+      {
+        sample_pos= sample_block_end;
+        if (sample_pos >= file->state->data_file_length)
+          return HA_ERR_END_OF_FILE;
+        sample_block_end+= sample_block_length;
+      } while (my_rnd(&sample_rand) >= sample_fraction);
+    }
+    error= mi_rrnd(file, buf, sample_pos);
+    sample_pos+= share->base.pack_reclength;
+    if (error != HA_ERR_RECORD_DELETED)
+      return error;
+  }
+}
+
 int ha_myisam::remember_rnd_pos()
 {
   position((uchar*) 0);
@@ -47,7 +47,11 @@ class ha_myisam: public handler
   ulonglong int_table_flags;
   char    *data_file_name, *index_file_name;
   bool can_enable_indexes;
+  /* The block sampling of the fixed length records, see sample_next() */
+  my_off_t sample_pos, sample_block_end, sample_block_length;
   int repair(THD *thd, HA_CHECK &param, bool optimize);
+  int sample_init();
+  int sample_next(uchar *buf);
 
  public:
   ha_myisam(handlerton *hton, TABLE_SHARE *table_arg);
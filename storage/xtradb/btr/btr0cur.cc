@@ -56,6 +56,7 @@ Created 10/16/1994 Heikki Tuuri
 #include "rem0rec.h"
 #include "rem0cmp.h"
 #include "buf0lru.h"
+#include "buf0rea.h"
 #include "btr0btr.h"
 #include "btr0sea.h"
 #include "row0log.h"
@@ -5467,6 +5468,16 @@ btr_copy_blob_prefix(
 			return(copied_len);
 		}
 
+		if (srv_blob_read_ahead_pages && part_len
+		    && copied_len < len) {
+			/* Do not read ahead past the end of the prefix
+			that the caller asked for. */
+			buf_read_ahead_blob(
+				space_id, 0, page_no,
+				ut_min(srv_blob_read_ahead_pages,
+				       1 + (len - copied_len - 1) / part_len));
+		}
+
 		/* On other BLOB pages except the first the BLOB header
 		always is at the page data start: */
 
@@ -5614,6 +5625,11 @@ end_of_blob:
 
 		buf_page_release_zip(bpage);
 
+		if (srv_blob_read_ahead_pages) {
+			buf_read_ahead_blob(space_id, zip_size, next_page_no,
+					    srv_blob_read_ahead_pages);
+		}
+
 		/* On other BLOB pages except the first
 		the BLOB header always is at the page header: */
 
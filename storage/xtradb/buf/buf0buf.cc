@@ -1396,6 +1396,15 @@ buf_pool_init_instance(
 
 		buf_pool->zip_hash = hash_create(2 * buf_pool->curr_size);
 
+		if (srv_page_hash_open_addressing) {
+			/* Room for every frame and the watch sentinels;
+			compressed-only pages beyond that are chained in
+			page_hash. */
+			buf_pool->page_hash_oa = hash_oa_create(
+				buf_pool->curr_size + BUF_POOL_WATCH_SIZE,
+				srv_n_page_hash_locks);
+		}
+
 		buf_pool->last_printout_time = ut_time();
 	}
 	/* 2. Initialize flushing fields
@@ -1464,6 +1473,11 @@ buf_pool_free_instance(
 	ha_clear(buf_pool->page_hash);
 	hash_table_free(buf_pool->page_hash);
 	hash_table_free(buf_pool->zip_hash);
+
+	if (buf_pool->page_hash_oa) {
+		hash_oa_free(buf_pool->page_hash_oa);
+		buf_pool->page_hash_oa = NULL;
+	}
 }
 
 /********************************************************************//**
@@ -1654,8 +1668,8 @@ buf_relocate(
 		LRU, buf_page_t, buf_pool->LRU, CheckInLRUList()));
 
 	/* relocate buf_pool->page_hash */
-	HASH_DELETE(buf_page_t, hash, buf_pool->page_hash, fold, bpage);
-	HASH_INSERT(buf_page_t, hash, buf_pool->page_hash, fold, dpage);
+	buf_page_hash_delete(buf_pool, fold, bpage);
+	buf_page_hash_insert(buf_pool, fold, dpage);
 }
 
 /********************************************************************//**
@@ -1779,8 +1793,7 @@ page_found:
 			mutex_exit(&buf_pool->zip_mutex);
 
 			ut_d(bpage->in_page_hash = TRUE);
-			HASH_INSERT(buf_page_t, hash, buf_pool->page_hash,
-				    fold, bpage);
+			buf_page_hash_insert(buf_pool, fold, bpage);
 
 			/* Once the sentinel is in the page_hash we can
 			safely release all locks except just the
@@ -1831,7 +1844,7 @@ buf_pool_watch_remove(
 	ut_ad(buf_page_get_state(watch) == BUF_BLOCK_ZIP_PAGE);
 	ut_ad(buf_own_zip_mutex_for_page(watch));
 
-	HASH_DELETE(buf_page_t, hash, buf_pool->page_hash, fold, watch);
+	buf_page_hash_delete(buf_pool, fold, watch);
 	ut_d(watch->in_page_hash = FALSE);
 	watch->buf_fix_count = 0;
 	watch->state = BUF_BLOCK_POOL_WATCH;
@@ -3634,7 +3647,7 @@ buf_page_init(
 	ut_ad(!block->page.in_page_hash);
 	ut_d(block->page.in_page_hash = TRUE);
 
-	HASH_INSERT(buf_page_t, hash, buf_pool->page_hash, fold, &block->page);
+	buf_page_hash_insert(buf_pool, fold, &block->page);
 
 	if (zip_size) {
 		page_zip_set_size(&block->page.zip, zip_size);
@@ -3885,8 +3898,7 @@ err_exit:
 			buf_pool_watch_remove(buf_pool, fold, watch_page);
 		}
 
-		HASH_INSERT(buf_page_t, hash, buf_pool->page_hash, fold,
-			    bpage);
+		buf_page_hash_insert(buf_pool, fold, bpage);
 
 		rw_lock_x_unlock(hash_lock);
 
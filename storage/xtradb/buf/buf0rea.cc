@@ -809,6 +809,115 @@ buf_read_ahead_linear(
 	return(count);
 }
 
+/********************************************************************//**
+Applies read-ahead to the page chain of an externally stored column.
+The pages of a BLOB are allocated from the same file segment as the
+column is written, so that the successors of a BLOB page usually have
+consecutive page numbers. We cannot know the chain without reading it,
+but we can speculatively post asynchronous reads for the next pages so
+that the synchronous read of each page in the chain is likely to find
+the page already in the buffer pool or at least in flight.
+NOTE: the calling thread may own latches on pages: to avoid deadlocks
+this function must be written such that it cannot end up waiting for
+these latches!
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_ahead_blob(
+/*================*/
+	ulint	space,		/*!< in: space id */
+	ulint	zip_size,	/*!< in: compressed page size in bytes, or 0 */
+	ulint	offset,		/*!< in: page number of the next page in
+				the BLOB page chain */
+	ulint	n_pages)	/*!< in: maximum number of pages to read,
+				starting from offset */
+{
+	buf_pool_t*	buf_pool = buf_pool_get(space, offset);
+	ib_int64_t	tablespace_version;
+	ulint		count;
+	ulint		high;
+	dberr_t		err;
+	ulint		i;
+
+	if (!n_pages) {
+		return(0);
+	}
+
+	if (UNIV_UNLIKELY(srv_startup_is_before_trx_rollback_phase)) {
+		/* No read-ahead to avoid thread deadlocks */
+		return(0);
+	}
+
+	if (buf_page_peek(space, offset)) {
+		/* The next page of the chain is already in the buffer
+		pool or being read: the previous read-ahead covered it. */
+		return(0);
+	}
+
+	/* Remember the tablespace version before we ask the tablespace size
+	below: if DISCARD + IMPORT changes the actual .ibd file meanwhile, we
+	do not try to read outside the bounds of the tablespace! */
+
+	tablespace_version = fil_space_get_version(space);
+
+	high = offset + n_pages;
+
+	if (high > fil_space_get_size(space)) {
+
+		high = fil_space_get_size(space);
+	}
+
+	if (buf_pool->n_pend_reads
+	    > buf_pool->curr_size / BUF_READ_AHEAD_PEND_LIMIT) {
+
+		return(0);
+	}
+
+	count = 0;
+
+	for (i = offset; i < high; i++) {
+		/* It is only sensible to do read-ahead in the non-sync
+		aio mode: hence false as the second parameter */
+
+		if (ibuf_bitmap_page(zip_size, i)
+		    || trx_sys_hdr_page(space, i)) {
+			continue;
+		}
+
+		count += buf_read_page_low(
+			&err, false,
+			BUF_READ_ANY_PAGE | OS_AIO_SIMULATED_WAKE_LATER,
+			space, zip_size, FALSE, tablespace_version, i, NULL);
+
+		if (err == DB_TABLESPACE_DELETED) {
+			/* The BLOB will be reported missing by the
+			caller; there is no point in reading further. */
+			break;
+		}
+	}
+
+	/* In simulated aio we wake the aio handler threads only after
+	queuing all aio requests, in native aio the following call does
+	nothing: */
+
+	os_aio_simulated_wake_handler_threads();
+
+#ifdef UNIV_DEBUG
+	if (buf_debug_prints && (count > 0)) {
+		fprintf(stderr,
+			"BLOB read-ahead space %lu offset %lu pages %lu\n",
+			(ulong) space, (ulong) offset, (ulong) count);
+	}
+#endif /* UNIV_DEBUG */
+
+	/* Read ahead is considered one I/O operation for the purpose of
+	LRU policy decision. */
+	buf_LRU_stat_inc_io();
+
+	buf_pool->stat.n_ra_pages_read += count;
+	return(count);
+}
+
 /********************************************************************//**
 Issues read requests for pages which the ibuf module wants to read in, in
 order to contract the insert buffer tree. Technically, this function is like
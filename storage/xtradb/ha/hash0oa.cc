@@ -0,0 +1,336 @@
+/*****************************************************************************
+
+Copyright (c) 2026, Percona Inc. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file ha/hash0oa.cc
+Cache-line aware open addressing hash table
+
+Created 10/18/2026
+*******************************************************/
+
+#include "hash0oa.h"
+#ifdef UNIV_NONINL
+#include "hash0oa.ic"
+#endif
+
+#include "ut0mem.h"
+#include "ut0byte.h"
+#include "mem0mem.h"
+
+/*************************************************************//**
+Creates an open addressing hash table that can hold at least n entries
+spread evenly over n_parts parts.
+@return	own: created table */
+UNIV_INTERN
+hash_oa_t*
+hash_oa_create(
+/*===========*/
+	ulint	n,		/*!< in: number of entries to size for */
+	ulint	n_parts)	/*!< in: number of parts, a power of 2 */
+{
+	hash_oa_t*	table;
+	ulint		n_per_part;
+	ulint		n_buckets;
+
+	ut_a(n_parts > 0);
+	ut_a(ut_is_2pow(n_parts));
+
+	table = static_cast<hash_oa_t*>(mem_alloc(sizeof(*table)));
+
+	/* Size the parts so that they are at most 3/4 full when
+	holding n entries, with a power of 2 number of buckets. */
+	n_per_part = n / n_parts + 1;
+	n_buckets = ut_2_power_up(
+		n_per_part * 4 / (3 * HASH_OA_N_SLOTS) + 1);
+
+	table->n_parts = n_parts;
+	table->n_buckets = n_buckets;
+	table->max_entries = n_buckets * HASH_OA_N_SLOTS * 7 / 8;
+
+	table->mem_size = CACHE_LINE_SIZE
+		+ n_parts * (n_buckets * sizeof(hash_oa_bucket_t)
+			     + sizeof(hash_oa_part_t));
+	table->mem = ut_malloc(table->mem_size);
+	memset(table->mem, 0, table->mem_size);
+
+	table->buckets = static_cast<hash_oa_bucket_t*>(
+		ut_align(table->mem, CACHE_LINE_SIZE));
+	table->parts = reinterpret_cast<hash_oa_part_t*>(
+		table->buckets + n_parts * n_buckets);
+
+	table->magic_n = HASH_OA_MAGIC_N;
+
+	return(table);
+}
+
+/*************************************************************//**
+Frees an open addressing hash table. */
+UNIV_INTERN
+void
+hash_oa_free(
+/*=========*/
+	hash_oa_t*	table)	/*!< in, own: hash table */
+{
+	ut_ad(table->magic_n == HASH_OA_MAGIC_N);
+
+	ut_free(table->mem);
+	table->magic_n = 0;
+	mem_free(table);
+}
+
+/*************************************************************//**
+Inserts an entry into a part of the table. If the part is full, the
+entry is counted as spilled and the caller must store it elsewhere.
+@return	TRUE if inserted, FALSE if the part is full */
+UNIV_INTERN
+ibool
+hash_oa_insert(
+/*===========*/
+	hash_oa_t*	table,	/*!< in: hash table */
+	ulint		part,	/*!< in: part number */
+	ulint		fold,	/*!< in: fold of the entry */
+	void*		data)	/*!< in: entry, must not be NULL */
+{
+	hash_oa_part_t*	p = &table->parts[part];
+	ib_uint64_t	h = hash_oa_calc(fold);
+	byte		tag = hash_oa_get_tag(h);
+	ulint		i = hash_oa_get_home(table, h);
+
+	ut_ad(table->magic_n == HASH_OA_MAGIC_N);
+	ut_ad(part < table->n_parts);
+	ut_ad(data != NULL);
+
+	if (p->n_entries >= table->max_entries) {
+		p->n_spilled++;
+
+		return(FALSE);
+	}
+
+	/* Because a part is never completely filled, this loop
+	terminates before it wraps around. */
+	for (;;) {
+		hash_oa_bucket_t*	b;
+		ulint			s;
+
+		b = hash_oa_get_nth_bucket(table, part, i);
+
+		for (s = 0; s < HASH_OA_N_SLOTS; s++) {
+			if (!b->tags[s]) {
+				b->tags[s] = tag;
+				b->data[s] = data;
+				p->n_entries++;
+
+				return(TRUE);
+			}
+		}
+
+		if (b->n_overflow < 255) {
+			b->n_overflow++;
+		}
+
+		i = (i + 1) & (table->n_buckets - 1);
+	}
+}
+
+/*************************************************************//**
+Deletes an entry from a part of the table. If the entry is not found
+it is assumed to have been spilled, and the spill count of the part is
+decremented.
+@return	TRUE if the entry was found and deleted */
+UNIV_INTERN
+ibool
+hash_oa_delete(
+/*===========*/
+	hash_oa_t*	table,	/*!< in: hash table */
+	ulint		part,	/*!< in: part number */
+	ulint		fold,	/*!< in: fold of the entry */
+	const void*	data)	/*!< in: entry */
+{
+	hash_oa_part_t*	p = &table->parts[part];
+	ib_uint64_t	h = hash_oa_calc(fold);
+	byte		tag = hash_oa_get_tag(h);
+	ulint		home = hash_oa_get_home(table, h);
+	ulint		i = home;
+	ulint		j;
+	ulint		n;
+
+	ut_ad(table->magic_n == HASH_OA_MAGIC_N);
+	ut_ad(part < table->n_parts);
+
+	for (n = 0; n < table->n_buckets; n++) {
+		hash_oa_bucket_t*	b;
+		ulint			s;
+
+		b = hash_oa_get_nth_bucket(table, part, i);
+
+		for (s = 0; s < HASH_OA_N_SLOTS; s++) {
+			if (b->tags[s] != tag || b->data[s] != data) {
+				continue;
+			}
+
+			b->tags[s] = 0;
+			b->data[s] = NULL;
+
+			ut_ad(p->n_entries > 0);
+			p->n_entries--;
+
+			/* The entry no longer passes the buckets
+			between its home and this one. */
+			for (j = home; j != i;
+			     j = (j + 1) & (table->n_buckets - 1)) {
+
+				hash_oa_bucket_t*	o;
+
+				o = hash_oa_get_nth_bucket(table, part, j);
+
+				ut_ad(o->n_overflow > 0);
+
+				if (o->n_overflow < 255) {
+					o->n_overflow--;
+				}
+			}
+
+			return(TRUE);
+		}
+
+		if (!b->n_overflow) {
+			break;
+		}
+
+		i = (i + 1) & (table->n_buckets - 1);
+	}
+
+	ut_ad(p->n_spilled > 0);
+	p->n_spilled--;
+
+	return(FALSE);
+}
+
+#ifdef UNIV_COMPILE_TEST_FUNCS
+
+#include "hash0hash.h"
+#include "ut0rnd.h"
+
+/** An entry of the lookup benchmark, keyed like a buf_page_t */
+struct test_hash_oa_entry_t {
+	ulint			space;	/*!< tablespace id */
+	ulint			offset;	/*!< page number */
+	test_hash_oa_entry_t*	hash;	/*!< hash_table_t chain node */
+};
+
+/*************************************************************//**
+Compares lookups in a hash_table_t and a hash_oa_t holding n entries
+and prints the time taken by each to stderr. */
+void
+test_hash_oa_lookup(
+/*================*/
+	ulint	n)	/*!< in: number of entries, e.g. 10000000 */
+{
+	const ulint		n_parts = 16;
+	test_hash_oa_entry_t*	entries;
+	ulint*			probes;
+	hash_table_t*		chained;
+	hash_oa_t*		oa;
+	speedo_t		speedo;
+	ulint			n_found;
+	ulint			i;
+
+	entries = static_cast<test_hash_oa_entry_t*>(
+		ut_malloc(n * sizeof(*entries)));
+	probes = static_cast<ulint*>(ut_malloc(n * sizeof(*probes)));
+
+	chained = hash_create(2 * n);
+	oa = hash_oa_create(n, n_parts);
+
+	/* Lay the pages out as 1000 tablespaces and fold them like
+	buf_page_address_fold() does. */
+	for (i = 0; i < n; i++) {
+		test_hash_oa_entry_t*	e = &entries[i];
+		ulint			fold;
+
+		e->space = i % 1000;
+		e->offset = i / 1000;
+
+		fold = (e->space << 20) + e->space + e->offset;
+
+		HASH_INSERT(test_hash_oa_entry_t, hash, chained, fold, e);
+		ut_a(hash_oa_insert(oa, ut_2pow_remainder(
+					    hash_calc_hash(fold, chained),
+					    n_parts),
+				    fold, e));
+	}
+
+	for (i = 0; i < n; i++) {
+		probes[i] = ut_rnd_gen_ulint() % n;
+	}
+
+	fprintf(stderr, "hash_table_t: %lu random lookups in %lu entries\n",
+		n, n);
+
+	speedo_reset(&speedo);
+
+	for (i = 0, n_found = 0; i < n; i++) {
+		const test_hash_oa_entry_t*	key = &entries[probes[i]];
+		test_hash_oa_entry_t*		e;
+		ulint				fold;
+
+		fold = (key->space << 20) + key->space + key->offset;
+
+		HASH_SEARCH(hash, chained, fold, test_hash_oa_entry_t*, e,
+			    ut_ad(1),
+			    e->space == key->space
+			    && e->offset == key->offset);
+
+		n_found += (e != NULL);
+	}
+
+	speedo_show(&speedo);
+	ut_a(n_found == n);
+
+	fprintf(stderr, "hash_oa_t: %lu random lookups in %lu entries\n",
+		n, n);
+
+	speedo_reset(&speedo);
+
+	for (i = 0, n_found = 0; i < n; i++) {
+		const test_hash_oa_entry_t*	key = &entries[probes[i]];
+		test_hash_oa_entry_t*		e;
+		ulint				fold;
+		ulint				part;
+
+		fold = (key->space << 20) + key->space + key->offset;
+		part = ut_2pow_remainder(hash_calc_hash(fold, chained),
+					 n_parts);
+
+		HASH_OA_SEARCH(oa, part, fold, test_hash_oa_entry_t*, e,
+			       e->space == key->space
+			       && e->offset == key->offset);
+
+		n_found += (e != NULL);
+	}
+
+	speedo_show(&speedo);
+	ut_a(n_found == n);
+
+	hash_oa_free(oa);
+	hash_table_free(chained);
+	ut_free(probes);
+	ut_free(entries);
+}
+
+#endif /* UNIV_COMPILE_TEST_FUNCS */
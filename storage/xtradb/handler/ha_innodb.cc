@@ -373,11 +373,13 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&fts_doc_id_mutex_key, "fts_doc_id_mutex", 0},
 	{&fts_pll_tokenize_mutex_key, "fts_pll_tokenize_mutex", 0},
 	{&log_flush_order_mutex_key, "log_flush_order_mutex", 0},
+	{&log_group_commit_mutex_key, "log_group_commit_mutex", 0},
 	{&hash_table_mutex_key, "hash_table_mutex", 0},
 	{&ibuf_bitmap_mutex_key, "ibuf_bitmap_mutex", 0},
 	{&ibuf_mutex_key, "ibuf_mutex", 0},
 	{&ibuf_pessimistic_insert_mutex_key,
 		 "ibuf_pessimistic_insert_mutex", 0},
+	{&ibuf_stat_per_index_mutex_key, "ibuf_stat_per_index_mutex", 0},
 #  ifndef HAVE_ATOMIC_BUILTINS
 	{&server_mutex_key, "server_mutex", 0},
 #  endif /* !HAVE_ATOMIC_BUILTINS */
@@ -424,6 +426,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&monitor_mutex_key, "monitor_mutex", 0},
 #endif /* !HAVE_ATOMIC_BUILTINS_64 */
 	{&ut_list_mutex_key, "ut_list_mutex", 0},
+	{&mem_block_cache_mutex_key, "mem_block_cache_mutex", 0},
 	{&trx_sys_mutex_key, "trx_sys_mutex", 0},
 	{&zip_pad_mutex_key, "zip_pad_mutex", 0},
 };
@@ -784,6 +787,18 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_ibuf_segment_size,	  SHOW_LONG},
   {"ibuf_size",
   (char*) &export_vars.innodb_ibuf_size,		  SHOW_LONG},
+  {"log_group_commit_size_1",
+  (char*) &export_vars.innodb_log_group_commit_sizes[0],  SHOW_LONG},
+  {"log_group_commit_size_2_3",
+  (char*) &export_vars.innodb_log_group_commit_sizes[1],  SHOW_LONG},
+  {"log_group_commit_size_4_7",
+  (char*) &export_vars.innodb_log_group_commit_sizes[2],  SHOW_LONG},
+  {"log_group_commit_size_8_15",
+  (char*) &export_vars.innodb_log_group_commit_sizes[3],  SHOW_LONG},
+  {"log_group_commit_size_16_31",
+  (char*) &export_vars.innodb_log_group_commit_sizes[4],  SHOW_LONG},
+  {"log_group_commit_size_32_more",
+  (char*) &export_vars.innodb_log_group_commit_sizes[5],  SHOW_LONG},
   {"log_waits",
   (char*) &export_vars.innodb_log_waits,		  SHOW_LONG},
   {"log_write_requests",
@@ -804,6 +819,12 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_max_trx_id,		  SHOW_LONGLONG},
   {"mem_adaptive_hash",
   (char*) &export_vars.innodb_mem_adaptive_hash,	  SHOW_LONG},
+  {"mem_block_cache_bytes",
+  (char*) &export_vars.innodb_mem_block_cache_bytes,	  SHOW_LONG},
+  {"mem_block_cache_hits",
+  (char*) &export_vars.innodb_mem_block_cache_hits,	  SHOW_LONG},
+  {"mem_block_cache_misses",
+  (char*) &export_vars.innodb_mem_block_cache_misses,	  SHOW_LONG},
   {"mem_dictionary",
   (char*) &export_vars.innodb_mem_dictionary,		  SHOW_LONG},
   {"mem_total",
@@ -17284,6 +17305,13 @@ static MYSQL_SYSVAR_BOOL(use_global_flush_log_at_trx_commit, srv_use_global_flus
   "Use global innodb_flush_log_at_trx_commit value. (default: ON).",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_BOOL(log_group_commit, srv_log_group_commit,
+  PLUGIN_VAR_NOCMDARG,
+  "Let one committing transaction write and flush the log for all "
+  "transactions that commit while it does so, when "
+  "innodb_flush_log_at_trx_commit=1 (default: ON).",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_STR(flush_method, innobase_file_flush_method,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "With which method to flush data.", NULL, NULL, NULL);
@@ -17484,6 +17512,13 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_populate, srv_buf_pool_populate,
   "established by the buffer pool memory region. Disabled by default.",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(page_hash_open_addressing,
+  srv_page_hash_open_addressing,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Look up buffer pool pages in a cache-line aware open addressing hash "
+  "table instead of following the page_hash chains. Disabled by default.",
+  NULL, NULL, FALSE);
+
 static MYSQL_SYSVAR_ENUM(foreground_preflush, srv_foreground_preflush,
   PLUGIN_VAR_OPCMDARG,
   "The algorithm InnoDB uses for the query threads at sync preflush.  "
@@ -17915,6 +17950,13 @@ static MYSQL_SYSVAR_BOOL(use_sys_malloc, srv_use_sys_malloc,
   "Use OS memory allocator instead of InnoDB's internal memory allocator",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_ULONG(mem_block_cache_size, srv_mem_block_cache_size,
+  PLUGIN_VAR_RQCMDARG,
+  "Maximum number of bytes of freed memory heap blocks kept in the shared "
+  "pool of the heap block cache, in addition to a few blocks cached per "
+  "thread (0 = disabled). Only used with innodb_use_sys_malloc.",
+  NULL, NULL, 0, 0, 1024 * 1024 * 1024L, 0);
+
 static MYSQL_SYSVAR_BOOL(use_native_aio, srv_use_native_aio,
   PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
   "Use native AIO if supported on this platform.",
@@ -17966,6 +18008,15 @@ static MYSQL_SYSVAR_UINT(change_buffer_max_size,
   NULL, innodb_change_buffer_max_size_update,
   CHANGE_BUFFER_DEFAULT_SIZE, 0, 50, 0);
 
+static MYSQL_SYSVAR_ULONG(ibuf_merge_threads, srv_n_ibuf_merge_threads,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of dedicated change buffer merge threads. When 0 (the default),"
+  " the master thread does the background change buffer merge.",
+  NULL, NULL,
+  0,			/* Default setting */
+  0,			/* Minimum value */
+  SRV_MAX_N_IBUF_MERGE_THREADS, 0);	/* Maximum value */
+
 static MYSQL_SYSVAR_ENUM(stats_method, srv_innodb_stats_method,
    PLUGIN_VAR_RQCMDARG,
   "Specifies how InnoDB index statistics collection code should "
@@ -18021,6 +18072,12 @@ static MYSQL_SYSVAR_ULONG(read_ahead_threshold, srv_read_ahead_threshold,
   "trigger a readahead.",
   NULL, NULL, 56, 0, 64, 0);
 
+static MYSQL_SYSVAR_ULONG(blob_read_ahead_pages, srv_blob_read_ahead_pages,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of pages of an externally stored column to read ahead "
+  "asynchronously while following its page chain (0 = disabled).",
+  NULL, NULL, 0, 0, 1024, 0);
+
 static MYSQL_SYSVAR_STR(monitor_enable, innobase_enable_monitor_counter,
   PLUGIN_VAR_RQCMDARG,
   "Turn on a monitor counter",
@@ -18157,6 +18214,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(autoextend_increment),
   MYSQL_SYSVAR(buffer_pool_size),
   MYSQL_SYSVAR(buffer_pool_populate),
+  MYSQL_SYSVAR(page_hash_open_addressing),
   MYSQL_SYSVAR(buffer_pool_instances),
   MYSQL_SYSVAR(buffer_pool_filename),
   MYSQL_SYSVAR(buffer_pool_dump_now),
@@ -18195,6 +18253,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(flush_log_at_timeout),
   MYSQL_SYSVAR(flush_log_at_trx_commit),
   MYSQL_SYSVAR(use_global_flush_log_at_trx_commit),
+  MYSQL_SYSVAR(log_group_commit),
   MYSQL_SYSVAR(flush_method),
   MYSQL_SYSVAR(force_recovery),
 #ifndef DBUG_OFF
@@ -18269,9 +18328,11 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(show_locks_held),
   MYSQL_SYSVAR(version),
   MYSQL_SYSVAR(use_sys_malloc),
+  MYSQL_SYSVAR(mem_block_cache_size),
   MYSQL_SYSVAR(use_native_aio),
   MYSQL_SYSVAR(change_buffering),
   MYSQL_SYSVAR(change_buffer_max_size),
+  MYSQL_SYSVAR(ibuf_merge_threads),
   MYSQL_SYSVAR(track_changed_pages),
   MYSQL_SYSVAR(max_bitmap_file_size),
   MYSQL_SYSVAR(max_changed_pages),
@@ -18281,6 +18342,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
   MYSQL_SYSVAR(random_read_ahead),
   MYSQL_SYSVAR(read_ahead_threshold),
+  MYSQL_SYSVAR(blob_read_ahead_pages),
   MYSQL_SYSVAR(read_only),
   MYSQL_SYSVAR(io_capacity),
   MYSQL_SYSVAR(io_capacity_max),
@@ -18376,6 +18438,7 @@ i_s_innodb_cmpmem,
 i_s_innodb_cmpmem_reset,
 i_s_innodb_cmp_per_index,
 i_s_innodb_cmp_per_index_reset,
+i_s_innodb_change_buffer_per_index,
 i_s_innodb_buffer_page,
 i_s_innodb_buffer_page_lru,
 i_s_innodb_buffer_stats,
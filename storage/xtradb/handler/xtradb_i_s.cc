@@ -362,12 +362,21 @@ static int xtradb_internal_hash_tables_fill_table(THD* thd, TABLE_LIST* tables,
 	OK(schema_table_store_record(thd, table));
 
 	{
+	  buf_pool_t*	buf_pool = buf_pool_from_array(0);
+	  ulint		page_hash_size
+		  = buf_pool->page_hash->n_cells * sizeof(hash_cell_t);
+
+	  if (buf_pool->page_hash_oa) {
+		  page_hash_size
+			  += hash_oa_get_mem_size(buf_pool->page_hash_oa);
+	  }
+
 	  OK(field_store_string(fields[INT_HASH_TABLES_NAME],
 				"Page hash (buffer pool 0 only)"));
 	  OK(field_store_ulint(fields[INT_HASH_TABLES_TOTAL],
-			       (ulong) (buf_pool_from_array(0)->page_hash->n_cells * sizeof(hash_cell_t))));
+			       (ulong) page_hash_size));
 	  OK(field_store_ulint(fields[INT_HASH_TABLES_CONSTANT],
-			       (ulong) (buf_pool_from_array(0)->page_hash->n_cells * sizeof(hash_cell_t))));
+			       (ulong) page_hash_size));
 	  OK(field_store_ulint(fields[INT_HASH_TABLES_VARIABLE], 0));
 	  OK(schema_table_store_record(thd, table));
 
@@ -204,10 +204,23 @@ UNIV_INTERN uint	ibuf_debug;
 /** The insert buffer control structure */
 UNIV_INTERN ibuf_t*	ibuf			= NULL;
 
+/** Event to wake up the change buffer merge threads */
+UNIV_INTERN os_event_t	ibuf_merge_event	= NULL;
+
+/** Number of change buffer merge threads that are running,
+protected by ibuf_mutex */
+UNIV_INTERN ulint	ibuf_merge_threads_active	= 0;
+
+/** Change buffer statistics, indexed by dict_index_t::id */
+UNIV_INTERN ibuf_stat_per_index_t	ibuf_stat_per_index;
+/** Mutex protecting ibuf_stat_per_index */
+UNIV_INTERN ib_mutex_t		ibuf_stat_per_index_mutex;
+
 #ifdef UNIV_PFS_MUTEX
 UNIV_INTERN mysql_pfs_key_t	ibuf_pessimistic_insert_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	ibuf_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	ibuf_bitmap_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	ibuf_stat_per_index_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 #ifdef UNIV_IBUF_COUNT_DEBUG
@@ -474,6 +487,14 @@ ibuf_close(void)
 	mutex_free(&ibuf_bitmap_mutex);
 	memset(&ibuf_bitmap_mutex, 0x0, sizeof(ibuf_mutex));
 
+	mutex_free(&ibuf_stat_per_index_mutex);
+	memset(&ibuf_stat_per_index_mutex, 0x0,
+	       sizeof(ibuf_stat_per_index_mutex));
+	ibuf_stat_per_index.clear();
+
+	os_event_free(ibuf_merge_event);
+	ibuf_merge_event = NULL;
+
 	mem_free(ibuf);
 	ibuf = NULL;
 }
@@ -575,6 +596,14 @@ ibuf_init_at_db_start(void)
 	mutex_create(ibuf_bitmap_mutex_key,
 		     &ibuf_bitmap_mutex, SYNC_IBUF_BITMAP_MUTEX);
 
+	/* ibuf_stat_per_index_mutex is acquired while holding page
+	latches and ibuf_mutex, and no other latch is acquired while
+	holding it. */
+	mutex_create(ibuf_stat_per_index_mutex_key,
+		     &ibuf_stat_per_index_mutex, SYNC_ANY_LATCH);
+
+	ibuf_merge_event = os_event_create();
+
 	mtr_start(&mtr);
 
 	mutex_enter(&ibuf_mutex);
@@ -2897,6 +2926,110 @@ ibuf_contract_in_background(
 	return(sum_bytes);
 }
 
+/*********************************************************************//**
+Computes the number of pages that the merge threads should merge in one
+round of about one second. The target grows with the size of the change
+buffer relative to its maximum size and with innodb_io_capacity; when the
+server has been idle during the previous round, a full batch is done.
+@return number of pages to merge by all merge threads together */
+static
+ulint
+ibuf_merge_thread_batch_size(
+/*=========================*/
+	bool	idle)	/*!< in: true if there was no server activity
+			during the previous round */
+{
+	ulint	n_pages;
+
+	if (idle) {
+		return(PCT_IO(100));
+	}
+
+	/* Dirty read: at worst we merge a little more or a little
+	less in this round. +1 is to avoid division by zero. */
+	n_pages = PCT_IO(5)
+		+ PCT_IO(ut_min(ibuf->size * 100 / (ibuf->max_size + 1),
+				100));
+
+	return(n_pages);
+}
+
+/*********************************************************************//**
+This is the thread for background change buffer merging. When
+innodb_ibuf_merge_threads is nonzero, these threads do the change buffer
+merge in place of the master thread. Each thread merges its share of the
+batch size, one ibuf_merge_pages() call at a time; each call opens the
+change buffer tree at a random position and reads the buffered pages of
+that neighbourhood, which are sorted by (space, page_no), so that merge
+threads tend to work on different tablespaces and the reads of one call
+are close to each other on disk.
+@return this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(ibuf_merge_thread)(
+/*==============================*/
+	void*	arg __attribute__((unused)))	/*!< in: a dummy parameter
+						required by os_thread_create */
+{
+	ulint	last_activity_count = srv_get_activity_count();
+
+	ut_a(!srv_read_only_mode);
+	ut_a(srv_n_ibuf_merge_threads > 0);
+
+	mutex_enter(&ibuf_mutex);
+	ibuf_merge_threads_active++;
+	mutex_exit(&ibuf_mutex);
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		ulint		activity_count = srv_get_activity_count();
+		ib_int64_t	sig_count = os_event_reset(ibuf_merge_event);
+		ulint		n_pages;
+		ulint		sum_pages = 0;
+
+		n_pages = ibuf_merge_thread_batch_size(
+			activity_count == last_activity_count)
+			/ srv_n_ibuf_merge_threads + 1;
+
+		last_activity_count = activity_count;
+
+		while (sum_pages < n_pages
+		       && srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+			ulint	n_pag2;
+
+#if defined UNIV_DEBUG || defined UNIV_IBUF_DEBUG
+			if (srv_ibuf_disable_background_merge) {
+				break;
+			}
+#endif /* UNIV_DEBUG || UNIV_IBUF_DEBUG */
+
+			/* This is a dedicated thread: it can afford to
+			wait for the reads, which also keeps the merge
+			threads from flooding the i/o queues. */
+			if (!ibuf_merge(0, &n_pag2, true)) {
+				break;
+			}
+
+			sum_pages += n_pag2;
+		}
+
+		mutex_enter(&ibuf_mutex);
+		ibuf->n_merge_thread_pages += sum_pages;
+		mutex_exit(&ibuf_mutex);
+
+		os_event_wait_time_low(ibuf_merge_event, 1000000, sig_count);
+	}
+
+	mutex_enter(&ibuf_mutex);
+	ibuf_merge_threads_active--;
+	mutex_exit(&ibuf_mutex);
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit instead of return(). */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*********************************************************************//**
 Contract insert buffer trees after insert if they are too big. */
 UNIV_INLINE
@@ -2921,6 +3054,12 @@ ibuf_contract_after_insert(
 	size = ibuf->size;
 	max_size = ibuf->max_size;
 
+	if (srv_n_ibuf_merge_threads && size > max_size / 2) {
+		/* Let the merge threads start the next batch at once
+		instead of waiting for their next round. */
+		os_event_set(ibuf_merge_event);
+	}
+
 	if (size < max_size + IBUF_CONTRACT_ON_INSERT_NON_SYNC) {
 		return;
 	}
@@ -3813,6 +3952,12 @@ func_exit:
 
 	mem_heap_free(heap);
 
+	if (err == DB_SUCCESS) {
+		mutex_enter(&ibuf_stat_per_index_mutex);
+		ibuf_stat_per_index[index->id].n_buffered_ops[op]++;
+		mutex_exit(&ibuf_stat_per_index_mutex);
+	}
+
 	if (err == DB_SUCCESS && mode == BTR_MODIFY_TREE) {
 		ibuf_contract_after_insert(entry_size);
 	}
@@ -4987,6 +5132,24 @@ reset_bit:
 	mutex_exit(&ibuf_mutex);
 #endif /* HAVE_ATOMIC_BUILTINS */
 
+	if (block
+	    && (mops[IBUF_OP_INSERT] | mops[IBUF_OP_DELETE_MARK]
+		| mops[IBUF_OP_DELETE])) {
+		/* The block is still x-latched by the caller, so the
+		index id in the page header can be trusted. */
+		index_id_t	index_id = btr_page_get_index_id(block->frame);
+
+		mutex_enter(&ibuf_stat_per_index_mutex);
+
+		ibuf_index_stat_t&	stat = ibuf_stat_per_index[index_id];
+
+		for (ulint i = 0; i < IBUF_OP_COUNT; i++) {
+			stat.n_merged_ops[i] += mops[i];
+		}
+
+		mutex_exit(&ibuf_stat_per_index_mutex);
+	}
+
 	if (update_ibuf_bitmap && !tablespace_being_deleted) {
 
 		fil_decr_pending_ops(space);
@@ -5138,6 +5301,13 @@ ibuf_print(
 		(ulong) ibuf->seg_size,
 		(ulong) ibuf->n_merges);
 
+	if (srv_n_ibuf_merge_threads) {
+		fprintf(file,
+			"%lu merge threads, %lu pages merged by them\n",
+			(ulong) ibuf_merge_threads_active,
+			(ulong) ibuf->n_merge_thread_pages);
+	}
+
 	fputs("merged operations:\n ", file);
 	ibuf_print_ops(ibuf->n_merged_ops, file);
 
@@ -31,6 +31,7 @@ Created 11/5/1995 Heikki Tuuri
 #include "mtr0types.h"
 #include "buf0types.h"
 #include "hash0hash.h"
+#include "hash0oa.h"
 #include "ut0byte.h"
 #include "page0types.h"
 #ifndef UNIV_HOTBACKUP
@@ -1275,6 +1276,28 @@ buf_page_hash_get_low(
 	ulint		space,	/*!< in: space id */
 	ulint		offset,	/*!< in: offset of the page within space */
 	ulint		fold);	/*!< in: buf_page_address_fold(space, offset) */
+#ifndef UNIV_HOTBACKUP
+/******************************************************************//**
+Inserts a file page into buf_pool->page_hash. The caller must hold the
+page_hash latch for fold in exclusive mode. */
+UNIV_INLINE
+void
+buf_page_hash_insert(
+/*=================*/
+	buf_pool_t*	buf_pool,/*!< buffer pool instance */
+	ulint		fold,	/*!< in: buf_page_address_fold() of bpage */
+	buf_page_t*	bpage);	/*!< in: control block of the page */
+/******************************************************************//**
+Removes a file page from buf_pool->page_hash. The caller must hold the
+page_hash latch for fold in exclusive mode. */
+UNIV_INLINE
+void
+buf_page_hash_delete(
+/*=================*/
+	buf_pool_t*	buf_pool,/*!< buffer pool instance */
+	ulint		fold,	/*!< in: buf_page_address_fold() of bpage */
+	buf_page_t*	bpage);	/*!< in: control block of the page */
+#endif /* !UNIV_HOTBACKUP */
 /******************************************************************//**
 Returns the control block of a file page, NULL if not found.
 If the block is found and lock is not NULL then the appropriate
@@ -1885,6 +1908,12 @@ struct buf_pool_t{
 					indexed by (space_id, offset).
 					page_hash is protected by an
 					array of mutexes. */
+	hash_oa_t*	page_hash_oa;	/*!< if not NULL, open addressing
+					index of the file pages, used
+					instead of the chains of page_hash
+					for all pages that fit in it;
+					partitioned like, and protected by
+					the latches of, page_hash */
 	hash_table_t*	zip_hash;	/*!< hash table of buf_block_t blocks
 					whose frames are allocated to the
 					zip buddy system,
@@ -115,6 +115,22 @@ buf_read_ahead_linear(
 	ibool	inside_ibuf,	/*!< in: TRUE if we are inside ibuf routine */
 	trx_t*	trx);
 /********************************************************************//**
+Applies read-ahead to the page chain of an externally stored column.
+Posts asynchronous reads for up to n_pages pages with consecutive page
+numbers, starting from offset, unless the page at offset already resides
+in the buffer pool. The calling thread may own page latches.
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_ahead_blob(
+/*================*/
+	ulint	space,		/*!< in: space id */
+	ulint	zip_size,	/*!< in: compressed page size in bytes, or 0 */
+	ulint	offset,		/*!< in: page number of the next page in
+				the BLOB page chain */
+	ulint	n_pages);	/*!< in: maximum number of pages to read,
+				starting from offset */
+/********************************************************************//**
 Issues read requests for pages which the ibuf module wants to read in, in
 order to contract the insert buffer tree. Technically, this function is like
 a read-ahead function. */
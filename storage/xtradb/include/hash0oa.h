@@ -0,0 +1,256 @@
+/*****************************************************************************
+
+Copyright (c) 2026, Percona Inc. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/hash0oa.h
+Cache-line aware open addressing hash table
+
+The table stores pointers keyed by a fold value. It is split into
+n_parts independent parts, so that a caller can protect each part with
+the latch that protects the corresponding cells of a hash_table_t.
+A part is an array of buckets, each of which fills one cache line and
+holds HASH_OA_N_SLOTS entries together with a one-byte fingerprint of
+the fold of each entry. A lookup compares fingerprints first and only
+dereferences the entries whose fingerprint matches, so a search usually
+touches a single cache line of the table plus the entry it finds.
+
+Collisions are resolved by linear probing over buckets. Each bucket
+counts the entries that had to be placed beyond it because it was full;
+a search stops at the first bucket whose count is zero, so no
+tombstones are needed on deletion.
+
+A part never holds more than 7/8 of its slots. When it is full, the
+insert fails and the caller is expected to store the entry elsewhere;
+such spilled entries are counted per part.
+
+Created 10/18/2026
+*******************************************************/
+
+#ifndef hash0oa_h
+#define hash0oa_h
+
+#include "univ.i"
+#include "ut0counter.h"
+
+/** Number of entries in a bucket */
+#define HASH_OA_N_SLOTS		7
+
+/** A bucket of the open addressing hash table. On 64-bit platforms
+it is exactly one cache line. */
+struct hash_oa_bucket_t {
+	byte		tags[HASH_OA_N_SLOTS];
+					/*!< fingerprints of the entries,
+					0 for a free slot */
+	byte		n_overflow;	/*!< number of entries whose probe
+					sequence passes this bucket;
+					sticks at 255 once it gets there */
+	void*		data[HASH_OA_N_SLOTS];
+					/*!< the entries */
+};
+
+/** Per part bookkeeping of the open addressing hash table */
+struct hash_oa_part_t {
+	ulint		n_entries;	/*!< number of entries in the part */
+	ulint		n_spilled;	/*!< number of entries that did not
+					fit in the part */
+	byte		pad[CACHE_LINE_SIZE - 2 * sizeof(ulint)];
+					/*!< padding to keep the parts on
+					separate cache lines */
+};
+
+/** Open addressing hash table */
+struct hash_oa_t {
+	ulint		n_parts;	/*!< number of parts, a power of 2 */
+	ulint		n_buckets;	/*!< number of buckets in a part,
+					a power of 2 */
+	ulint		max_entries;	/*!< maximum number of entries in
+					a part */
+	hash_oa_bucket_t*
+			buckets;	/*!< the buckets of all parts,
+					aligned to CACHE_LINE_SIZE */
+	hash_oa_part_t*	parts;		/*!< array of n_parts, following
+					the buckets */
+	void*		mem;		/*!< unaligned allocation holding
+					buckets and parts */
+	ulint		mem_size;	/*!< size of mem in bytes */
+	ulint		magic_n;	/*!< HASH_OA_MAGIC_N */
+};
+
+#define HASH_OA_MAGIC_N	29871347
+
+/*************************************************************//**
+Creates an open addressing hash table that can hold at least n entries
+spread evenly over n_parts parts.
+@return	own: created table */
+UNIV_INTERN
+hash_oa_t*
+hash_oa_create(
+/*===========*/
+	ulint	n,		/*!< in: number of entries to size for */
+	ulint	n_parts);	/*!< in: number of parts, a power of 2 */
+/*************************************************************//**
+Frees an open addressing hash table. */
+UNIV_INTERN
+void
+hash_oa_free(
+/*=========*/
+	hash_oa_t*	table);	/*!< in, own: hash table */
+/*************************************************************//**
+Inserts an entry into a part of the table. If the part is full, the
+entry is counted as spilled and the caller must store it elsewhere.
+@return	TRUE if inserted, FALSE if the part is full */
+UNIV_INTERN
+ibool
+hash_oa_insert(
+/*===========*/
+	hash_oa_t*	table,	/*!< in: hash table */
+	ulint		part,	/*!< in: part number */
+	ulint		fold,	/*!< in: fold of the entry */
+	void*		data);	/*!< in: entry, must not be NULL */
+/*************************************************************//**
+Deletes an entry from a part of the table. If the entry is not found
+it is assumed to have been spilled, and the spill count of the part is
+decremented.
+@return	TRUE if the entry was found and deleted */
+UNIV_INTERN
+ibool
+hash_oa_delete(
+/*===========*/
+	hash_oa_t*	table,	/*!< in: hash table */
+	ulint		part,	/*!< in: part number */
+	ulint		fold,	/*!< in: fold of the entry */
+	const void*	data);	/*!< in: entry */
+/*************************************************************//**
+Returns the number of bytes allocated for the table.
+@return	size in bytes */
+UNIV_INLINE
+ulint
+hash_oa_get_mem_size(
+/*=================*/
+	const hash_oa_t*	table);	/*!< in: hash table */
+/*************************************************************//**
+Returns the number of entries of a part that were not stored in the
+table because it was full.
+@return	number of spilled entries */
+UNIV_INLINE
+ulint
+hash_oa_get_n_spilled(
+/*==================*/
+	const hash_oa_t*	table,	/*!< in: hash table */
+	ulint			part);	/*!< in: part number */
+/*************************************************************//**
+Computes the hash value of a fold.
+@return	hash value; the bucket and the fingerprint are taken from it */
+UNIV_INLINE
+ib_uint64_t
+hash_oa_calc(
+/*=========*/
+	ulint	fold);	/*!< in: fold */
+/*************************************************************//**
+Gets the fingerprint of a hash value.
+@return	fingerprint, never 0 */
+UNIV_INLINE
+byte
+hash_oa_get_tag(
+/*============*/
+	ib_uint64_t	h);	/*!< in: hash value */
+/*************************************************************//**
+Gets the number of the first bucket to probe for a hash value.
+@return	bucket number within a part */
+UNIV_INLINE
+ulint
+hash_oa_get_home(
+/*=============*/
+	const hash_oa_t*	table,	/*!< in: hash table */
+	ib_uint64_t		h);	/*!< in: hash value */
+/*************************************************************//**
+Gets the nth bucket of a part.
+@return	bucket */
+UNIV_INLINE
+hash_oa_bucket_t*
+hash_oa_get_nth_bucket(
+/*===================*/
+	const hash_oa_t*	table,	/*!< in: hash table */
+	ulint			part,	/*!< in: part number */
+	ulint			n);	/*!< in: bucket number */
+
+/*************************************************************//**
+Gets the slots of a bucket whose fingerprint matches a given one.
+@return	bitmap with bit n set if slot n matches */
+UNIV_INLINE
+ulint
+hash_oa_match(
+/*==========*/
+	const hash_oa_bucket_t*	bucket,	/*!< in: bucket */
+	byte			tag);	/*!< in: fingerprint */
+
+/********************************************************************//**
+Looks for an entry in a part of an open addressing hash table. Only the
+entries whose fingerprint matches that of FOLD are passed to TEST. */
+#define HASH_OA_SEARCH(TABLE, PART, FOLD, TYPE, DATA, TEST)		\
+do {									\
+	const hash_oa_bucket_t*	hash_oa_b;				\
+	ib_uint64_t	hash_oa_h = hash_oa_calc(FOLD);			\
+	byte		hash_oa_tag = hash_oa_get_tag(hash_oa_h);	\
+	ulint		hash_oa_i = hash_oa_get_home(TABLE, hash_oa_h);	\
+	ulint		hash_oa_n;					\
+	ulint		hash_oa_s;					\
+	ulint		hash_oa_m;					\
+									\
+	(DATA) = NULL;							\
+									\
+	for (hash_oa_n = 0; hash_oa_n < (TABLE)->n_buckets;		\
+	     hash_oa_n++) {						\
+		hash_oa_b = hash_oa_get_nth_bucket(TABLE, PART,		\
+						   hash_oa_i);		\
+		hash_oa_m = hash_oa_match(hash_oa_b, hash_oa_tag);	\
+									\
+		for (hash_oa_s = 0; hash_oa_m;				\
+		     hash_oa_s++, hash_oa_m >>= 1) {			\
+			if (hash_oa_m & 1) {				\
+				(DATA) = (TYPE) hash_oa_b->data[hash_oa_s];\
+				if (TEST) {				\
+					break;				\
+				}					\
+				(DATA) = NULL;				\
+			}						\
+		}							\
+									\
+		if ((DATA) != NULL || !hash_oa_b->n_overflow) {	\
+			break;						\
+		}							\
+									\
+		hash_oa_i = (hash_oa_i + 1) & ((TABLE)->n_buckets - 1);\
+	}								\
+} while (0)
+
+#ifdef UNIV_COMPILE_TEST_FUNCS
+/*************************************************************//**
+Compares lookups in a hash_table_t and a hash_oa_t holding n entries
+and prints the time taken by each to stderr. */
+void
+test_hash_oa_lookup(
+/*================*/
+	ulint	n);	/*!< in: number of entries, e.g. 10000000 */
+#endif /* UNIV_COMPILE_TEST_FUNCS */
+
+#ifndef UNIV_NONINL
+#include "hash0oa.ic"
+#endif
+
+#endif
@@ -34,6 +34,9 @@ Created 7/19/1997 Heikki Tuuri
 
 #ifndef UNIV_HOTBACKUP
 # include "ibuf0types.h"
+# include "os0thread.h" /* DECLARE_THREAD */
+# include "sync0sync.h"
+# include <map>
 
 /** Default value for maximum on-disk size of change buffer in terms
 of percentage of the buffer pool. */
@@ -70,6 +73,38 @@ extern ibuf_use_t	ibuf_use;
 /** The insert buffer control structure */
 extern ibuf_t*		ibuf;
 
+/** Event to wake up the change buffer merge threads */
+extern os_event_t	ibuf_merge_event;
+
+/** Number of change buffer merge threads that are running,
+protected by ibuf_mutex */
+extern ulint		ibuf_merge_threads_active;
+
+/** Change buffer statistics of one secondary index */
+struct ibuf_index_stat_t {
+	ulint	n_buffered_ops[IBUF_OP_COUNT];
+					/*!< number of operations of each
+					type buffered for the index */
+	ulint	n_merged_ops[IBUF_OP_COUNT];
+					/*!< number of operations of each
+					type merged to the index pages */
+
+	/** Constructor. Required because std::map::operator[] creates
+	missing entries with the default constructor. */
+	ibuf_index_stat_t()
+	{
+		memset(this, 0, sizeof *this);
+	}
+};
+
+/** Change buffer statistics, indexed by dict_index_t::id */
+typedef std::map<index_id_t, ibuf_index_stat_t>	ibuf_stat_per_index_t;
+
+/** Change buffer statistics, indexed by dict_index_t::id */
+extern ibuf_stat_per_index_t	ibuf_stat_per_index;
+/** Mutex protecting ibuf_stat_per_index */
+extern ib_mutex_t		ibuf_stat_per_index_mutex;
+
 /* The purpose of the insert buffer is to reduce random disk access.
 When we wish to insert a record into a non-unique secondary index and
 the B-tree leaf page where the record belongs to is not in the buffer
@@ -381,6 +416,17 @@ ibuf_contract_in_background(
 					If FALSE then the size of contract
 					batch is determined based on the
 					current size of the ibuf tree. */
+/*********************************************************************//**
+This is the thread for background change buffer merging. When
+innodb_ibuf_merge_threads is nonzero, these threads do the change buffer
+merge in place of the master thread.
+@return this function does not return, it calls os_thread_exit() */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(ibuf_merge_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
 #endif /* !UNIV_HOTBACKUP */
 /*********************************************************************//**
 Parses a redo log record of an ibuf bitmap page init.
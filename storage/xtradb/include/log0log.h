@@ -51,6 +51,8 @@ typedef	ib_uint64_t		lsn_t;
 struct log_t;
 /** Redo log group */
 struct log_group_t;
+/** Follower in the group commit queue */
+struct log_group_commit_waiter_t;
 
 #ifdef UNIV_DEBUG
 /** Flag: write to log file? */
@@ -76,6 +78,10 @@ extern log_checksum_func_t log_checksum_algorithm_ptr;
 #define LOG_WAIT_ONE_GROUP	92
 #define	LOG_WAIT_ALL_GROUPS	93
 /* @} */
+/** Number of slots in the group commit size histogram; slot n counts
+the groups of 2^n to 2^(n+1)-1 commits, and the last slot counts all
+larger groups */
+#define LOG_GROUP_COMMIT_N_SIZES	6
 /** Maximum number of log groups in log_group_t::checkpoint_buf */
 #define LOG_MAX_N_GROUPS	32
 
@@ -243,6 +249,19 @@ log_write_up_to(
 	ibool	flush_to_disk);
 			/*!< in: TRUE if we want the written log
 			also to be flushed to disk */
+/******************************************************//**
+Writes and flushes the log to disk up to a given lsn on behalf of a
+committing transaction. The first thread to arrive becomes the group
+commit leader and calls log_write_up_to(); threads that arrive while it
+is flushing queue up behind it and are woken when the flush completes.
+Those covered by the flushed lsn return at once, the others elect the
+next leader among themselves. */
+UNIV_INTERN
+void
+log_group_commit_up_to(
+/*===================*/
+	lsn_t	lsn);	/*!< in: log sequence number up to which
+			the log must be flushed */
 /****************************************************************//**
 Does a syncronous flush of the log buffer to disk. */
 UNIV_INTERN
@@ -963,6 +982,26 @@ struct log_t{
 					but NOTE that to set or reset this
 					event, the thread MUST own the log
 					mutex! */
+	ib_mutex_t	group_commit_mutex;/*!< mutex protecting the
+					group_commit_ fields below; never
+					held while acquiring another latch */
+	ibool		group_commit_leader;
+					/*!< TRUE while a group commit
+					leader is writing the log */
+	log_group_commit_waiter_t*
+			group_commit_queue;
+					/*!< followers waiting for the
+					current leader, newest first */
+	os_event_t	group_commit_event;
+					/*!< set when a leader completes;
+					followers wait for this */
+	lsn_t		group_commit_lsn;
+					/*!< flushed_to_disk_lsn as seen by
+					the last leader */
+	ulint		group_commit_sizes[LOG_GROUP_COMMIT_N_SIZES];
+					/*!< histogram of the number of
+					commits completed by a leader,
+					including itself */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
 					far */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
@@ -91,6 +91,30 @@ UNIV_INTERN
 void
 mem_close(void);
 /*===========*/
+#ifndef UNIV_HOTBACKUP
+/******************************************************************//**
+Initializes the block cache. */
+UNIV_INTERN
+void
+mem_block_cache_init(void);
+/*======================*/
+/******************************************************************//**
+Frees all blocks held in the block cache and the cache itself. */
+UNIV_INTERN
+void
+mem_block_cache_close(void);
+/*=======================*/
+/******************************************************************//**
+Returns statistics of the heap block cache. */
+UNIV_INTERN
+void
+mem_block_cache_get_stats(
+/*======================*/
+	ulint*	hits,	/*!< out: allocations served from the cache */
+	ulint*	misses,	/*!< out: allocations of the cached block size
+			that had to call malloc() */
+	ulint*	bytes);	/*!< out: bytes currently held in the cache */
+#endif /* !UNIV_HOTBACKUP */
 
 #ifdef UNIV_DEBUG
 /**************************************************************//**
@@ -281,6 +281,7 @@ extern ib_uint64_t	srv_log_file_size_requested;
 extern ulint	srv_log_buffer_size;
 extern uint	srv_flush_log_at_timeout;
 extern char	srv_use_global_flush_log_at_trx_commit;
+extern my_bool	srv_log_group_commit;
 extern char	srv_adaptive_flushing;
 
 /* If this flag is TRUE, then we will load the indexes' (and tables') metadata
@@ -299,11 +300,15 @@ extern my_bool	srv_use_sys_malloc;
 #else
 extern ibool	srv_use_sys_malloc;
 #endif /* UNIV_HOTBACKUP */
+extern ulong	srv_mem_block_cache_size;
 extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern my_bool	srv_buf_pool_populate;	/*!< virtual page preallocation */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
 extern ulong	srv_n_page_hash_locks;	/*!< number of locks to
 					protect buf_pool->page_hash */
+extern my_bool	srv_page_hash_open_addressing;
+					/*!< whether to index the page_hash
+					with an open addressing table */
 extern ulong	srv_LRU_scan_depth;	/*!< Scan depth for LRU
 					flush batch */
 extern ulong	srv_flush_neighbors;	/*!< whether or not to flush
@@ -355,6 +360,7 @@ extern ulong	srv_empty_free_list_algorithm;
 extern ulint	srv_n_file_io_threads;
 extern my_bool	srv_random_read_ahead;
 extern ulong	srv_read_ahead_threshold;
+extern ulong	srv_blob_read_ahead_pages;
 extern ulint	srv_n_read_io_threads;
 extern ulint	srv_n_write_io_threads;
 
@@ -523,6 +529,9 @@ extern ib_mutex_t	server_mutex;
 
 #define SRV_MAX_N_PURGE_THREADS 32
 
+/** Maximum number of change buffer merge threads */
+#define SRV_MAX_N_IBUF_MERGE_THREADS 32
+
 /* Array of English strings describing the current state of an
 i/o handler thread */
 extern const char* srv_io_thread_op_info[];
@@ -573,6 +582,10 @@ extern ulong srv_n_purge_threads;
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
+/* the number of dedicated change buffer merge threads; 0 means that
+the master thread does the background change buffer merge */
+extern ulong srv_n_ibuf_merge_threads;
+
 /* the number of sync wait arrays */
 extern ulong srv_sync_array_size;
 
@@ -1015,6 +1028,8 @@ struct export_var_t{
 	ulint innodb_log_waits;			/*!< srv_log_waits */
 	ulint innodb_log_write_requests;	/*!< srv_log_write_requests */
 	ulint innodb_log_writes;		/*!< srv_log_writes */
+	ulint innodb_log_group_commit_sizes[LOG_GROUP_COMMIT_N_SIZES];
+						/*!< log_sys->group_commit_sizes */
 	lsn_t innodb_os_log_written;		/*!< srv_os_log_written */
 	lsn_t innodb_lsn_current;
 	lsn_t innodb_lsn_flushed;
@@ -1023,6 +1038,12 @@ struct export_var_t{
 	ulint innodb_master_thread_idle_loops;	/*!< srv_main_idle_loops */
 	ib_int64_t innodb_max_trx_id;
 	ulint innodb_mem_adaptive_hash;
+	ulint innodb_mem_block_cache_bytes;	/*!< bytes held in the
+						heap block cache */
+	ulint innodb_mem_block_cache_hits;	/*!< heap blocks served
+						from the cache */
+	ulint innodb_mem_block_cache_misses;	/*!< heap blocks of the
+						cached size malloc()ed */
 	ulint innodb_mem_dictionary;
 	ulint innodb_mem_total;
 	ib_int64_t innodb_mutex_os_waits;
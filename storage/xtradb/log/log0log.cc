@@ -100,6 +100,7 @@ UNIV_INTERN mysql_pfs_key_t	archive_lock_key;
 #ifdef UNIV_PFS_MUTEX
 UNIV_INTERN mysql_pfs_key_t	log_sys_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	log_flush_order_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	log_group_commit_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
 #ifdef UNIV_DEBUG
@@ -1000,6 +1001,16 @@ log_init(void)
 
 	os_event_set(log_sys->one_flushed_event);
 
+	mutex_create(log_group_commit_mutex_key,
+		     &log_sys->group_commit_mutex, SYNC_NO_ORDER_CHECK);
+
+	log_sys->group_commit_leader = FALSE;
+	log_sys->group_commit_queue = NULL;
+	log_sys->group_commit_event = os_event_create();
+	log_sys->group_commit_lsn = 0;
+	memset(log_sys->group_commit_sizes, 0,
+	       sizeof log_sys->group_commit_sizes);
+
 	/*----------------------------*/
 
 	log_sys->next_checkpoint_no = 0;
@@ -1768,6 +1779,122 @@ do_waits:
 	}
 }
 
+/** Follower in the group commit queue. It lives on the stack of the
+waiting thread and is only accessed under log_sys->group_commit_mutex. */
+struct log_group_commit_waiter_t {
+	lsn_t				lsn;	/*!< lsn the follower needs
+						flushed */
+	ibool				done;	/*!< set by the leader if its
+						flush covered lsn */
+	log_group_commit_waiter_t*	next;	/*!< next follower in
+						log_sys->group_commit_queue */
+};
+
+/******************************************************//**
+Writes and flushes the log to disk up to a given lsn on behalf of a
+committing transaction. The first thread to arrive becomes the group
+commit leader and calls log_write_up_to(); threads that arrive while it
+is flushing queue up behind it and are woken when the flush completes.
+Those covered by the flushed lsn return at once, the others elect the
+next leader among themselves. */
+UNIV_INTERN
+void
+log_group_commit_up_to(
+/*===================*/
+	lsn_t	lsn)	/*!< in: log sequence number up to which
+			the log must be flushed */
+{
+	log_group_commit_waiter_t	waiter;
+	log_group_commit_waiter_t*	w;
+	lsn_t				flushed_lsn;
+	ulint				n_commits;
+	ulint				slot;
+
+	mutex_enter(&log_sys->group_commit_mutex);
+
+	while (log_sys->group_commit_leader) {
+		ib_int64_t	sig_count;
+
+		if (log_sys->group_commit_lsn >= lsn) {
+			mutex_exit(&log_sys->group_commit_mutex);
+
+			return;
+		}
+
+		waiter.lsn = lsn;
+		waiter.done = FALSE;
+		waiter.next = log_sys->group_commit_queue;
+		log_sys->group_commit_queue = &waiter;
+
+		sig_count = os_event_reset(log_sys->group_commit_event);
+
+		mutex_exit(&log_sys->group_commit_mutex);
+
+		os_event_wait_low(log_sys->group_commit_event, sig_count);
+
+		mutex_enter(&log_sys->group_commit_mutex);
+
+		/* The leader that woke us has removed us from the queue.
+		If its flush did not cover our lsn, we either follow the
+		next leader or become it. */
+		if (waiter.done) {
+			mutex_exit(&log_sys->group_commit_mutex);
+
+			return;
+		}
+	}
+
+	if (log_sys->group_commit_lsn >= lsn) {
+		mutex_exit(&log_sys->group_commit_mutex);
+
+		return;
+	}
+
+	log_sys->group_commit_leader = TRUE;
+
+	mutex_exit(&log_sys->group_commit_mutex);
+
+	/* This writes and flushes everything in the log buffer, which
+	usually covers the commits of the followers that queue up while
+	we are doing it. */
+	log_write_up_to(lsn, LOG_WAIT_ONE_GROUP, TRUE);
+
+	mutex_enter(&log_sys->mutex);
+	flushed_lsn = log_sys->flushed_to_disk_lsn;
+	mutex_exit(&log_sys->mutex);
+
+	mutex_enter(&log_sys->group_commit_mutex);
+
+	ut_ad(log_sys->group_commit_leader);
+
+	if (flushed_lsn > log_sys->group_commit_lsn) {
+		log_sys->group_commit_lsn = flushed_lsn;
+	}
+
+	n_commits = 1;
+
+	for (w = log_sys->group_commit_queue; w != NULL; w = w->next) {
+		if (w->lsn <= flushed_lsn) {
+			w->done = TRUE;
+			n_commits++;
+		}
+	}
+
+	for (slot = 0;
+	     slot < LOG_GROUP_COMMIT_N_SIZES - 1 && (n_commits >> (slot + 1));
+	     slot++) {
+	}
+
+	log_sys->group_commit_sizes[slot]++;
+
+	log_sys->group_commit_queue = NULL;
+	log_sys->group_commit_leader = FALSE;
+
+	os_event_set(log_sys->group_commit_event);
+
+	mutex_exit(&log_sys->group_commit_mutex);
+}
+
 /****************************************************************//**
 Does a syncronous flush of the log buffer to disk. */
 UNIV_INTERN
@@ -4037,6 +4164,8 @@ log_shutdown(void)
 
 	os_event_free(log_sys->no_flush_event);
 	os_event_free(log_sys->one_flushed_event);
+	os_event_free(log_sys->group_commit_event);
+	mutex_free(&log_sys->group_commit_mutex);
 
 	rw_lock_free(&log_sys->checkpoint_lock);
 
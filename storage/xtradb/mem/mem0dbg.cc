@@ -175,6 +175,13 @@ mem_init(
 	}
 
 	mem_comm_pool = mem_pool_create(size);
+
+	if (UNIV_LIKELY(srv_use_sys_malloc)) {
+		/* The block cache holds blocks obtained with malloc()
+		and frees them with free(), so it can only be used
+		when the mem_comm_pool is bypassed. */
+		mem_block_cache_init();
+	}
 }
 
 /******************************************************************//**
@@ -184,6 +191,7 @@ void
 mem_close(void)
 /*===========*/
 {
+	mem_block_cache_close();
 	mem_pool_free(mem_comm_pool);
 	mem_comm_pool = NULL;
 #ifdef UNIV_MEM_DEBUG
@@ -31,6 +31,7 @@ Created 6/9/1994 Heikki Tuuri
 #include "buf0buf.h"
 #include "srv0srv.h"
 #include "mem0dbg.cc"
+#include "ut0counter.h"
 #include <stdarg.h>
 
 /*
@@ -98,6 +99,273 @@ UT_LIST_BASE_NODE_T(mem_block_t)	mem_block_list;
 
 #endif
 
+#ifndef UNIV_HOTBACKUP
+/*
+			THE BLOCK CACHE
+			===============
+
+When innodb_use_sys_malloc is set, every heap block is obtained from
+malloc() and returned with free(). Short-lived heaps, such as the ones
+created for each row in row_search_for_mysql() and in the row update
+code, then spend a noticeable share of their time in the allocator.
+
+If innodb_mem_block_cache_size is nonzero, freed dynamic blocks of the
+standard size are kept in a small cache and handed out again to the
+next heap that needs such a block. Each thread hashes its id to one of
+MEM_BLOCK_CACHE_N_SLOTS slots, each of which holds up to
+MEM_BLOCK_CACHE_SLOT_SIZE blocks; slots are padded to a cache line so
+that threads in different slots do not contend. Blocks that do not fit
+in the slot go to a shared overflow pool, whose size in bytes is capped
+by innodb_mem_block_cache_size; beyond that they are freed. */
+
+/** Number of per-thread slots in the block cache */
+#define MEM_BLOCK_CACHE_N_SLOTS		64
+
+/** Maximum number of blocks held in one slot */
+#define MEM_BLOCK_CACHE_SLOT_SIZE	4
+
+/** A slot of the block cache */
+struct mem_block_cache_slot_t {
+	os_fast_mutex_t	mutex;		/*!< protects the fields below */
+	ulint		n_blocks;	/*!< number of cached blocks */
+	mem_block_t*	blocks[MEM_BLOCK_CACHE_SLOT_SIZE];
+					/*!< cached blocks */
+	byte		pad[CACHE_LINE_SIZE];
+					/*!< padding to prevent other
+					slots from sharing the cache line */
+};
+
+/** The per-thread slots of the block cache */
+static mem_block_cache_slot_t	mem_block_cache_slots[MEM_BLOCK_CACHE_N_SLOTS];
+
+/** Mutex protecting mem_block_cache_pool */
+static os_fast_mutex_t		mem_block_cache_mutex;
+
+/** The shared overflow pool of the block cache, linked through
+mem_block_t::list; protected by mem_block_cache_mutex */
+static UT_LIST_BASE_NODE_T(mem_block_t)	mem_block_cache_pool;
+
+/** Length of a cached block, header included; set in mem_init() */
+static ulint			mem_block_cache_len;
+
+/** TRUE if the block cache has been initialized */
+static ibool			mem_block_cache_inited;
+
+/** Number of block allocations served from the cache */
+static ib_counter_t<ulint>	mem_block_cache_n_hits;
+
+/** Number of block allocations of the cached size that missed */
+static ib_counter_t<ulint>	mem_block_cache_n_misses;
+
+#ifdef UNIV_PFS_MUTEX
+/* Key to register the block cache mutexes with performance schema */
+UNIV_INTERN mysql_pfs_key_t	mem_block_cache_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/******************************************************************//**
+Returns the block cache slot of the calling thread.
+@return slot */
+static
+mem_block_cache_slot_t*
+mem_block_cache_get_slot(void)
+/*==========================*/
+{
+	ulint	id = (ulint) os_thread_get_curr_id();
+
+	/* Thread ids are often addresses of thread stacks, which are
+	aligned to large powers of two: mix in the higher bits. */
+	id ^= (id >> 13) ^ (id >> 23);
+
+	return(&mem_block_cache_slots[id % MEM_BLOCK_CACHE_N_SLOTS]);
+}
+
+/******************************************************************//**
+Checks whether blocks of length len may be taken from or returned to
+the block cache.
+@return TRUE if the block cache can be used */
+UNIV_INLINE
+ibool
+mem_block_cache_enabled(
+/*====================*/
+	ulint	len)	/*!< in: block length, header included */
+{
+	return(mem_block_cache_inited
+	       && srv_mem_block_cache_size
+	       && len == mem_block_cache_len);
+}
+
+/******************************************************************//**
+Takes a block from the block cache.
+@return block, or NULL if the cache is empty */
+static
+mem_block_t*
+mem_block_cache_get(void)
+/*=====================*/
+{
+	mem_block_cache_slot_t*	slot = mem_block_cache_get_slot();
+	mem_block_t*		block = NULL;
+
+	os_fast_mutex_lock(&slot->mutex);
+
+	if (slot->n_blocks) {
+		block = slot->blocks[--slot->n_blocks];
+	}
+
+	os_fast_mutex_unlock(&slot->mutex);
+
+	if (!block && UT_LIST_GET_LEN(mem_block_cache_pool)) {
+		os_fast_mutex_lock(&mem_block_cache_mutex);
+
+		block = UT_LIST_GET_FIRST(mem_block_cache_pool);
+
+		if (block) {
+			UT_LIST_REMOVE(list, mem_block_cache_pool, block);
+		}
+
+		os_fast_mutex_unlock(&mem_block_cache_mutex);
+	}
+
+	if (block) {
+		mem_block_cache_n_hits.inc();
+	} else {
+		mem_block_cache_n_misses.inc();
+	}
+
+	return(block);
+}
+
+/******************************************************************//**
+Returns a block to the block cache.
+@return TRUE if the block was cached, FALSE if the caller must free it */
+static
+ibool
+mem_block_cache_put(
+/*================*/
+	mem_block_t*	block)	/*!< in: block, removed from its heap */
+{
+	mem_block_cache_slot_t*	slot = mem_block_cache_get_slot();
+	ibool			cached = FALSE;
+
+	os_fast_mutex_lock(&slot->mutex);
+
+	if (slot->n_blocks < MEM_BLOCK_CACHE_SLOT_SIZE) {
+		slot->blocks[slot->n_blocks++] = block;
+		cached = TRUE;
+	}
+
+	os_fast_mutex_unlock(&slot->mutex);
+
+	if (cached) {
+		return(TRUE);
+	}
+
+	os_fast_mutex_lock(&mem_block_cache_mutex);
+
+	if ((UT_LIST_GET_LEN(mem_block_cache_pool) + 1) * mem_block_cache_len
+	    <= srv_mem_block_cache_size) {
+
+		UT_LIST_ADD_FIRST(list, mem_block_cache_pool, block);
+		cached = TRUE;
+	}
+
+	os_fast_mutex_unlock(&mem_block_cache_mutex);
+
+	return(cached);
+}
+
+/******************************************************************//**
+Initializes the block cache. */
+UNIV_INTERN
+void
+mem_block_cache_init(void)
+/*======================*/
+{
+	ulint	i;
+
+	ut_a(!mem_block_cache_inited);
+
+	for (i = 0; i < MEM_BLOCK_CACHE_N_SLOTS; i++) {
+		os_fast_mutex_init(mem_block_cache_mutex_key,
+				   &mem_block_cache_slots[i].mutex);
+		mem_block_cache_slots[i].n_blocks = 0;
+	}
+
+	os_fast_mutex_init(mem_block_cache_mutex_key, &mem_block_cache_mutex);
+	UT_LIST_INIT(mem_block_cache_pool);
+
+	mem_block_cache_len = MEM_BLOCK_HEADER_SIZE
+		+ MEM_SPACE_NEEDED(MEM_BLOCK_STANDARD_SIZE);
+
+	mem_block_cache_inited = TRUE;
+}
+
+/******************************************************************//**
+Frees all blocks held in the block cache and the cache itself. */
+UNIV_INTERN
+void
+mem_block_cache_close(void)
+/*=======================*/
+{
+	ulint		i;
+	mem_block_t*	block;
+
+	if (!mem_block_cache_inited) {
+		return;
+	}
+
+	mem_block_cache_inited = FALSE;
+
+	for (i = 0; i < MEM_BLOCK_CACHE_N_SLOTS; i++) {
+		mem_block_cache_slot_t*	slot = &mem_block_cache_slots[i];
+
+		while (slot->n_blocks) {
+			free(slot->blocks[--slot->n_blocks]);
+		}
+
+		os_fast_mutex_free(&slot->mutex);
+	}
+
+	while ((block = UT_LIST_GET_FIRST(mem_block_cache_pool)) != NULL) {
+		UT_LIST_REMOVE(list, mem_block_cache_pool, block);
+		free(block);
+	}
+
+	os_fast_mutex_free(&mem_block_cache_mutex);
+}
+
+/******************************************************************//**
+Returns statistics of the heap block cache. */
+UNIV_INTERN
+void
+mem_block_cache_get_stats(
+/*======================*/
+	ulint*	hits,	/*!< out: allocations served from the cache */
+	ulint*	misses,	/*!< out: allocations of the cached block size
+			that had to call malloc() */
+	ulint*	bytes)	/*!< out: bytes currently held in the cache */
+{
+	ulint	n_blocks = 0;
+	ulint	i;
+
+	*hits = mem_block_cache_n_hits;
+	*misses = mem_block_cache_n_misses;
+
+	if (!mem_block_cache_inited) {
+		*bytes = 0;
+		return;
+	}
+
+	/* Dirty reads: the result is only used for monitoring. */
+	for (i = 0; i < MEM_BLOCK_CACHE_N_SLOTS; i++) {
+		n_blocks += mem_block_cache_slots[i].n_blocks;
+	}
+
+	n_blocks += UT_LIST_GET_LEN(mem_block_cache_pool);
+
+	*bytes = n_blocks * mem_block_cache_len;
+}
+#endif /* !UNIV_HOTBACKUP */
+
 /**********************************************************************//**
 Duplicates a NUL-terminated string, allocated from a memory heap.
 @return	own: a copy of the string */
@@ -324,6 +592,17 @@ mem_heap_create_block_func(
 		mem_analyze_corruption(heap);
 	}
 
+#ifndef UNIV_HOTBACKUP
+	/* Round requests that are close to the standard size up to it,
+	so that the block can be served from the block cache. */
+	if (mem_block_cache_inited && srv_mem_block_cache_size
+	    && n > MEM_BLOCK_STANDARD_SIZE / 2
+	    && n < MEM_BLOCK_STANDARD_SIZE) {
+
+		n = MEM_BLOCK_STANDARD_SIZE;
+	}
+#endif /* !UNIV_HOTBACKUP */
+
 	/* In dynamic allocation, calculate the size: block header + data. */
 	len = MEM_BLOCK_HEADER_SIZE + MEM_SPACE_NEEDED(n);
 
@@ -332,8 +611,16 @@ mem_heap_create_block_func(
 
 		ut_ad(type == MEM_HEAP_DYNAMIC || n <= MEM_MAX_ALLOC_IN_BUF);
 
-		block = static_cast<mem_block_t*>(
-			mem_area_alloc(&len, mem_comm_pool));
+		block = NULL;
+
+		if (mem_block_cache_enabled(len)) {
+			block = mem_block_cache_get();
+		}
+
+		if (!block) {
+			block = static_cast<mem_block_t*>(
+				mem_area_alloc(&len, mem_comm_pool));
+		}
 	} else {
 		len = UNIV_PAGE_SIZE;
 
@@ -518,7 +805,12 @@ mem_heap_block_free(
 	if (type == MEM_HEAP_DYNAMIC || len < UNIV_PAGE_SIZE / 2) {
 
 		ut_ad(!buf_block);
-		mem_area_free(block, mem_comm_pool);
+
+		if (!mem_block_cache_enabled(len)
+		    || !mem_block_cache_put(block)) {
+
+			mem_area_free(block, mem_comm_pool);
+		}
 	} else {
 		ut_ad(type & MEM_HEAP_BUFFER);
 
@@ -218,6 +218,9 @@ UNIV_INTERN uint	srv_flush_log_at_timeout = 1;
 UNIV_INTERN ulong	srv_page_size		= UNIV_PAGE_SIZE_DEF;
 UNIV_INTERN ulong	srv_page_size_shift	= UNIV_PAGE_SIZE_SHIFT_DEF;
 UNIV_INTERN char	srv_use_global_flush_log_at_trx_commit	= TRUE;
+/* If TRUE, transactions that flush the log at commit form groups behind a
+single leader, see log_group_commit_up_to() */
+UNIV_INTERN my_bool	srv_log_group_commit	= TRUE;
 
 /* Try to flush dirty pages so as to avoid IO bursts at
 the checkpoints. */
@@ -242,6 +245,9 @@ UNIV_INTERN const byte*	srv_latin1_ordering;
 
 /* use os/external memory allocator */
 UNIV_INTERN my_bool	srv_use_sys_malloc	= TRUE;
+/* maximum number of bytes of freed memory heap blocks kept in the shared
+pool of the block cache; 0 disables the cache */
+UNIV_INTERN ulong	srv_mem_block_cache_size	= 0;
 /* requested size in kilobytes */
 UNIV_INTERN ulint	srv_buf_pool_size	= ULINT_MAX;
 /* force virtual page preallocation (prefault) */
@@ -250,6 +256,8 @@ UNIV_INTERN my_bool	srv_buf_pool_populate	= FALSE;
 UNIV_INTERN ulint       srv_buf_pool_instances  = 1;
 /* number of locks to protect buf_pool->page_hash */
 UNIV_INTERN ulong	srv_n_page_hash_locks = 16;
+/* whether to index buf_pool->page_hash with an open addressing table */
+UNIV_INTERN my_bool	srv_page_hash_open_addressing = FALSE;
 /** Scan depth for LRU flush batch i.e.: number of blocks scanned*/
 UNIV_INTERN ulong	srv_LRU_scan_depth	= 1024;
 /** whether or not to flush neighbors of a block */
@@ -316,6 +324,11 @@ in the buffer cache and accessed sequentially for InnoDB to trigger a
 readahead request. */
 UNIV_INTERN ulong	srv_read_ahead_threshold	= 56;
 
+/* User settable value of the number of pages that are read ahead
+asynchronously when following the page chain of an externally stored
+column; 0 disables BLOB read-ahead. */
+UNIV_INTERN ulong	srv_blob_read_ahead_pages	= 0;
+
 #ifdef UNIV_LOG_ARCHIVE
 UNIV_INTERN ibool		srv_log_archive_on	= FALSE;
 UNIV_INTERN ibool		srv_archive_recovery	= 0;
@@ -406,6 +419,10 @@ UNIV_INTERN ulong	srv_n_purge_threads = 1;
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
+/* The number of dedicated change buffer merge threads; 0 means that
+the master thread does the background change buffer merge. */
+UNIV_INTERN ulong	srv_n_ibuf_merge_threads = 0;
+
 /* Internal setting for "innodb_stats_method". Decides how InnoDB treats
 NULL value when collecting statistics. By default, it is set to
 SRV_STATS_NULLS_EQUAL(0), ie. all NULL value are treated equal */
@@ -1750,6 +1767,10 @@ srv_export_innodb_status(void)
 		= mem_adaptive_hash;
 	export_vars.innodb_mem_dictionary
 		= mem_dictionary;
+	mem_block_cache_get_stats(
+		&export_vars.innodb_mem_block_cache_hits,
+		&export_vars.innodb_mem_block_cache_misses,
+		&export_vars.innodb_mem_block_cache_bytes);
 	export_vars.innodb_mem_total
 		= ut_total_allocated_memory;
 	export_vars.innodb_mutex_os_waits
@@ -1802,6 +1823,10 @@ srv_export_innodb_status(void)
 
 	export_vars.innodb_log_writes = srv_stats.log_writes;
 
+	memcpy(export_vars.innodb_log_group_commit_sizes,
+	       log_sys->group_commit_sizes,
+	       sizeof export_vars.innodb_log_group_commit_sizes);
+
 	export_vars.innodb_dblwr_pages_written =
 		srv_stats.dblwr_pages_written;
 
@@ -2281,6 +2306,8 @@ srv_any_background_threads_are_active(void)
 		thread_active = "buf_dump_thread";
 	} else if (srv_dict_stats_thread_active) {
 		thread_active = "dict_stats_thread";
+	} else if (ibuf_merge_threads_active) {
+		thread_active = "ibuf_merge_thread";
 	}
 
 	os_event_set(srv_error_event);
@@ -2288,6 +2315,7 @@ srv_any_background_threads_are_active(void)
 	os_event_set(srv_buf_dump_event);
 	os_event_set(lock_sys->timeout_event);
 	os_event_set(dict_stats_event);
+	os_event_set(ibuf_merge_event);
 
 	return(thread_active);
 }
@@ -2710,12 +2738,14 @@ srv_master_do_active_tasks(void)
 	srv_main_thread_op_info = "checking free log space";
 	log_free_check();
 
-	/* Do an ibuf merge */
-	srv_main_thread_op_info = "doing insert buffer merge";
-	counter_time = ut_time_us(NULL);
-	ibuf_contract_in_background(0, FALSE);
-	MONITOR_INC_TIME_IN_MICRO_SECS(
-		MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	/* Do an ibuf merge, unless the merge threads do it */
+	if (!srv_n_ibuf_merge_threads) {
+		srv_main_thread_op_info = "doing insert buffer merge";
+		counter_time = ut_time_us(NULL);
+		ibuf_contract_in_background(0, FALSE);
+		MONITOR_INC_TIME_IN_MICRO_SECS(
+			MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	}
 
 	/* Flush logs if needed */
 	srv_main_thread_op_info = "flushing log";
@@ -2802,12 +2832,14 @@ srv_master_do_idle_tasks(void)
 	srv_main_thread_op_info = "checking free log space";
 	log_free_check();
 
-	/* Do an ibuf merge */
+	/* Do an ibuf merge, unless the merge threads do it */
 	counter_time = ut_time_us(NULL);
-	srv_main_thread_op_info = "doing insert buffer merge";
-	ibuf_contract_in_background(0, TRUE);
-	MONITOR_INC_TIME_IN_MICRO_SECS(
-		MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	if (!srv_n_ibuf_merge_threads) {
+		srv_main_thread_op_info = "doing insert buffer merge";
+		ibuf_contract_in_background(0, TRUE);
+		MONITOR_INC_TIME_IN_MICRO_SECS(
+			MONITOR_SRV_IBUF_MERGE_MICROSECOND, counter_time);
+	}
 
 	if (srv_shutdown_state > 0) {
 		return;
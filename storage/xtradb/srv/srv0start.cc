@@ -1870,6 +1870,7 @@ innobase_start_or_create_for_mysql(void)
 			    + 1 /* srv_purge_coordinator_thread */
 			    + 1 /* buf_dump_thread */
 			    + 1 /* dict_stats_thread */
+			    + srv_n_ibuf_merge_threads
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
 			    + 1 /* buf_flush_page_cleaner_thread */
@@ -2948,6 +2949,11 @@ files_checked:
 		/* Create the dict stats gathering thread */
 		os_thread_create(dict_stats_thread, NULL, NULL);
 
+		/* Create the change buffer merge threads */
+		for (ulint i = 0; i < srv_n_ibuf_merge_threads; ++i) {
+			os_thread_create(ibuf_merge_thread, NULL, NULL);
+		}
+
 		/* Create the thread that will optimize the FTS sub-system. */
 		fts_optimize_init();
 	}
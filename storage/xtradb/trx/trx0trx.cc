@@ -1325,8 +1325,15 @@ trx_flush_log_if_needed_low(
 	case 1:
         case 3:
 		/* Write the log and optionally flush it to disk */
-		log_write_up_to(lsn, LOG_WAIT_ONE_GROUP,
-				srv_unix_file_flush_method != SRV_UNIX_NOSYNC);
+		if (srv_log_group_commit
+		    && srv_unix_file_flush_method != SRV_UNIX_NOSYNC) {
+			log_group_commit_up_to(lsn);
+		} else {
+			log_write_up_to(
+				lsn, LOG_WAIT_ONE_GROUP,
+				srv_unix_file_flush_method
+				!= SRV_UNIX_NOSYNC);
+		}
 		break;
 	case 2:
 		/* Write the log but do not flush it to disk */
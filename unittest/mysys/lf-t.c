@@ -167,9 +167,44 @@ pthread_handler_t test_lf_hash(void *arg)
 }
 
 
+static my_bool sum_element(void *element, void *arg)
+{
+  *(int32 *)arg+= *(int32 *)element;
+  return 0;
+}
+
+static my_bool find_element(void *element, void *arg)
+{
+  return *(int32 *)element == *(int32 *)arg;
+}
+
+void test_lf_hash_iterate()
+{
+  LF_PINS *pins= lf_hash_get_pins(&lf_hash);
+  int32 i, sum= 0, expected= 0;
+  int found_first, found_missing;
+
+  for (i= 1; i <= N_TLH; i++)
+  {
+    lf_hash_insert(&lf_hash, pins, &i);
+    expected+= i;
+  }
+  lf_hash_iterate(&lf_hash, pins, sum_element, &sum);
+  i= 1;
+  found_first= lf_hash_iterate(&lf_hash, pins, find_element, &i);
+  i= N_TLH + 1;
+  found_missing= lf_hash_iterate(&lf_hash, pins, find_element, &i);
+  for (i= 1; i <= N_TLH; i++)
+    lf_hash_delete(&lf_hash, pins, (uchar *)&i, sizeof(i));
+  lf_hash_put_pins(pins);
+  ok(sum == expected && found_first == 1 && found_missing == 0 &&
+     lf_hash.count == 0, "lf_hash_iterate");
+}
+
+
 void do_tests()
 {
-  plan(7);
+  plan(8);
 
   lf_alloc_init(&lf_allocator, sizeof(TLA), offsetof(TLA, not_used));
   lf_hash_init(&lf_hash, sizeof(int), LF_HASH_UNIQUE, 0, sizeof(int), 0,
@@ -188,6 +223,8 @@ void do_tests()
   test_concurrently("lf_alloc (without my_thread_init)",  test_lf_alloc,  N= THREADS, CYCLES);
   test_concurrently("lf_hash (without my_thread_init)",   test_lf_hash,   N= THREADS, CYCLES/10);
 
+  test_lf_hash_iterate();
+
   lf_hash_destroy(&lf_hash);
   lf_alloc_destroy(&lf_allocator);
 }
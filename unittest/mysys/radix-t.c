@@ -0,0 +1,101 @@
+/* Copyright (c) 2014, MariaDB
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#include <my_global.h>
+#include <my_sys.h>
+#include <my_rdtsc.h>
+#include "tap.h"
+
+#define ITEMS 20000
+
+static uchar *data;
+static uchar *keys[ITEMS], *sorted[ITEMS], *buffer[ITEMS];
+
+static int cmp_keys(const void *arg, const void *a, const void *b)
+{
+  return memcmp(*(uchar**) a, *(uchar**) b, *(const size_t*) arg);
+}
+
+/*
+  Fill keys of the given length, with the first prefix bytes the same in
+  all keys (like padding or a constant column) and only a few distinct
+  values in the rest, so that the buckets have duplicates.
+*/
+static void fill_keys(size_t length, size_t prefix)
+{
+  uint i;
+  size_t j;
+  for (i= 0; i < ITEMS; i++)
+  {
+    keys[i]= data + i * length;
+    for (j= 0; j < length; j++)
+      keys[i][j]= j < prefix ? 'x' : (uchar) (rand() % 7);
+  }
+}
+
+/* Equal keys may come in any order, so compare the key values */
+static my_bool same_order(size_t length)
+{
+  uint i;
+  for (i= 0; i < ITEMS; i++)
+    if (memcmp(keys[i], sorted[i], length))
+      return FALSE;
+  return TRUE;
+}
+
+static void test_msd(size_t length, size_t prefix)
+{
+  ulonglong qsort_time, radix_time;
+  size_t size= length;
+
+  fill_keys(length, prefix);
+  memcpy(sorted, keys, sizeof(keys));
+  qsort_time= my_timer_microseconds();
+  my_qsort2(sorted, ITEMS, sizeof(uchar*), cmp_keys, &size);
+  qsort_time= my_timer_microseconds() - qsort_time;
+
+  ok(radixsort_msd_is_applicable(ITEMS, length),
+     "msd radix sort applicable for %u keys of %u bytes",
+     ITEMS, (uint) length);
+  radix_time= my_timer_microseconds();
+  radixsort_msd_for_str_ptr(keys, ITEMS, length, buffer);
+  radix_time= my_timer_microseconds() - radix_time;
+  ok(same_order(length),
+     "msd radix sort of %u byte keys with %u byte common prefix",
+     (uint) length, (uint) prefix);
+  diag("%u byte keys: qsort %llu us, msd radix sort %llu us",
+       (uint) length, qsort_time, radix_time);
+}
+
+int main(int argc __attribute__((unused)),char *argv[])
+{
+  MY_INIT(argv[0]);
+
+  plan(10);
+
+  data= (uchar*) my_malloc(ITEMS * 256, MYF(MY_FAE));
+
+  ok(!radixsort_msd_is_applicable(100, 16), "too few keys for radix sort");
+  test_msd(4, 0);
+  test_msd(16, 8);
+  test_msd(64, 60);
+  test_msd(256, 200);
+  ok(radixsort_is_appliccable(ITEMS, 16) &&
+     !radixsort_is_appliccable(ITEMS, 64),
+     "lsd radix sort only for short keys");
+  my_free(data);
+  my_end(0);
+  return exit_status();
+}